@@ -0,0 +1,51 @@
+#include "AdapterCache.h"
+#include <fstream>
+
+using namespace std;
+using namespace std::filesystem;
+
+namespace
+{
+    // 파일 형식이 바뀌면 올린다
+    const uint32_t AdapterCacheVersion = 1;
+}
+
+AdapterCacheEntry MakeAdapterCacheEntry(const DXGI_ADAPTER_DESC1& desc)
+{
+    return { desc.AdapterLuid, desc.VendorId, desc.DeviceId, desc.SubSysId, desc.Revision };
+}
+
+bool IsSameAdapter(const AdapterCacheEntry& entry, const DXGI_ADAPTER_DESC1& desc)
+{
+    return entry.luid.LowPart == desc.AdapterLuid.LowPart
+        && entry.luid.HighPart == desc.AdapterLuid.HighPart
+        && entry.vendorId == desc.VendorId
+        && entry.deviceId == desc.DeviceId
+        && entry.subSysId == desc.SubSysId
+        && entry.revision == desc.Revision
+        && !(desc.Flags & DXGI_ADAPTER_FLAG_SOFTWARE);
+}
+
+bool LoadAdapterCache(const path& cachePath, AdapterCacheEntry& entry)
+{
+    ifstream file(cachePath, ios::binary);
+    if (!file)
+        return false;
+
+    uint32_t version = 0;
+    if (!file.read(reinterpret_cast<char*>(&version), sizeof(version)) || version != AdapterCacheVersion)
+        return false;
+
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(&entry), sizeof(entry)));
+}
+
+bool SaveAdapterCache(const path& cachePath, const AdapterCacheEntry& entry)
+{
+    ofstream file(cachePath, ios::binary | ios::trunc);
+    if (!file)
+        return false;
+
+    file.write(reinterpret_cast<const char*>(&AdapterCacheVersion), sizeof(AdapterCacheVersion));
+    file.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+    return static_cast<bool>(file);
+}
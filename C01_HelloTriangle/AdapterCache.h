@@ -0,0 +1,23 @@
+#pragma once
+#include <Windows.h>
+#include <dxgi1_6.h>
+#include <filesystem>
+
+// 지난번 시작때 고른 어댑터
+// 다음 시작에서는 어댑터마다 테스트 device를 만들어보지 않고 이 어댑터로 바로 device를 만든다
+struct AdapterCacheEntry
+{
+    LUID luid;
+    UINT vendorId;
+    UINT deviceId;
+    UINT subSysId;
+    UINT revision;
+};
+
+AdapterCacheEntry MakeAdapterCacheEntry(const DXGI_ADAPTER_DESC1& desc);
+
+// LUID는 재부팅하면 다른 어댑터를 가리킬 수 있으므로 하드웨어 id까지 비교한다
+bool IsSameAdapter(const AdapterCacheEntry& entry, const DXGI_ADAPTER_DESC1& desc);
+
+bool LoadAdapterCache(const std::filesystem::path& cachePath, AdapterCacheEntry& entry);
+bool SaveAdapterCache(const std::filesystem::path& cachePath, const AdapterCacheEntry& entry);
@@ -0,0 +1,159 @@
+#include "AllocationTracker.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+using namespace std;
+
+namespace
+{
+    atomic<uint64_t> heapAllocationCount(0);
+    thread_local uint64_t threadHeapAllocationCount = 0;
+
+    void* AllocateCounted(size_t size)
+    {
+        heapAllocationCount.fetch_add(1, memory_order_relaxed);
+        threadHeapAllocationCount++;
+        return malloc(size == 0 ? 1 : size);
+    }
+
+    void* AllocateAlignedCounted(size_t size, size_t alignment)
+    {
+        heapAllocationCount.fetch_add(1, memory_order_relaxed);
+        threadHeapAllocationCount++;
+#if defined(_MSC_VER)
+        return _aligned_malloc(size == 0 ? 1 : size, alignment);
+#else
+        // aligned_alloc은 크기가 alignment의 배수여야 한다
+        return aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+    }
+
+    void FreeAligned(void* pointer)
+    {
+#if defined(_MSC_VER)
+        _aligned_free(pointer);
+#else
+        free(pointer);
+#endif
+    }
+}
+
+uint64_t GetHeapAllocationCount()
+{
+    return heapAllocationCount.load(memory_order_relaxed);
+}
+
+uint64_t GetThreadHeapAllocationCount()
+{
+    return threadHeapAllocationCount;
+}
+
+// 배열, nothrow, sized, 정렬 버전까지 모두 바꿔서 어느 new/delete로 들어와도 세고 짝이 맞는 해제로 간다
+void* operator new(size_t size)
+{
+    void* pointer = AllocateCounted(size);
+    if (!pointer)
+        throw bad_alloc();
+
+    return pointer;
+}
+
+void* operator new(size_t size, const nothrow_t&) noexcept
+{
+    return AllocateCounted(size);
+}
+
+void* operator new(size_t size, align_val_t alignment)
+{
+    void* pointer = AllocateAlignedCounted(size, static_cast<size_t>(alignment));
+    if (!pointer)
+        throw bad_alloc();
+
+    return pointer;
+}
+
+void* operator new(size_t size, align_val_t alignment, const nothrow_t&) noexcept
+{
+    return AllocateAlignedCounted(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new[](size_t size, const nothrow_t&) noexcept
+{
+    return AllocateCounted(size);
+}
+
+void* operator new[](size_t size, align_val_t alignment)
+{
+    return operator new(size, alignment);
+}
+
+void* operator new[](size_t size, align_val_t alignment, const nothrow_t&) noexcept
+{
+    return AllocateAlignedCounted(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* pointer) noexcept
+{
+    free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept
+{
+    free(pointer);
+}
+
+void operator delete(void* pointer, const nothrow_t&) noexcept
+{
+    free(pointer);
+}
+
+void operator delete(void* pointer, align_val_t) noexcept
+{
+    FreeAligned(pointer);
+}
+
+void operator delete(void* pointer, size_t, align_val_t) noexcept
+{
+    FreeAligned(pointer);
+}
+
+void operator delete(void* pointer, align_val_t, const nothrow_t&) noexcept
+{
+    FreeAligned(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    free(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept
+{
+    free(pointer);
+}
+
+void operator delete[](void* pointer, const nothrow_t&) noexcept
+{
+    free(pointer);
+}
+
+void operator delete[](void* pointer, align_val_t) noexcept
+{
+    FreeAligned(pointer);
+}
+
+void operator delete[](void* pointer, size_t, align_val_t) noexcept
+{
+    FreeAligned(pointer);
+}
+
+void operator delete[](void* pointer, align_val_t, const nothrow_t&) noexcept
+{
+    FreeAligned(pointer);
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include <cstdint>
+
+// 전역 operator new를 바꿔서 힙 할당 횟수를 센다 (AllocationTracker.cpp)
+// 프레임 루프처럼 안정된 뒤에는 할당이 없어야 하는 구간을 확인할때 쓴다
+uint64_t GetHeapAllocationCount();       // 모든 스레드
+uint64_t GetThreadHeapAllocationCount(); // 부른 스레드
+
+// 만든 뒤로 이 스레드에서 일어난 힙 할당 수. 워커 스레드에서 한 할당은 세지 않는다
+class HeapAllocationScope
+{
+    uint64_t startCount;
+
+public:
+    HeapAllocationScope() : startCount(GetThreadHeapAllocationCount()) {}
+
+    uint64_t GetCount() const { return GetThreadHeapAllocationCount() - startCount; }
+};
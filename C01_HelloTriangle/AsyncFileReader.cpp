@@ -0,0 +1,154 @@
+#include "AsyncFileReader.h"
+#include <fstream>
+
+using namespace std;
+
+#if defined(_WIN32)
+
+namespace
+{
+    // completion port를 닫으라는 신호로 쓰는 completion key
+    const ULONG_PTR StopKey = 1;
+}
+
+AsyncFileReader::AsyncFileReader(Executor& executor)
+    : executor(executor)
+{
+    completionPort = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+    thread = std::thread([this] { Run(); });
+}
+
+AsyncFileReader::~AsyncFileReader()
+{
+    PostQueuedCompletionStatus(completionPort, 0, StopKey, nullptr);
+    thread.join();
+    CloseHandle(completionPort);
+}
+
+bool AsyncFileReader::Start(ReadOperation* operation)
+{
+    operation->result.succeeded = false;
+
+    operation->file = CreateFile(operation->path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_OVERLAPPED, nullptr);
+    if (operation->file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(operation->file, &fileSize) || fileSize.HighPart != 0)
+    {
+        CloseHandle(operation->file);
+        return false;
+    }
+
+    operation->result.data.resize(fileSize.LowPart);
+
+    // 빈 파일은 읽을 것이 없다
+    if (fileSize.LowPart == 0)
+    {
+        CloseHandle(operation->file);
+        operation->result.succeeded = true;
+        return false;
+    }
+
+    if (!CreateIoCompletionPort(operation->file, completionPort, 0, 0))
+    {
+        CloseHandle(operation->file);
+        return false;
+    }
+
+    // 동기적으로 끝나도 completion port로 완료가 통지되므로 Run에서 한 곳으로 처리한다
+    ZeroMemory(&operation->overlapped, sizeof(operation->overlapped));
+    if (!ReadFile(operation->file, operation->result.data.data(), fileSize.LowPart, nullptr, &operation->overlapped)
+        && GetLastError() != ERROR_IO_PENDING)
+    {
+        CloseHandle(operation->file);
+        return false;
+    }
+
+    return true;
+}
+
+void AsyncFileReader::Run()
+{
+    for (;;)
+    {
+        DWORD bytesTransferred = 0;
+        ULONG_PTR completionKey = 0;
+        OVERLAPPED* overlapped = nullptr;
+
+        BOOL succeeded = GetQueuedCompletionStatus(completionPort, &bytesTransferred, &completionKey, &overlapped, INFINITE);
+        if (overlapped == nullptr)
+        {
+            if (completionKey == StopKey)
+                return;
+
+            continue;
+        }
+
+        ReadOperation* operation = reinterpret_cast<ReadOperation*>(overlapped);
+        CloseHandle(operation->file);
+
+        operation->result.succeeded = succeeded && bytesTransferred == operation->result.data.size();
+        executor.Post(operation->handle);
+    }
+}
+
+#else
+
+AsyncFileReader::AsyncFileReader(Executor& executor)
+    : executor(executor), stopping(false)
+{
+    thread = std::thread([this] { Run(); });
+}
+
+AsyncFileReader::~AsyncFileReader()
+{
+    {
+        lock_guard<mutex> lock(requestMutex);
+        stopping = true;
+    }
+    cv.notify_one();
+    thread.join();
+}
+
+bool AsyncFileReader::Start(ReadOperation* operation)
+{
+    {
+        lock_guard<mutex> lock(requestMutex);
+        requests.push_back(operation);
+    }
+    cv.notify_one();
+    return true;
+}
+
+void AsyncFileReader::Run()
+{
+    for (;;)
+    {
+        ReadOperation* operation;
+        {
+            unique_lock<mutex> lock(requestMutex);
+            cv.wait(lock, [this] { return stopping || !requests.empty(); });
+            if (requests.empty())
+                return;
+
+            operation = requests.front();
+            requests.pop_front();
+        }
+
+        operation->result.succeeded = false;
+
+        ifstream file(operation->path, ios::binary | ios::ate);
+        if (file)
+        {
+            streamsize size = file.tellg();
+            file.seekg(0);
+            operation->result.data.resize(static_cast<size_t>(size));
+            operation->result.succeeded = static_cast<bool>(file.read(reinterpret_cast<char*>(operation->result.data.data()), size));
+        }
+
+        executor.Post(operation->handle);
+    }
+}
+
+#endif
@@ -0,0 +1,82 @@
+#pragma once
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Executor.h"
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <condition_variable>
+#endif
+
+struct FileReadResult
+{
+    bool succeeded;
+    std::vector<uint8_t> data;
+};
+
+// 파일 전체를 비동기로 읽는다. 읽기가 끝나면 기다리던 코루틴을 Executor로 넘긴다
+// Windows에서는 overlapped I/O와 completion port 하나로 여러 읽기를 동시에 진행하고,
+// 그 외 환경에서는 I/O 전용 스레드 하나가 차례로 읽는다
+class AsyncFileReader
+{
+public:
+    struct ReadOperation
+    {
+#if defined(_WIN32)
+        OVERLAPPED overlapped; // 반드시 첫번째 멤버. completion port에서 이걸로 ReadOperation을 찾는다
+        HANDLE file;
+#endif
+        std::filesystem::path path;
+        FileReadResult result;
+        std::coroutine_handle<> handle;
+    };
+
+private:
+    Executor& executor;
+    std::thread thread;
+
+#if defined(_WIN32)
+    HANDLE completionPort;
+#else
+    std::mutex requestMutex;
+    std::condition_variable cv;
+    std::deque<ReadOperation*> requests;
+    bool stopping;
+#endif
+
+public:
+    explicit AsyncFileReader(Executor& executor);
+    ~AsyncFileReader();
+
+    AsyncFileReader(const AsyncFileReader&) = delete;
+    AsyncFileReader& operator=(const AsyncFileReader&) = delete;
+
+    struct Awaiter
+    {
+        AsyncFileReader& reader;
+        ReadOperation operation;
+
+        bool await_ready() noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> handle) { operation.handle = handle; return reader.Start(&operation); }
+        FileReadResult await_resume() { return std::move(operation.result); }
+    };
+
+    // FileReadResult source = co_await fileReader.ReadAsync(path);
+    Awaiter ReadAsync(const std::filesystem::path& path)
+    {
+        Awaiter awaiter{ *this, {} };
+        awaiter.operation.path = path;
+        return awaiter;
+    }
+
+private:
+    // 완료를 기다려야 하면 true, 그 자리에서 실패해서 바로 이어가야 하면 false
+    bool Start(ReadOperation* operation);
+    void Run();
+};
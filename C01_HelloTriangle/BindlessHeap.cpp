@@ -0,0 +1,80 @@
+#include "BindlessHeap.h"
+#include <directx/d3dx12.h>
+
+using namespace winrt;
+
+BindlessHeap::BindlessHeap()
+    : descriptorSize(0)
+{
+}
+
+bool BindlessHeap::IsSupported(ID3D12Device* device)
+{
+    D3D12_FEATURE_DATA_SHADER_MODEL shaderModel = { D3D_SHADER_MODEL_6_6 };
+    if (FAILED(device->CheckFeatureSupport(D3D12_FEATURE_SHADER_MODEL, &shaderModel, sizeof(shaderModel))))
+        return false;
+
+    if (shaderModel.HighestShaderModel < D3D_SHADER_MODEL_6_6)
+        return false;
+
+    D3D12_FEATURE_DATA_D3D12_OPTIONS options = {};
+    if (FAILED(device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS, &options, sizeof(options))))
+        return false;
+
+    return options.ResourceBindingTier >= D3D12_RESOURCE_BINDING_TIER_3;
+}
+
+bool BindlessHeap::Init(ID3D12Device* device, UINT capacity)
+{
+    // 1. 모든 리소스가 들어갈 shader visible 힙 하나
+    D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
+    heapDesc.NumDescriptors = capacity;
+    heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+    heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+    if (FAILED(device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&heap))))
+        return false;
+
+    descriptorSize = device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    indexAllocator.Reset(capacity);
+
+    // 2. root signature는 한번만 만든다. 드로우별 인덱스를 넣을 root constant(b0) 하나뿐이고
+    // 리소스는 셰이더가 ResourceDescriptorHeap에서 직접 꺼내므로 descriptor table이 없다
+    CD3DX12_ROOT_PARAMETER1 rootParameters[1];
+    rootParameters[DrawConstantsRootParameter].InitAsConstants(DrawConstantCount, /*shaderRegister*/ 0, /*registerSpace*/ 0, D3D12_SHADER_VISIBILITY_ALL);
+
+    CD3DX12_VERSIONED_ROOT_SIGNATURE_DESC rootSignatureDesc;
+    rootSignatureDesc.Init_1_1(_countof(rootParameters), rootParameters, /*numStaticSamplers*/ 0, /*pStaticSamplers*/ nullptr, D3D12_ROOT_SIGNATURE_FLAG_CBV_SRV_UAV_HEAP_DIRECTLY_INDEXED);
+
+    com_ptr<ID3DBlob> signature;
+    com_ptr<ID3DBlob> error;
+
+    // HEAP_DIRECTLY_INDEXED는 1.1 이상에서만 serialize된다
+    if (FAILED(D3D12SerializeVersionedRootSignature(&rootSignatureDesc, signature.put(), error.put())))
+        return false;
+
+    if (FAILED(device->CreateRootSignature(/*nodeMask*/0, signature->GetBufferPointer(), signature->GetBufferSize(), IID_PPV_ARGS(&rootSignature))))
+        return false;
+
+    return true;
+}
+
+uint32_t BindlessHeap::CreateStructuredBufferSrv(ID3D12Device* device, ID3D12Resource* buffer, UINT numElements, UINT stride)
+{
+    uint32_t index = indexAllocator.Allocate();
+    if (index == DescriptorIndexAllocator::InvalidIndex)
+        return index;
+
+    D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Format = DXGI_FORMAT_UNKNOWN;
+    srvDesc.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
+    srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    srvDesc.Buffer.FirstElement = 0;
+    srvDesc.Buffer.NumElements = numElements;
+    srvDesc.Buffer.StructureByteStride = stride;
+    srvDesc.Buffer.Flags = D3D12_BUFFER_SRV_FLAG_NONE;
+
+    CD3DX12_CPU_DESCRIPTOR_HANDLE handle(heap->GetCPUDescriptorHandleForHeapStart(), index, descriptorSize);
+    device->CreateShaderResourceView(buffer, &srvDesc, handle);
+
+    return index;
+}
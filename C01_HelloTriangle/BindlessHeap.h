@@ -0,0 +1,47 @@
+#pragma once
+#include <Windows.h>
+#include <winrt/base.h>
+#include <directx/d3d12.h>
+#include "DescriptorIndexAllocator.h"
+
+// SM 6.6 ResourceDescriptorHeap으로 접근하는 shader visible CBV/SRV/UAV 힙 하나와,
+// 드로우마다 인덱스만 넘기는 root constant 하나짜리 root signature
+// 드로우마다 descriptor table을 복사하는 대신 32비트 상수 몇개만 바꾸면 된다
+class BindlessHeap
+{
+    winrt::com_ptr<ID3D12DescriptorHeap> heap;
+    winrt::com_ptr<ID3D12RootSignature> rootSignature;
+    DescriptorIndexAllocator indexAllocator;
+    UINT descriptorSize;
+
+public:
+    static const UINT DefaultCapacity = 65536;
+
+    // bindless.hlsl의 DrawConstants와 맞아야 한다
+    struct DrawConstants
+    {
+        UINT vertexBufferIndex;
+        UINT firstVertex;
+        UINT materialIndex;
+        UINT instanceIndex;
+    };
+
+    static const UINT DrawConstantCount = sizeof(DrawConstants) / sizeof(UINT);
+    static const UINT DrawConstantsRootParameter = 0;
+
+    BindlessHeap();
+
+    // SM 6.6과 Resource Binding Tier 3이 되어야 bindless 모드를 쓸 수 있다
+    static bool IsSupported(ID3D12Device* device);
+
+    bool Init(ID3D12Device* device, UINT capacity = DefaultCapacity);
+
+    // StructuredBuffer SRV를 만들고 셰이더에서 쓸 인덱스를 돌려준다. 실패하면 InvalidIndex
+    uint32_t CreateStructuredBufferSrv(ID3D12Device* device, ID3D12Resource* buffer, UINT numElements, UINT stride);
+
+    void Free(uint32_t index, uint64_t fenceValue) { indexAllocator.Free(index, fenceValue); }
+    void Reclaim(uint64_t completedFenceValue) { indexAllocator.Reclaim(completedFenceValue); }
+
+    ID3D12DescriptorHeap* GetHeap() { return heap.get(); }
+    ID3D12RootSignature* GetRootSignature() { return rootSignature.get(); }
+};
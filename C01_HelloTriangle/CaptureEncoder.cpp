@@ -0,0 +1,287 @@
+#include "CaptureEncoder.h"
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+using namespace std;
+using namespace std::filesystem;
+
+namespace
+{
+    const uint32_t RawMagic = 0x57415246; // "FRAW"
+    const size_t MaxStoredBlockSize = 65535;
+
+    const uint32_t* GetCrcTable()
+    {
+        static const auto table = []
+        {
+            array<uint32_t, 256> t;
+            for (uint32_t n = 0; n < 256; n++)
+            {
+                uint32_t c = n;
+                for (int k = 0; k < 8; k++)
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                t[n] = c;
+            }
+            return t;
+        }();
+        return table.data();
+    }
+
+    uint32_t UpdateCrc(uint32_t crc, const uint8_t* data, size_t size)
+    {
+        const uint32_t* table = GetCrcTable();
+        for (size_t i = 0; i < size; i++)
+            crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        return crc;
+    }
+
+    uint32_t Adler32(const uint8_t* data, size_t size)
+    {
+        // 5552바이트까지는 모듈로 없이 더해도 넘치지 않는다
+        uint32_t a = 1, b = 0;
+        while (size > 0)
+        {
+            size_t blockSize = min<size_t>(size, 5552);
+            for (size_t i = 0; i < blockSize; i++)
+            {
+                a += data[i];
+                b += a;
+            }
+            a %= 65521;
+            b %= 65521;
+            data += blockSize;
+            size -= blockSize;
+        }
+        return (b << 16) | a;
+    }
+
+    void PutU16LE(vector<uint8_t>& output, uint32_t value)
+    {
+        output.push_back(static_cast<uint8_t>(value));
+        output.push_back(static_cast<uint8_t>(value >> 8));
+    }
+
+    void PutU32LE(vector<uint8_t>& output, uint32_t value)
+    {
+        PutU16LE(output, value & 0xFFFF);
+        PutU16LE(output, value >> 16);
+    }
+
+    void PutU32BE(vector<uint8_t>& output, uint32_t value)
+    {
+        output.push_back(static_cast<uint8_t>(value >> 24));
+        output.push_back(static_cast<uint8_t>(value >> 16));
+        output.push_back(static_cast<uint8_t>(value >> 8));
+        output.push_back(static_cast<uint8_t>(value));
+    }
+
+    void PutChunk(vector<uint8_t>& output, const char type[4], const uint8_t* data, size_t size)
+    {
+        PutU32BE(output, static_cast<uint32_t>(size));
+
+        size_t typeOffset = output.size();
+        output.insert(output.end(), type, type + 4);
+        output.insert(output.end(), data, data + size);
+
+        // crc는 type부터 data 끝까지
+        uint32_t crc = UpdateCrc(0xFFFFFFFFu, output.data() + typeOffset, 4 + size) ^ 0xFFFFFFFFu;
+        PutU32BE(output, crc);
+    }
+
+    // 픽셀을 readback 버퍼에서 빽빽한 줄로 옮긴다. PNG는 줄마다 filter 바이트(0 = None)가 앞에 붙는다
+    void CopyRows(const CaptureFrame& frame, bool filterBytes, vector<uint8_t>& rows)
+    {
+        const size_t rowSize = static_cast<size_t>(frame.width) * 4;
+        const size_t stride = rowSize + (filterBytes ? 1 : 0);
+
+        rows.resize(stride * frame.height);
+        for (uint32_t y = 0; y < frame.height; y++)
+        {
+            uint8_t* dest = rows.data() + stride * y;
+            if (filterBytes)
+                *dest++ = 0;
+            memcpy(dest, frame.pixels + static_cast<size_t>(frame.rowPitch) * y, rowSize);
+        }
+    }
+
+    void WritePng(uint32_t width, uint32_t height, const vector<uint8_t>& scanlines, vector<uint8_t>& output)
+    {
+        static const uint8_t signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+        // 압축하지 않는 stored 블록만 쓴다. 크기는 커지지만 캡처가 프레임을 따라갈 수 있다
+        const size_t blockCount = max<size_t>(1, (scanlines.size() + MaxStoredBlockSize - 1) / MaxStoredBlockSize);
+
+        vector<uint8_t> zlib;
+        zlib.reserve(2 + scanlines.size() + blockCount * 5 + 4);
+        zlib.push_back(0x78); // deflate, 32K 윈도우
+        zlib.push_back(0x01); // 압축 레벨 최저, (0x78 << 8 | 0x01) % 31 == 0
+
+        size_t offset = 0;
+        for (size_t block = 0; block < blockCount; block++)
+        {
+            size_t blockSize = min(MaxStoredBlockSize, scanlines.size() - offset);
+            zlib.push_back(block + 1 == blockCount ? 1 : 0); // BFINAL, BTYPE = 00
+            PutU16LE(zlib, static_cast<uint32_t>(blockSize));
+            PutU16LE(zlib, static_cast<uint32_t>(~blockSize & 0xFFFF));
+            zlib.insert(zlib.end(), scanlines.begin() + offset, scanlines.begin() + offset + blockSize);
+            offset += blockSize;
+        }
+        PutU32BE(zlib, Adler32(scanlines.data(), scanlines.size()));
+
+        vector<uint8_t> header;
+        PutU32BE(header, width);
+        PutU32BE(header, height);
+        header.push_back(8); // bit depth
+        header.push_back(6); // RGBA
+        header.push_back(0); // compression
+        header.push_back(0); // filter
+        header.push_back(0); // interlace
+
+        output.clear();
+        output.reserve(sizeof(signature) + 25 + zlib.size() + 12 + 12);
+        output.insert(output.end(), signature, signature + sizeof(signature));
+        PutChunk(output, "IHDR", header.data(), header.size());
+        PutChunk(output, "IDAT", zlib.data(), zlib.size());
+        PutChunk(output, "IEND", nullptr, 0);
+    }
+
+    void WriteRaw(const CaptureFrame& frame, const vector<uint8_t>& rows, vector<uint8_t>& output)
+    {
+        output.clear();
+        output.reserve(16 + rows.size());
+        PutU32LE(output, RawMagic);
+        PutU32LE(output, frame.width);
+        PutU32LE(output, frame.height);
+        PutU32LE(output, static_cast<uint32_t>(frame.frameNumber));
+        output.insert(output.end(), rows.begin(), rows.end());
+    }
+}
+
+CaptureEncoder::CaptureEncoder(const path& outputDirectory, CaptureFormat format, uint32_t threadCount)
+    : outputDirectory(outputDirectory), format(format), runningCount(0), stopping(false), stats{}
+{
+    if (threadCount == 0)
+        threadCount = max(1u, thread::hardware_concurrency() / 2);
+
+    threads.reserve(threadCount);
+    for (uint32_t i = 0; i < threadCount; i++)
+        threads.emplace_back([this] { Run(); });
+}
+
+CaptureEncoder::~CaptureEncoder()
+{
+    {
+        lock_guard<mutex> lock(jobMutex);
+        stopping = true;
+    }
+    jobCv.notify_all();
+
+    for (auto& t : threads)
+        t.join();
+}
+
+void CaptureEncoder::Encode(const CaptureFrame& frame, function<void()> onRead)
+{
+    {
+        lock_guard<mutex> lock(jobMutex);
+        jobs.push_back({ frame, move(onRead) });
+    }
+    jobCv.notify_one();
+}
+
+void CaptureEncoder::Flush()
+{
+    unique_lock<mutex> lock(jobMutex);
+    idleCv.wait(lock, [this] { return jobs.empty() && runningCount == 0; });
+}
+
+CaptureEncoderStats CaptureEncoder::GetStats()
+{
+    lock_guard<mutex> lock(jobMutex);
+    return stats;
+}
+
+void CaptureEncoder::EncodePng(const CaptureFrame& frame, vector<uint8_t>& output)
+{
+    vector<uint8_t> scanlines;
+    CopyRows(frame, /*filterBytes*/ true, scanlines);
+    WritePng(frame.width, frame.height, scanlines, output);
+}
+
+void CaptureEncoder::EncodeRaw(const CaptureFrame& frame, vector<uint8_t>& output)
+{
+    vector<uint8_t> rows;
+    CopyRows(frame, /*filterBytes*/ false, rows);
+    WriteRaw(frame, rows, output);
+}
+
+void CaptureEncoder::Run()
+{
+    for (;;)
+    {
+        Job job;
+        {
+            unique_lock<mutex> lock(jobMutex);
+            jobCv.wait(lock, [this] { return stopping || !jobs.empty(); });
+
+            // 남은 프레임은 다 쓰고 끝낸다
+            if (jobs.empty())
+                return;
+
+            job = move(jobs.front());
+            jobs.pop_front();
+            runningCount++;
+        }
+
+        uint64_t writtenBytes = 0;
+        bool succeeded = EncodeJob(job, writtenBytes);
+
+        {
+            lock_guard<mutex> lock(jobMutex);
+            runningCount--;
+            if (succeeded)
+            {
+                stats.encodedCount++;
+                stats.encodedBytes += writtenBytes;
+            }
+            else
+            {
+                stats.failedCount++;
+            }
+        }
+        idleCv.notify_all();
+    }
+}
+
+bool CaptureEncoder::EncodeJob(Job& job, uint64_t& writtenBytes)
+{
+    const bool png = format == CaptureFormat::Png;
+
+    // 여기까지만 readback 버퍼를 읽는다
+    vector<uint8_t> rows;
+    CopyRows(job.frame, /*filterBytes*/ png, rows);
+    job.onRead();
+
+    vector<uint8_t> output;
+    if (png)
+        WritePng(job.frame.width, job.frame.height, rows, output);
+    else
+        WriteRaw(job.frame, rows, output);
+
+    char fileName[64];
+    snprintf(fileName, sizeof(fileName), "frame_%06llu.%s", static_cast<unsigned long long>(job.frame.frameNumber), png ? "png" : "raw");
+
+    ofstream file(outputDirectory / fileName, ios::binary);
+    if (!file)
+        return false;
+
+    file.write(reinterpret_cast<const char*>(output.data()), output.size());
+    if (!file)
+        return false;
+
+    writtenBytes = output.size();
+    return true;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+enum class CaptureFormat
+{
+    Png, // RGBA8 PNG. 압축하지 않은 deflate 블록으로 써서 인코딩이 빠르다
+    Raw, // 16바이트 헤더(magic, width, height, frameNumber 하위 32비트) + RGBA8 픽셀
+};
+
+// readback 버퍼에 복사된 한 프레임. pixels는 인코더가 onRead를 부를때까지 유효해야 한다
+struct CaptureFrame
+{
+    uint64_t frameNumber;
+    uint32_t width;
+    uint32_t height;
+    uint32_t rowPitch; // readback 버퍼는 줄마다 256바이트 정렬이라 width * 4보다 클 수 있다
+    const uint8_t* pixels;
+};
+
+struct CaptureEncoderStats
+{
+    uint64_t encodedCount;
+    uint64_t failedCount; // 파일 쓰기 실패
+    uint64_t encodedBytes;
+};
+
+// 캡처한 프레임을 워커 스레드에서 PNG나 raw 파일로 쓴다
+// 픽셀을 먼저 자기 버퍼로 옮기고 바로 onRead를 불러서, readback 슬롯은 압축이나 파일 쓰기를 기다리지 않고 돌려준다
+class CaptureEncoder
+{
+    struct Job
+    {
+        CaptureFrame frame;
+        std::function<void()> onRead;
+    };
+
+    std::filesystem::path outputDirectory;
+    CaptureFormat format;
+
+    std::vector<std::thread> threads;
+    std::mutex jobMutex;
+    std::condition_variable jobCv;
+    std::condition_variable idleCv;
+    std::deque<Job> jobs;
+    uint32_t runningCount;
+    bool stopping;
+    CaptureEncoderStats stats;
+
+public:
+    // threadCount가 0이면 코어 수의 절반만큼 만든다. 렌더 스레드와 Executor 몫은 남겨둔다
+    CaptureEncoder(const std::filesystem::path& outputDirectory, CaptureFormat format, uint32_t threadCount = 0);
+    ~CaptureEncoder();
+
+    CaptureEncoder(const CaptureEncoder&) = delete;
+    CaptureEncoder& operator=(const CaptureEncoder&) = delete;
+
+    // onRead는 워커 스레드에서 frame.pixels를 다 읽은 직후에 불린다
+    void Encode(const CaptureFrame& frame, std::function<void()> onRead);
+
+    // 맡긴 프레임을 다 쓸때까지 기다린다
+    void Flush();
+
+    CaptureEncoderStats GetStats();
+
+    // 파일로 쓰지 않고 메모리에 인코딩한다
+    static void EncodePng(const CaptureFrame& frame, std::vector<uint8_t>& output);
+    static void EncodeRaw(const CaptureFrame& frame, std::vector<uint8_t>& output);
+
+private:
+    void Run();
+    bool EncodeJob(Job& job, uint64_t& writtenBytes);
+};
@@ -0,0 +1,355 @@
+#include "ClusteredLighting.h"
+#include <directx/d3dx12.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <tuple>
+
+using namespace winrt;
+using namespace std;
+
+namespace
+{
+    // 카메라는 뷰 공간 원점에서 +z를 본다. 세로 시야각 60도
+    const float NearZ = 0.1f;
+    const float FarZ = 100.0f;
+    const float TanHalfFovY = 0.57735027f;
+    const float FloorY = -1.5f;
+
+    // 빛은 바닥 위 화면 안쪽에 흩어놓는다
+    const uint32_t LightSeed = 0x2545F491;
+    const float MinLightZ = 2.0f;
+    const float LightZRange = 58.0f;
+    const float MinLightHeight = 0.3f;
+    const float LightHeightRange = 1.2f;
+    const float MinLightRange = 1.5f;
+    const float LightRangeRange = 2.5f;
+    const float MinSpotAngle = 0.35f; // 라디안
+    const float SpotAngleRange = 0.45f;
+    const float WanderRadius = 1.5f;
+
+    uint32_t PcgHash(uint32_t value)
+    {
+        uint32_t state = value * 747796405u + 2891336453u;
+        uint32_t word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+        return (word >> 22u) ^ word;
+    }
+
+    float ToUnitFloat(uint32_t hash)
+    {
+        return static_cast<float>(hash >> 8) * (1.0f / 16777216.0f);
+    }
+
+    float Saturate(float value)
+    {
+        return value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+    }
+}
+
+ClusteredLighting::ClusteredLighting()
+    : currentFrame(0), executor(nullptr), constants{},
+      lightCount(0), time(0.0f), useGpu(true), cpuAssignMilliseconds(0.0)
+{
+}
+
+bool ClusteredLighting::Init(ID3D12Device* device, const Shaders& shaders, DXGI_FORMAT renderTargetFormat, UINT width, UINT height, Executor* executor, uint32_t frameCount, uint32_t lightCount)
+{
+    frames.resize(frameCount);
+    this->executor = executor;
+    this->lightCount = lightCount < MaxLights ? lightCount : MaxLights;
+
+    ClusterGridDesc desc = {};
+    desc.tilesX = DefaultTilesX;
+    desc.tilesY = DefaultTilesY;
+    desc.slices = DefaultSlices;
+    desc.nearZ = NearZ;
+    desc.farZ = FarZ;
+    desc.tanHalfFovX = TanHalfFovY * width / height;
+    desc.tanHalfFovY = TanHalfFovY;
+    cpuClusters.Build(desc);
+
+    constants = cpuClusters.MakeConstants();
+    constants.viewportWidth = static_cast<float>(width);
+    constants.viewportHeight = static_cast<float>(height);
+    constants.floorY = FloorY;
+
+    if (!CreateComputePipeline(device, shaders))
+        return false;
+
+    if (!CreateDrawPipeline(device, shaders, renderTargetFormat))
+        return false;
+
+    for (Frame& frame : frames)
+    {
+        if (!CreateBuffers(device, frame))
+            return false;
+
+        if (FAILED(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COMPUTE, IID_PPV_ARGS(&frame.computeAllocator))))
+            return false;
+    }
+
+    if (FAILED(device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_COMPUTE, frames[0].computeAllocator.get(), nullptr, IID_PPV_ARGS(&computeCommandList))))
+        return false;
+
+    if (FAILED(computeCommandList->Close()))
+        return false;
+
+    CreateLights();
+    return true;
+}
+
+bool ClusteredLighting::CreateComputePipeline(ID3D12Device* device, const Shaders& shaders)
+{
+    CD3DX12_ROOT_PARAMETER rootParameters[RootParameterCount];
+    rootParameters[ConstantsParameter].InitAsConstants(sizeof(ClusterConstants) / 4, /*shaderRegister*/ 0);
+    rootParameters[LightsParameter].InitAsShaderResourceView(0);
+    rootParameters[LightCountsParameter].InitAsUnorderedAccessView(0);
+    rootParameters[LightIndicesParameter].InitAsUnorderedAccessView(1);
+
+    CD3DX12_ROOT_SIGNATURE_DESC rootSignatureDesc;
+    rootSignatureDesc.Init(_countof(rootParameters), rootParameters, /*numStaticSamplers*/ 0, /*pStaticSamplers*/ nullptr, D3D12_ROOT_SIGNATURE_FLAG_NONE);
+
+    com_ptr<ID3DBlob> signature;
+    com_ptr<ID3DBlob> error;
+    if (FAILED(D3D12SerializeRootSignature(&rootSignatureDesc, D3D_ROOT_SIGNATURE_VERSION_1, signature.put(), error.put())))
+        return false;
+
+    if (FAILED(device->CreateRootSignature(/*nodeMask*/0, signature->GetBufferPointer(), signature->GetBufferSize(), IID_PPV_ARGS(&computeRootSignature))))
+        return false;
+
+    D3D12_COMPUTE_PIPELINE_STATE_DESC psoDesc = {};
+    psoDesc.pRootSignature = computeRootSignature.get();
+    psoDesc.CS = CD3DX12_SHADER_BYTECODE(shaders.assign.data(), shaders.assign.size());
+    if (FAILED(device->CreateComputePipelineState(&psoDesc, IID_PPV_ARGS(&assignPipelineState))))
+        return false;
+
+    return true;
+}
+
+bool ClusteredLighting::CreateDrawPipeline(ID3D12Device* device, const Shaders& shaders, DXGI_FORMAT renderTargetFormat)
+{
+    // 버텍스 셰이더는 SV_VertexID로 화면을 덮는 삼각형을 만들고, 버퍼는 픽셀 셰이더만 읽는다
+    CD3DX12_ROOT_PARAMETER rootParameters[RootParameterCount];
+    rootParameters[ConstantsParameter].InitAsConstants(sizeof(ClusterConstants) / 4, /*shaderRegister*/ 0, 0, D3D12_SHADER_VISIBILITY_PIXEL);
+    rootParameters[LightsParameter].InitAsShaderResourceView(0, 0, D3D12_SHADER_VISIBILITY_PIXEL);
+    rootParameters[LightCountsParameter].InitAsShaderResourceView(1, 0, D3D12_SHADER_VISIBILITY_PIXEL);
+    rootParameters[LightIndicesParameter].InitAsShaderResourceView(2, 0, D3D12_SHADER_VISIBILITY_PIXEL);
+
+    CD3DX12_ROOT_SIGNATURE_DESC rootSignatureDesc;
+    rootSignatureDesc.Init(_countof(rootParameters), rootParameters, /*numStaticSamplers*/ 0, /*pStaticSamplers*/ nullptr, D3D12_ROOT_SIGNATURE_FLAG_NONE);
+
+    com_ptr<ID3DBlob> signature;
+    com_ptr<ID3DBlob> error;
+    if (FAILED(D3D12SerializeRootSignature(&rootSignatureDesc, D3D_ROOT_SIGNATURE_VERSION_1, signature.put(), error.put())))
+        return false;
+
+    if (FAILED(device->CreateRootSignature(/*nodeMask*/0, signature->GetBufferPointer(), signature->GetBufferSize(), IID_PPV_ARGS(&drawRootSignature))))
+        return false;
+
+    D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
+    psoDesc.pRootSignature = drawRootSignature.get();
+    psoDesc.VS = CD3DX12_SHADER_BYTECODE(shaders.floorVertex.data(), shaders.floorVertex.size());
+    psoDesc.PS = CD3DX12_SHADER_BYTECODE(shaders.floorPixel.data(), shaders.floorPixel.size());
+    psoDesc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
+    psoDesc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
+    psoDesc.DepthStencilState.DepthEnable = FALSE;
+    psoDesc.DepthStencilState.StencilEnable = FALSE;
+    psoDesc.SampleMask = UINT_MAX;
+    psoDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+    psoDesc.NumRenderTargets = 1;
+    psoDesc.RTVFormats[0] = renderTargetFormat;
+    psoDesc.SampleDesc.Count = 1;
+
+    if (FAILED(device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&drawPipelineState))))
+        return false;
+
+    return true;
+}
+
+bool ClusteredLighting::CreateBuffers(ID3D12Device* device, Frame& frame)
+{
+    const UINT64 countsSize = static_cast<UINT64>(cpuClusters.GetClusterCount()) * sizeof(uint32_t);
+    const UINT64 indicesSize = countsSize * cpuClusters.GetMaxLightsPerCluster();
+
+    // GPU 경로 목록. COMMON으로 만들고 compute 큐에서 UAV, 그래픽스 큐에서 SRV로 올라간다
+    const pair<UINT64, com_ptr<ID3D12Resource>*> gpuBuffers[] =
+    {
+        { countsSize, &frame.lightCountsBuffer },
+        { indicesSize, &frame.lightIndicesBuffer },
+    };
+
+    for (const auto& [size, buffer] : gpuBuffers)
+    {
+        if (FAILED(device->CreateCommittedResource(
+            &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+            D3D12_HEAP_FLAG_NONE,
+            &CD3DX12_RESOURCE_DESC::Buffer(size, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS),
+            D3D12_RESOURCE_STATE_COMMON,
+            nullptr,
+            IID_PPV_ARGS(buffer->put()))))
+            return false;
+    }
+
+    // 빛과 CPU 경로 목록은 업로드 버퍼. 그 슬롯의 이전 프레임이 끝난 뒤에 고쳐 쓴다
+    const tuple<UINT64, com_ptr<ID3D12Resource>*, void**> uploadBuffers[] =
+    {
+        { static_cast<UINT64>(MaxLights) * sizeof(GpuLight), &frame.lightBuffer, reinterpret_cast<void**>(&frame.uploadLights) },
+        { countsSize, &frame.cpuLightCountsBuffer, reinterpret_cast<void**>(&frame.uploadLightCounts) },
+        { indicesSize, &frame.cpuLightIndicesBuffer, reinterpret_cast<void**>(&frame.uploadLightIndices) },
+    };
+
+    for (const auto& [size, buffer, mapped] : uploadBuffers)
+    {
+        if (FAILED(device->CreateCommittedResource(
+            &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+            D3D12_HEAP_FLAG_NONE,
+            &CD3DX12_RESOURCE_DESC::Buffer(size),
+            D3D12_RESOURCE_STATE_GENERIC_READ,
+            nullptr,
+            IID_PPV_ARGS(buffer->put()))))
+            return false;
+
+        CD3DX12_RANGE readRange(0, 0);
+        if (FAILED((*buffer)->Map(0, &readRange, mapped)))
+            return false;
+    }
+
+    // CPU 경로로 바꾸기 전에 그려도 빈 목록이 되도록 한다
+    memset(frame.uploadLightCounts, 0, countsSize);
+    return true;
+}
+
+void ClusteredLighting::CreateLights()
+{
+    baseLights.resize(lightCount);
+    phases.resize(lightCount);
+
+    for (uint32_t i = 0; i < lightCount; i++)
+    {
+        uint32_t hash[6];
+        hash[0] = PcgHash(i ^ LightSeed);
+        for (uint32_t n = 1; n < _countof(hash); n++)
+            hash[n] = PcgHash(hash[n - 1]);
+
+        // 깊이를 먼저 정하고 그 깊이에서 화면 폭 안에 둔다
+        GpuLight& light = baseLights[i];
+        light.positionZ = MinLightZ + ToUnitFloat(hash[0]) * LightZRange;
+        light.positionX = (ToUnitFloat(hash[1]) * 2.0f - 1.0f) * light.positionZ * constants.tanHalfFovX;
+        light.positionY = FloorY + MinLightHeight + ToUnitFloat(hash[2]) * LightHeightRange;
+        light.range = MinLightRange + ToUnitFloat(hash[3]) * LightRangeRange;
+
+        // 채도가 가장 높은 색상환 색
+        float hue = ToUnitFloat(hash[4]) * 6.0f;
+        light.colorR = Saturate(fabsf(hue - 3.0f) - 1.0f);
+        light.colorG = Saturate(2.0f - fabsf(hue - 2.0f));
+        light.colorB = Saturate(2.0f - fabsf(hue - 4.0f));
+
+        // 넷 중 하나는 바닥을 내려다보는 스포트 조명
+        light.type = (hash[5] & 3) == 0 ? LightType::Spot : LightType::Point;
+        light.directionX = 0.0f;
+        light.directionY = -1.0f;
+        light.directionZ = 0.0f;
+        light.cosOuterAngle = cosf(MinSpotAngle + ToUnitFloat(hash[5]) * SpotAngleRange);
+
+        phases[i] = ToUnitFloat(PcgHash(hash[5])) * 6.2831853f;
+    }
+
+    lights = baseLights;
+}
+
+void ClusteredLighting::AnimateLights()
+{
+    // 빛마다 제자리 근처에서 원을 그리며 돌고, 스포트 조명은 고개를 흔든다
+    for (uint32_t i = 0; i < lightCount; i++)
+    {
+        const GpuLight& base = baseLights[i];
+        GpuLight& light = lights[i];
+        float phase = phases[i];
+
+        light.positionX = base.positionX + sinf(time * 0.6f + phase) * WanderRadius;
+        light.positionZ = base.positionZ + cosf(time * 0.4f + phase) * WanderRadius;
+
+        if (light.type == LightType::Spot)
+        {
+            float x = sinf(time * 0.9f + phase) * 0.5f;
+            float z = cosf(time * 0.7f + phase) * 0.5f;
+            float inverseLength = 1.0f / sqrtf(x * x + 1.0f + z * z);
+            light.directionX = x * inverseLength;
+            light.directionY = -inverseLength;
+            light.directionZ = z * inverseLength;
+        }
+    }
+}
+
+bool ClusteredLighting::Update(float deltaTime, uint32_t frameSlot)
+{
+    currentFrame = frameSlot;
+    Frame& frame = frames[frameSlot];
+
+    time += deltaTime;
+    AnimateLights();
+
+    memcpy(frame.uploadLights, lights.data(), lightCount * sizeof(GpuLight));
+    constants.lightCount = lightCount;
+
+    if (useGpu)
+        return RecordCompute();
+
+    auto start = chrono::steady_clock::now();
+    cpuClusters.Assign(lights.data(), lightCount, executor);
+    cpuAssignMilliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    // 클러스터마다 담긴 만큼만 업로드 버퍼로 옮긴다. 나머지 칸은 셰이더가 읽지 않는다
+    const vector<uint32_t>& counts = cpuClusters.GetLightCounts();
+    const vector<uint32_t>& indices = cpuClusters.GetLightIndices();
+    const size_t maxLightsPerCluster = cpuClusters.GetMaxLightsPerCluster();
+
+    memcpy(frame.uploadLightCounts, counts.data(), counts.size() * sizeof(uint32_t));
+    for (size_t cluster = 0; cluster < counts.size(); cluster++)
+    {
+        if (counts[cluster] > 0)
+            memcpy(frame.uploadLightIndices + cluster * maxLightsPerCluster, indices.data() + cluster * maxLightsPerCluster, counts[cluster] * sizeof(uint32_t));
+    }
+
+    return true;
+}
+
+bool ClusteredLighting::RecordCompute()
+{
+    Frame& frame = frames[currentFrame];
+    if (FAILED(frame.computeAllocator->Reset()))
+        return false;
+
+    if (FAILED(computeCommandList->Reset(frame.computeAllocator.get(), assignPipelineState.get())))
+        return false;
+
+    // 버퍼는 이 리스트에서 처음 쓸때 UAV로 올라가고, 끝나면 COMMON으로 돌아간다
+    computeCommandList->SetComputeRootSignature(computeRootSignature.get());
+    computeCommandList->SetComputeRoot32BitConstants(ConstantsParameter, sizeof(ClusterConstants) / 4, &constants, 0);
+    computeCommandList->SetComputeRootShaderResourceView(LightsParameter, frame.lightBuffer->GetGPUVirtualAddress());
+    computeCommandList->SetComputeRootUnorderedAccessView(LightCountsParameter, frame.lightCountsBuffer->GetGPUVirtualAddress());
+    computeCommandList->SetComputeRootUnorderedAccessView(LightIndicesParameter, frame.lightIndicesBuffer->GetGPUVirtualAddress());
+    computeCommandList->Dispatch((cpuClusters.GetClusterCount() + ThreadGroupSize - 1) / ThreadGroupSize, 1, 1);
+
+    if (FAILED(computeCommandList->Close()))
+        return false;
+
+    return true;
+}
+
+void ClusteredLighting::RecordDraw(ID3D12GraphicsCommandList* commandList)
+{
+    Frame& frame = frames[currentFrame];
+    ID3D12Resource* counts = useGpu ? frame.lightCountsBuffer.get() : frame.cpuLightCountsBuffer.get();
+    ID3D12Resource* indices = useGpu ? frame.lightIndicesBuffer.get() : frame.cpuLightIndicesBuffer.get();
+
+    commandList->SetPipelineState(drawPipelineState.get());
+    commandList->SetGraphicsRootSignature(drawRootSignature.get());
+    commandList->SetGraphicsRoot32BitConstants(ConstantsParameter, sizeof(ClusterConstants) / 4, &constants, 0);
+    commandList->SetGraphicsRootShaderResourceView(LightsParameter, frame.lightBuffer->GetGPUVirtualAddress());
+    commandList->SetGraphicsRootShaderResourceView(LightCountsParameter, counts->GetGPUVirtualAddress());
+    commandList->SetGraphicsRootShaderResourceView(LightIndicesParameter, indices->GetGPUVirtualAddress());
+    commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    commandList->DrawInstanced(3, 1, 0, 0);
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include <Windows.h>
+#include <winrt/base.h>
+#include <directx/d3d12.h>
+#include <vector>
+#include "ClusteredLights.h"
+
+// 움직이는 점/스포트 조명 수천개를 clustered forward 방식으로 바닥에 비춘다
+// 빛 배정은 compute 셰이더(async compute 큐)나 CPU(LightClusters, AVX2 + 워커 스레드) 중 하나로 하고,
+// 바닥을 칠하는 픽셀 셰이더는 자기 클러스터의 빛 목록만 본다
+// 빛과 클러스터 목록 버퍼는 프레임 슬롯마다 따로 있어서, compute 큐가 이번 프레임 목록을 만드는 동안 그래픽스 큐는 지난 프레임 목록으로 그린다
+class ClusteredLighting
+{
+public:
+    static const uint32_t MaxLights = 4096;
+    static const uint32_t DefaultLightCount = 2048;
+    static const UINT ThreadGroupSize = 64; // clusteredlights.hlsl의 THREAD_GROUP_SIZE
+
+    // 기본 격자. 16:9 화면에서 타일이 대략 정사각형이 된다
+    static const uint32_t DefaultTilesX = 16;
+    static const uint32_t DefaultTilesY = 9;
+    static const uint32_t DefaultSlices = 24;
+
+    struct Shaders
+    {
+        std::vector<uint8_t> assign;
+        std::vector<uint8_t> floorVertex;
+        std::vector<uint8_t> floorPixel;
+    };
+
+private:
+    // compute와 그리기 root signature가 같은 순서를 쓴다
+    // compute: 빛 SRV(t0), 개수 UAV(u0), 인덱스 UAV(u1) / 그리기: 빛 SRV(t0), 개수 SRV(t1), 인덱스 SRV(t2)
+    enum RootParameter
+    {
+        ConstantsParameter,
+        LightsParameter,
+        LightCountsParameter,
+        LightIndicesParameter,
+        RootParameterCount,
+    };
+
+    winrt::com_ptr<ID3D12RootSignature> computeRootSignature;
+    winrt::com_ptr<ID3D12PipelineState> assignPipelineState;
+    winrt::com_ptr<ID3D12RootSignature> drawRootSignature;
+    winrt::com_ptr<ID3D12PipelineState> drawPipelineState;
+
+    struct Frame
+    {
+        // 빛은 매 프레임 CPU에서 움직여서 업로드 버퍼에 쓴다
+        winrt::com_ptr<ID3D12Resource> lightBuffer;
+        GpuLight* uploadLights;
+
+        // GPU 경로의 클러스터 목록. 상태 전환은 암묵적 promotion에 맡긴다
+        winrt::com_ptr<ID3D12Resource> lightCountsBuffer;
+        winrt::com_ptr<ID3D12Resource> lightIndicesBuffer;
+
+        // CPU 경로의 클러스터 목록. 계속 Map해둔다
+        winrt::com_ptr<ID3D12Resource> cpuLightCountsBuffer;
+        winrt::com_ptr<ID3D12Resource> cpuLightIndicesBuffer;
+        uint32_t* uploadLightCounts;
+        uint32_t* uploadLightIndices;
+
+        winrt::com_ptr<ID3D12CommandAllocator> computeAllocator;
+    };
+
+    std::vector<Frame> frames;
+    uint32_t currentFrame; // 마지막 Update의 프레임 슬롯. RecordDraw가 쓴다
+    winrt::com_ptr<ID3D12GraphicsCommandList> computeCommandList;
+
+    LightClusters cpuClusters;
+    Executor* executor; // CPU 경로에서 슬라이스를 나눠 맡길 워커. 없으면 부른 스레드에서 한다
+    ClusterConstants constants;
+
+    std::vector<GpuLight> baseLights; // 움직이기 전 위치와 방향
+    std::vector<GpuLight> lights;     // 이번 프레임 위치. 업로드 버퍼는 쓰기 결합 메모리라 CPU 배정은 이쪽을 읽는다
+    std::vector<float> phases;
+    uint32_t lightCount;
+    float time;
+    bool useGpu;
+    double cpuAssignMilliseconds;
+
+public:
+    ClusteredLighting();
+
+    bool Init(ID3D12Device* device, const Shaders& shaders, DXGI_FORMAT renderTargetFormat, UINT width, UINT height, Executor* executor, uint32_t frameCount, uint32_t lightCount = DefaultLightCount);
+
+    void SetUseGpu(bool useGpu) { this->useGpu = useGpu; }
+    bool UsesGpu() const { return useGpu; }
+
+    // 빛을 움직이고 배정한다. GPU 경로면 compute 커맨드 리스트를 기록하고, CPU 경로면 바로 배정해서 업로드 버퍼에 쓴다
+    // frameSlot을 마지막으로 쓴 프레임의 GPU 작업이 끝난 뒤에 불러야 한다
+    bool Update(float deltaTime, uint32_t frameSlot);
+
+    // GPU 경로일때 compute 큐에 제출할 커맨드 리스트
+    ID3D12CommandList* GetComputeCommandList() { return computeCommandList.get(); }
+
+    // 렌더 타겟이 설정된 그래픽스 커맨드 리스트에 바닥을 그린다. root signature와 PSO를 바꾼다
+    void RecordDraw(ID3D12GraphicsCommandList* commandList);
+
+    uint32_t GetLightCount() const { return lightCount; }
+
+    // CPU 경로의 마지막 배정 결과와 걸린 시간. GPU 경로는 읽어오지 않는다
+    const ClusterAssignStats& GetCpuStats() const { return cpuClusters.GetStats(); }
+    double GetCpuAssignMilliseconds() const { return cpuAssignMilliseconds; }
+
+private:
+    bool CreateComputePipeline(ID3D12Device* device, const Shaders& shaders);
+    bool CreateDrawPipeline(ID3D12Device* device, const Shaders& shaders, DXGI_FORMAT renderTargetFormat);
+    bool CreateBuffers(ID3D12Device* device, Frame& frame);
+    void CreateLights();
+    void AnimateLights();
+    bool RecordCompute();
+};
@@ -0,0 +1,415 @@
+#include "ClusteredLights.h"
+#include "CpuFeatures.h"
+#include "FrameArena.h"
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cmath>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define CLUSTER_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#define CLUSTER_AVX2_TARGET
+#else
+// 이 함수만 AVX2로 만든다. FMA는 켜지 않는다 (스칼라 경로와 결과가 달라진다)
+#define CLUSTER_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+
+using namespace std;
+
+namespace
+{
+    // 원뿔 반각이 45도보다 좁으면 꼭짓점과 밑면 테두리를 지나는 구가 더 작다
+    const float NarrowConeCos = 0.70710678f;
+
+    uint32_t RoundUpToSimdWidth(uint32_t value)
+    {
+        return (value + 7) & ~7u;
+    }
+
+#if CLUSTER_SIMD_X86
+    // movemask 값마다 켜진 레인 번호를 앞으로 모으는 permute 인덱스
+    const array<array<int32_t, 8>, 256>& GetCompactTable()
+    {
+        static const array<array<int32_t, 8>, 256> table = []
+        {
+            array<array<int32_t, 8>, 256> t = {};
+            for (uint32_t mask = 0; mask < 256; mask++)
+            {
+                uint32_t n = 0;
+                for (uint32_t lane = 0; lane < 8; lane++)
+                    if (mask & (1u << lane))
+                        t[mask][n++] = lane;
+            }
+            return t;
+        }();
+        return table;
+    }
+#endif
+}
+
+LightClusters::LightClusters()
+    : desc{}, maxLightsPerCluster(0), stats{}, simdPath(ClusterSimdPath::Scalar)
+{
+    SetSimdPath(ClusterSimdPath::Avx2);
+}
+
+void LightClusters::Build(const ClusterGridDesc& desc, uint32_t maxLightsPerCluster)
+{
+    this->desc = desc;
+    this->maxLightsPerCluster = maxLightsPerCluster;
+
+    uint32_t clusterCount = GetClusterCount();
+    bounds.resize(clusterCount);
+    for (uint32_t slice = 0; slice < desc.slices; slice++)
+        for (uint32_t tileY = 0; tileY < desc.tilesY; tileY++)
+            for (uint32_t tileX = 0; tileX < desc.tilesX; tileX++)
+                bounds[(slice * desc.tilesY + tileY) * desc.tilesX + tileX] = ComputeClusterBounds(desc, tileX, tileY, slice);
+
+    lightCounts.assign(clusterCount, 0);
+    lightIndices.assign(static_cast<size_t>(clusterCount) * maxLightsPerCluster, 0);
+    stats = {};
+}
+
+void LightClusters::SetSimdPath(ClusterSimdPath path)
+{
+    simdPath = (path == ClusterSimdPath::Avx2 && !IsAvx2Supported()) ? ClusterSimdPath::Scalar : path;
+}
+
+ClusterBounds LightClusters::ComputeClusterBounds(const ClusterGridDesc& desc, uint32_t tileX, uint32_t tileY, uint32_t slice)
+{
+    // 타일의 NDC 범위. 타일 y는 화면 위에서부터 센다
+    float ndcMinX = -1.0f + 2.0f * tileX / desc.tilesX;
+    float ndcMaxX = -1.0f + 2.0f * (tileX + 1) / desc.tilesX;
+    float ndcMaxY = 1.0f - 2.0f * tileY / desc.tilesY;
+    float ndcMinY = 1.0f - 2.0f * (tileY + 1) / desc.tilesY;
+
+    float depthRatio = desc.farZ / desc.nearZ;
+    float sliceNear = desc.nearZ * powf(depthRatio, static_cast<float>(slice) / desc.slices);
+    float sliceFar = desc.nearZ * powf(depthRatio, static_cast<float>(slice + 1) / desc.slices);
+
+    // 절두체 조각의 8 꼭짓점을 감싼다. 같은 NDC에서 x, y는 깊이에 비례하므로 가까운 면과 먼 면만 보면 된다
+    ClusterBounds result;
+    result.minX = min(ndcMinX * desc.tanHalfFovX * sliceNear, ndcMinX * desc.tanHalfFovX * sliceFar);
+    result.maxX = max(ndcMaxX * desc.tanHalfFovX * sliceNear, ndcMaxX * desc.tanHalfFovX * sliceFar);
+    result.minY = min(ndcMinY * desc.tanHalfFovY * sliceNear, ndcMinY * desc.tanHalfFovY * sliceFar);
+    result.maxY = max(ndcMaxY * desc.tanHalfFovY * sliceNear, ndcMaxY * desc.tanHalfFovY * sliceFar);
+    result.minZ = sliceNear;
+    result.maxZ = sliceFar;
+    return result;
+}
+
+void LightClusters::ComputeCullSphere(const GpuLight& light, float& centerX, float& centerY, float& centerZ, float& radius)
+{
+    centerX = light.positionX;
+    centerY = light.positionY;
+    centerZ = light.positionZ;
+    radius = light.range;
+
+    if (light.type != LightType::Spot || light.cosOuterAngle <= 0.0f)
+        return;
+
+    float offset;
+    if (light.cosOuterAngle > NarrowConeCos)
+    {
+        // 좁은 원뿔: 꼭짓점과 밑면 테두리를 지나는 구
+        radius = light.range / (2.0f * light.cosOuterAngle);
+        offset = radius;
+    }
+    else
+    {
+        // 넓은 원뿔: 밑면 원을 지름으로 하는 구
+        radius = light.range * sqrtf(1.0f - light.cosOuterAngle * light.cosOuterAngle);
+        offset = light.range * light.cosOuterAngle;
+    }
+
+    centerX += light.directionX * offset;
+    centerY += light.directionY * offset;
+    centerZ += light.directionZ * offset;
+}
+
+uint32_t LightClusters::GetSlice(float viewZ) const
+{
+    if (!(viewZ > desc.nearZ))
+        return 0;
+
+    ClusterConstants constants = MakeConstants();
+    float slice = floorf(logf(viewZ) * constants.sliceScale + constants.sliceBias);
+    return min(static_cast<uint32_t>(max(slice, 0.0f)), desc.slices - 1);
+}
+
+uint32_t LightClusters::GetClusterIndex(float pixelX, float pixelY, float viewZ, float viewportWidth, float viewportHeight) const
+{
+    uint32_t tileX = min(static_cast<uint32_t>(max(pixelX * desc.tilesX / viewportWidth, 0.0f)), desc.tilesX - 1);
+    uint32_t tileY = min(static_cast<uint32_t>(max(pixelY * desc.tilesY / viewportHeight, 0.0f)), desc.tilesY - 1);
+    return (GetSlice(viewZ) * desc.tilesY + tileY) * desc.tilesX + tileX;
+}
+
+ClusterConstants LightClusters::MakeConstants() const
+{
+    float logDepthRatio = logf(desc.farZ / desc.nearZ);
+
+    ClusterConstants constants = {};
+    constants.tilesX = desc.tilesX;
+    constants.tilesY = desc.tilesY;
+    constants.slices = desc.slices;
+    constants.nearZ = desc.nearZ;
+    constants.farZ = desc.farZ;
+    constants.tanHalfFovX = desc.tanHalfFovX;
+    constants.tanHalfFovY = desc.tanHalfFovY;
+    constants.sliceScale = desc.slices / logDepthRatio;
+    constants.sliceBias = -(desc.slices * logf(desc.nearZ) / logDepthRatio);
+    constants.maxLightsPerCluster = maxLightsPerCluster;
+    return constants;
+}
+
+LightClusters::LightSubset::LightSubset(LinearArena* arena)
+    : x(ArenaAllocator<float>(arena)), y(ArenaAllocator<float>(arena)), z(ArenaAllocator<float>(arena)),
+      radiusSq(ArenaAllocator<float>(arena)), lightIndex(ArenaAllocator<uint32_t>(arena))
+{
+}
+
+void LightClusters::LightSubset::Reserve(uint32_t capacity)
+{
+    // 채우는 도중에 늘어나면 arena에는 앞의 배열이 버려진 채로 남으므로 채울 수 있는 최대만큼 먼저 잡는다
+    capacity = RoundUpToSimdWidth(capacity);
+    x.reserve(capacity);
+    y.reserve(capacity);
+    z.reserve(capacity);
+    radiusSq.reserve(capacity);
+    lightIndex.reserve(capacity);
+}
+
+void LightClusters::LightSubset::Clear()
+{
+    x.clear();
+    y.clear();
+    z.clear();
+    radiusSq.clear();
+    lightIndex.clear();
+    count = 0;
+}
+
+void LightClusters::LightSubset::Add(float x, float y, float z, float radiusSq, uint32_t lightIndex)
+{
+    this->x.push_back(x);
+    this->y.push_back(y);
+    this->z.push_back(z);
+    this->radiusSq.push_back(radiusSq);
+    this->lightIndex.push_back(lightIndex);
+    count++;
+}
+
+void LightClusters::LightSubset::Pad()
+{
+    // 아주 멀리 두고 반지름을 0으로 해서 어떤 클러스터와도 겹치지 않게 한다
+    uint32_t paddedCount = RoundUpToSimdWidth(count);
+    x.resize(paddedCount, FLT_MAX);
+    y.resize(paddedCount, FLT_MAX);
+    z.resize(paddedCount, FLT_MAX);
+    radiusSq.resize(paddedCount, 0.0f);
+    lightIndex.resize(paddedCount, 0);
+}
+
+void LightClusters::Assign(const GpuLight* lights, uint32_t lightCount, Executor* executor)
+{
+    allLights.Clear();
+    for (uint32_t i = 0; i < lightCount; i++)
+    {
+        float x, y, z, radius;
+        ComputeCullSphere(lights[i], x, y, z, radius);
+        allLights.Add(x, y, z, radius * radius, i);
+    }
+    allLights.Pad();
+
+    // 슬라이스별 통계와 태스크 배열은 이 함수 안에서만 쓰므로 스레드 임시 메모리에 둔다
+    ScratchScope scratch;
+    ArenaVector<ClusterAssignStats> sliceStats(desc.slices, ArenaAllocator<ClusterAssignStats>(&scratch.GetArena()));
+    if (executor)
+    {
+        // 슬라이스마다 클러스터 목록이 겹치지 않으므로 락 없이 나눠서 쓴다
+        ArenaVector<Task<void>> tasks(ArenaAllocator<Task<void>>(&scratch.GetArena()));
+        tasks.reserve(desc.slices);
+        for (uint32_t slice = 0; slice < desc.slices; slice++)
+            tasks.push_back(AssignSliceAsync(*executor, slice, sliceStats[slice]));
+
+        SyncWait(WhenAll(move(tasks)));
+    }
+    else
+    {
+        for (uint32_t slice = 0; slice < desc.slices; slice++)
+            sliceStats[slice] = AssignSlice(slice);
+    }
+
+    stats = {};
+    for (const ClusterAssignStats& slice : sliceStats)
+    {
+        stats.assignedLights += slice.assignedLights;
+        stats.overflowedClusters += slice.overflowedClusters;
+        stats.maxLightsInCluster = max(stats.maxLightsInCluster, slice.maxLightsInCluster);
+        stats.occupiedClusters += slice.occupiedClusters;
+    }
+}
+
+Task<void> LightClusters::AssignSliceAsync(Executor& executor, uint32_t slice, ClusterAssignStats& sliceStats)
+{
+    co_await executor.Schedule();
+
+    sliceStats = AssignSlice(slice);
+}
+
+void LightClusters::Filter(const LightSubset& source, const ClusterBounds& region, LightSubset& result)
+{
+    // 클러스터 판정과 같은 구-AABB 판정이다. region이 클러스터들을 감싸므로 여기서 빠진 빛은 어느 클러스터와도 겹치지 않는다
+    result.Clear();
+    result.Reserve(source.count);
+    for (uint32_t i = 0; i < source.count; i++)
+    {
+        float dx = max(max(region.minX - source.x[i], source.x[i] - region.maxX), 0.0f);
+        float dy = max(max(region.minY - source.y[i], source.y[i] - region.maxY), 0.0f);
+        float dz = max(max(region.minZ - source.z[i], source.z[i] - region.maxZ), 0.0f);
+        if (dx * dx + dy * dy + dz * dz <= source.radiusSq[i])
+            result.Add(source.x[i], source.y[i], source.z[i], source.radiusSq[i], source.lightIndex[i]);
+    }
+    result.Pad();
+}
+
+ClusterAssignStats LightClusters::AssignSlice(uint32_t slice)
+{
+    ClusterAssignStats sliceStats = {};
+
+    auto unite = [](ClusterBounds& region, const ClusterBounds& cluster)
+    {
+        region.minX = min(region.minX, cluster.minX);
+        region.minY = min(region.minY, cluster.minY);
+        region.minZ = min(region.minZ, cluster.minZ);
+        region.maxX = max(region.maxX, cluster.maxX);
+        region.maxY = max(region.maxY, cluster.maxY);
+        region.maxZ = max(region.maxZ, cluster.maxZ);
+    };
+
+    const ClusterBounds empty = { FLT_MAX, FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    uint32_t clustersPerSlice = desc.tilesX * desc.tilesY;
+    uint32_t firstCluster = slice * clustersPerSlice;
+
+    ClusterBounds sliceRegion = empty;
+    for (uint32_t clusterIndex = firstCluster; clusterIndex < firstCluster + clustersPerSlice; clusterIndex++)
+        unite(sliceRegion, bounds[clusterIndex]);
+
+    ScratchScope scratch;
+    LightSubset sliceLights(&scratch.GetArena());
+    Filter(allLights, sliceRegion, sliceLights);
+
+    // 행마다 다시 채우지만 용량은 남으므로 처음 한 번만 잡힌다
+    LightSubset rowLights(&scratch.GetArena());
+    for (uint32_t tileY = 0; tileY < desc.tilesY; tileY++)
+    {
+        uint32_t firstInRow = firstCluster + tileY * desc.tilesX;
+
+        ClusterBounds rowRegion = empty;
+        for (uint32_t tileX = 0; tileX < desc.tilesX; tileX++)
+            unite(rowRegion, bounds[firstInRow + tileX]);
+
+        Filter(sliceLights, rowRegion, rowLights);
+
+        for (uint32_t clusterIndex = firstInRow; clusterIndex < firstInRow + desc.tilesX; clusterIndex++)
+        {
+            uint32_t count = simdPath == ClusterSimdPath::Avx2 ? AssignClusterAvx2(clusterIndex, rowLights) : AssignClusterScalar(clusterIndex, rowLights);
+            lightCounts[clusterIndex] = min(count, maxLightsPerCluster);
+
+            sliceStats.assignedLights += count;
+            sliceStats.maxLightsInCluster = max(sliceStats.maxLightsInCluster, count);
+            if (count > maxLightsPerCluster)
+                sliceStats.overflowedClusters++;
+            if (count > 0)
+                sliceStats.occupiedClusters++;
+        }
+    }
+
+    return sliceStats;
+}
+
+uint32_t LightClusters::AssignClusterScalar(uint32_t clusterIndex, const LightSubset& lights)
+{
+    const ClusterBounds& cluster = bounds[clusterIndex];
+    uint32_t* indices = &lightIndices[static_cast<size_t>(clusterIndex) * maxLightsPerCluster];
+
+    // 구 중심에서 AABB까지 거리의 제곱. 축마다 바깥으로 벗어난 만큼만 더한다
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < lights.count; i++)
+    {
+        float dx = max(max(cluster.minX - lights.x[i], lights.x[i] - cluster.maxX), 0.0f);
+        float dy = max(max(cluster.minY - lights.y[i], lights.y[i] - cluster.maxY), 0.0f);
+        float dz = max(max(cluster.minZ - lights.z[i], lights.z[i] - cluster.maxZ), 0.0f);
+        float distanceSq = dx * dx + dy * dy + dz * dz;
+        if (distanceSq <= lights.radiusSq[i])
+        {
+            if (count < maxLightsPerCluster)
+                indices[count] = lights.lightIndex[i];
+            count++;
+        }
+    }
+
+    return count;
+}
+
+#if CLUSTER_SIMD_X86
+CLUSTER_AVX2_TARGET uint32_t LightClusters::AssignClusterAvx2(uint32_t clusterIndex, const LightSubset& lights)
+{
+    const auto& compactTable = GetCompactTable();
+    const ClusterBounds& cluster = bounds[clusterIndex];
+    uint32_t* indices = &lightIndices[static_cast<size_t>(clusterIndex) * maxLightsPerCluster];
+
+    // 클러스터 하나에 빛 8개씩. AssignClusterScalar와 같은 연산을 같은 순서로 한다
+    const __m256 minX = _mm256_set1_ps(cluster.minX);
+    const __m256 minY = _mm256_set1_ps(cluster.minY);
+    const __m256 minZ = _mm256_set1_ps(cluster.minZ);
+    const __m256 maxX = _mm256_set1_ps(cluster.maxX);
+    const __m256 maxY = _mm256_set1_ps(cluster.maxY);
+    const __m256 maxZ = _mm256_set1_ps(cluster.maxZ);
+    const __m256 zero = _mm256_setzero_ps();
+
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < lights.count; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(&lights.x[i]);
+        __m256 y = _mm256_loadu_ps(&lights.y[i]);
+        __m256 z = _mm256_loadu_ps(&lights.z[i]);
+        __m256 radiusSq = _mm256_loadu_ps(&lights.radiusSq[i]);
+
+        __m256 dx = _mm256_max_ps(_mm256_max_ps(_mm256_sub_ps(minX, x), _mm256_sub_ps(x, maxX)), zero);
+        __m256 dy = _mm256_max_ps(_mm256_max_ps(_mm256_sub_ps(minY, y), _mm256_sub_ps(y, maxY)), zero);
+        __m256 dz = _mm256_max_ps(_mm256_max_ps(_mm256_sub_ps(minZ, z), _mm256_sub_ps(z, maxZ)), zero);
+        __m256 distanceSq = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(distanceSq, radiusSq, _CMP_LE_OQ)));
+        if (mask == 0)
+            continue;
+
+        // 겹친 빛 번호를 앞으로 모아서 8칸을 통째로 쓴다. 개수 밖의 칸은 다음 묶음이 덮어쓰거나 읽지 않는다
+        // 목록 끝 근처에서는 옆 클러스터 목록을 건드리지 않도록 하나씩 쓴다
+        uint32_t hits = static_cast<uint32_t>(_mm_popcnt_u32(mask));
+        if (count + 8 <= maxLightsPerCluster)
+        {
+            __m256i permute = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(compactTable[mask].data()));
+            __m256i lightIndex = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&lights.lightIndex[i]));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(&indices[count]), _mm256_permutevar8x32_epi32(lightIndex, permute));
+        }
+        else
+        {
+            for (uint32_t n = 0; n < hits && count + n < maxLightsPerCluster; n++)
+                indices[count + n] = lights.lightIndex[i + compactTable[mask][n]];
+        }
+        count += hits;
+    }
+
+    return count;
+}
+#else
+uint32_t LightClusters::AssignClusterAvx2(uint32_t clusterIndex, const LightSubset& lights)
+{
+    return AssignClusterScalar(clusterIndex, lights);
+}
+#endif
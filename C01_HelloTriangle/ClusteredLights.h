@@ -0,0 +1,154 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Executor.h"
+#include "FrameArena.h"
+#include "Task.h"
+
+enum class LightType : uint32_t
+{
+    Point,
+    Spot,
+};
+
+// clusteredlights.hlsl의 Light와 맞아야 한다. 좌표와 방향은 뷰 공간(+z가 앞, +y가 위)이다
+struct GpuLight
+{
+    float positionX, positionY, positionZ;
+    float range;
+    float colorR, colorG, colorB;
+    LightType type;
+    float directionX, directionY, directionZ; // Spot만 쓴다. 길이 1
+    float cosOuterAngle;                      // Spot만 쓴다. 원뿔 반각의 cos
+};
+
+// clusteredlights.hlsl의 ClusterConstants와 맞아야 한다. 배정 compute 셰이더와 조명 픽셀 셰이더가 같이 쓴다
+struct ClusterConstants
+{
+    uint32_t tilesX;
+    uint32_t tilesY;
+    uint32_t slices;
+    uint32_t lightCount;
+    float nearZ;
+    float farZ;
+    float tanHalfFovX;
+    float tanHalfFovY;
+    float viewportWidth;
+    float viewportHeight;
+    float sliceScale; // slice = floor(log(z) * sliceScale + sliceBias)
+    float sliceBias;
+    uint32_t maxLightsPerCluster;
+    float floorY;     // 조명을 받는 바닥 평면의 뷰 공간 높이
+    uint32_t padding[2];
+};
+
+// 뷰 공간 클러스터 격자. 화면을 tilesX x tilesY 타일로 나누고, 깊이는 near~far를 지수 간격으로 slices개로 나눈다
+// 지수 간격이라 먼 곳의 클러스터도 화면에서 보이는 크기에 비해 너무 길어지지 않는다
+struct ClusterGridDesc
+{
+    uint32_t tilesX;
+    uint32_t tilesY;
+    uint32_t slices;
+    float nearZ;
+    float farZ;
+    float tanHalfFovX;
+    float tanHalfFovY;
+};
+
+// 클러스터 하나의 뷰 공간 AABB
+struct ClusterBounds
+{
+    float minX, minY, minZ;
+    float maxX, maxY, maxZ;
+};
+
+enum class ClusterSimdPath
+{
+    Scalar,
+    Avx2,
+};
+
+struct ClusterAssignStats
+{
+    uint64_t assignedLights;     // 모든 클러스터의 (잘리기 전) 빛 수 합
+    uint32_t overflowedClusters; // maxLightsPerCluster를 넘어서 잘린 클러스터
+    uint32_t maxLightsInCluster; // 잘리기 전 가장 많은 클러스터의 빛 수
+    uint32_t occupiedClusters;   // 빛이 하나라도 있는 클러스터
+};
+
+// 클러스터별 빛 목록을 만드는 CPU 구현. clusteredlights.hlsl의 CSAssignLights와 같은 배치를 만든다
+// 결과는 클러스터마다 maxLightsPerCluster 칸을 고정으로 잡은 인덱스 배열과 개수 배열이고, GPU 버퍼와 같은 레이아웃이다
+// 클러스터 안의 인덱스는 빛 번호 순서라서 스칼라, AVX2, 스레드 수에 상관없이 결과가 같다
+class LightClusters
+{
+    ClusterGridDesc desc;
+    uint32_t maxLightsPerCluster;
+    std::vector<ClusterBounds> bounds;
+
+    // 컬링용 구 목록. SIMD로 8개씩 읽도록 SoA로 두고 8의 배수까지 어디와도 겹치지 않는 구로 채운다
+    // 슬라이스, 행 단위로 겹치는 것만 추려서 클러스터마다 전체 빛을 보지 않는다. 빛 번호 순서는 그대로 지킨다
+    // arena가 없으면 힙에 둔다. 슬라이스와 행마다 거른 목록은 워커 스레드의 임시 메모리에 둔다
+    struct LightSubset
+    {
+        ArenaVector<float> x;
+        ArenaVector<float> y;
+        ArenaVector<float> z;
+        ArenaVector<float> radiusSq;
+        ArenaVector<uint32_t> lightIndex;
+        uint32_t count = 0;
+
+        explicit LightSubset(LinearArena* arena = nullptr);
+
+        void Reserve(uint32_t capacity);
+        void Clear();
+        void Add(float x, float y, float z, float radiusSq, uint32_t lightIndex);
+        void Pad();
+    };
+
+    LightSubset allLights;
+
+    std::vector<uint32_t> lightCounts;  // 클러스터마다 실제로 담은 수 (maxLightsPerCluster 이하)
+    std::vector<uint32_t> lightIndices; // 클러스터 i의 목록은 [i * maxLightsPerCluster, i * maxLightsPerCluster + lightCounts[i])
+    ClusterAssignStats stats;
+    ClusterSimdPath simdPath;
+
+public:
+    static const uint32_t DefaultMaxLightsPerCluster = 256;
+
+    LightClusters();
+
+    // 격자를 바꾸면 클러스터 AABB를 다시 계산한다. 투영이나 창 크기가 바뀔때만 부르면 된다
+    void Build(const ClusterGridDesc& desc, uint32_t maxLightsPerCluster = DefaultMaxLightsPerCluster);
+
+    // 빛을 클러스터에 배정한다. executor가 있으면 z 슬라이스 단위로 나눠서 워커 스레드에서 동시에 한다
+    void Assign(const GpuLight* lights, uint32_t lightCount, Executor* executor = nullptr);
+
+    void SetSimdPath(ClusterSimdPath path);
+    ClusterSimdPath GetSimdPath() const { return simdPath; }
+
+    const ClusterGridDesc& GetDesc() const { return desc; }
+    uint32_t GetClusterCount() const { return desc.tilesX * desc.tilesY * desc.slices; }
+    uint32_t GetMaxLightsPerCluster() const { return maxLightsPerCluster; }
+    const std::vector<ClusterBounds>& GetBounds() const { return bounds; }
+    const std::vector<uint32_t>& GetLightCounts() const { return lightCounts; }
+    const std::vector<uint32_t>& GetLightIndices() const { return lightIndices; }
+    const ClusterAssignStats& GetStats() const { return stats; }
+
+    // 셰이더 쪽 찾기(GetClusterIndex)와 같은 계산. viewZ는 뷰 공간 깊이
+    uint32_t GetSlice(float viewZ) const;
+    uint32_t GetClusterIndex(float pixelX, float pixelY, float viewZ, float viewportWidth, float viewportHeight) const;
+
+    // 셰이더에 넘길 상수. lightCount, viewport, floorY는 부르는 쪽에서 채운다
+    ClusterConstants MakeConstants() const;
+
+    // 빛을 감싸는 구. Spot은 원뿔을 감싸는 가장 작은 구를 쓴다
+    static void ComputeCullSphere(const GpuLight& light, float& centerX, float& centerY, float& centerZ, float& radius);
+    static ClusterBounds ComputeClusterBounds(const ClusterGridDesc& desc, uint32_t tileX, uint32_t tileY, uint32_t slice);
+
+private:
+    ClusterAssignStats AssignSlice(uint32_t slice);
+    Task<void> AssignSliceAsync(Executor& executor, uint32_t slice, ClusterAssignStats& sliceStats);
+    static void Filter(const LightSubset& source, const ClusterBounds& region, LightSubset& result);
+    uint32_t AssignClusterScalar(uint32_t clusterIndex, const LightSubset& lights);
+    uint32_t AssignClusterAvx2(uint32_t clusterIndex, const LightSubset& lights);
+};
@@ -0,0 +1,758 @@
+#include "CommandStream.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+using namespace std;
+using namespace std::filesystem;
+
+namespace
+{
+    // 파일 형식이 바뀌면 올린다
+    const uint32_t CommandCaptureVersion = 1;
+
+    // 루트 시그니처 전체가 32비트 값 64개까지라서 루트 상수도 그 이상은 없다
+    const uint32_t MaxRootConstants = 64;
+
+    // 앞에서부터 읽으며 남은 길이를 넘으면 실패한다
+    class StreamReader
+    {
+        const uint8_t* data;
+        size_t size;
+        size_t offset;
+
+    public:
+        StreamReader(const uint8_t* data, size_t size) : data(data), size(size), offset(0) {}
+
+        bool IsEnd() const { return offset == size; }
+
+        bool ReadBytes(const uint8_t*& bytes, size_t count)
+        {
+            if (size - offset < count)
+                return false;
+
+            bytes = data + offset;
+            offset += count;
+            return true;
+        }
+
+        template<typename T>
+        bool Read(T& value)
+        {
+            const uint8_t* bytes;
+            if (!ReadBytes(bytes, sizeof(T)))
+                return false;
+
+            memcpy(&value, bytes, sizeof(T));
+            return true;
+        }
+    };
+
+    bool ReplayCommand(CommandType type, StreamReader& reader, ICommandBackend& backend)
+    {
+        switch (type)
+        {
+        case CommandType::BeginFrame:
+        {
+            uint64_t frameNumber;
+            if (!reader.Read(frameNumber))
+                return false;
+
+            backend.BeginFrame(frameNumber);
+            return true;
+        }
+        case CommandType::Upload:
+        {
+            CommandObjectId resource;
+            uint32_t offset, size;
+            const uint8_t* data;
+            if (!reader.Read(resource) || !reader.Read(offset) || !reader.Read(size) || !reader.ReadBytes(data, size))
+                return false;
+
+            backend.Upload(resource, offset, data, size);
+            return true;
+        }
+        case CommandType::ResourceBarrier:
+        {
+            CommandObjectId resource;
+            uint32_t stateBefore, stateAfter;
+            if (!reader.Read(resource) || !reader.Read(stateBefore) || !reader.Read(stateAfter))
+                return false;
+
+            backend.ResourceBarrier(resource, stateBefore, stateAfter);
+            return true;
+        }
+        case CommandType::SetRenderTarget:
+        {
+            CommandObjectId renderTargetView;
+            if (!reader.Read(renderTargetView))
+                return false;
+
+            backend.SetRenderTarget(renderTargetView);
+            return true;
+        }
+        case CommandType::ClearRenderTarget:
+        {
+            CommandObjectId renderTargetView;
+            float color[4];
+            if (!reader.Read(renderTargetView) || !reader.Read(color))
+                return false;
+
+            backend.ClearRenderTarget(renderTargetView, color);
+            return true;
+        }
+        case CommandType::SetViewport:
+        {
+            CommandViewport viewport;
+            if (!reader.Read(viewport))
+                return false;
+
+            backend.SetViewport(viewport);
+            return true;
+        }
+        case CommandType::SetScissorRect:
+        {
+            CommandRect rect;
+            if (!reader.Read(rect))
+                return false;
+
+            backend.SetScissorRect(rect);
+            return true;
+        }
+        case CommandType::SetPipelineState:
+        {
+            CommandObjectId pipelineState;
+            if (!reader.Read(pipelineState))
+                return false;
+
+            backend.SetPipelineState(pipelineState);
+            return true;
+        }
+        case CommandType::SetRootSignature:
+        {
+            CommandObjectId rootSignature;
+            if (!reader.Read(rootSignature))
+                return false;
+
+            backend.SetRootSignature(rootSignature);
+            return true;
+        }
+        case CommandType::SetPrimitiveTopology:
+        {
+            uint32_t topology;
+            if (!reader.Read(topology))
+                return false;
+
+            backend.SetPrimitiveTopology(topology);
+            return true;
+        }
+        case CommandType::SetVertexBuffer:
+        {
+            CommandObjectId resource;
+            uint32_t size, stride;
+            if (!reader.Read(resource) || !reader.Read(size) || !reader.Read(stride))
+                return false;
+
+            backend.SetVertexBuffer(resource, size, stride);
+            return true;
+        }
+        case CommandType::SetRootConstants:
+        {
+            uint32_t rootParameter, count;
+            uint32_t values[MaxRootConstants];
+            if (!reader.Read(rootParameter) || !reader.Read(count) || count > MaxRootConstants)
+                return false;
+
+            for (uint32_t i = 0; i < count; i++)
+                if (!reader.Read(values[i]))
+                    return false;
+
+            backend.SetRootConstants(rootParameter, values, count);
+            return true;
+        }
+        case CommandType::DrawInstanced:
+        {
+            uint32_t vertexCount, instanceCount, startVertex, startInstance;
+            if (!reader.Read(vertexCount) || !reader.Read(instanceCount) || !reader.Read(startVertex) || !reader.Read(startInstance))
+                return false;
+
+            backend.DrawInstanced(vertexCount, instanceCount, startVertex, startInstance);
+            return true;
+        }
+        case CommandType::External:
+        {
+            uint32_t length;
+            const uint8_t* name;
+            if (!reader.Read(length) || !reader.ReadBytes(name, length))
+                return false;
+
+            backend.External(string_view(reinterpret_cast<const char*>(name), length));
+            return true;
+        }
+        case CommandType::ExecutePass:
+        {
+            uint8_t queue;
+            uint32_t passIndex;
+            if (!reader.Read(queue) || !reader.Read(passIndex) || queue >= QueueTypeCount)
+                return false;
+
+            return backend.ExecutePass(static_cast<QueueType>(queue), passIndex);
+        }
+        case CommandType::QueueWait:
+        {
+            uint8_t queue, signalQueue;
+            uint64_t value;
+            if (!reader.Read(queue) || !reader.Read(signalQueue) || !reader.Read(value) || queue >= QueueTypeCount || signalQueue >= QueueTypeCount)
+                return false;
+
+            return backend.Wait(static_cast<QueueType>(queue), static_cast<QueueType>(signalQueue), value);
+        }
+        case CommandType::QueueSignal:
+        {
+            uint8_t queue;
+            uint64_t value;
+            if (!reader.Read(queue) || !reader.Read(value) || queue >= QueueTypeCount)
+                return false;
+
+            return backend.Signal(static_cast<QueueType>(queue), value);
+        }
+        case CommandType::Present:
+        {
+            uint32_t syncInterval;
+            if (!reader.Read(syncInterval))
+                return false;
+
+            return backend.Present(syncInterval);
+        }
+        default:
+            return false;
+        }
+    }
+
+    // 캡처마다 달라지는 값을 빼고 writer에 다시 적는다. 명령마다 writer 스트림에서 시작하는 위치도 남긴다
+    class NormalizingBackend : public ICommandBackend
+    {
+        CommandStreamWriter& writer;
+        vector<size_t>& commandOffsets;
+        bool hasFirstFrame;
+        uint64_t firstFrameNumber;
+        bool hasFirstSignal[QueueTypeCount];
+        uint64_t firstSignaledValues[QueueTypeCount];
+
+        void BeginCommand() { commandOffsets.push_back(writer.GetStream().size()); }
+
+    public:
+        NormalizingBackend(CommandStreamWriter& writer, vector<size_t>& commandOffsets)
+            : writer(writer), commandOffsets(commandOffsets), hasFirstFrame(false), firstFrameNumber(0), hasFirstSignal{}, firstSignaledValues{}
+        {
+        }
+
+        bool ExecutePass(QueueType queue, uint32_t passIndex) override
+        {
+            BeginCommand();
+            return writer.ExecutePass(queue, passIndex);
+        }
+
+        bool Wait(QueueType /*queue*/, QueueType /*signalQueue*/, uint64_t /*value*/) override { return true; }
+
+        bool Signal(QueueType queue, uint64_t value) override
+        {
+            uint32_t q = static_cast<uint32_t>(queue);
+            if (!hasFirstSignal[q])
+            {
+                hasFirstSignal[q] = true;
+                firstSignaledValues[q] = value;
+            }
+
+            BeginCommand();
+            return writer.Signal(queue, value - firstSignaledValues[q]);
+        }
+
+        uint64_t GetCompletedValue(QueueType /*queue*/) override { return 0; }
+
+        void BeginFrame(uint64_t frameNumber) override
+        {
+            if (!hasFirstFrame)
+            {
+                hasFirstFrame = true;
+                firstFrameNumber = frameNumber;
+            }
+
+            BeginCommand();
+            writer.BeginFrame(frameNumber - firstFrameNumber);
+        }
+
+        void Upload(CommandObjectId resource, uint32_t offset, const void* /*data*/, uint32_t size) override
+        {
+            // 내용 대신 크기만 적는다
+            BeginCommand();
+            writer.Upload(resource, offset, &size, sizeof(size));
+        }
+
+        void ResourceBarrier(CommandObjectId resource, uint32_t stateBefore, uint32_t stateAfter) override
+        {
+            BeginCommand();
+            writer.ResourceBarrier(resource, stateBefore, stateAfter);
+        }
+
+        void SetRenderTarget(CommandObjectId renderTargetView) override
+        {
+            BeginCommand();
+            writer.SetRenderTarget(renderTargetView);
+        }
+
+        void ClearRenderTarget(CommandObjectId renderTargetView, const float color[4]) override
+        {
+            BeginCommand();
+            writer.ClearRenderTarget(renderTargetView, color);
+        }
+
+        void SetViewport(const CommandViewport& viewport) override
+        {
+            BeginCommand();
+            writer.SetViewport(viewport);
+        }
+
+        void SetScissorRect(const CommandRect& rect) override
+        {
+            BeginCommand();
+            writer.SetScissorRect(rect);
+        }
+
+        void SetPipelineState(CommandObjectId pipelineState) override
+        {
+            BeginCommand();
+            writer.SetPipelineState(pipelineState);
+        }
+
+        void SetRootSignature(CommandObjectId rootSignature) override
+        {
+            BeginCommand();
+            writer.SetRootSignature(rootSignature);
+        }
+
+        void SetPrimitiveTopology(uint32_t topology) override
+        {
+            BeginCommand();
+            writer.SetPrimitiveTopology(topology);
+        }
+
+        void SetVertexBuffer(CommandObjectId resource, uint32_t size, uint32_t stride) override
+        {
+            BeginCommand();
+            writer.SetVertexBuffer(resource, size, stride);
+        }
+
+        void SetRootConstants(uint32_t rootParameter, const uint32_t* values, uint32_t count) override
+        {
+            BeginCommand();
+            writer.SetRootConstants(rootParameter, values, count);
+        }
+
+        void DrawInstanced(uint32_t vertexCount, uint32_t instanceCount, uint32_t startVertex, uint32_t startInstance) override
+        {
+            BeginCommand();
+            writer.DrawInstanced(vertexCount, instanceCount, startVertex, startInstance);
+        }
+
+        void External(string_view name) override
+        {
+            BeginCommand();
+            writer.External(name);
+        }
+
+        bool Present(uint32_t syncInterval) override
+        {
+            BeginCommand();
+            return writer.Present(syncInterval);
+        }
+    };
+
+    // offset을 포함하는 명령의 순번. offset이 스트림 끝이면 명령 수
+    uint64_t FindCommandIndex(const vector<size_t>& commandOffsets, size_t streamSize, size_t offset)
+    {
+        if (offset >= streamSize)
+            return commandOffsets.size();
+
+        return upper_bound(commandOffsets.begin(), commandOffsets.end(), offset) - commandOffsets.begin() - 1;
+    }
+}
+
+CommandStreamWriter::CommandStreamWriter()
+    : commandCounts{}, frameCount(0), pendingPasses{}, submissionCounts{}
+{
+}
+
+void CommandStreamWriter::Clear()
+{
+    stream.clear();
+    fill(begin(commandCounts), end(commandCounts), 0);
+    frameCount = 0;
+    fill(begin(pendingPasses), end(pendingPasses), 0);
+    fill(begin(submissionCounts), end(submissionCounts), 0);
+}
+
+uint64_t CommandStreamWriter::GetTotalCommandCount() const
+{
+    uint64_t total = 0;
+    for (uint64_t count : commandCounts)
+        total += count;
+    return total;
+}
+
+void CommandStreamWriter::BeginCommand(CommandType type)
+{
+    commandCounts[static_cast<uint32_t>(type)]++;
+    Write(static_cast<uint8_t>(type));
+}
+
+void CommandStreamWriter::FlushPending(QueueType queue)
+{
+    uint32_t q = static_cast<uint32_t>(queue);
+    if (pendingPasses[q] == 0)
+        return;
+
+    submissionCounts[q]++;
+    pendingPasses[q] = 0;
+}
+
+void CommandStreamWriter::WriteBytes(const void* data, size_t size)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    stream.insert(stream.end(), bytes, bytes + size);
+}
+
+bool CommandStreamWriter::ExecutePass(QueueType queue, uint32_t passIndex)
+{
+    BeginCommand(CommandType::ExecutePass);
+    Write(static_cast<uint8_t>(queue));
+    Write(passIndex);
+    pendingPasses[static_cast<uint32_t>(queue)]++;
+    return true;
+}
+
+bool CommandStreamWriter::Wait(QueueType queue, QueueType signalQueue, uint64_t value)
+{
+    BeginCommand(CommandType::QueueWait);
+    Write(static_cast<uint8_t>(queue));
+    Write(static_cast<uint8_t>(signalQueue));
+    Write(value);
+    FlushPending(queue);
+    return true;
+}
+
+bool CommandStreamWriter::Signal(QueueType queue, uint64_t value)
+{
+    BeginCommand(CommandType::QueueSignal);
+    Write(static_cast<uint8_t>(queue));
+    Write(value);
+    FlushPending(queue);
+    return true;
+}
+
+void CommandStreamWriter::BeginFrame(uint64_t frameNumber)
+{
+    BeginCommand(CommandType::BeginFrame);
+    Write(frameNumber);
+    frameCount++;
+}
+
+void CommandStreamWriter::Upload(CommandObjectId resource, uint32_t offset, const void* data, uint32_t size)
+{
+    BeginCommand(CommandType::Upload);
+    Write(resource);
+    Write(offset);
+    Write(size);
+    WriteBytes(data, size);
+}
+
+void CommandStreamWriter::ResourceBarrier(CommandObjectId resource, uint32_t stateBefore, uint32_t stateAfter)
+{
+    BeginCommand(CommandType::ResourceBarrier);
+    Write(resource);
+    Write(stateBefore);
+    Write(stateAfter);
+}
+
+void CommandStreamWriter::SetRenderTarget(CommandObjectId renderTargetView)
+{
+    BeginCommand(CommandType::SetRenderTarget);
+    Write(renderTargetView);
+}
+
+void CommandStreamWriter::ClearRenderTarget(CommandObjectId renderTargetView, const float color[4])
+{
+    BeginCommand(CommandType::ClearRenderTarget);
+    Write(renderTargetView);
+    WriteBytes(color, sizeof(float) * 4);
+}
+
+void CommandStreamWriter::SetViewport(const CommandViewport& viewport)
+{
+    BeginCommand(CommandType::SetViewport);
+    Write(viewport);
+}
+
+void CommandStreamWriter::SetScissorRect(const CommandRect& rect)
+{
+    BeginCommand(CommandType::SetScissorRect);
+    Write(rect);
+}
+
+void CommandStreamWriter::SetPipelineState(CommandObjectId pipelineState)
+{
+    BeginCommand(CommandType::SetPipelineState);
+    Write(pipelineState);
+}
+
+void CommandStreamWriter::SetRootSignature(CommandObjectId rootSignature)
+{
+    BeginCommand(CommandType::SetRootSignature);
+    Write(rootSignature);
+}
+
+void CommandStreamWriter::SetPrimitiveTopology(uint32_t topology)
+{
+    BeginCommand(CommandType::SetPrimitiveTopology);
+    Write(topology);
+}
+
+void CommandStreamWriter::SetVertexBuffer(CommandObjectId resource, uint32_t size, uint32_t stride)
+{
+    BeginCommand(CommandType::SetVertexBuffer);
+    Write(resource);
+    Write(size);
+    Write(stride);
+}
+
+void CommandStreamWriter::SetRootConstants(uint32_t rootParameter, const uint32_t* values, uint32_t count)
+{
+    BeginCommand(CommandType::SetRootConstants);
+    Write(rootParameter);
+    Write(count);
+    WriteBytes(values, sizeof(uint32_t) * count);
+}
+
+void CommandStreamWriter::DrawInstanced(uint32_t vertexCount, uint32_t instanceCount, uint32_t startVertex, uint32_t startInstance)
+{
+    BeginCommand(CommandType::DrawInstanced);
+    Write(vertexCount);
+    Write(instanceCount);
+    Write(startVertex);
+    Write(startInstance);
+}
+
+void CommandStreamWriter::External(string_view name)
+{
+    BeginCommand(CommandType::External);
+    Write(static_cast<uint32_t>(name.size()));
+    WriteBytes(name.data(), name.size());
+}
+
+bool CommandStreamWriter::Present(uint32_t syncInterval)
+{
+    BeginCommand(CommandType::Present);
+    Write(syncInterval);
+    return true;
+}
+
+bool CommandTee::ExecutePass(QueueType queue, uint32_t passIndex)
+{
+    recorder.ExecutePass(queue, passIndex);
+    return primary.ExecutePass(queue, passIndex);
+}
+
+bool CommandTee::Wait(QueueType queue, QueueType signalQueue, uint64_t value)
+{
+    recorder.Wait(queue, signalQueue, value);
+    return primary.Wait(queue, signalQueue, value);
+}
+
+bool CommandTee::Signal(QueueType queue, uint64_t value)
+{
+    recorder.Signal(queue, value);
+    return primary.Signal(queue, value);
+}
+
+void CommandTee::BeginFrame(uint64_t frameNumber)
+{
+    recorder.BeginFrame(frameNumber);
+    primary.BeginFrame(frameNumber);
+}
+
+void CommandTee::Upload(CommandObjectId resource, uint32_t offset, const void* data, uint32_t size)
+{
+    recorder.Upload(resource, offset, data, size);
+    primary.Upload(resource, offset, data, size);
+}
+
+void CommandTee::ResourceBarrier(CommandObjectId resource, uint32_t stateBefore, uint32_t stateAfter)
+{
+    recorder.ResourceBarrier(resource, stateBefore, stateAfter);
+    primary.ResourceBarrier(resource, stateBefore, stateAfter);
+}
+
+void CommandTee::SetRenderTarget(CommandObjectId renderTargetView)
+{
+    recorder.SetRenderTarget(renderTargetView);
+    primary.SetRenderTarget(renderTargetView);
+}
+
+void CommandTee::ClearRenderTarget(CommandObjectId renderTargetView, const float color[4])
+{
+    recorder.ClearRenderTarget(renderTargetView, color);
+    primary.ClearRenderTarget(renderTargetView, color);
+}
+
+void CommandTee::SetViewport(const CommandViewport& viewport)
+{
+    recorder.SetViewport(viewport);
+    primary.SetViewport(viewport);
+}
+
+void CommandTee::SetScissorRect(const CommandRect& rect)
+{
+    recorder.SetScissorRect(rect);
+    primary.SetScissorRect(rect);
+}
+
+void CommandTee::SetPipelineState(CommandObjectId pipelineState)
+{
+    recorder.SetPipelineState(pipelineState);
+    primary.SetPipelineState(pipelineState);
+}
+
+void CommandTee::SetRootSignature(CommandObjectId rootSignature)
+{
+    recorder.SetRootSignature(rootSignature);
+    primary.SetRootSignature(rootSignature);
+}
+
+void CommandTee::SetPrimitiveTopology(uint32_t topology)
+{
+    recorder.SetPrimitiveTopology(topology);
+    primary.SetPrimitiveTopology(topology);
+}
+
+void CommandTee::SetVertexBuffer(CommandObjectId resource, uint32_t size, uint32_t stride)
+{
+    recorder.SetVertexBuffer(resource, size, stride);
+    primary.SetVertexBuffer(resource, size, stride);
+}
+
+void CommandTee::SetRootConstants(uint32_t rootParameter, const uint32_t* values, uint32_t count)
+{
+    recorder.SetRootConstants(rootParameter, values, count);
+    primary.SetRootConstants(rootParameter, values, count);
+}
+
+void CommandTee::DrawInstanced(uint32_t vertexCount, uint32_t instanceCount, uint32_t startVertex, uint32_t startInstance)
+{
+    recorder.DrawInstanced(vertexCount, instanceCount, startVertex, startInstance);
+    primary.DrawInstanced(vertexCount, instanceCount, startVertex, startInstance);
+}
+
+void CommandTee::External(string_view name)
+{
+    recorder.External(name);
+    primary.External(name);
+}
+
+bool CommandTee::Present(uint32_t syncInterval)
+{
+    recorder.Present(syncInterval);
+    return primary.Present(syncInterval);
+}
+
+bool ReplayCommandStream(const vector<uint8_t>& stream, ICommandBackend& backend, CommandReplayStats* stats)
+{
+    StreamReader reader(stream.data(), stream.size());
+    CommandReplayStats replayStats = {};
+    bool succeeded = true;
+
+    while (!reader.IsEnd())
+    {
+        uint8_t type;
+        if (!reader.Read(type) || !ReplayCommand(static_cast<CommandType>(type), reader, backend))
+        {
+            succeeded = false;
+            break;
+        }
+
+        replayStats.commandCount++;
+        if (static_cast<CommandType>(type) == CommandType::BeginFrame)
+            replayStats.frameCount++;
+    }
+
+    if (stats)
+        *stats = replayStats;
+    return succeeded;
+}
+
+bool LoadCommandCapture(const path& capturePath, vector<uint8_t>& stream)
+{
+    ifstream file(capturePath, ios::binary);
+    if (!file)
+        return false;
+
+    uint32_t version = 0;
+    if (!file.read(reinterpret_cast<char*>(&version), sizeof(version)) || version != CommandCaptureVersion)
+        return false;
+
+    // 헤더의 크기가 파일보다 크면 깨진 파일이다
+    uint64_t size = 0;
+    error_code ec;
+    uint64_t fileSize = file_size(capturePath, ec);
+    if (!file.read(reinterpret_cast<char*>(&size), sizeof(size)) || ec || size > fileSize)
+        return false;
+
+    stream.resize(static_cast<size_t>(size));
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(stream.data()), stream.size()));
+}
+
+bool SaveCommandCapture(const path& capturePath, const vector<uint8_t>& stream)
+{
+    ofstream file(capturePath, ios::binary | ios::trunc);
+    if (!file)
+        return false;
+
+    uint64_t size = stream.size();
+    file.write(reinterpret_cast<const char*>(&CommandCaptureVersion), sizeof(CommandCaptureVersion));
+    file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    file.write(reinterpret_cast<const char*>(stream.data()), stream.size());
+    return static_cast<bool>(file);
+}
+
+bool CompareCommandStreams(const vector<uint8_t>& reference, const vector<uint8_t>& captured, CommandStreamDiff& diff)
+{
+    CommandStreamWriter normalizedReference, normalizedCaptured;
+    vector<size_t> referenceOffsets, capturedOffsets;
+    NormalizingBackend referenceBackend(normalizedReference, referenceOffsets);
+    NormalizingBackend capturedBackend(normalizedCaptured, capturedOffsets);
+    if (!ReplayCommandStream(reference, referenceBackend) || !ReplayCommandStream(captured, capturedBackend))
+        return false;
+
+    // 다른 바이트 앞까지는 같은 명령들이므로 명령 경계도 두 스트림이 같다
+    const vector<uint8_t>& a = normalizedReference.GetStream();
+    const vector<uint8_t>& b = normalizedCaptured.GetStream();
+    size_t offset = mismatch(a.begin(), a.end(), b.begin(), b.end()).first - a.begin();
+
+    diff.identical = offset == a.size() && offset == b.size();
+    diff.commandIndex = offset < a.size() ? FindCommandIndex(referenceOffsets, a.size(), offset) : FindCommandIndex(capturedOffsets, b.size(), offset);
+    diff.referenceType = offset < a.size() ? static_cast<CommandType>(a[referenceOffsets[diff.commandIndex]]) : CommandType::Count;
+    diff.capturedType = offset < b.size() ? static_cast<CommandType>(b[capturedOffsets[diff.commandIndex]]) : CommandType::Count;
+    return true;
+}
+
+const char* GetCommandTypeName(CommandType type)
+{
+    static const char* const names[CommandTypeCount] =
+    {
+        "BeginFrame", "Upload", "ResourceBarrier", "SetRenderTarget", "ClearRenderTarget", "SetViewport", "SetScissorRect",
+        "SetPipelineState", "SetRootSignature", "SetPrimitiveTopology", "SetVertexBuffer", "SetRootConstants", "DrawInstanced",
+        "External", "ExecutePass", "QueueWait", "QueueSignal", "Present",
+    };
+
+    uint32_t index = static_cast<uint32_t>(type);
+    return index < CommandTypeCount ? names[index] : "end of stream";
+}
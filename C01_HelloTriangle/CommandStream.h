@@ -0,0 +1,192 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+#include <vector>
+#include "FrameGraph.h"
+
+// 캡처 안에서 리소스, 뷰, 파이프라인을 가리키는 번호. 어떤 번호가 무엇인지는 기록하는 쪽(MyWindow)이 정한다
+using CommandObjectId = uint32_t;
+
+enum class CommandType : uint8_t
+{
+    BeginFrame,
+    Upload,
+    ResourceBarrier,
+    SetRenderTarget,
+    ClearRenderTarget,
+    SetViewport,
+    SetScissorRect,
+    SetPipelineState,
+    SetRootSignature,
+    SetPrimitiveTopology,
+    SetVertexBuffer,
+    SetRootConstants,
+    DrawInstanced,
+    External,
+    ExecutePass,
+    QueueWait,
+    QueueSignal,
+    Present,
+    Count
+};
+
+constexpr uint32_t CommandTypeCount = static_cast<uint32_t>(CommandType::Count);
+
+struct CommandViewport
+{
+    float x, y, width, height;
+    float minDepth, maxDepth;
+};
+
+struct CommandRect
+{
+    int32_t left, top, right, bottom;
+};
+
+// MyWindow가 프레임을 만들면서 하는 디바이스, 커맨드 리스트, 큐 호출
+// 이 인터페이스로만 부르면 그대로 캡처했다가 아무 백엔드로나 다시 재생할 수 있다
+// 리소스 상태, 토폴로지는 D3D12 열거형 값을 그대로 담는다
+// 큐 호출(ExecuteCommandLists, Wait, Signal)은 IQueueBackend 것을 그대로 써서 FrameGraph::Submit에 바로 넘긴다
+class ICommandBackend : public IQueueBackend
+{
+public:
+    virtual void BeginFrame(uint64_t frameNumber) = 0;
+
+    // CPU에서 쓸 수 있는 버퍼에 data를 복사한다
+    virtual void Upload(CommandObjectId resource, uint32_t offset, const void* data, uint32_t size) = 0;
+
+    virtual void ResourceBarrier(CommandObjectId resource, uint32_t stateBefore, uint32_t stateAfter) = 0;
+    virtual void SetRenderTarget(CommandObjectId renderTargetView) = 0;
+    virtual void ClearRenderTarget(CommandObjectId renderTargetView, const float color[4]) = 0;
+    virtual void SetViewport(const CommandViewport& viewport) = 0;
+    virtual void SetScissorRect(const CommandRect& rect) = 0;
+    virtual void SetPipelineState(CommandObjectId pipelineState) = 0;
+    virtual void SetRootSignature(CommandObjectId rootSignature) = 0;
+    virtual void SetPrimitiveTopology(uint32_t topology) = 0;
+    virtual void SetVertexBuffer(CommandObjectId resource, uint32_t size, uint32_t stride) = 0;
+    virtual void SetRootConstants(uint32_t rootParameter, const uint32_t* values, uint32_t count) = 0;
+    virtual void DrawInstanced(uint32_t vertexCount, uint32_t instanceCount, uint32_t startVertex, uint32_t startInstance) = 0;
+
+    // 하위 시스템(파티클, 조명, 디버그 그리기 등)이 커맨드 리스트에 직접 기록한 자리. 이름만 남고 재생할때는 건너뛴다
+    virtual void External(std::string_view name) = 0;
+
+    virtual bool Present(uint32_t syncInterval) = 0;
+};
+
+// 호출을 바이트 스트림으로 적기만 하는 백엔드. GPU 없이 재생 목적지로 쓰면 제출 비용만 잴 수 있다
+// 같은 호출열은 같은 바이트가 되므로 빌드 사이에 스트림을 바이트 단위로 비교하면 된다
+// 형식: 명령마다 CommandType 1바이트 + 고정 길이 인자, 가변 길이 인자는 uint32 길이를 앞에 둔다 (리틀 엔디언)
+class CommandStreamWriter : public ICommandBackend
+{
+    std::vector<uint8_t> stream;
+    uint64_t commandCounts[CommandTypeCount];
+    uint32_t frameCount;
+
+    // GpuQueues와 같은 규칙으로 센 ExecuteCommandLists 횟수. ExecutePass를 모았다가 Wait/Signal에서 한 번 제출한다
+    uint32_t pendingPasses[QueueTypeCount];
+    uint64_t submissionCounts[QueueTypeCount];
+
+public:
+    CommandStreamWriter();
+
+    // 버퍼 메모리는 남겨둔다
+    void Clear();
+    void Reserve(size_t size) { stream.reserve(size); }
+
+    const std::vector<uint8_t>& GetStream() const { return stream; }
+    uint64_t GetCommandCount(CommandType type) const { return commandCounts[static_cast<uint32_t>(type)]; }
+    uint64_t GetTotalCommandCount() const;
+    uint32_t GetFrameCount() const { return frameCount; }
+    uint64_t GetSubmissionCount(QueueType queue) const { return submissionCounts[static_cast<uint32_t>(queue)]; }
+
+    bool ExecutePass(QueueType queue, uint32_t passIndex) override;
+    bool Wait(QueueType queue, QueueType signalQueue, uint64_t value) override;
+    bool Signal(QueueType queue, uint64_t value) override;
+    uint64_t GetCompletedValue(QueueType /*queue*/) override { return 0; } // GPU가 없으므로 끝난 것이 없다
+
+    void BeginFrame(uint64_t frameNumber) override;
+    void Upload(CommandObjectId resource, uint32_t offset, const void* data, uint32_t size) override;
+    void ResourceBarrier(CommandObjectId resource, uint32_t stateBefore, uint32_t stateAfter) override;
+    void SetRenderTarget(CommandObjectId renderTargetView) override;
+    void ClearRenderTarget(CommandObjectId renderTargetView, const float color[4]) override;
+    void SetViewport(const CommandViewport& viewport) override;
+    void SetScissorRect(const CommandRect& rect) override;
+    void SetPipelineState(CommandObjectId pipelineState) override;
+    void SetRootSignature(CommandObjectId rootSignature) override;
+    void SetPrimitiveTopology(uint32_t topology) override;
+    void SetVertexBuffer(CommandObjectId resource, uint32_t size, uint32_t stride) override;
+    void SetRootConstants(uint32_t rootParameter, const uint32_t* values, uint32_t count) override;
+    void DrawInstanced(uint32_t vertexCount, uint32_t instanceCount, uint32_t startVertex, uint32_t startInstance) override;
+    void External(std::string_view name) override;
+    bool Present(uint32_t syncInterval) override;
+
+private:
+    void BeginCommand(CommandType type);
+    void FlushPending(QueueType queue);
+    void WriteBytes(const void* data, size_t size);
+
+    template<typename T>
+    void Write(const T& value) { WriteBytes(&value, sizeof(T)); }
+};
+
+// 캡처하는 동안 호출을 실제 백엔드와 기록하는 백엔드 양쪽에 넘긴다. 결과와 완료 값은 primary 것을 쓴다
+class CommandTee : public ICommandBackend
+{
+    ICommandBackend& primary;
+    ICommandBackend& recorder;
+
+public:
+    CommandTee(ICommandBackend& primary, ICommandBackend& recorder) : primary(primary), recorder(recorder) {}
+
+    bool ExecutePass(QueueType queue, uint32_t passIndex) override;
+    bool Wait(QueueType queue, QueueType signalQueue, uint64_t value) override;
+    bool Signal(QueueType queue, uint64_t value) override;
+    uint64_t GetCompletedValue(QueueType queue) override { return primary.GetCompletedValue(queue); }
+
+    void BeginFrame(uint64_t frameNumber) override;
+    void Upload(CommandObjectId resource, uint32_t offset, const void* data, uint32_t size) override;
+    void ResourceBarrier(CommandObjectId resource, uint32_t stateBefore, uint32_t stateAfter) override;
+    void SetRenderTarget(CommandObjectId renderTargetView) override;
+    void ClearRenderTarget(CommandObjectId renderTargetView, const float color[4]) override;
+    void SetViewport(const CommandViewport& viewport) override;
+    void SetScissorRect(const CommandRect& rect) override;
+    void SetPipelineState(CommandObjectId pipelineState) override;
+    void SetRootSignature(CommandObjectId rootSignature) override;
+    void SetPrimitiveTopology(uint32_t topology) override;
+    void SetVertexBuffer(CommandObjectId resource, uint32_t size, uint32_t stride) override;
+    void SetRootConstants(uint32_t rootParameter, const uint32_t* values, uint32_t count) override;
+    void DrawInstanced(uint32_t vertexCount, uint32_t instanceCount, uint32_t startVertex, uint32_t startInstance) override;
+    void External(std::string_view name) override;
+    bool Present(uint32_t syncInterval) override;
+};
+
+struct CommandReplayStats
+{
+    uint64_t commandCount;
+    uint32_t frameCount;
+};
+
+// 스트림을 처음부터 읽으며 backend에 그대로 다시 부른다. 기다리지 않고 최대한 빨리 넘긴다
+// 형식이 깨졌거나 backend가 실패하면 거기서 멈추고 false
+bool ReplayCommandStream(const std::vector<uint8_t>& stream, ICommandBackend& backend, CommandReplayStats* stats = nullptr);
+
+struct CommandStreamDiff
+{
+    bool identical;
+    uint64_t commandIndex;     // 처음 다른 명령의 순번 (QueueWait는 세지 않는다). 같으면 명령 수
+    CommandType referenceType; // 그 자리의 명령. 그 스트림이 먼저 끝났으면 Count
+    CommandType capturedType;
+};
+
+// 두 캡처가 같은 명령을 같은 인자로 같은 순서대로 불렀는지 본다. 캡처마다 달라지는 값은 빼고 비교한다
+// - 프레임 번호와 큐별 Signal 값은 스트림에서 처음 나온 값을 0으로 맞춘다
+// - QueueWait는 제출할때 GPU가 이미 끝냈으면 생략되므로 보지 않는다
+// - Upload는 대상, 위치, 크기만 본다. 내용은 애니메이션 때문에 매번 다르다
+// 어느 쪽이든 형식이 깨졌으면 false
+bool CompareCommandStreams(const std::vector<uint8_t>& reference, const std::vector<uint8_t>& captured, CommandStreamDiff& diff);
+
+const char* GetCommandTypeName(CommandType type);
+
+bool LoadCommandCapture(const std::filesystem::path& capturePath, std::vector<uint8_t>& stream);
+bool SaveCommandCapture(const std::filesystem::path& capturePath, const std::vector<uint8_t>& stream);
@@ -0,0 +1,39 @@
+#include "CpuFeatures.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define CPU_FEATURES_X86 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+#endif
+
+namespace
+{
+    bool DetectAvx2()
+    {
+#if CPU_FEATURES_X86 && defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 1);
+
+        // OS가 YMM 레지스터를 저장해주는지까지 확인해야 한다
+        const bool osxsave = (info[2] & (1 << 27)) != 0;
+        const bool avx = (info[2] & (1 << 28)) != 0;
+        if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+            return false;
+
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#elif CPU_FEATURES_X86
+        return __builtin_cpu_supports("avx2");
+#else
+        return false;
+#endif
+    }
+}
+
+bool IsAvx2Supported()
+{
+    static const bool supported = DetectAvx2();
+    return supported;
+}
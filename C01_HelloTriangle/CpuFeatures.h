@@ -0,0 +1,4 @@
+#pragma once
+
+// 실행 중인 CPU와 OS가 AVX2를 쓸 수 있는지. 처음 부를때 한번만 확인한다
+bool IsAvx2Supported();
@@ -0,0 +1,157 @@
+#include "D3D12CommandBackend.h"
+#include <cstring>
+
+using namespace std;
+
+namespace
+{
+    template<typename T>
+    void SetObject(vector<T>& objects, CommandObjectId id, const T& object)
+    {
+        if (objects.size() <= id)
+            objects.resize(id + 1, T{});
+
+        objects[id] = object;
+    }
+
+    template<typename T>
+    const T* FindObject(const vector<T>& objects, CommandObjectId id)
+    {
+        return id < objects.size() ? &objects[id] : nullptr;
+    }
+}
+
+D3D12CommandBackend::D3D12CommandBackend()
+    : queues(nullptr), commandList(nullptr), swapChain(nullptr)
+{
+}
+
+void D3D12CommandBackend::RegisterResource(CommandObjectId id, ID3D12Resource* resource, void* mappedData)
+{
+    SetObject(resources, id, Resource{ resource, static_cast<uint8_t*>(mappedData) });
+}
+
+void D3D12CommandBackend::RegisterRenderTargetView(CommandObjectId id, D3D12_CPU_DESCRIPTOR_HANDLE handle)
+{
+    SetObject(renderTargetViews, id, handle);
+}
+
+void D3D12CommandBackend::RegisterPipelineState(CommandObjectId id, ID3D12PipelineState* pipelineState)
+{
+    SetObject(pipelineStates, id, pipelineState);
+}
+
+void D3D12CommandBackend::RegisterRootSignature(CommandObjectId id, ID3D12RootSignature* rootSignature)
+{
+    SetObject(rootSignatures, id, rootSignature);
+}
+
+bool D3D12CommandBackend::ExecutePass(QueueType queue, uint32_t passIndex)
+{
+    return queues && queues->ExecutePass(queue, passIndex);
+}
+
+bool D3D12CommandBackend::Wait(QueueType queue, QueueType signalQueue, uint64_t value)
+{
+    return queues && queues->Wait(queue, signalQueue, value);
+}
+
+bool D3D12CommandBackend::Signal(QueueType queue, uint64_t value)
+{
+    return queues && queues->Signal(queue, value);
+}
+
+uint64_t D3D12CommandBackend::GetCompletedValue(QueueType queue)
+{
+    return queues ? queues->GetCompletedValue(queue) : 0;
+}
+
+void D3D12CommandBackend::Upload(CommandObjectId resource, uint32_t offset, const void* data, uint32_t size)
+{
+    const Resource* target = FindObject(resources, resource);
+    if (target && target->mappedData)
+        memcpy(target->mappedData + offset, data, size);
+}
+
+void D3D12CommandBackend::ResourceBarrier(CommandObjectId resource, uint32_t stateBefore, uint32_t stateAfter)
+{
+    const Resource* target = FindObject(resources, resource);
+    if (!target || !target->resource)
+        return;
+
+    D3D12_RESOURCE_BARRIER barrier = {};
+    barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+    barrier.Transition.pResource = target->resource;
+    barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+    barrier.Transition.StateBefore = static_cast<D3D12_RESOURCE_STATES>(stateBefore);
+    barrier.Transition.StateAfter = static_cast<D3D12_RESOURCE_STATES>(stateAfter);
+    commandList->ResourceBarrier(1, &barrier);
+}
+
+void D3D12CommandBackend::SetRenderTarget(CommandObjectId renderTargetView)
+{
+    if (const D3D12_CPU_DESCRIPTOR_HANDLE* handle = FindObject(renderTargetViews, renderTargetView))
+        commandList->OMSetRenderTargets(1, handle, /*RTsSingleHandleToDescriptorRange*/ FALSE, /*pDepthStencilDescriptor*/ nullptr);
+}
+
+void D3D12CommandBackend::ClearRenderTarget(CommandObjectId renderTargetView, const float color[4])
+{
+    if (const D3D12_CPU_DESCRIPTOR_HANDLE* handle = FindObject(renderTargetViews, renderTargetView))
+        commandList->ClearRenderTargetView(*handle, color, 0, nullptr);
+}
+
+void D3D12CommandBackend::SetViewport(const CommandViewport& viewport)
+{
+    D3D12_VIEWPORT d3dViewport = { viewport.x, viewport.y, viewport.width, viewport.height, viewport.minDepth, viewport.maxDepth };
+    commandList->RSSetViewports(1, &d3dViewport);
+}
+
+void D3D12CommandBackend::SetScissorRect(const CommandRect& rect)
+{
+    D3D12_RECT d3dRect = { rect.left, rect.top, rect.right, rect.bottom };
+    commandList->RSSetScissorRects(1, &d3dRect);
+}
+
+void D3D12CommandBackend::SetPipelineState(CommandObjectId pipelineState)
+{
+    const auto* found = FindObject(pipelineStates, pipelineState);
+    if (found && *found)
+        commandList->SetPipelineState(*found);
+}
+
+void D3D12CommandBackend::SetRootSignature(CommandObjectId rootSignature)
+{
+    const auto* found = FindObject(rootSignatures, rootSignature);
+    if (found && *found)
+        commandList->SetGraphicsRootSignature(*found);
+}
+
+void D3D12CommandBackend::SetPrimitiveTopology(uint32_t topology)
+{
+    commandList->IASetPrimitiveTopology(static_cast<D3D12_PRIMITIVE_TOPOLOGY>(topology));
+}
+
+void D3D12CommandBackend::SetVertexBuffer(CommandObjectId resource, uint32_t size, uint32_t stride)
+{
+    const Resource* target = FindObject(resources, resource);
+    if (!target || !target->resource)
+        return;
+
+    D3D12_VERTEX_BUFFER_VIEW view = { target->resource->GetGPUVirtualAddress(), size, stride };
+    commandList->IASetVertexBuffers(0, 1, &view);
+}
+
+void D3D12CommandBackend::SetRootConstants(uint32_t rootParameter, const uint32_t* values, uint32_t count)
+{
+    commandList->SetGraphicsRoot32BitConstants(rootParameter, count, values, 0);
+}
+
+void D3D12CommandBackend::DrawInstanced(uint32_t vertexCount, uint32_t instanceCount, uint32_t startVertex, uint32_t startInstance)
+{
+    commandList->DrawInstanced(vertexCount, instanceCount, startVertex, startInstance);
+}
+
+bool D3D12CommandBackend::Present(uint32_t syncInterval)
+{
+    return swapChain && SUCCEEDED(swapChain->Present(syncInterval, 0));
+}
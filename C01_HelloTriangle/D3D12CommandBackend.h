@@ -0,0 +1,60 @@
+#pragma once
+#include <directx/d3d12.h>
+#include <dxgi1_6.h>
+#include <vector>
+#include "CommandStream.h"
+
+// ICommandBackend 호출을 실제 커맨드 리스트, 큐, 스왑체인으로 보낸다
+// 캡처의 오브젝트 번호는 Register로 미리 실제 오브젝트에 이어둔다. 모르는 번호를 가리키는 호출은 건너뛴다
+class D3D12CommandBackend : public ICommandBackend
+{
+    IQueueBackend* queues;
+    ID3D12GraphicsCommandList* commandList;
+    IDXGISwapChain* swapChain;
+
+    struct Resource
+    {
+        ID3D12Resource* resource;
+        uint8_t* mappedData; // Upload 대상이면 계속 Map해둔 주소
+    };
+
+    std::vector<Resource> resources;
+    std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> renderTargetViews;
+    std::vector<ID3D12PipelineState*> pipelineStates;
+    std::vector<ID3D12RootSignature*> rootSignatures;
+
+public:
+    D3D12CommandBackend();
+
+    void SetQueues(IQueueBackend* queueBackend) { queues = queueBackend; }
+    void SetSwapChain(IDXGISwapChain* chain) { swapChain = chain; }
+
+    // 프레임마다 Reset한 커맨드 리스트를 넘긴다. Close는 부르는 쪽이 한다
+    void SetCommandList(ID3D12GraphicsCommandList* list) { commandList = list; }
+
+    void RegisterResource(CommandObjectId id, ID3D12Resource* resource, void* mappedData = nullptr);
+    void RegisterRenderTargetView(CommandObjectId id, D3D12_CPU_DESCRIPTOR_HANDLE handle);
+    void RegisterPipelineState(CommandObjectId id, ID3D12PipelineState* pipelineState);
+    void RegisterRootSignature(CommandObjectId id, ID3D12RootSignature* rootSignature);
+
+    bool ExecutePass(QueueType queue, uint32_t passIndex) override;
+    bool Wait(QueueType queue, QueueType signalQueue, uint64_t value) override;
+    bool Signal(QueueType queue, uint64_t value) override;
+    uint64_t GetCompletedValue(QueueType queue) override;
+
+    void BeginFrame(uint64_t frameNumber) override {}
+    void Upload(CommandObjectId resource, uint32_t offset, const void* data, uint32_t size) override;
+    void ResourceBarrier(CommandObjectId resource, uint32_t stateBefore, uint32_t stateAfter) override;
+    void SetRenderTarget(CommandObjectId renderTargetView) override;
+    void ClearRenderTarget(CommandObjectId renderTargetView, const float color[4]) override;
+    void SetViewport(const CommandViewport& viewport) override;
+    void SetScissorRect(const CommandRect& rect) override;
+    void SetPipelineState(CommandObjectId pipelineState) override;
+    void SetRootSignature(CommandObjectId rootSignature) override;
+    void SetPrimitiveTopology(uint32_t topology) override;
+    void SetVertexBuffer(CommandObjectId resource, uint32_t size, uint32_t stride) override;
+    void SetRootConstants(uint32_t rootParameter, const uint32_t* values, uint32_t count) override;
+    void DrawInstanced(uint32_t vertexCount, uint32_t instanceCount, uint32_t startVertex, uint32_t startInstance) override;
+    void External(std::string_view name) override {}
+    bool Present(uint32_t syncInterval) override;
+};
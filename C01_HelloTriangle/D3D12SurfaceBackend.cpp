@@ -0,0 +1,246 @@
+#include "D3D12SurfaceBackend.h"
+#include <directx/d3dx12.h>
+#include <cstdio>
+#include <cstring>
+#include "BindlessHeap.h"
+
+using namespace winrt;
+using namespace std;
+
+namespace
+{
+    const wchar_t* SurfaceWindowClassName = L"HelloSurfaceWindow";
+
+    // 창마다 바탕색을 달리해서 구분한다
+    const float SurfaceClearColors[D3D12SurfaceBackend::MaxSurfaces][4] =
+    {
+        { 0.2f, 0.1f, 0.3f, 1.0f },
+        { 0.1f, 0.3f, 0.2f, 1.0f },
+        { 0.3f, 0.2f, 0.1f, 1.0f },
+    };
+}
+
+D3D12SurfaceBackend::D3D12SurfaceBackend()
+    : context{}, firstRtvIndex(0), windowClassRegistered(false)
+{
+}
+
+D3D12SurfaceBackend::~D3D12SurfaceBackend()
+{
+    // GPU는 MyWindow::OnDestroy에서 이미 기다렸다
+    for (Surface& surface : surfaces)
+        Release(surface);
+}
+
+void D3D12SurfaceBackend::SetContext(const SharedRenderContext& sharedContext, UINT firstRtv)
+{
+    context = sharedContext;
+    firstRtvIndex = firstRtv;
+}
+
+void D3D12SurfaceBackend::Release(Surface& surface)
+{
+    // 스왑체인을 먼저 놓고 나서 창을 없앤다
+    surface.commandList = nullptr;
+    surface.renderTargets.clear();
+    surface.swapChain = nullptr;
+
+    if (surface.frameLatencyWaitable)
+    {
+        CloseHandle(surface.frameLatencyWaitable);
+        surface.frameLatencyWaitable = nullptr;
+    }
+
+    if (surface.hWnd)
+    {
+        DestroyWindow(surface.hWnd);
+        surface.hWnd = nullptr;
+    }
+}
+
+bool D3D12SurfaceBackend::CreateSurface(uint32_t surfaceIndex, uint32_t width, uint32_t height, SurfaceMemory& memory)
+{
+    // SurfaceSet은 번호를 0부터 차례로 준다
+    if (surfaceIndex != surfaces.size() || surfaceIndex >= MaxSurfaces || !context.device)
+        return false;
+
+    HINSTANCE hInstance = GetModuleHandle(nullptr);
+    if (!windowClassRegistered)
+    {
+        WNDCLASSEX windowClass = { 0 };
+        windowClass.cbSize = sizeof(WNDCLASSEX);
+        windowClass.style = CS_HREDRAW | CS_VREDRAW;
+        windowClass.lpfnWndProc = &D3D12SurfaceBackend::SurfaceWindowProc;
+        windowClass.hInstance = hInstance;
+        windowClass.hCursor = LoadCursor(NULL, IDC_ARROW);
+        windowClass.lpszClassName = SurfaceWindowClassName;
+        if (!RegisterClassEx(&windowClass))
+            return false;
+
+        windowClassRegistered = true;
+    }
+
+    Surface surface = {};
+    RECT windowRect{ 0, 0, static_cast<LONG>(width), static_cast<LONG>(height) };
+    AdjustWindowRect(&windowRect, WS_OVERLAPPEDWINDOW, FALSE);
+
+    wchar_t title[64];
+    swprintf_s(title, L"D3D12 Hello Window %u", surfaceIndex + 2);
+    surface.hWnd = CreateWindow(SurfaceWindowClassName, title, WS_OVERLAPPEDWINDOW, CW_USEDEFAULT, CW_USEDEFAULT,
+        windowRect.right - windowRect.left, windowRect.bottom - windowRect.top, nullptr, nullptr, hInstance, nullptr);
+    if (!surface.hWnd)
+        return false;
+
+    // 키 입력은 주 창이 받도록 포커스를 가져가지 않는다
+    ShowWindow(surface.hWnd, SW_SHOWNOACTIVATE);
+
+    auto fail = [&surface] { Release(surface); return false; };
+
+    // 주 창과 같은 그래픽스 큐에 붙인다. 한 프레임만 앞서 가게 해서 waitable로 준비 여부를 본다
+    DXGI_SWAP_CHAIN_DESC1 swapChainDesc = {};
+    swapChainDesc.BufferCount = context.frameCount;
+    swapChainDesc.Width = width;
+    swapChainDesc.Height = height;
+    swapChainDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    swapChainDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+    swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
+    swapChainDesc.SampleDesc.Count = 1;
+    swapChainDesc.Flags = DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT;
+
+    com_ptr<IDXGISwapChain1> swapChain1;
+    if (FAILED(context.factory->CreateSwapChainForHwnd(context.queues->GetQueue(QueueType::Graphics), surface.hWnd, &swapChainDesc, nullptr, nullptr, swapChain1.put())))
+        return fail();
+
+    if (FAILED(context.factory->MakeWindowAssociation(surface.hWnd, DXGI_MWA_NO_ALT_ENTER)))
+        return fail();
+
+    swapChain1.as(surface.swapChain);
+    if (!surface.swapChain)
+        return fail();
+
+    if (FAILED(surface.swapChain->SetMaximumFrameLatency(1)))
+        return fail();
+
+    surface.frameLatencyWaitable = surface.swapChain->GetFrameLatencyWaitableObject();
+    if (!surface.frameLatencyWaitable)
+        return fail();
+
+    // RTV는 공유 힙에서 이 창 몫의 칸에 만든다
+    CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHandle(context.rtvHeap->GetCPUDescriptorHandleForHeapStart(), firstRtvIndex + surfaceIndex * context.frameCount, context.rtvDescriptorSize);
+    surface.firstRtv = rtvHandle;
+    surface.renderTargets.resize(context.frameCount);
+
+    memory = {};
+    for (UINT n = 0; n < context.frameCount; n++)
+    {
+        if (FAILED(surface.swapChain->GetBuffer(n, IID_PPV_ARGS(&surface.renderTargets[n]))))
+            return fail();
+
+        context.device->CreateRenderTargetView(surface.renderTargets[n].get(), nullptr, rtvHandle);
+        rtvHandle.Offset(1, context.rtvDescriptorSize);
+
+        D3D12_RESOURCE_DESC bufferDesc = surface.renderTargets[n]->GetDesc();
+        memory.backBufferBytes += context.device->GetResourceAllocationInfo(0, 1, &bufferDesc).SizeInBytes;
+    }
+    memory.descriptorBytes = static_cast<uint64_t>(context.rtvDescriptorSize) * context.frameCount;
+
+    // 만들때만 할당자에 붙고 바로 닫는다. 기록 중인 리스트가 없는 때라 어느 슬롯 할당자에 붙여도 된다
+    if (FAILED(context.device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, context.commandAllocators[0], nullptr, IID_PPV_ARGS(&surface.commandList))))
+        return fail();
+
+    if (FAILED(surface.commandList->Close()))
+        return fail();
+
+    surface.viewport = CD3DX12_VIEWPORT(0.0f, 0.0f, static_cast<float>(width), static_cast<float>(height));
+    surface.scissorRect = CD3DX12_RECT(0, 0, static_cast<LONG>(width), static_cast<LONG>(height));
+    memcpy(surface.clearColor, SurfaceClearColors[surfaceIndex], sizeof(surface.clearColor));
+
+    surfaces.push_back(move(surface));
+    return true;
+}
+
+bool D3D12SurfaceBackend::IsSurfaceReady(uint32_t surfaceIndex)
+{
+    Surface& surface = surfaces[surfaceIndex];
+
+    // 닫은 창은 숨겨만 두고 그리지 않는다
+    if (!IsWindowVisible(surface.hWnd))
+        return false;
+
+    // signal 상태면 이 호출이 그것을 소비하므로 이번 프레임에 반드시 Present해야 한다
+    return WaitForSingleObject(surface.frameLatencyWaitable, 0) == WAIT_OBJECT_0;
+}
+
+bool D3D12SurfaceBackend::RecordSurface(uint32_t surfaceIndex, uint32_t frameSlot, uint32_t passIndex, ICommandBackend& commands)
+{
+    Surface& surface = surfaces[surfaceIndex];
+    ID3D12GraphicsCommandList* commandList = surface.commandList.get();
+
+    // 아래 기록은 창 커맨드 리스트에 직접 하므로 F8 캡처에는 이 창을 그렸다는 것만 남긴다
+    commands.External("Surface");
+
+    // 주 창 커맨드 리스트는 이미 닫혔으므로 같은 슬롯 할당자에 이어서 기록한다
+    if (FAILED(commandList->Reset(context.commandAllocators[frameSlot], context.pipelineState)))
+        return false;
+
+    UINT frameIndex = surface.swapChain->GetCurrentBackBufferIndex();
+    ID3D12Resource* renderTarget = surface.renderTargets[frameIndex].get();
+    CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHandle(surface.firstRtv, frameIndex, context.rtvDescriptorSize);
+
+    if (context.bindlessHeap)
+    {
+        ID3D12DescriptorHeap* heaps[] = { context.bindlessHeap };
+        commandList->SetDescriptorHeaps(_countof(heaps), heaps);
+    }
+
+    commandList->SetGraphicsRootSignature(context.rootSignature);
+    commandList->RSSetViewports(1, &surface.viewport);
+    commandList->RSSetScissorRects(1, &surface.scissorRect);
+
+    auto toRenderTarget = CD3DX12_RESOURCE_BARRIER::Transition(renderTarget, D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    commandList->ResourceBarrier(1, &toRenderTarget);
+
+    commandList->OMSetRenderTargets(1, &rtvHandle, FALSE, nullptr);
+    commandList->ClearRenderTargetView(rtvHandle, surface.clearColor, 0, nullptr);
+    commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+    // 버텍스 버퍼도 공유한다. 주 창 OnUpdate가 이 슬롯에 올린 삼각형이 그대로 보인다
+    uint32_t firstVertex = frameSlot * context.vertexCount;
+    if (context.bindlessHeap)
+    {
+        BindlessHeap::DrawConstants drawConstants = { context.vertexBufferIndex, firstVertex, /*materialIndex*/ 0, /*instanceIndex*/ 0 };
+        commandList->SetGraphicsRoot32BitConstants(BindlessHeap::DrawConstantsRootParameter, BindlessHeap::DrawConstantCount, &drawConstants, 0);
+        commandList->DrawInstanced(context.vertexCount, 1, 0, 0);
+    }
+    else
+    {
+        commandList->IASetVertexBuffers(0, 1, &context.vertexBufferView);
+        commandList->DrawInstanced(context.vertexCount, 1, firstVertex, 0);
+    }
+
+    auto toPresent = CD3DX12_RESOURCE_BARRIER::Transition(renderTarget, D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT);
+    commandList->ResourceBarrier(1, &toPresent);
+
+    if (FAILED(commandList->Close()))
+        return false;
+
+    context.queues->SetPassCommandList(passIndex, commandList);
+    return true;
+}
+
+bool D3D12SurfaceBackend::Present(uint32_t surfaceIndex, uint32_t syncInterval)
+{
+    return SUCCEEDED(surfaces[surfaceIndex].swapChain->Present(syncInterval, 0));
+}
+
+LRESULT CALLBACK D3D12SurfaceBackend::SurfaceWindowProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
+{
+    // 추가 창을 닫아도 프로그램은 계속된다. 스왑체인이 창을 쓰고 있으므로 숨기기만 한다
+    if (message == WM_CLOSE)
+    {
+        ShowWindow(hWnd, SW_HIDE);
+        return 0;
+    }
+
+    return DefWindowProc(hWnd, message, wParam, lParam);
+}
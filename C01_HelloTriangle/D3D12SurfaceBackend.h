@@ -0,0 +1,74 @@
+#pragma once
+#include <Windows.h>
+#include <winrt/base.h>
+#include <directx/d3d12.h>
+#include <dxgi1_6.h>
+#include <vector>
+#include "GpuQueues.h"
+#include "SurfaceSet.h"
+
+// 창들이 함께 쓰는 디바이스 단위 오브젝트. 주 창(MyWindow)이 만들어서 채워 넘긴다
+// 추가 창은 이것들을 다시 만들지 않고 스왑체인, 백 버퍼, 커맨드 리스트만 따로 가진다
+struct SharedRenderContext
+{
+    IDXGIFactory4* factory;
+    ID3D12Device* device;
+    GpuQueues* queues;
+
+    // 프레임 슬롯별 기록 메모리. 주 창 커맨드 리스트를 닫은 뒤에 차례로 기록하므로 같은 할당자를 쓸 수 있다
+    std::vector<ID3D12CommandAllocator*> commandAllocators;
+
+    // RTV 힙은 주 창 백 버퍼 뒤에 창마다 frameCount칸씩 이어 쓴다
+    ID3D12DescriptorHeap* rtvHeap;
+    UINT rtvDescriptorSize;
+    UINT frameCount;
+
+    ID3D12PipelineState* pipelineState;
+    ID3D12RootSignature* rootSignature;
+    D3D12_VERTEX_BUFFER_VIEW vertexBufferView;
+    uint32_t vertexCount; // 버텍스 버퍼에는 프레임 슬롯마다 vertexCount개씩 이어져 있다
+
+    // bindless 모드일때만 쓴다
+    ID3D12DescriptorHeap* bindlessHeap;
+    uint32_t vertexBufferIndex;
+};
+
+// 추가 창 하나를 스왑체인과 함께 만들어 공유 파이프라인으로 삼각형을 그린다
+// 스왑체인마다 frame latency waitable object를 두고, 그것이 signal된 창만 그 프레임에 그려서 Present가 막히지 않는다
+class D3D12SurfaceBackend : public ISurfaceBackend
+{
+    struct Surface
+    {
+        HWND hWnd;
+        winrt::com_ptr<IDXGISwapChain3> swapChain;
+        HANDLE frameLatencyWaitable;
+        std::vector<winrt::com_ptr<ID3D12Resource>> renderTargets;
+        D3D12_CPU_DESCRIPTOR_HANDLE firstRtv;
+        winrt::com_ptr<ID3D12GraphicsCommandList> commandList;
+        D3D12_VIEWPORT viewport;
+        D3D12_RECT scissorRect;
+        float clearColor[4];
+    };
+
+    SharedRenderContext context;
+    std::vector<Surface> surfaces;
+    UINT firstRtvIndex; // 공유 RTV 힙에서 추가 창이 쓰기 시작하는 칸
+    bool windowClassRegistered;
+
+public:
+    static const uint32_t MaxSurfaces = 3;
+
+    D3D12SurfaceBackend();
+    ~D3D12SurfaceBackend();
+
+    void SetContext(const SharedRenderContext& sharedContext, UINT firstRtv);
+
+    bool CreateSurface(uint32_t surface, uint32_t width, uint32_t height, SurfaceMemory& memory) override;
+    bool IsSurfaceReady(uint32_t surface) override;
+    bool RecordSurface(uint32_t surface, uint32_t frameSlot, uint32_t passIndex, ICommandBackend& commands) override;
+    bool Present(uint32_t surface, uint32_t syncInterval) override;
+
+private:
+    static void Release(Surface& surface);
+    static LRESULT CALLBACK SurfaceWindowProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam);
+};
@@ -0,0 +1,284 @@
+#include "DebugDraw.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+// 스레드별로 DebugDraw 인스턴스 -> 자기 청크. 인스턴스는 보통 하나라서 선형 검색이면 된다
+// 스레드가 끝나면 청크를 retired로 표시해서 다른 스레드가 메모리를 물려받게 한다
+struct ThreadChunksCache
+{
+    struct Entry
+    {
+        uint64_t instanceId;
+        shared_ptr<DebugDraw::ThreadChunks> chunks;
+    };
+
+    vector<Entry> entries;
+
+    ~ThreadChunksCache()
+    {
+        for (const auto& entry : entries)
+            entry.chunks->retired.store(true, memory_order_release);
+    }
+};
+
+namespace
+{
+    thread_local ThreadChunksCache threadChunksCache;
+
+    uint32_t ToUnorm8(float value)
+    {
+        return static_cast<uint32_t>(clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
+}
+
+atomic<uint64_t> DebugDraw::nextInstanceId(1);
+
+DebugDraw::DebugDraw(uint32_t maxVerticesPerThread)
+    : instanceId(nextInstanceId++), maxVerticesPerThread(maxVerticesPerThread), stats{}
+{
+}
+
+uint32_t DebugDraw::MakeColor(float r, float g, float b, float a)
+{
+    return ToUnorm8(r) | (ToUnorm8(g) << 8) | (ToUnorm8(b) << 16) | (ToUnorm8(a) << 24);
+}
+
+DebugDraw::ThreadChunks& DebugDraw::GetThreadChunks()
+{
+    for (const auto& entry : threadChunksCache.entries)
+        if (entry.instanceId == instanceId)
+            return *entry.chunks;
+
+    // 이 스레드가 처음 넣을때만 락을 잡는다. 끝난 스레드의 청크가 있으면 메모리째 물려받는다
+    shared_ptr<ThreadChunks> chunks;
+    {
+        lock_guard<mutex> lock(registerMutex);
+        for (const auto& candidate : threadChunks)
+        {
+            if (candidate->retired.load(memory_order_acquire))
+            {
+                candidate->retired.store(false, memory_order_relaxed);
+                chunks = candidate;
+                break;
+            }
+        }
+
+        if (!chunks)
+        {
+            chunks = make_shared<ThreadChunks>();
+            chunks->droppedVertices = 0;
+            chunks->retired = false;
+            threadChunks.push_back(chunks);
+        }
+    }
+
+    threadChunksCache.entries.push_back({ instanceId, chunks });
+    return *chunks;
+}
+
+template<typename T>
+bool DebugDraw::Reserve(ThreadChunks& chunks, vector<T>& vertices, size_t count)
+{
+    // 한 스레드가 너무 많이 넣어도 프레임 비용이 끝없이 늘지 않게 자른다
+    if (vertices.size() + count > maxVerticesPerThread)
+    {
+        chunks.droppedVertices += count;
+        return false;
+    }
+
+    return true;
+}
+
+void DebugDraw::AddLine(float x0, float y0, float z0, float x1, float y1, float z1, uint32_t color, DebugDepth depth)
+{
+    ThreadChunks& chunks = GetThreadChunks();
+    vector<DebugLineVertex>& lines = chunks.lines[depth == DebugDepth::Tested ? 0 : 1];
+    if (!Reserve(chunks, lines, 2))
+        return;
+
+    lines.push_back({ x0, y0, z0, color });
+    lines.push_back({ x1, y1, z1, color });
+}
+
+void DebugDraw::AddBox(const float minCorner[3], const float maxCorner[3], uint32_t color, DebugDepth depth)
+{
+    ThreadChunks& chunks = GetThreadChunks();
+    vector<DebugLineVertex>& lines = chunks.lines[depth == DebugDepth::Tested ? 0 : 1];
+    if (!Reserve(chunks, lines, 24))
+        return;
+
+    // 꼭짓점 인덱스의 비트 0, 1, 2가 각각 x, y, z에서 max 쪽인지
+    auto corner = [&](uint32_t i) -> DebugLineVertex
+    {
+        return { (i & 1) ? maxCorner[0] : minCorner[0], (i & 2) ? maxCorner[1] : minCorner[1], (i & 4) ? maxCorner[2] : minCorner[2], color };
+    };
+
+    static const uint8_t edges[12][2] =
+    {
+        { 0, 1 }, { 2, 3 }, { 4, 5 }, { 6, 7 }, // x 방향
+        { 0, 2 }, { 1, 3 }, { 4, 6 }, { 5, 7 }, // y 방향
+        { 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 }, // z 방향
+    };
+
+    for (const auto& edge : edges)
+    {
+        lines.push_back(corner(edge[0]));
+        lines.push_back(corner(edge[1]));
+    }
+}
+
+void DebugDraw::AddText(float x, float y, string_view text, uint32_t color, float scale)
+{
+    ThreadChunks& chunks = GetThreadChunks();
+    if (!Reserve(chunks, chunks.text, text.size() * 6))
+        return;
+
+    const float width = GlyphWidth * scale;
+    const float height = GlyphHeight * scale;
+
+    float penX = x;
+    float penY = y;
+    for (char c : text)
+    {
+        if (c == '\n')
+        {
+            penX = x;
+            penY += height;
+            continue;
+        }
+
+        if (c < FirstGlyph || c > '~')
+            c = '?';
+
+        if (c != ' ')
+        {
+            uint32_t glyph = static_cast<uint32_t>(c - FirstGlyph);
+            float u = static_cast<float>((glyph % AtlasColumns) * GlyphWidth);
+            float v = static_cast<float>((glyph / AtlasColumns) * GlyphHeight);
+
+            DebugTextVertex topLeft = { penX, penY, u, v, color };
+            DebugTextVertex topRight = { penX + width, penY, u + GlyphWidth, v, color };
+            DebugTextVertex bottomLeft = { penX, penY + height, u, v + GlyphHeight, color };
+            DebugTextVertex bottomRight = { penX + width, penY + height, u + GlyphWidth, v + GlyphHeight, color };
+
+            chunks.text.push_back(topLeft);
+            chunks.text.push_back(topRight);
+            chunks.text.push_back(bottomLeft);
+            chunks.text.push_back(bottomLeft);
+            chunks.text.push_back(topRight);
+            chunks.text.push_back(bottomRight);
+        }
+
+        penX += width;
+    }
+}
+
+void DebugDraw::Flush(IDebugDrawBackend& backend)
+{
+    lock_guard<mutex> lock(registerMutex);
+
+    stats.drawCount = 0;
+    stats.threadCount = 0;
+    stats.droppedVertices = 0;
+
+    for (const auto& chunks : threadChunks)
+    {
+        if (!chunks->retired.load(memory_order_acquire))
+            stats.threadCount++;
+
+        stats.droppedVertices += chunks->droppedVertices;
+        chunks->droppedVertices = 0;
+    }
+
+    // 스트림마다 모든 스레드의 청크를 한 덩어리로 이어 붙인다
+    auto flushStream = [&](DebugDrawStream stream, auto getVertices)
+    {
+        using Vertex = typename remove_reference_t<decltype(getVertices(*threadChunks.front()))>::value_type;
+
+        size_t vertexCount = 0;
+        for (const auto& chunks : threadChunks)
+            vertexCount += getVertices(*chunks).size();
+
+        uint32_t streamIndex = static_cast<uint32_t>(stream);
+        stats.vertexCounts[streamIndex] = 0;
+        if (vertexCount == 0)
+            return;
+
+        Vertex* dest = static_cast<Vertex*>(backend.AllocateUpload(stream, vertexCount * sizeof(Vertex)));
+        if (!dest)
+        {
+            stats.droppedVertices += vertexCount;
+        }
+        else
+        {
+            Vertex* cursor = dest;
+            for (const auto& chunks : threadChunks)
+            {
+                const auto& vertices = getVertices(*chunks);
+                memcpy(cursor, vertices.data(), vertices.size() * sizeof(Vertex));
+                cursor += vertices.size();
+            }
+
+            backend.Draw(stream, static_cast<uint32_t>(vertexCount));
+            stats.vertexCounts[streamIndex] = static_cast<uint32_t>(vertexCount);
+            stats.drawCount++;
+        }
+
+        // 메모리는 다음 프레임에 다시 쓴다
+        for (const auto& chunks : threadChunks)
+            getVertices(*chunks).clear();
+    };
+
+    if (threadChunks.empty())
+    {
+        fill(begin(stats.vertexCounts), end(stats.vertexCounts), 0u);
+        return;
+    }
+
+    flushStream(DebugDrawStream::DepthLines, [](ThreadChunks& chunks) -> vector<DebugLineVertex>& { return chunks.lines[0]; });
+    flushStream(DebugDrawStream::OverlayLines, [](ThreadChunks& chunks) -> vector<DebugLineVertex>& { return chunks.lines[1]; });
+    flushStream(DebugDrawStream::Text, [](ThreadChunks& chunks) -> vector<DebugTextVertex>& { return chunks.text; });
+}
+
+void DebugDraw::Clear()
+{
+    lock_guard<mutex> lock(registerMutex);
+    for (const auto& chunks : threadChunks)
+    {
+        chunks->lines[0].clear();
+        chunks->lines[1].clear();
+        chunks->text.clear();
+    }
+}
+
+NullDebugDrawBackend::NullDebugDrawBackend(size_t uploadSize)
+    : upload(uploadSize), uploadOffset(0), streamData{}, streamVertexCounts{}, drawCount(0)
+{
+}
+
+void NullDebugDrawBackend::BeginFrame()
+{
+    uploadOffset = 0;
+    fill(begin(streamData), end(streamData), nullptr);
+    fill(begin(streamVertexCounts), end(streamVertexCounts), 0u);
+}
+
+void* NullDebugDrawBackend::AllocateUpload(DebugDrawStream stream, size_t size)
+{
+    // DebugDrawRenderer처럼 16바이트씩 맞춰서 잘라준다
+    size_t offset = (uploadOffset + 15) & ~size_t(15);
+    if (offset + size > upload.size())
+        return nullptr;
+
+    uploadOffset = offset + size;
+    streamData[static_cast<uint32_t>(stream)] = upload.data() + offset;
+    return upload.data() + offset;
+}
+
+void NullDebugDrawBackend::Draw(DebugDrawStream stream, uint32_t vertexCount)
+{
+    streamVertexCounts[static_cast<uint32_t>(stream)] = vertexCount;
+    drawCount++;
+}
@@ -0,0 +1,152 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+// debugdraw.hlsl의 입력 레이아웃과 맞아야 한다
+struct DebugLineVertex
+{
+    float x, y, z;
+    uint32_t color; // R8G8B8A8_UNORM (0xAABBGGRR)
+};
+
+struct DebugTextVertex
+{
+    float x, y; // 픽셀 좌표, 왼쪽 위가 원점
+    float u, v; // 글리프 아틀라스 텍셀 좌표
+    uint32_t color;
+};
+
+// 스트림 하나가 드로우 하나다
+enum class DebugDrawStream : uint32_t
+{
+    DepthLines,   // 깊이 테스트를 하는 선
+    OverlayLines, // 항상 위에 그리는 선
+    Text,         // 글리프 아틀라스로 그리는 글자. 항상 위에 그린다
+    Count
+};
+
+constexpr uint32_t DebugDrawStreamCount = static_cast<uint32_t>(DebugDrawStream::Count);
+
+enum class DebugDepth
+{
+    Tested,
+    Overlay,
+};
+
+// 모은 버텍스를 실제로 올리고 그리는 쪽. D3D12에서는 DebugDrawRenderer가 구현하고,
+// D3D12가 없는 환경에서는 메모리만 잡는 가짜 백엔드를 붙여서 CPU 비용을 잴 수 있다
+class IDebugDrawBackend
+{
+public:
+    virtual ~IDebugDrawBackend() = default;
+
+    // 이번 프레임 업로드 메모리에서 size 바이트를 받는다. 모자라면 nullptr
+    virtual void* AllocateUpload(DebugDrawStream stream, size_t size) = 0;
+    virtual void Draw(DebugDrawStream stream, uint32_t vertexCount) = 0;
+};
+
+struct DebugDrawStats
+{
+    uint32_t vertexCounts[DebugDrawStreamCount]; // 마지막 Flush에서 그린 버텍스
+    uint32_t drawCount;
+    uint32_t threadCount; // 청크를 가진 스레드
+    uint64_t droppedVertices; // 마지막 Flush에서 버린 버텍스. 스레드별 상한이나 업로드 메모리가 모자랐던 것
+};
+
+// 즉시 모드 디버그 그리기. 아무 스레드에서나 선, 박스, 글자를 넣을 수 있다
+// 스레드마다 자기 버텍스 청크에 락 없이 쌓고, Flush에서 스트림별로 업로드 메모리에 이어 붙여 드로우 한번으로 그린다
+// Flush는 그 프레임에 넣는 스레드들이 다 끝난 뒤에 불러야 한다 (프레임 경계에서 작업을 join한 뒤)
+class DebugDraw
+{
+public:
+    // 글리프 아틀라스는 ASCII 32~127을 16 x 6 칸에 고정 폭으로 담는다
+    static const uint32_t GlyphWidth = 8;
+    static const uint32_t GlyphHeight = 16;
+    static const uint32_t AtlasColumns = 16;
+    static const uint32_t AtlasRows = 6;
+    static const uint32_t AtlasWidth = GlyphWidth * AtlasColumns;
+    static const uint32_t AtlasHeight = GlyphHeight * AtlasRows;
+    static const char FirstGlyph = ' ';
+
+    // 스레드 하나가 한 프레임에 스트림별로 넣을 수 있는 버텍스 상한. 넘으면 버린다
+    static const uint32_t DefaultMaxVerticesPerThread = 1 << 21;
+
+private:
+    struct ThreadChunks
+    {
+        std::vector<DebugLineVertex> lines[2]; // DepthLines, OverlayLines
+        std::vector<DebugTextVertex> text;
+        uint64_t droppedVertices;
+        std::atomic<bool> retired; // 주인 스레드가 끝났다. 남은 버텍스는 그대로 그리고 다른 스레드가 이어 쓴다
+    };
+
+    friend struct ThreadChunksCache;
+
+    static std::atomic<uint64_t> nextInstanceId;
+
+    uint64_t instanceId; // thread_local 캐시가 다른(또는 같은 주소에 새로 만든) 인스턴스와 섞이지 않게 한다
+    uint32_t maxVerticesPerThread;
+
+    std::mutex registerMutex; // 스레드가 처음 넣을때와 Flush에서만 잡는다
+    std::vector<std::shared_ptr<ThreadChunks>> threadChunks; // 스레드가 끝나도 thread_local 쪽과 같이 살아있어야 한다
+    DebugDrawStats stats;
+
+public:
+    explicit DebugDraw(uint32_t maxVerticesPerThread = DefaultMaxVerticesPerThread);
+
+    DebugDraw(const DebugDraw&) = delete;
+    DebugDraw& operator=(const DebugDraw&) = delete;
+
+    static uint32_t MakeColor(float r, float g, float b, float a = 1.0f);
+
+    void AddLine(float x0, float y0, float z0, float x1, float y1, float z1, uint32_t color, DebugDepth depth = DebugDepth::Tested);
+    void AddBox(const float minCorner[3], const float maxCorner[3], uint32_t color, DebugDepth depth = DebugDepth::Tested);
+
+    // (x, y)는 글자 왼쪽 위의 픽셀 좌표. '\n'에서 줄을 바꾸고 아틀라스에 없는 글자는 '?'로 그린다
+    void AddText(float x, float y, std::string_view text, uint32_t color, float scale = 1.0f);
+
+    // 모든 스레드의 청크를 스트림별로 업로드 메모리에 모으고 스트림마다 한번씩 그린다. 청크는 비우지만 메모리는 남겨둔다
+    void Flush(IDebugDrawBackend& backend);
+
+    // Flush하지 않고 버린다
+    void Clear();
+
+    const DebugDrawStats& GetStats() const { return stats; }
+
+private:
+    ThreadChunks& GetThreadChunks();
+
+    template<typename T>
+    bool Reserve(ThreadChunks& chunks, std::vector<T>& vertices, size_t count);
+};
+
+// GPU 없이 DebugDraw를 돌리는 백엔드. 업로드 메모리를 CPU 메모리 한 덩어리로 흉내 내고 드로우는 세기만 한다
+// 마지막으로 그린 스트림 데이터를 남겨두므로 Flush가 이어 붙인 버텍스를 그대로 확인할 수 있다
+class NullDebugDrawBackend : public IDebugDrawBackend
+{
+    std::vector<uint8_t> upload;
+    size_t uploadOffset;
+    const void* streamData[DebugDrawStreamCount];
+    uint32_t streamVertexCounts[DebugDrawStreamCount];
+    uint64_t drawCount;
+
+public:
+    explicit NullDebugDrawBackend(size_t uploadSize);
+
+    // 다음 프레임을 업로드 메모리 처음부터 채운다. 남겨둔 스트림 데이터는 여기서 무효가 된다
+    void BeginFrame();
+
+    uint64_t GetDrawCount() const { return drawCount; }
+    size_t GetUploadedBytes() const { return uploadOffset; }
+
+    // 이번 프레임에 stream을 그린 데이터와 버텍스 수. 그리지 않았으면 nullptr, 0
+    const void* GetStreamData(DebugDrawStream stream) const { return streamData[static_cast<uint32_t>(stream)]; }
+    uint32_t GetStreamVertexCount(DebugDrawStream stream) const { return streamVertexCounts[static_cast<uint32_t>(stream)]; }
+
+    void* AllocateUpload(DebugDrawStream stream, size_t size) override;
+    void Draw(DebugDrawStream stream, uint32_t vertexCount) override;
+};
@@ -0,0 +1,282 @@
+#include "DebugDrawRenderer.h"
+#include <directx/d3dx12.h>
+
+using namespace winrt;
+using namespace std;
+
+namespace
+{
+    const DXGI_FORMAT DepthFormat = DXGI_FORMAT_D32_FLOAT;
+
+    // 고정 폭 글꼴로 ASCII 32~127을 아틀라스 칸마다 그리고 커버리지만 뽑는다
+    bool RasterizeGlyphAtlas(vector<uint8_t>& coverage)
+    {
+        HDC dc = CreateCompatibleDC(nullptr);
+        if (!dc)
+            return false;
+
+        BITMAPINFO bitmapInfo = {};
+        bitmapInfo.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+        bitmapInfo.bmiHeader.biWidth = DebugDraw::AtlasWidth;
+        bitmapInfo.bmiHeader.biHeight = -static_cast<LONG>(DebugDraw::AtlasHeight); // 위에서 아래로
+        bitmapInfo.bmiHeader.biPlanes = 1;
+        bitmapInfo.bmiHeader.biBitCount = 32;
+        bitmapInfo.bmiHeader.biCompression = BI_RGB;
+
+        void* bits = nullptr;
+        HBITMAP bitmap = CreateDIBSection(dc, &bitmapInfo, DIB_RGB_COLORS, &bits, nullptr, 0);
+        HFONT font = CreateFont(DebugDraw::GlyphHeight, DebugDraw::GlyphWidth, 0, 0, FW_NORMAL, FALSE, FALSE, FALSE,
+            ANSI_CHARSET, OUT_DEFAULT_PRECIS, CLIP_DEFAULT_PRECIS, ANTIALIASED_QUALITY, FIXED_PITCH | FF_MODERN, L"Consolas");
+
+        bool succeeded = bitmap && font;
+        if (succeeded)
+        {
+            HGDIOBJ oldBitmap = SelectObject(dc, bitmap);
+            HGDIOBJ oldFont = SelectObject(dc, font);
+            SetTextColor(dc, RGB(255, 255, 255));
+            SetBkColor(dc, RGB(0, 0, 0));
+            SetBkMode(dc, OPAQUE);
+
+            for (char c = DebugDraw::FirstGlyph; c <= '~'; c++)
+            {
+                uint32_t glyph = static_cast<uint32_t>(c - DebugDraw::FirstGlyph);
+                TextOutA(dc, (glyph % DebugDraw::AtlasColumns) * DebugDraw::GlyphWidth, (glyph / DebugDraw::AtlasColumns) * DebugDraw::GlyphHeight, &c, 1);
+            }
+            GdiFlush();
+
+            // 흰 글자를 그렸으므로 아무 채널이나 커버리지다
+            const uint32_t* pixels = static_cast<const uint32_t*>(bits);
+            coverage.resize(DebugDraw::AtlasWidth * DebugDraw::AtlasHeight);
+            for (size_t i = 0; i < coverage.size(); i++)
+                coverage[i] = static_cast<uint8_t>(pixels[i] & 0xFF);
+
+            SelectObject(dc, oldFont);
+            SelectObject(dc, oldBitmap);
+        }
+
+        if (font)
+            DeleteObject(font);
+        if (bitmap)
+            DeleteObject(bitmap);
+        DeleteDC(dc);
+        return succeeded;
+    }
+}
+
+DebugDrawRenderer::DebugDrawRenderer()
+    : uploadBegin(nullptr), uploadSize(0), uploadOffset(0), uploadEnd(0), streamViews{}, drawConstants{}, recordingCommandList(nullptr)
+{
+    static const float identity[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+    SetViewProjection(identity);
+}
+
+bool DebugDrawRenderer::Init(ID3D12Device* device, const Shaders& shaders, DXGI_FORMAT renderTargetFormat, UINT width, UINT height, UINT frameCount, UINT64 uploadSize)
+{
+    drawConstants.viewportSize[0] = static_cast<float>(width);
+    drawConstants.viewportSize[1] = static_cast<float>(height);
+
+    if (!CreatePipelineStates(device, shaders, renderTargetFormat))
+        return false;
+
+    if (!CreateGlyphAtlas(device))
+        return false;
+
+    if (!CreateDepthBuffer(device, width, height))
+        return false;
+
+    // 모든 스트림이 같이 쓰는 업로드 메모리. 계속 Map해둔다
+    this->uploadSize = uploadSize;
+    if (FAILED(device->CreateCommittedResource(
+        &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+        D3D12_HEAP_FLAG_NONE,
+        &CD3DX12_RESOURCE_DESC::Buffer(uploadSize * frameCount),
+        D3D12_RESOURCE_STATE_GENERIC_READ,
+        nullptr,
+        IID_PPV_ARGS(&uploadBuffer))))
+        return false;
+
+    CD3DX12_RANGE readRange(0, 0);
+    if (FAILED(uploadBuffer->Map(0, &readRange, reinterpret_cast<void**>(&uploadBegin))))
+        return false;
+
+    return true;
+}
+
+bool DebugDrawRenderer::CreatePipelineStates(ID3D12Device* device, const Shaders& shaders, DXGI_FORMAT renderTargetFormat)
+{
+    CD3DX12_ROOT_PARAMETER rootParameters[RootParameterCount];
+    rootParameters[DrawConstantsParameter].InitAsConstants(sizeof(DrawConstants) / 4, /*shaderRegister*/ 0, 0, D3D12_SHADER_VISIBILITY_VERTEX);
+    rootParameters[GlyphAtlasParameter].InitAsShaderResourceView(0, 0, D3D12_SHADER_VISIBILITY_PIXEL);
+
+    CD3DX12_ROOT_SIGNATURE_DESC rootSignatureDesc;
+    rootSignatureDesc.Init(_countof(rootParameters), rootParameters, /*numStaticSamplers*/ 0, /*pStaticSamplers*/ nullptr, D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
+
+    com_ptr<ID3DBlob> signature;
+    com_ptr<ID3DBlob> error;
+    if (FAILED(D3D12SerializeRootSignature(&rootSignatureDesc, D3D_ROOT_SIGNATURE_VERSION_1, signature.put(), error.put())))
+        return false;
+
+    if (FAILED(device->CreateRootSignature(/*nodeMask*/0, signature->GetBufferPointer(), signature->GetBufferSize(), IID_PPV_ARGS(&rootSignature))))
+        return false;
+
+    // DebugLineVertex, DebugTextVertex와 맞아야 한다
+    D3D12_INPUT_ELEMENT_DESC lineElements[] =
+    {
+        { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+        { "COLOR", 0, DXGI_FORMAT_R8G8B8A8_UNORM, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+    };
+
+    D3D12_INPUT_ELEMENT_DESC textElements[] =
+    {
+        { "POSITION", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+        { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 8, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+        { "COLOR", 0, DXGI_FORMAT_R8G8B8A8_UNORM, 0, 16, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+    };
+
+    // 세 스트림 모두 깊이 버퍼가 묶인 상태에서 그리므로 DSVFormat은 같게 둔다
+    D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
+    psoDesc.pRootSignature = rootSignature.get();
+    psoDesc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
+    psoDesc.RasterizerState.CullMode = D3D12_CULL_MODE_NONE;
+    psoDesc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
+    psoDesc.DepthStencilState = CD3DX12_DEPTH_STENCIL_DESC(D3D12_DEFAULT);
+    psoDesc.SampleMask = UINT_MAX;
+    psoDesc.NumRenderTargets = 1;
+    psoDesc.RTVFormats[0] = renderTargetFormat;
+    psoDesc.DSVFormat = DepthFormat;
+    psoDesc.SampleDesc.Count = 1;
+
+    // 1. 깊이 테스트하는 선
+    psoDesc.InputLayout = { lineElements, _countof(lineElements) };
+    psoDesc.VS = CD3DX12_SHADER_BYTECODE(shaders.lineVertex.data(), shaders.lineVertex.size());
+    psoDesc.PS = CD3DX12_SHADER_BYTECODE(shaders.linePixel.data(), shaders.linePixel.size());
+    psoDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_LINE;
+    psoDesc.DepthStencilState.DepthFunc = D3D12_COMPARISON_FUNC_LESS_EQUAL;
+    if (FAILED(device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(pipelineStates[static_cast<uint32_t>(DebugDrawStream::DepthLines)].put()))))
+        return false;
+
+    // 2. 항상 위에 그리는 선
+    psoDesc.DepthStencilState.DepthEnable = FALSE;
+    if (FAILED(device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(pipelineStates[static_cast<uint32_t>(DebugDrawStream::OverlayLines)].put()))))
+        return false;
+
+    // 3. 글자. 커버리지를 알파로 섞는다
+    psoDesc.InputLayout = { textElements, _countof(textElements) };
+    psoDesc.VS = CD3DX12_SHADER_BYTECODE(shaders.textVertex.data(), shaders.textVertex.size());
+    psoDesc.PS = CD3DX12_SHADER_BYTECODE(shaders.textPixel.data(), shaders.textPixel.size());
+    psoDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+
+    D3D12_RENDER_TARGET_BLEND_DESC& blend = psoDesc.BlendState.RenderTarget[0];
+    blend.BlendEnable = TRUE;
+    blend.SrcBlend = D3D12_BLEND_SRC_ALPHA;
+    blend.DestBlend = D3D12_BLEND_INV_SRC_ALPHA;
+    blend.BlendOp = D3D12_BLEND_OP_ADD;
+    blend.SrcBlendAlpha = D3D12_BLEND_ONE;
+    blend.DestBlendAlpha = D3D12_BLEND_INV_SRC_ALPHA;
+    blend.BlendOpAlpha = D3D12_BLEND_OP_ADD;
+    if (FAILED(device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(pipelineStates[static_cast<uint32_t>(DebugDrawStream::Text)].put()))))
+        return false;
+
+    return true;
+}
+
+bool DebugDrawRenderer::CreateGlyphAtlas(ID3D12Device* device)
+{
+    vector<uint8_t> coverage;
+    if (!RasterizeGlyphAtlas(coverage))
+        return false;
+
+    // 12KB뿐이라 업로드 힙에 두고 셰이더가 바로 읽는다
+    if (FAILED(device->CreateCommittedResource(
+        &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+        D3D12_HEAP_FLAG_NONE,
+        &CD3DX12_RESOURCE_DESC::Buffer(coverage.size()),
+        D3D12_RESOURCE_STATE_GENERIC_READ,
+        nullptr,
+        IID_PPV_ARGS(&glyphAtlas))))
+        return false;
+
+    UINT8* data;
+    CD3DX12_RANGE readRange(0, 0);
+    if (FAILED(glyphAtlas->Map(0, &readRange, reinterpret_cast<void**>(&data))))
+        return false;
+
+    memcpy(data, coverage.data(), coverage.size());
+    glyphAtlas->Unmap(0, nullptr);
+    return true;
+}
+
+bool DebugDrawRenderer::CreateDepthBuffer(ID3D12Device* device, UINT width, UINT height)
+{
+    D3D12_DESCRIPTOR_HEAP_DESC dsvHeapDesc = {};
+    dsvHeapDesc.NumDescriptors = 1;
+    dsvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_DSV;
+    dsvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+    if (FAILED(device->CreateDescriptorHeap(&dsvHeapDesc, IID_PPV_ARGS(&dsvHeap))))
+        return false;
+
+    D3D12_CLEAR_VALUE clearValue = {};
+    clearValue.Format = DepthFormat;
+    clearValue.DepthStencil.Depth = 1.0f;
+
+    if (FAILED(device->CreateCommittedResource(
+        &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+        D3D12_HEAP_FLAG_NONE,
+        &CD3DX12_RESOURCE_DESC::Tex2D(DepthFormat, width, height, 1, 1, 1, 0, D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL),
+        D3D12_RESOURCE_STATE_DEPTH_WRITE,
+        &clearValue,
+        IID_PPV_ARGS(&depthBuffer))))
+        return false;
+
+    device->CreateDepthStencilView(depthBuffer.get(), nullptr, dsvHeap->GetCPUDescriptorHandleForHeapStart());
+    return true;
+}
+
+void DebugDrawRenderer::SetViewProjection(const float viewProjection[16])
+{
+    memcpy(drawConstants.viewProjection, viewProjection, sizeof(drawConstants.viewProjection));
+}
+
+void DebugDrawRenderer::Record(ID3D12GraphicsCommandList* commandList, D3D12_CPU_DESCRIPTOR_HANDLE renderTarget, DebugDraw& debugDraw, UINT frameSlot)
+{
+    D3D12_CPU_DESCRIPTOR_HANDLE dsvHandle = dsvHeap->GetCPUDescriptorHandleForHeapStart();
+    commandList->ClearDepthStencilView(dsvHandle, D3D12_CLEAR_FLAG_DEPTH, 1.0f, 0, 0, nullptr);
+    commandList->OMSetRenderTargets(1, &renderTarget, FALSE, &dsvHandle);
+
+    commandList->SetGraphicsRootSignature(rootSignature.get());
+    commandList->SetGraphicsRoot32BitConstants(DrawConstantsParameter, sizeof(DrawConstants) / 4, &drawConstants, 0);
+    commandList->SetGraphicsRootShaderResourceView(GlyphAtlasParameter, glyphAtlas->GetGPUVirtualAddress());
+
+    // Flush가 스트림마다 AllocateUpload, Draw를 부른다
+    uploadOffset = frameSlot * uploadSize;
+    uploadEnd = uploadOffset + uploadSize;
+    recordingCommandList = commandList;
+    debugDraw.Flush(*this);
+    recordingCommandList = nullptr;
+}
+
+void* DebugDrawRenderer::AllocateUpload(DebugDrawStream stream, size_t size)
+{
+    UINT64 offset = (uploadOffset + 15) & ~15ull;
+    if (offset + size > uploadEnd)
+        return nullptr;
+
+    uploadOffset = offset + size;
+
+    D3D12_VERTEX_BUFFER_VIEW& view = streamViews[static_cast<uint32_t>(stream)];
+    view.BufferLocation = uploadBuffer->GetGPUVirtualAddress() + offset;
+    view.SizeInBytes = static_cast<UINT>(size);
+    view.StrideInBytes = stream == DebugDrawStream::Text ? sizeof(DebugTextVertex) : sizeof(DebugLineVertex);
+
+    return uploadBegin + offset;
+}
+
+void DebugDrawRenderer::Draw(DebugDrawStream stream, uint32_t vertexCount)
+{
+    uint32_t streamIndex = static_cast<uint32_t>(stream);
+
+    recordingCommandList->SetPipelineState(pipelineStates[streamIndex].get());
+    recordingCommandList->IASetPrimitiveTopology(stream == DebugDrawStream::Text ? D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST : D3D_PRIMITIVE_TOPOLOGY_LINELIST);
+    recordingCommandList->IASetVertexBuffers(0, 1, &streamViews[streamIndex]);
+    recordingCommandList->DrawInstanced(vertexCount, 1, 0, 0);
+}
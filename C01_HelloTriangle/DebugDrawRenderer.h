@@ -0,0 +1,79 @@
+#pragma once
+#include <Windows.h>
+#include <winrt/base.h>
+#include <directx/d3d12.h>
+#include <vector>
+#include "DebugDraw.h"
+
+// DebugDraw를 D3D12로 그린다. 스트림마다 PSO 하나, 드로우 하나다
+// 버텍스는 업로드 힙 하나에 이어 붙이고, 글리프 아틀라스는 GDI로 고정 폭 글꼴을 그려서 만든다
+class DebugDrawRenderer : public IDebugDrawBackend
+{
+public:
+    static const UINT64 DefaultUploadSize = 32 * 1024 * 1024; // 프레임 슬롯 하나 몫
+
+    struct Shaders
+    {
+        std::vector<uint8_t> lineVertex;
+        std::vector<uint8_t> linePixel;
+        std::vector<uint8_t> textVertex;
+        std::vector<uint8_t> textPixel;
+    };
+
+    // debugdraw.hlsl의 DrawConstants와 맞아야 한다
+    struct DrawConstants
+    {
+        float viewProjection[16]; // row major
+        float viewportSize[2];
+        float padding[2];
+    };
+
+private:
+    enum RootParameter
+    {
+        DrawConstantsParameter,
+        GlyphAtlasParameter,
+        RootParameterCount,
+    };
+
+    winrt::com_ptr<ID3D12RootSignature> rootSignature;
+    winrt::com_ptr<ID3D12PipelineState> pipelineStates[DebugDrawStreamCount];
+
+    // 프레임 슬롯마다 uploadSize씩 나눠 쓰고, 그 슬롯 차례가 오면 처음부터 다시 채운다
+    // 앞 프레임이 아직 GPU에서 읽고 있어도 다른 슬롯이라 겹치지 않는다
+    winrt::com_ptr<ID3D12Resource> uploadBuffer;
+    UINT8* uploadBegin;
+    UINT64 uploadSize;
+    UINT64 uploadOffset;
+    UINT64 uploadEnd;
+    D3D12_VERTEX_BUFFER_VIEW streamViews[DebugDrawStreamCount];
+
+    winrt::com_ptr<ID3D12Resource> glyphAtlas;
+
+    // 깊이 테스트하는 선끼리만 쓰는 깊이 버퍼
+    winrt::com_ptr<ID3D12Resource> depthBuffer;
+    winrt::com_ptr<ID3D12DescriptorHeap> dsvHeap;
+
+    DrawConstants drawConstants;
+    ID3D12GraphicsCommandList* recordingCommandList; // Record 중에만 유효하다
+
+public:
+    DebugDrawRenderer();
+
+    bool Init(ID3D12Device* device, const Shaders& shaders, DXGI_FORMAT renderTargetFormat, UINT width, UINT height, UINT frameCount, UINT64 uploadSize = DefaultUploadSize);
+
+    // 선을 변환할 행렬. 기본은 단위 행렬이라 선 좌표가 그대로 클립 좌표다
+    void SetViewProjection(const float viewProjection[16]);
+
+    // 렌더 타겟에 이번 프레임 debugDraw 내용을 그린다. root signature, PSO, 렌더 타겟 설정을 바꾼다
+    // frameSlot의 이전 프레임은 GPU에서 끝나 있어야 한다
+    void Record(ID3D12GraphicsCommandList* commandList, D3D12_CPU_DESCRIPTOR_HANDLE renderTarget, DebugDraw& debugDraw, UINT frameSlot);
+
+    void* AllocateUpload(DebugDrawStream stream, size_t size) override;
+    void Draw(DebugDrawStream stream, uint32_t vertexCount) override;
+
+private:
+    bool CreatePipelineStates(ID3D12Device* device, const Shaders& shaders, DXGI_FORMAT renderTargetFormat);
+    bool CreateGlyphAtlas(ID3D12Device* device);
+    bool CreateDepthBuffer(ID3D12Device* device, UINT width, UINT height);
+};
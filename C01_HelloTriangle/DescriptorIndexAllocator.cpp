@@ -0,0 +1,61 @@
+#include "DescriptorIndexAllocator.h"
+#include <algorithm>
+
+using namespace std;
+
+DescriptorIndexAllocator::DescriptorIndexAllocator(uint32_t capacity)
+    : capacity(capacity), nextUnusedIndex(0)
+{
+}
+
+void DescriptorIndexAllocator::Reset(uint32_t capacity)
+{
+    this->capacity = capacity;
+    nextUnusedIndex = 0;
+    freeIndices.clear();
+    retiredIndices.clear();
+}
+
+uint32_t DescriptorIndexAllocator::Allocate()
+{
+    if (!freeIndices.empty())
+    {
+        uint32_t index = freeIndices.back();
+        freeIndices.pop_back();
+        return index;
+    }
+
+    if (nextUnusedIndex < capacity)
+        return nextUnusedIndex++;
+
+    return InvalidIndex;
+}
+
+void DescriptorIndexAllocator::Free(uint32_t index, uint64_t fenceValue)
+{
+    // 보통은 fence 값이 커지는 순서로 들어오므로 뒤에 붙인다
+    if (retiredIndices.empty() || retiredIndices.back().fenceValue <= fenceValue)
+    {
+        retiredIndices.push_back({ index, fenceValue });
+        return;
+    }
+
+    // 더 작은 값이 늦게 오면 자리를 찾아 넣는다. 그래야 Reclaim이 앞에서부터만 보고 멈출 수 있다
+    auto position = upper_bound(retiredIndices.begin(), retiredIndices.end(), fenceValue,
+        [](uint64_t value, const RetiredIndex& retired) { return value < retired.fenceValue; });
+    retiredIndices.insert(position, { index, fenceValue });
+}
+
+void DescriptorIndexAllocator::Reclaim(uint64_t completedFenceValue)
+{
+    while (!retiredIndices.empty() && retiredIndices.front().fenceValue <= completedFenceValue)
+    {
+        freeIndices.push_back(retiredIndices.front().index);
+        retiredIndices.pop_front();
+    }
+}
+
+uint32_t DescriptorIndexAllocator::GetAllocatedCount() const
+{
+    return nextUnusedIndex - static_cast<uint32_t>(freeIndices.size() + retiredIndices.size());
+}
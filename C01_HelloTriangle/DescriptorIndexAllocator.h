@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+// bindless 힙의 슬롯 번호를 나눠준다
+// 한번 받은 인덱스는 Free할때까지 바뀌지 않으므로 셰이더에 그대로 넘길 수 있다
+// Free된 인덱스는 GPU가 아직 읽고 있을 수 있으니 fence가 지난 다음에 재사용한다
+class DescriptorIndexAllocator
+{
+    struct RetiredIndex
+    {
+        uint32_t index;
+        uint64_t fenceValue;
+    };
+
+    uint32_t capacity;
+    uint32_t nextUnusedIndex;
+    std::vector<uint32_t> freeIndices;
+    std::deque<RetiredIndex> retiredIndices; // fenceValue 오름차순
+
+public:
+    static const uint32_t InvalidIndex = UINT32_MAX;
+
+    explicit DescriptorIndexAllocator(uint32_t capacity = 0);
+
+    void Reset(uint32_t capacity);
+
+    // 남은 슬롯이 없으면 InvalidIndex
+    uint32_t Allocate();
+
+    // fenceValue는 이 인덱스를 마지막으로 쓰는 제출의 fence 값. 모든 Free와 Reclaim이 같은 큐 타임라인 값을 써야 한다
+    // 순서대로 오지 않아도 된다
+    void Free(uint32_t index, uint64_t fenceValue);
+
+    // completedFenceValue까지 끝난 인덱스를 다시 쓸 수 있게 한다
+    void Reclaim(uint64_t completedFenceValue);
+
+    uint32_t GetCapacity() const { return capacity; }
+    uint32_t GetAllocatedCount() const;
+};
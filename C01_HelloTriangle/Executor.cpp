@@ -0,0 +1,80 @@
+#include "Executor.h"
+#include "FrameArena.h"
+#include <algorithm>
+
+using namespace std;
+
+Executor::Executor(uint32_t threadCount)
+    : readyHead(0), readyCount(0), stopping(false)
+{
+    if (threadCount == 0)
+        threadCount = max(1u, thread::hardware_concurrency());
+
+    threads.reserve(threadCount);
+    for (uint32_t i = 0; i < threadCount; i++)
+        threads.emplace_back([this] { Run(); });
+}
+
+Executor::~Executor()
+{
+    {
+        lock_guard<mutex> lock(queueMutex);
+        stopping = true;
+    }
+    cv.notify_all();
+
+    for (auto& t : threads)
+        t.join();
+}
+
+void Executor::Post(coroutine_handle<> handle)
+{
+    {
+        lock_guard<mutex> lock(queueMutex);
+        if (readyCount == readyQueue.size())
+            GrowReadyQueue();
+
+        readyQueue[(readyHead + readyCount) % readyQueue.size()] = handle;
+        readyCount++;
+    }
+    cv.notify_one();
+}
+
+void Executor::GrowReadyQueue()
+{
+    // 꽉 찼을때만 두 배로 늘린다. 한 번 늘고 나면 매 프레임 태스크를 넣고 빼도 힙을 건드리지 않는다
+    vector<coroutine_handle<>> grown(max<size_t>(64, readyQueue.size() * 2));
+    for (size_t i = 0; i < readyCount; i++)
+        grown[i] = readyQueue[(readyHead + i) % readyQueue.size()];
+
+    readyQueue.swap(grown);
+    readyHead = 0;
+}
+
+void Executor::Run()
+{
+    // 이 스레드의 임시 메모리 블록을 미리 받아둔다. 처음 일을 받은 프레임에 힙 할당이 생기지 않게 한다
+    {
+        ScratchScope scratch;
+        scratch.GetArena().Allocate(1);
+    }
+
+    for (;;)
+    {
+        coroutine_handle<> handle;
+        {
+            unique_lock<mutex> lock(queueMutex);
+            cv.wait(lock, [this] { return stopping || readyCount > 0; });
+
+            // 남은 코루틴은 다 실행하고 끝낸다
+            if (readyCount == 0)
+                return;
+
+            handle = readyQueue[readyHead];
+            readyHead = (readyHead + 1) % readyQueue.size();
+            readyCount--;
+        }
+
+        handle.resume();
+    }
+}
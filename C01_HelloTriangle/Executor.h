@@ -0,0 +1,46 @@
+#pragma once
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 코루틴을 이어서 실행하는 워커 스레드 풀
+// fence나 파일 읽기를 기다리는 동안에는 스레드를 잡고 있지 않고, 완료되면 여기로 다시 넘어온다
+class Executor
+{
+    std::vector<std::thread> threads;
+    std::mutex queueMutex;
+    std::condition_variable cv;
+    std::vector<std::coroutine_handle<>> readyQueue; // readyHead부터 readyCount개가 차례로 들어 있는 원형 버퍼
+    size_t readyHead;
+    size_t readyCount;
+    bool stopping;
+
+public:
+    // threadCount가 0이면 코어 수만큼 만든다
+    explicit Executor(uint32_t threadCount = 0);
+    ~Executor();
+
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    void Post(std::coroutine_handle<> handle);
+
+    struct ScheduleAwaiter
+    {
+        Executor& executor;
+
+        bool await_ready() noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) { executor.Post(handle); }
+        void await_resume() noexcept {}
+    };
+
+    // co_await executor.Schedule(); 이후의 코드는 워커 스레드에서 실행된다
+    ScheduleAwaiter Schedule() { return ScheduleAwaiter{ *this }; }
+
+private:
+    void GrowReadyQueue();
+    void Run();
+};
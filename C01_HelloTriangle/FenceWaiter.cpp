@@ -0,0 +1,143 @@
+#include "FenceWaiter.h"
+
+using namespace std;
+
+#if defined(_WIN32)
+
+WakeEvent::WakeEvent()
+{
+    handle = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+}
+
+WakeEvent::~WakeEvent()
+{
+    CloseHandle(handle);
+}
+
+void WakeEvent::Set()
+{
+    SetEvent(handle);
+}
+
+void WakeEvent::Wait()
+{
+    WaitForSingleObject(handle, INFINITE);
+}
+
+#else
+
+WakeEvent::WakeEvent()
+    : signaled(false)
+{
+}
+
+WakeEvent::~WakeEvent()
+{
+}
+
+void WakeEvent::Set()
+{
+    {
+        lock_guard<std::mutex> lock(mutex);
+        signaled = true;
+    }
+    cv.notify_one();
+}
+
+void WakeEvent::Wait()
+{
+    unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [this] { return signaled; });
+    signaled = false;
+}
+
+#endif
+
+FenceWaiter::FenceWaiter(Executor& executor)
+    : executor(executor), stopping(false)
+{
+    thread = std::thread([this] { Run(); });
+}
+
+FenceWaiter::~FenceWaiter()
+{
+    {
+        lock_guard<mutex> lock(pendingMutex);
+        stopping = true;
+    }
+    wakeEvent.Set();
+    thread.join();
+
+    // 끝나지 않은 wait는 실패로 이어줘야 코루틴 프레임이 남지 않는다
+    // executor는 FenceWaiter보다 나중에 없어지고, 없어지기 전에 받은 코루틴을 다 실행한다
+    for (PendingWait& pending : pendingWaits)
+    {
+        pending.awaiter->failed = true;
+        executor.Post(pending.handle);
+    }
+    pendingWaits.clear();
+}
+
+size_t FenceWaiter::GetPendingCount()
+{
+    lock_guard<mutex> lock(pendingMutex);
+    return pendingWaits.size();
+}
+
+void FenceWaiter::Add(Awaiter* awaiter, coroutine_handle<> handle)
+{
+    // push_back 뒤에는 다른 스레드에서 이미 이어졌을 수 있으므로 awaiter를 더 건드리지 않는다
+    IWaitableFence* fence = awaiter->fence;
+    uint64_t value = awaiter->value;
+    {
+        lock_guard<mutex> lock(pendingMutex);
+        pendingWaits.push_back({ awaiter, handle });
+    }
+
+    // 등록이 실패하면 완료 여부를 알 수 없으니 일단 깨워서 다시 확인하게 한다
+    if (!fence->SetWakeOnCompletion(value, wakeEvent))
+        wakeEvent.Set();
+}
+
+void FenceWaiter::Run()
+{
+    vector<coroutine_handle<>> readyHandles;
+
+    for (;;)
+    {
+        // 등록된 fence 중 하나라도 완료되면 깨어난다
+        wakeEvent.Wait();
+
+        bool stop;
+        {
+            lock_guard<mutex> lock(pendingMutex);
+
+            // 끝난 것들만 골라내고 나머지는 계속 기다린다
+            for (size_t i = 0; i < pendingWaits.size();)
+            {
+                const Awaiter* awaiter = pendingWaits[i].awaiter;
+                if (awaiter->value <= awaiter->fence->GetCompletedValue())
+                {
+                    readyHandles.push_back(pendingWaits[i].handle);
+                    pendingWaits[i] = pendingWaits.back();
+                    pendingWaits.pop_back();
+                }
+                else
+                {
+                    i++;
+                }
+            }
+
+            stop = stopping;
+        }
+
+        for (auto handle : readyHandles)
+            executor.Post(handle);
+
+        readyHandles.clear();
+
+        // 남은 wait는 소멸자가 실패로 이어준다
+        if (stop)
+            return;
+    }
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Executor.h"
+
+#if defined(_WIN32)
+#include <Windows.h>
+#endif
+
+// 여러 fence가 공유하는 auto-reset 이벤트
+// Windows에서는 ID3D12Fence::SetEventOnCompletion에 그대로 넘길 수 있는 이벤트 핸들이다
+class WakeEvent
+{
+#if defined(_WIN32)
+    HANDLE handle;
+#else
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool signaled;
+#endif
+
+public:
+    WakeEvent();
+    ~WakeEvent();
+
+    WakeEvent(const WakeEvent&) = delete;
+    WakeEvent& operator=(const WakeEvent&) = delete;
+
+    void Set();
+    void Wait();
+
+#if defined(_WIN32)
+    HANDLE GetHandle() const { return handle; }
+#endif
+};
+
+// FenceWaiter가 기다릴 수 있는 fence. D3D12 fence(D3D12WaitableFence)나 시뮬레이션 fence가 구현한다
+class IWaitableFence
+{
+public:
+    virtual ~IWaitableFence() = default;
+
+    virtual uint64_t GetCompletedValue() = 0;
+
+    // fence가 value에 도달하면 wakeEvent를 Set하도록 등록한다. 이미 도달했다면 바로 Set한다
+    virtual bool SetWakeOnCompletion(uint64_t value, WakeEvent& wakeEvent) = 0;
+};
+
+// 스레드 하나가 이벤트 하나로 여러 fence의 완료를 기다리고,
+// 완료된 fence를 기다리던 코루틴을 Executor로 넘긴다
+class FenceWaiter
+{
+public:
+    struct Awaiter;
+
+private:
+    struct PendingWait
+    {
+        Awaiter* awaiter; // 멈춘 코루틴 프레임 안에 있으므로 이어질때까지 살아 있다
+        std::coroutine_handle<> handle;
+    };
+
+    Executor& executor;
+    WakeEvent wakeEvent;
+    std::mutex pendingMutex;
+    std::vector<PendingWait> pendingWaits;
+    bool stopping;
+    std::thread thread;
+
+public:
+    explicit FenceWaiter(Executor& executor);
+    ~FenceWaiter();
+
+    FenceWaiter(const FenceWaiter&) = delete;
+    FenceWaiter& operator=(const FenceWaiter&) = delete;
+
+    struct Awaiter
+    {
+        FenceWaiter& waiter;
+        IWaitableFence* fence;
+        uint64_t value;
+        bool failed; // Signal을 넣지 못했거나 fence가 value에 닿기 전에 FenceWaiter가 없어졌다
+
+        bool await_ready() { return failed || value <= fence->GetCompletedValue(); }
+        void await_suspend(std::coroutine_handle<> handle) { waiter.Add(this, handle); }
+
+        // fence가 value에 도달했으면 true
+        bool await_resume() noexcept { return !failed; }
+    };
+
+    // bool reached = co_await fenceWaiter.Wait(fence, value); fence가 value에 도달하면 Executor 스레드에서 이어진다
+    Awaiter Wait(IWaitableFence* fence, uint64_t value) { return Awaiter{ *this, fence, value, false }; }
+
+    // 멈추지 않고 바로 false로 끝나는 awaiter. 기다릴 값을 Signal하지 못했을때 돌려준다
+    Awaiter Failed() { return Awaiter{ *this, nullptr, 0, true }; }
+
+    size_t GetPendingCount();
+
+private:
+    void Add(Awaiter* awaiter, std::coroutine_handle<> handle);
+    void Run();
+};
@@ -0,0 +1,105 @@
+#include "FrameArena.h"
+#include <algorithm>
+
+using namespace std;
+
+namespace
+{
+    // 워커 스레드에서 쓰는 배열들은 작으므로 블록 하나로 충분하다
+    const size_t ScratchBlockSize = 256 * 1024;
+
+    uintptr_t AlignUp(uintptr_t value, size_t alignment)
+    {
+        return (value + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+    }
+}
+
+LinearArena::LinearArena(size_t blockSize)
+    : blockSize(blockSize), currentBlock(0), offset(0), stats{}
+{
+}
+
+void* LinearArena::Allocate(size_t size, size_t alignment)
+{
+    // 지금 블록부터 뒤로 가면서 들어가는 곳을 찾는다. Reset 뒤에는 앞에서 받아둔 블록들을 다시 쓴다
+    size_t blockStart = stats.usedBytes - offset;
+    for (uint32_t block = currentBlock; block < blocks.size(); block++)
+    {
+        uintptr_t base = reinterpret_cast<uintptr_t>(blocks[block].memory.get());
+        size_t start = block == currentBlock ? offset : 0;
+        size_t alignedStart = static_cast<size_t>(AlignUp(base + start, alignment) - base);
+        if (alignedStart + size <= blocks[block].size)
+        {
+            // usedBytes는 앞 블록들 크기에 지금 위치를 더한 값이다. 건너뛴 블록 끝자리도 쓴 것으로 센다
+            currentBlock = block;
+            offset = alignedStart + size;
+            stats.usedBytes = blockStart + offset;
+            stats.peakBytes = max(stats.peakBytes, stats.usedBytes);
+            return reinterpret_cast<void*>(base + alignedStart);
+        }
+
+        blockStart += blocks[block].size;
+    }
+
+    // 남은 블록에 안 들어가면 새 블록을 붙인다. 큰 요청은 그 크기대로 받는다
+    Block newBlock;
+    newBlock.size = max(blockSize, size + alignment);
+    newBlock.memory = make_unique<uint8_t[]>(newBlock.size);
+    blocks.push_back(move(newBlock));
+
+    currentBlock = static_cast<uint32_t>(blocks.size() - 1);
+    offset = 0;
+    stats.usedBytes = blockStart;
+    stats.capacityBytes += blocks.back().size;
+    stats.blockCount++;
+    stats.blockAllocations++;
+    return Allocate(size, alignment);
+}
+
+void LinearArena::Rewind(const Marker& marker)
+{
+    currentBlock = marker.block;
+    offset = marker.offset;
+    stats.usedBytes = marker.usedBytes;
+}
+
+void LinearArena::Reset()
+{
+    currentBlock = 0;
+    offset = 0;
+    stats.usedBytes = 0;
+}
+
+FrameArenas::FrameArenas(uint32_t frameCount, size_t blockSize)
+    : currentArena(0)
+{
+    frameCount = max(2u, frameCount);
+    arenas.reserve(frameCount);
+    for (uint32_t i = 0; i < frameCount; i++)
+        arenas.emplace_back(blockSize);
+
+    fenceValues.assign(frameCount, 0);
+}
+
+LinearArena* FrameArenas::BeginFrame(uint64_t completedFenceValue)
+{
+    uint32_t next = (currentArena + 1) % static_cast<uint32_t>(arenas.size());
+    if (fenceValues[next] > completedFenceValue)
+        return nullptr;
+
+    currentArena = next;
+    arenas[currentArena].Reset();
+    fenceValues[currentArena] = 0;
+    return &arenas[currentArena];
+}
+
+void FrameArenas::EndFrame(uint64_t fenceValue)
+{
+    fenceValues[currentArena] = fenceValue;
+}
+
+LinearArena& GetScratchArena()
+{
+    thread_local LinearArena scratchArena(ScratchBlockSize);
+    return scratchArena;
+}
@@ -0,0 +1,156 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// 앞에서부터 잘라 쓰고 한꺼번에 되돌리는 메모리. 하나씩 해제하지는 않는다
+// 블록이 모자라면 새 블록을 붙이고, Reset해도 블록은 버리지 않는다
+// 그래서 한 번 가장 많이 쓰는 프레임만큼 커지고 나면 그 뒤로는 힙을 건드리지 않는다
+class LinearArena
+{
+public:
+    static const size_t DefaultBlockSize = 64 * 1024;
+
+    // Rewind로 돌아갈 위치
+    struct Marker
+    {
+        uint32_t block;
+        size_t offset;
+        size_t usedBytes;
+    };
+
+    struct Stats
+    {
+        size_t usedBytes;         // 정렬 때문에 건너뛴 곳과 블록 끝에 남긴 곳도 포함한다
+        size_t peakBytes;
+        size_t capacityBytes;
+        uint32_t blockCount;
+        uint64_t blockAllocations; // 힙에서 블록을 받아온 횟수. 안정되면 더 늘지 않아야 한다
+    };
+
+private:
+    struct Block
+    {
+        std::unique_ptr<uint8_t[]> memory;
+        size_t size;
+    };
+
+    std::vector<Block> blocks;
+    size_t blockSize;
+    uint32_t currentBlock;
+    size_t offset;
+    Stats stats;
+
+public:
+    explicit LinearArena(size_t blockSize = DefaultBlockSize);
+
+    LinearArena(LinearArena&&) = default;
+    LinearArena& operator=(LinearArena&&) = default;
+    LinearArena(const LinearArena&) = delete;
+    LinearArena& operator=(const LinearArena&) = delete;
+
+    void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    // 생성자는 부르지 않는다. 소멸자가 필요 없는 타입만 담는다
+    template<typename T>
+    T* Allocate(size_t count)
+    {
+        static_assert(std::is_trivially_destructible_v<T>, "LinearArena never runs destructors");
+        return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    Marker GetMarker() const { return { currentBlock, offset, stats.usedBytes }; }
+    void Rewind(const Marker& marker);
+    void Reset();
+
+    const Stats& GetStats() const { return stats; }
+};
+
+// 프레임마다 돌려 쓰는 LinearArena들
+// 그 프레임을 제출하고 받은 fence 값을 적어두고, 다시 차례가 왔을때 fence가 지났으면 Reset해서 준다
+// 여기 잡은 메모리는 GPU가 그 프레임을 끝낼때까지 살아 있으므로 업로드할 데이터나 지연 제출할 인자를 둬도 된다
+class FrameArenas
+{
+    std::vector<LinearArena> arenas;
+    std::vector<uint64_t> fenceValues; // 0이면 아직 제출한 적 없다
+    uint32_t currentArena;
+
+public:
+    // 지난 프레임이 만든 것을 다음 프레임 시작에서 치우는 곳(FrameGraph 등)이 있으므로 frameCount는 2 이상이다
+    explicit FrameArenas(uint32_t frameCount = 2, size_t blockSize = LinearArena::DefaultBlockSize);
+
+    // 다음 차례 arena의 fence가 아직 안 지났으면 nullptr. 그때는 fence를 기다린 뒤 다시 부른다
+    LinearArena* BeginFrame(uint64_t completedFenceValue);
+
+    // 이번 프레임의 마지막 제출 뒤에 부른다
+    void EndFrame(uint64_t fenceValue);
+
+    LinearArena& GetCurrent() { return arenas[currentArena]; }
+    uint32_t GetFrameCount() const { return static_cast<uint32_t>(arenas.size()); }
+    const LinearArena::Stats& GetStats(uint32_t frame) const { return arenas[frame].GetStats(); }
+};
+
+// 부른 스레드의 임시 메모리. 워커 스레드마다 따로 있어서 락이 없다
+LinearArena& GetScratchArena();
+
+// 범위를 벗어날때 이 스레드의 임시 메모리를 들어올때 위치로 되돌린다
+// 함수 안에서만 쓰는 배열을 힙 대신 여기에 둔다. 안에서 잡은 것을 밖으로 넘기면 안 된다
+class ScratchScope
+{
+    LinearArena& arena;
+    LinearArena::Marker marker;
+
+public:
+    ScratchScope() : arena(GetScratchArena()), marker(arena.GetMarker()) {}
+    ~ScratchScope() { arena.Rewind(marker); }
+
+    ScratchScope(const ScratchScope&) = delete;
+    ScratchScope& operator=(const ScratchScope&) = delete;
+
+    LinearArena& GetArena() { return arena; }
+};
+
+// STL 컨테이너를 LinearArena 위에 올리는 할당자. 해제는 아무것도 하지 않고 arena를 Reset할때 한꺼번에 돌아간다
+// arena가 없으면(기본 생성) 보통 힙을 쓴다
+template<typename T>
+class ArenaAllocator
+{
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    LinearArena* arena;
+
+    ArenaAllocator() noexcept : arena(nullptr) {}
+    explicit ArenaAllocator(LinearArena* arena) noexcept : arena(arena) {}
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena(other.arena) {}
+
+    T* allocate(size_t count)
+    {
+        if (!arena)
+            return std::allocator<T>().allocate(count);
+
+        return static_cast<T*>(arena->Allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    void deallocate(T* pointer, size_t count) noexcept
+    {
+        if (!arena)
+            std::allocator<T>().deallocate(pointer, count);
+    }
+
+    template<typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept { return arena == other.arena; }
+
+    template<typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const noexcept { return arena != other.arena; }
+};
+
+template<typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
@@ -0,0 +1,132 @@
+#include "FrameCapture.h"
+#include <directx/d3dx12.h>
+
+using namespace winrt;
+using namespace std;
+using namespace std::filesystem;
+
+FrameCapture::FrameCapture(const path& outputDirectory, CaptureFormat format)
+    : footprint{}, readbackSize(0), width(0), height(0), encoder(outputDirectory, format), recordedSlot(ReadbackRing::InvalidSlot)
+{
+}
+
+FrameCapture::~FrameCapture()
+{
+    // 워커가 아직 Map된 버퍼를 읽고 있을 수 있다
+    encoder.Flush();
+}
+
+bool FrameCapture::Init(ID3D12Device* device, ID3D12Resource* backBuffer, uint32_t slotCount)
+{
+    D3D12_RESOURCE_DESC desc = backBuffer->GetDesc();
+
+    // CaptureEncoder는 RGBA8만 다룬다
+    if (desc.Format != DXGI_FORMAT_R8G8B8A8_UNORM)
+        return false;
+
+    // readback 버퍼의 줄 간격은 D3D12_TEXTURE_DATA_PITCH_ALIGNMENT(256)에 맞춰야 한다
+    UINT numRows;
+    UINT64 rowSize;
+    device->GetCopyableFootprints(&desc, 0, 1, 0, &footprint, &numRows, &rowSize, &readbackSize);
+
+    width = static_cast<UINT>(desc.Width);
+    height = desc.Height;
+
+    readbackBuffers.resize(slotCount);
+    for (auto& buffer : readbackBuffers)
+    {
+        if (FAILED(device->CreateCommittedResource(
+            &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_READBACK),
+            D3D12_HEAP_FLAG_NONE,
+            &CD3DX12_RESOURCE_DESC::Buffer(readbackSize),
+            D3D12_RESOURCE_STATE_COPY_DEST,
+            nullptr,
+            IID_PPV_ARGS(&buffer))))
+            return false;
+    }
+
+    ring.Reset(slotCount);
+    return true;
+}
+
+void FrameCapture::Destroy()
+{
+    encoder.Flush();
+    readbackBuffers.clear();
+    ring.Reset(0);
+}
+
+bool FrameCapture::RecordCopy(ID3D12GraphicsCommandList* commandList, ID3D12Resource* backBuffer, uint64_t frameNumber)
+{
+    // 앞 슬롯을 아직 인코딩 중이면 기다리지 않고 이번 프레임은 버린다
+    recordedSlot = ring.Acquire(frameNumber);
+    if (recordedSlot == ReadbackRing::InvalidSlot)
+        return false;
+
+    auto toCopySource = CD3DX12_RESOURCE_BARRIER::Transition(backBuffer, D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_COPY_SOURCE);
+    commandList->ResourceBarrier(1, &toCopySource);
+
+    CD3DX12_TEXTURE_COPY_LOCATION dest(readbackBuffers[recordedSlot].get(), footprint);
+    CD3DX12_TEXTURE_COPY_LOCATION source(backBuffer, 0);
+    commandList->CopyTextureRegion(&dest, 0, 0, 0, &source, nullptr);
+
+    auto toPresent = CD3DX12_RESOURCE_BARRIER::Transition(backBuffer, D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_PRESENT);
+    commandList->ResourceBarrier(1, &toPresent);
+    return true;
+}
+
+void FrameCapture::Submit(uint64_t fenceValue)
+{
+    if (recordedSlot == ReadbackRing::InvalidSlot)
+        return;
+
+    ring.Submit(recordedSlot, fenceValue);
+    recordedSlot = ReadbackRing::InvalidSlot;
+}
+
+bool FrameCapture::Poll(uint64_t completedFenceValue)
+{
+    retiredSlots.clear();
+    ring.Retire(completedFenceValue, retiredSlots);
+
+    for (size_t i = 0; i < retiredSlots.size(); i++)
+    {
+        const ReadbackRing::RetiredSlot& retired = retiredSlots[i];
+        ID3D12Resource* buffer = readbackBuffers[retired.slot].get();
+
+        // fence가 이미 지났으므로 Map은 기다리지 않는다
+        CD3DX12_RANGE readRange(0, static_cast<SIZE_T>(readbackSize));
+        void* data;
+        if (FAILED(buffer->Map(0, &readRange, &data)))
+        {
+            // 이번에 꺼낸 나머지 슬롯도 Encoding으로 남지 않게 돌려준다. 안 그러면 링이 차서 뒤 프레임이 모두 버려진다
+            for (size_t j = i; j < retiredSlots.size(); j++)
+                ring.Discard(retiredSlots[j].slot);
+            return false;
+        }
+
+        CaptureFrame frame;
+        frame.frameNumber = retired.frameNumber;
+        frame.width = width;
+        frame.height = height;
+        frame.rowPitch = footprint.Footprint.RowPitch;
+        frame.pixels = static_cast<const uint8_t*>(data) + footprint.Offset;
+
+        // Map/Unmap은 아무 스레드에서나 해도 된다. 워커가 픽셀을 옮기자마자 슬롯을 돌려준다
+        uint32_t slot = retired.slot;
+        encoder.Encode(frame, [this, buffer, slot]
+        {
+            CD3DX12_RANGE writtenRange(0, 0);
+            buffer->Unmap(0, &writtenRange);
+            ring.Release(slot);
+        });
+    }
+
+    return true;
+}
+
+void FrameCapture::Flush(uint64_t completedFenceValue)
+{
+    Poll(completedFenceValue);
+    encoder.Flush();
+}
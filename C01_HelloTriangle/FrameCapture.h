@@ -0,0 +1,52 @@
+#pragma once
+#include <Windows.h>
+#include <winrt/base.h>
+#include <directx/d3d12.h>
+#include <filesystem>
+#include <vector>
+#include "CaptureEncoder.h"
+#include "ReadbackRing.h"
+
+// 백버퍼를 READBACK 힙 버퍼 여러개에 돌아가며 복사해서 파일로 남긴다
+// 복사는 그 프레임 커맨드 리스트에 같이 넣고, Map은 몇 프레임 뒤 그 슬롯의 fence가 지난 다음에만 하므로
+// 렌더 스레드가 GPU를 기다리지 않는다. 인코딩과 파일 쓰기는 CaptureEncoder 워커에서 한다
+class FrameCapture
+{
+    std::vector<winrt::com_ptr<ID3D12Resource>> readbackBuffers;
+    D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint;
+    UINT64 readbackSize;
+    UINT width;
+    UINT height;
+
+    ReadbackRing ring;
+    CaptureEncoder encoder;
+
+    uint32_t recordedSlot; // RecordCopy에서 잡고 Submit에서 fence 값을 붙인다
+    std::vector<ReadbackRing::RetiredSlot> retiredSlots;
+
+public:
+    // GPU가 보통 1~2 프레임 뒤에 있으므로 그보다 넉넉하게 잡는다
+    static const uint32_t DefaultSlotCount = 4;
+
+    FrameCapture(const std::filesystem::path& outputDirectory, CaptureFormat format);
+    ~FrameCapture();
+
+    bool Init(ID3D12Device* device, ID3D12Resource* backBuffer, uint32_t slotCount = DefaultSlotCount);
+    void Destroy();
+
+    // RENDER_TARGET 상태인 백버퍼를 복사하고 PRESENT 상태로 바꿔둔다
+    // 빈 슬롯이 없어서 이번 프레임을 건너뛰면 false이고, 이때 PRESENT 전환은 호출한 쪽이 한다
+    bool RecordCopy(ID3D12GraphicsCommandList* commandList, ID3D12Resource* backBuffer, uint64_t frameNumber);
+
+    // RecordCopy한 커맨드 리스트가 fenceValue에서 끝난다
+    void Submit(uint64_t fenceValue);
+
+    // 렌더 스레드에서 매 프레임 부른다. fence가 지난 슬롯만 Map해서 인코더에 넘긴다
+    bool Poll(uint64_t completedFenceValue);
+
+    // 종료할때 남은 프레임을 다 쓴다. GPU는 이미 끝났어야 한다
+    void Flush(uint64_t completedFenceValue);
+
+    ReadbackRing::Stats GetRingStats() { return ring.GetStats(); }
+    CaptureEncoderStats GetEncoderStats() { return encoder.GetStats(); }
+};
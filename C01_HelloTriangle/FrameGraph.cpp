@@ -0,0 +1,213 @@
+#include "FrameGraph.h"
+#include <algorithm>
+
+using namespace std;
+
+namespace
+{
+    uint32_t ToIndex(QueueType queue)
+    {
+        return static_cast<uint32_t>(queue);
+    }
+}
+
+FrameGraph::FrameGraph()
+    : frameArena(nullptr), nextFenceValues{}, frameStartValues{}, waitedValues{}, stats{}
+{
+    // 0은 '접근 없음'으로 쓰기 때문에 타임라인은 1부터 시작한다
+    for (uint32_t q = 0; q < QueueTypeCount; q++)
+        nextFenceValues[q] = 1;
+}
+
+void FrameGraph::BeginFrame(LinearArena* arena)
+{
+    // arena를 쓰면 지난 프레임 목록은 지난 arena에 버려두고 새로 잡는다. 그 메모리는 지난 프레임 fence가 지나면 돌아간다
+    if (arena || frameArena)
+    {
+        frameArena = arena;
+        passes = ArenaVector<Pass>(ArenaAllocator<Pass>(arena));
+        schedule = ArenaVector<ScheduledPass>(ArenaAllocator<ScheduledPass>(arena));
+        for (auto& frameSchedule : frameSchedules)
+            frameSchedule = ArenaVector<uint32_t>(ArenaAllocator<uint32_t>(arena));
+        return;
+    }
+
+    passes.clear();
+    schedule.clear();
+}
+
+uint32_t FrameGraph::AddPass(const char* name, QueueType queue, initializer_list<ResourceId> reads, initializer_list<ResourceId> writes)
+{
+    ArenaAllocator<ResourceId> allocator(frameArena);
+    passes.push_back({ name, queue, ArenaVector<ResourceId>(reads, allocator), ArenaVector<ResourceId>(writes, allocator) });
+    return static_cast<uint32_t>(passes.size() - 1);
+}
+
+uint64_t FrameGraph::ReserveFenceValue(QueueType queue)
+{
+    uint32_t q = ToIndex(queue);
+    uint64_t value = nextFenceValues[q]++;
+    stats[q].lastSignaledValue = value;
+    return value;
+}
+
+void FrameGraph::AddWait(ScheduledPass& scheduledPass, const Access& access)
+{
+    // 같은 큐 안에서는 실행 순서가 보장되므로 기다릴 필요가 없다
+    if (access.value == 0 || access.queue == scheduledPass.queue)
+        return;
+
+    uint32_t q = ToIndex(scheduledPass.queue);
+    uint32_t s = ToIndex(access.queue);
+
+    // 이미 그 값 이상을 기다린 적이 있으면 생략
+    if (access.value <= waitedValues[q][s])
+        return;
+
+    // 이번 프레임에 만들어진 값이면 해당 패스가 Signal하도록 표시한다
+    // 이전 프레임 값은 ResolveAccess에서 실제 Signal된 값으로 바꿔두었다
+    if (frameStartValues[s] <= access.value)
+        schedule[frameSchedules[s][access.value - frameStartValues[s]]].signal = true;
+
+    waitedValues[q][s] = access.value;
+
+    // 같은 큐에 대한 wait는 하나만 남긴다
+    for (auto& wait : scheduledPass.waits)
+    {
+        if (wait.queue == access.queue)
+        {
+            wait.value = max(wait.value, access.value);
+            return;
+        }
+    }
+
+    scheduledPass.waits.push_back({ access.queue, access.value });
+}
+
+void FrameGraph::ResolveAccess(Access& access, const ArenaVector<uint64_t> (&signaledValues)[QueueTypeCount]) const
+{
+    uint32_t q = ToIndex(access.queue);
+    if (access.value < frameStartValues[q])
+        return;
+
+    // Signal하지 않은 중간 값을 다음 프레임에서 기다리면 영원히 끝나지 않으므로
+    // 그 이후 처음으로 Signal되는 값으로 올려둔다. 큐의 마지막 패스는 항상 Signal한다
+    auto it = lower_bound(signaledValues[q].begin(), signaledValues[q].end(), access.value);
+    access.value = *it;
+}
+
+const ArenaVector<ScheduledPass>& FrameGraph::Compile()
+{
+    schedule.clear();
+    schedule.reserve(passes.size());
+
+    for (uint32_t q = 0; q < QueueTypeCount; q++)
+    {
+        frameStartValues[q] = nextFenceValues[q];
+        frameSchedules[q].clear();
+    }
+
+    for (uint32_t passIndex = 0; passIndex < passes.size(); passIndex++)
+    {
+        const Pass& pass = passes[passIndex];
+        uint32_t q = ToIndex(pass.queue);
+
+        schedule.push_back({ passIndex, pass.queue, ArenaVector<FenceWait>(ArenaAllocator<FenceWait>(frameArena)), nextFenceValues[q]++, false });
+        frameSchedules[q].push_back(static_cast<uint32_t>(schedule.size() - 1));
+        ScheduledPass& scheduledPass = schedule.back();
+
+        // read after write
+        for (ResourceId id : pass.reads)
+            AddWait(scheduledPass, resourceStates[id].lastWrite);
+
+        // write after write, write after read
+        for (ResourceId id : pass.writes)
+        {
+            ResourceState& state = resourceStates[id];
+            AddWait(scheduledPass, state.lastWrite);
+            for (auto& lastRead : state.lastReads)
+                AddWait(scheduledPass, lastRead);
+        }
+
+        Access access = { pass.queue, scheduledPass.fenceValue };
+        for (ResourceId id : pass.reads)
+            resourceStates[id].lastReads[q] = access;
+
+        for (ResourceId id : pass.writes)
+        {
+            ResourceState& state = resourceStates[id];
+            state.lastWrite = access;
+            for (auto& lastRead : state.lastReads)
+                lastRead = {};
+        }
+    }
+
+    // 큐마다 마지막 패스는 Signal해서 다음 프레임과 CPU가 기다릴 수 있게 한다
+    ArenaVector<uint64_t> signaledValues[QueueTypeCount];
+    for (uint32_t q = 0; q < QueueTypeCount; q++)
+    {
+        signaledValues[q] = ArenaVector<uint64_t>(ArenaAllocator<uint64_t>(frameArena));
+        if (frameSchedules[q].empty())
+            continue;
+
+        schedule[frameSchedules[q].back()].signal = true;
+        for (uint32_t index : frameSchedules[q])
+            if (schedule[index].signal)
+                signaledValues[q].push_back(schedule[index].fenceValue);
+    }
+
+    for (auto& entry : resourceStates)
+    {
+        ResourceState& state = entry.second;
+        if (state.lastWrite.value != 0)
+            ResolveAccess(state.lastWrite, signaledValues);
+
+        for (auto& lastRead : state.lastReads)
+            if (lastRead.value != 0)
+                ResolveAccess(lastRead, signaledValues);
+    }
+
+    return schedule;
+}
+
+bool FrameGraph::Submit(IQueueBackend& backend)
+{
+    for (uint32_t q = 0; q < QueueTypeCount; q++)
+        stats[q].completedValue = backend.GetCompletedValue(static_cast<QueueType>(q));
+
+    for (const ScheduledPass& scheduledPass : schedule)
+    {
+        QueueTimelineStats& queueStats = stats[ToIndex(scheduledPass.queue)];
+
+        for (const FenceWait& wait : scheduledPass.waits)
+        {
+            // 제출하는 시점에 이미 끝난 값이면 GPU wait를 넣지 않는다
+            if (wait.value <= stats[ToIndex(wait.queue)].completedValue)
+            {
+                queueStats.skippedWaitCount++;
+                continue;
+            }
+
+            if (!backend.Wait(scheduledPass.queue, wait.queue, wait.value))
+                return false;
+
+            queueStats.waitCount++;
+        }
+
+        if (!backend.ExecutePass(scheduledPass.queue, scheduledPass.passIndex))
+            return false;
+
+        queueStats.passCount++;
+
+        if (scheduledPass.signal)
+        {
+            if (!backend.Signal(scheduledPass.queue, scheduledPass.fenceValue))
+                return false;
+
+            queueStats.signalCount++;
+            queueStats.lastSignaledValue = scheduledPass.fenceValue;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,119 @@
+#pragma once
+#include <cstdint>
+#include <initializer_list>
+#include <unordered_map>
+#include <vector>
+#include "FrameArena.h"
+
+// 패스가 실행될 큐 종류
+enum class QueueType : uint32_t
+{
+    Graphics,
+    Compute,
+    Count
+};
+
+constexpr uint32_t QueueTypeCount = static_cast<uint32_t>(QueueType::Count);
+
+// 패스 사이의 의존성을 추적하기 위한 리소스 식별자, 값은 사용하는 쪽에서 정한다
+using ResourceId = uint32_t;
+
+// 실제로 큐에 Execute/Wait/Signal을 하는 쪽. D3D12에서는 GpuQueues가 구현하고,
+// D3D12가 없는 환경에서는 가짜 큐 모델을 붙여서 스케줄을 검증할 수 있다
+class IQueueBackend
+{
+public:
+    virtual ~IQueueBackend() = default;
+
+    virtual bool ExecutePass(QueueType queue, uint32_t passIndex) = 0;
+
+    // queue가 GPU상에서 signalQueue의 fence가 value에 도달할때까지 기다리게 한다
+    virtual bool Wait(QueueType queue, QueueType signalQueue, uint64_t value) = 0;
+    virtual bool Signal(QueueType queue, uint64_t value) = 0;
+    virtual uint64_t GetCompletedValue(QueueType queue) = 0;
+};
+
+struct FenceWait
+{
+    QueueType queue; // 기다릴 fence의 큐
+    uint64_t value;
+};
+
+struct ScheduledPass
+{
+    uint32_t passIndex;
+    QueueType queue;
+    ArenaVector<FenceWait> waits; // 실행 전에 기다려야 하는 다른 큐의 fence 값들
+    uint64_t fenceValue;          // 이 패스까지 끝났을때의 큐 타임라인 값
+    bool signal;                  // 다른 큐가 기다리거나 프레임의 마지막 패스라서 Signal이 필요한지
+};
+
+// 큐별 타임라인 통계
+struct QueueTimelineStats
+{
+    uint64_t passCount;
+    uint64_t signalCount;
+    uint64_t waitCount;
+    uint64_t skippedWaitCount; // 제출 시점에 이미 끝나있어서 생략한 wait
+    uint64_t lastSignaledValue;
+    uint64_t completedValue;
+};
+
+// 프레임마다 패스를 등록하면 큐 간 fence 의존성을 계산해서 제출한다
+// 리소스 접근 기록은 프레임을 넘어 유지되므로, 이전 프레임의 그래픽스 작업과
+// 실제로 겹치는 리소스가 없는 compute 패스는 기다리지 않고 바로 실행된다
+class FrameGraph
+{
+    struct Pass
+    {
+        const char* name;
+        QueueType queue;
+        ArenaVector<ResourceId> reads;
+        ArenaVector<ResourceId> writes;
+    };
+
+    // value가 0이면 접근 기록이 없는 것
+    struct Access
+    {
+        QueueType queue;
+        uint64_t value;
+    };
+
+    struct ResourceState
+    {
+        Access lastWrite;
+        Access lastReads[QueueTypeCount];
+    };
+
+    // 프레임마다 새로 만드는 목록은 BeginFrame에 넘긴 arena에 둔다. 다음 BeginFrame까지만 쓴다
+    LinearArena* frameArena;
+    ArenaVector<Pass> passes;
+    ArenaVector<ScheduledPass> schedule;
+    ArenaVector<uint32_t> frameSchedules[QueueTypeCount]; // 이번 프레임 타임라인 값 - frameStartValue -> schedule 인덱스
+    std::unordered_map<ResourceId, ResourceState> resourceStates;
+
+    uint64_t nextFenceValues[QueueTypeCount];
+    uint64_t frameStartValues[QueueTypeCount];
+    uint64_t waitedValues[QueueTypeCount][QueueTypeCount]; // [기다리는 큐][signal한 큐]
+    QueueTimelineStats stats[QueueTypeCount];
+
+public:
+    FrameGraph();
+
+    // frameArena가 없으면 힙에 잡고 다음 프레임에 다시 쓴다
+    void BeginFrame(LinearArena* frameArena = nullptr);
+    uint32_t AddPass(const char* name, QueueType queue, std::initializer_list<ResourceId> reads, std::initializer_list<ResourceId> writes);
+
+    const ArenaVector<ScheduledPass>& Compile();
+    bool Submit(IQueueBackend& backend);
+
+    // 패스 밖에서 직접 Signal할때(프레임 동기화 등) 타임라인 값을 예약한다
+    uint64_t ReserveFenceValue(QueueType queue);
+
+    const char* GetPassName(uint32_t passIndex) const { return passes[passIndex].name; }
+    const QueueTimelineStats& GetStats(QueueType queue) const { return stats[static_cast<uint32_t>(queue)]; }
+
+private:
+    void AddWait(ScheduledPass& scheduledPass, const Access& access);
+    void ResolveAccess(Access& access, const ArenaVector<uint64_t> (&signaledValues)[QueueTypeCount]) const;
+};
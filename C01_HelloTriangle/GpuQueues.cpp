@@ -0,0 +1,121 @@
+#include "GpuQueues.h"
+
+using namespace winrt;
+
+GpuQueues::GpuQueues()
+    : fenceEvent(nullptr)
+{
+    for (Queue& queue : queues)
+        queue.submissionCount = 0;
+}
+
+bool GpuQueues::Init(ID3D12Device* device)
+{
+    const D3D12_COMMAND_LIST_TYPE listTypes[QueueTypeCount] =
+    {
+        D3D12_COMMAND_LIST_TYPE_DIRECT,  // QueueType::Graphics
+        D3D12_COMMAND_LIST_TYPE_COMPUTE, // QueueType::Compute
+    };
+
+    for (uint32_t q = 0; q < QueueTypeCount; q++)
+    {
+        D3D12_COMMAND_QUEUE_DESC queueDesc = {};
+        queueDesc.Type = listTypes[q];
+        queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+        if (FAILED(device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&queues[q].commandQueue))))
+            return false;
+
+        // 큐마다 타임라인 fence가 하나씩 있고, 다른 큐는 이 fence를 Wait한다
+        if (FAILED(device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&queues[q].fence))))
+            return false;
+
+        queues[q].waitableFence.SetFence(queues[q].fence.get());
+    }
+
+    fenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    if (fenceEvent == nullptr)
+        return false;
+
+    return true;
+}
+
+void GpuQueues::Destroy()
+{
+    if (fenceEvent)
+    {
+        CloseHandle(fenceEvent);
+        fenceEvent = nullptr;
+    }
+}
+
+void GpuQueues::SetPassCommandList(uint32_t passIndex, ID3D12CommandList* commandList)
+{
+    if (passCommandLists.size() <= passIndex)
+        passCommandLists.resize(passIndex + 1, nullptr);
+
+    passCommandLists[passIndex] = commandList;
+}
+
+bool GpuQueues::WaitForValue(QueueType queueType, uint64_t value)
+{
+    Queue& queue = queues[static_cast<uint32_t>(queueType)];
+    if (value <= queue.fence->GetCompletedValue())
+        return true;
+
+    if (FAILED(queue.fence->SetEventOnCompletion(value, fenceEvent)))
+        return false;
+
+    WaitForSingleObject(fenceEvent, INFINITE);
+    return true;
+}
+
+FenceWaiter::Awaiter GpuQueues::SignalAsync(FenceWaiter& fenceWaiter, QueueType queueType, uint64_t value)
+{
+    // Signal을 넣지 못하면 fence가 value에 닿지 않으므로 기다리지 않고 실패로 끝낸다
+    if (!Signal(queueType, value))
+        return fenceWaiter.Failed();
+
+    return fenceWaiter.Wait(GetWaitableFence(queueType), value);
+}
+
+void GpuQueues::Flush(Queue& queue)
+{
+    if (queue.pendingCommandLists.empty())
+        return;
+
+    queue.commandQueue->ExecuteCommandLists(static_cast<UINT>(queue.pendingCommandLists.size()), queue.pendingCommandLists.data());
+    queue.pendingCommandLists.clear();
+    queue.submissionCount++;
+}
+
+bool GpuQueues::ExecutePass(QueueType queueType, uint32_t passIndex)
+{
+    // 커맨드 리스트가 없는 패스는 의존성만 표현하는 패스다
+    if (passIndex < passCommandLists.size() && passCommandLists[passIndex])
+        queues[static_cast<uint32_t>(queueType)].pendingCommandLists.push_back(passCommandLists[passIndex]);
+
+    return true;
+}
+
+bool GpuQueues::Wait(QueueType queueType, QueueType signalQueueType, uint64_t value)
+{
+    Queue& queue = queues[static_cast<uint32_t>(queueType)];
+
+    // Wait 이전에 쌓인 커맨드 리스트는 기다리지 않고 먼저 실행되어야 한다
+    Flush(queue);
+
+    return SUCCEEDED(queue.commandQueue->Wait(queues[static_cast<uint32_t>(signalQueueType)].fence.get(), value));
+}
+
+bool GpuQueues::Signal(QueueType queueType, uint64_t value)
+{
+    Queue& queue = queues[static_cast<uint32_t>(queueType)];
+    Flush(queue);
+
+    return SUCCEEDED(queue.commandQueue->Signal(queue.fence.get(), value));
+}
+
+uint64_t GpuQueues::GetCompletedValue(QueueType queueType)
+{
+    return queues[static_cast<uint32_t>(queueType)].fence->GetCompletedValue();
+}
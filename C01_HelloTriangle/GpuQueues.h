@@ -0,0 +1,67 @@
+#pragma once
+#include <Windows.h>
+#include <winrt/base.h>
+#include <directx/d3d12.h>
+#include <vector>
+#include "FenceWaiter.h"
+#include "FrameGraph.h"
+
+// ID3D12Fence를 FenceWaiter에서 기다릴 수 있게 한다
+class D3D12WaitableFence : public IWaitableFence
+{
+    ID3D12Fence* fence;
+
+public:
+    D3D12WaitableFence() : fence(nullptr) {}
+
+    void SetFence(ID3D12Fence* fence) { this->fence = fence; }
+
+    uint64_t GetCompletedValue() override { return fence->GetCompletedValue(); }
+    bool SetWakeOnCompletion(uint64_t value, WakeEvent& wakeEvent) override { return SUCCEEDED(fence->SetEventOnCompletion(value, wakeEvent.GetHandle())); }
+};
+
+// 그래픽스(DIRECT) 큐와 async compute 큐, 그리고 큐마다 하나씩 있는 fence를 들고 있다
+// FrameGraph가 계산한 스케줄대로 ExecuteCommandLists/Wait/Signal을 한다
+class GpuQueues : public IQueueBackend
+{
+    struct Queue
+    {
+        winrt::com_ptr<ID3D12CommandQueue> commandQueue;
+        winrt::com_ptr<ID3D12Fence> fence;
+        D3D12WaitableFence waitableFence;
+
+        // Wait/Signal 전까지 모아뒀다가 한번의 ExecuteCommandLists로 제출한다
+        std::vector<ID3D12CommandList*> pendingCommandLists;
+        uint64_t submissionCount; // ExecuteCommandLists를 부른 횟수
+    };
+
+    Queue queues[QueueTypeCount];
+    std::vector<ID3D12CommandList*> passCommandLists; // passIndex -> 커맨드 리스트
+    HANDLE fenceEvent;
+
+public:
+    GpuQueues();
+
+    bool Init(ID3D12Device* device);
+    void Destroy();
+
+    ID3D12CommandQueue* GetQueue(QueueType queue) { return queues[static_cast<uint32_t>(queue)].commandQueue.get(); }
+    void SetPassCommandList(uint32_t passIndex, ID3D12CommandList* commandList);
+
+    // CPU에서 queue의 fence가 value에 도달할때까지 기다린다
+    bool WaitForValue(QueueType queue, uint64_t value);
+
+    // 스레드를 막지 않고 기다린다. bool reached = co_await gpuQueues.SignalAsync(fenceWaiter, queue, value);
+    // Signal이 실패하면 기다리지 않고 false로 끝난다. value는 FrameGraph::ReserveFenceValue로 예약한 값이어야 한다
+    FenceWaiter::Awaiter SignalAsync(FenceWaiter& fenceWaiter, QueueType queue, uint64_t value);
+    IWaitableFence* GetWaitableFence(QueueType queue) { return &queues[static_cast<uint32_t>(queue)].waitableFence; }
+    uint64_t GetSubmissionCount(QueueType queue) const { return queues[static_cast<uint32_t>(queue)].submissionCount; }
+
+    bool ExecutePass(QueueType queue, uint32_t passIndex) override;
+    bool Wait(QueueType queue, QueueType signalQueue, uint64_t value) override;
+    bool Signal(QueueType queue, uint64_t value) override;
+    uint64_t GetCompletedValue(QueueType queue) override;
+
+private:
+    void Flush(Queue& queue);
+};
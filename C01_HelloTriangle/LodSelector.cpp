@@ -0,0 +1,178 @@
+#include "LodSelector.h"
+#include "CpuFeatures.h"
+#include "FrameArena.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define LOD_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#define LOD_AVX2_TARGET
+#else
+// 이 함수만 AVX2로 만든다. FMA는 켜지 않는다 (스칼라 경로와 결과가 달라진다)
+#define LOD_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+
+using namespace std;
+
+void LodInstances::Resize(uint32_t count)
+{
+    x.resize(count);
+    y.resize(count);
+    z.resize(count);
+    scale.resize(count, 1.0f);
+}
+
+LodSelector::LodSelector()
+    : lodCount(1), lodErrors{}, boundsRadius(0.0f), simdPath(LodSimdPath::Scalar)
+{
+    SetSimdPath(LodSimdPath::Avx2);
+}
+
+void LodSelector::SetMesh(const MeshAsset& asset)
+{
+    lodCount = max(1u, min(static_cast<uint32_t>(asset.lods.size()), static_cast<uint32_t>(MeshAsset::MaxLods)));
+    boundsRadius = asset.boundsRadius;
+
+    // 오차가 LOD 순서대로 커져야 거리 문턱도 순서대로 선다. 뒤집힌 곳은 앞의 값으로 올린다
+    float error = 0.0f;
+    for (uint32_t lod = 0; lod < MeshAsset::MaxLods; lod++)
+    {
+        if (lod < lodCount && lod > 0)
+            error = max(error, asset.lods[lod].error);
+        lodErrors[lod] = lod < lodCount ? error : 0.0f;
+    }
+}
+
+void LodSelector::SetSimdPath(LodSimdPath path)
+{
+    simdPath = (path == LodSimdPath::Avx2 && !IsAvx2Supported()) ? LodSimdPath::Scalar : path;
+}
+
+LodSelector::Thresholds LodSelector::MakeThresholds(const LodCamera& camera) const
+{
+    // LOD마다 scale 1인 인스턴스가 그 LOD를 써도 되는 최소 거리
+    Thresholds thresholds = {};
+    float distancePerError = camera.projectionScale / camera.pixelThreshold;
+
+    // 1 이상이면 0으로 나누거나 문턱이 음수가 된다. NaN은 0이 된다
+    float hysteresis = min(max(0.0f, camera.hysteresis), MaxHysteresis);
+    for (uint32_t lod = 0; lod < lodCount; lod++)
+    {
+        thresholds.finer[lod] = lodErrors[lod] * distancePerError;
+        thresholds.coarser[lod] = thresholds.finer[lod] / (1.0f - hysteresis);
+    }
+    return thresholds;
+}
+
+void LodSelector::Select(const LodInstances& instances, const LodCamera& camera, uint8_t* lods, Executor* executor) const
+{
+    Thresholds thresholds = MakeThresholds(camera);
+    uint32_t count = instances.GetCount();
+
+    if (!executor || count <= ChunkSize)
+    {
+        SelectRange(instances, camera, thresholds, lods, 0, count);
+        return;
+    }
+
+    // 구간마다 lods의 다른 칸을 쓰므로 락 없이 나눈다. 태스크 배열은 스레드 임시 메모리에 둔다
+    ScratchScope scratch;
+    ArenaVector<Task<void>> tasks(ArenaAllocator<Task<void>>(&scratch.GetArena()));
+    tasks.reserve((count + ChunkSize - 1) / ChunkSize);
+    for (uint32_t begin = 0; begin < count; begin += ChunkSize)
+        tasks.push_back(SelectRangeAsync(*executor, instances, camera, thresholds, lods, begin, min(begin + ChunkSize, count)));
+
+    SyncWait(WhenAll(move(tasks)));
+}
+
+Task<void> LodSelector::SelectRangeAsync(Executor& executor, const LodInstances& instances, const LodCamera& camera, const Thresholds& thresholds, uint8_t* lods, uint32_t begin, uint32_t end) const
+{
+    co_await executor.Schedule();
+
+    SelectRange(instances, camera, thresholds, lods, begin, end);
+}
+
+void LodSelector::SelectRange(const LodInstances& instances, const LodCamera& camera, const Thresholds& thresholds, uint8_t* lods, uint32_t begin, uint32_t end) const
+{
+    if (simdPath == LodSimdPath::Avx2)
+        SelectRangeAvx2(instances, camera, thresholds, lods, begin, end);
+    else
+        SelectRangeScalar(instances, camera, thresholds, lods, begin, end);
+}
+
+void LodSelector::SelectRangeScalar(const LodInstances& instances, const LodCamera& camera, const Thresholds& thresholds, uint8_t* lods, uint32_t begin, uint32_t end) const
+{
+    for (uint32_t i = begin; i < end; i++)
+    {
+        float scale = instances.scale[i];
+        float dx = instances.x[i] - camera.x;
+        float dy = instances.y[i] - camera.y;
+        float dz = instances.z[i] - camera.z;
+        float distance = sqrtf(dx * dx + dy * dy + dz * dz) - boundsRadius * scale;
+
+        // 문턱을 넘은 LOD 수가 곧 쓸 수 있는 가장 거친 LOD다. LOD 0은 늘 된다
+        uint32_t finer = 0;
+        uint32_t coarser = 0;
+        for (uint32_t lod = 1; lod < lodCount; lod++)
+        {
+            finer += distance >= thresholds.finer[lod] * scale ? 1 : 0;
+            coarser += distance >= thresholds.coarser[lod] * scale ? 1 : 0;
+        }
+
+        // 지금 LOD가 너무 거칠면 바로 고운 쪽으로 가고, 거친 쪽으로는 더 엄한 문턱을 넘어야 간다
+        uint32_t previous = lods[i];
+        uint32_t next = previous > finer ? finer : max(previous, coarser);
+        lods[i] = static_cast<uint8_t>(next);
+    }
+}
+
+#if LOD_SIMD_X86
+LOD_AVX2_TARGET void LodSelector::SelectRangeAvx2(const LodInstances& instances, const LodCamera& camera, const Thresholds& thresholds, uint8_t* lods, uint32_t begin, uint32_t end) const
+{
+    // 인스턴스 8개씩. SelectRangeScalar와 같은 연산을 같은 순서로 한다
+    const __m256 cameraX = _mm256_set1_ps(camera.x);
+    const __m256 cameraY = _mm256_set1_ps(camera.y);
+    const __m256 cameraZ = _mm256_set1_ps(camera.z);
+    const __m256 radius = _mm256_set1_ps(boundsRadius);
+
+    uint32_t i = begin;
+    for (; i + 8 <= end; i += 8)
+    {
+        __m256 scale = _mm256_loadu_ps(&instances.scale[i]);
+        __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(&instances.x[i]), cameraX);
+        __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(&instances.y[i]), cameraY);
+        __m256 dz = _mm256_sub_ps(_mm256_loadu_ps(&instances.z[i]), cameraZ);
+        __m256 distanceSq = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+        __m256 distance = _mm256_sub_ps(_mm256_sqrt_ps(distanceSq), _mm256_mul_ps(radius, scale));
+
+        // 비교 결과는 참이면 -1이라 빼면 하나씩 센다
+        __m256i finer = _mm256_setzero_si256();
+        __m256i coarser = _mm256_setzero_si256();
+        for (uint32_t lod = 1; lod < lodCount; lod++)
+        {
+            __m256 finerDistance = _mm256_mul_ps(_mm256_set1_ps(thresholds.finer[lod]), scale);
+            __m256 coarserDistance = _mm256_mul_ps(_mm256_set1_ps(thresholds.coarser[lod]), scale);
+            finer = _mm256_sub_epi32(finer, _mm256_castps_si256(_mm256_cmp_ps(distance, finerDistance, _CMP_GE_OQ)));
+            coarser = _mm256_sub_epi32(coarser, _mm256_castps_si256(_mm256_cmp_ps(distance, coarserDistance, _CMP_GE_OQ)));
+        }
+
+        __m256i previous = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&lods[i])));
+        __m256i tooCoarse = _mm256_cmpgt_epi32(previous, finer);
+        __m256i next = _mm256_blendv_epi8(_mm256_max_epu32(previous, coarser), finer, tooCoarse);
+
+        // 32비트 8개를 바이트 8개로 줄인다. 값이 MaxLods보다 작아서 포화되지 않는다
+        __m128i packed = _mm_packus_epi32(_mm256_castsi256_si128(next), _mm256_extracti128_si256(next, 1));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(&lods[i]), _mm_packus_epi16(packed, _mm_setzero_si128()));
+    }
+
+    SelectRangeScalar(instances, camera, thresholds, lods, i, end);
+}
+#else
+void LodSelector::SelectRangeAvx2(const LodInstances& instances, const LodCamera& camera, const Thresholds& thresholds, uint8_t* lods, uint32_t begin, uint32_t end) const
+{
+    SelectRangeScalar(instances, camera, thresholds, lods, begin, end);
+}
+#endif
@@ -0,0 +1,76 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Executor.h"
+#include "MeshAsset.h"
+#include "Task.h"
+
+// 같은 메시를 쓰는 인스턴스들. SIMD로 8개씩 읽도록 성분별로 나눠 둔다
+struct LodInstances
+{
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+    std::vector<float> scale;
+
+    uint32_t GetCount() const { return static_cast<uint32_t>(x.size()); }
+    void Resize(uint32_t count);
+};
+
+struct LodCamera
+{
+    float x, y, z;
+    float projectionScale; // 거리 1에서 길이 1이 몇 픽셀인지. 화면 높이 / (2 * tan(fovY / 2))
+    float pixelThreshold;  // 이 픽셀 수보다 작게 보이는 오차는 눈에 띄지 않는다고 본다
+    float hysteresis;      // 거칠게 바꿀때만 문턱을 이 비율만큼 더 엄하게 한다. 경계에서 LOD가 매 프레임 바뀌지 않게 한다. 0 ~ LodSelector::MaxHysteresis로 자른다
+};
+
+enum class LodSimdPath
+{
+    Scalar,
+    Avx2,
+};
+
+// 화면에 보이는 오차 크기로 인스턴스마다 LOD를 고른다
+// 오차 e인 LOD가 거리 d에서 e * scale * projectionScale / d 픽셀로 보이므로, 이 값이 문턱 이하인 가장 거친 LOD를 쓴다
+// 거리는 경계 구 표면까지로 재서 카메라가 구 안에 있으면 항상 LOD 0이 된다
+class LodSelector
+{
+public:
+    static const uint32_t ChunkSize = 16384; // 워커 하나가 맡는 인스턴스 수
+    static constexpr float MaxHysteresis = 0.9f; // 거친 문턱이 고운 문턱의 10배까지. 1이면 문턱이 무한대가 되어 거칠게 바꾸지 못한다
+
+private:
+    uint32_t lodCount;
+    float lodErrors[MeshAsset::MaxLods];
+    float boundsRadius;
+    LodSimdPath simdPath;
+
+    // Select 한 번 동안만 쓰는 값
+    struct Thresholds
+    {
+        float finer[MeshAsset::MaxLods];   // 이 거리보다 가까우면 그 LOD는 너무 거칠다
+        float coarser[MeshAsset::MaxLods]; // 이 거리보다 멀어야 그 LOD로 내려간다
+    };
+
+public:
+    LodSelector();
+
+    void SetMesh(const MeshAsset& asset);
+    uint32_t GetLodCount() const { return lodCount; }
+
+    // AVX2가 없는 CPU에서는 Avx2를 골라도 Scalar가 된다
+    void SetSimdPath(LodSimdPath path);
+    LodSimdPath GetSimdPath() const { return simdPath; }
+
+    // lods는 인스턴스마다 지난 프레임 LOD를 넣어두면 이번 LOD로 바뀐다. 처음에는 0으로 채운다
+    // executor가 있으면 ChunkSize씩 나눠서 워커들이 같이 고른다
+    void Select(const LodInstances& instances, const LodCamera& camera, uint8_t* lods, Executor* executor = nullptr) const;
+
+private:
+    Thresholds MakeThresholds(const LodCamera& camera) const;
+    Task<void> SelectRangeAsync(Executor& executor, const LodInstances& instances, const LodCamera& camera, const Thresholds& thresholds, uint8_t* lods, uint32_t begin, uint32_t end) const;
+    void SelectRange(const LodInstances& instances, const LodCamera& camera, const Thresholds& thresholds, uint8_t* lods, uint32_t begin, uint32_t end) const;
+    void SelectRangeScalar(const LodInstances& instances, const LodCamera& camera, const Thresholds& thresholds, uint8_t* lods, uint32_t begin, uint32_t end) const;
+    void SelectRangeAvx2(const LodInstances& instances, const LodCamera& camera, const Thresholds& thresholds, uint8_t* lods, uint32_t begin, uint32_t end) const;
+};
@@ -0,0 +1,326 @@
+#include "MeshAsset.h"
+#include "MeshSimplifier.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+using namespace std;
+using namespace std::filesystem;
+
+namespace
+{
+    // 파일 형식이 바뀌면 올린다
+    const uint32_t MeshAssetVersion = 1;
+
+    const float Pi = 3.14159265f;
+
+    struct MeshAssetHeader
+    {
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        uint32_t lodCount;
+        float boundsCenter[3];
+        float boundsRadius;
+    };
+
+    bool IsValidSource(const MeshSource& source)
+    {
+        if (source.positions.empty() || source.positions.size() % 3 != 0 || source.indices.empty() || source.indices.size() % 3 != 0)
+            return false;
+
+        uint32_t vertexCount = static_cast<uint32_t>(source.positions.size() / 3);
+        return all_of(source.indices.begin(), source.indices.end(), [vertexCount](uint32_t index) { return index < vertexCount; });
+    }
+
+    void ComputeBounds(const vector<float>& positions, float center[3], float& radius)
+    {
+        float minCorner[3] = { positions[0], positions[1], positions[2] };
+        float maxCorner[3] = { positions[0], positions[1], positions[2] };
+        for (size_t i = 0; i < positions.size(); i += 3)
+        {
+            for (uint32_t axis = 0; axis < 3; axis++)
+            {
+                minCorner[axis] = min(minCorner[axis], positions[i + axis]);
+                maxCorner[axis] = max(maxCorner[axis], positions[i + axis]);
+            }
+        }
+
+        for (uint32_t axis = 0; axis < 3; axis++)
+            center[axis] = (minCorner[axis] + maxCorner[axis]) * 0.5f;
+
+        float radiusSq = 0.0f;
+        for (size_t i = 0; i < positions.size(); i += 3)
+        {
+            float dx = positions[i] - center[0];
+            float dy = positions[i + 1] - center[1];
+            float dz = positions[i + 2] - center[2];
+            radiusSq = max(radiusSq, dx * dx + dy * dy + dz * dz);
+        }
+        radius = sqrtf(radiusSq);
+    }
+
+    // rows x columns 격자를 삼각형 두 개씩으로 잇는다. 열이 감기면 마지막 열이 첫 열과 이어진다
+    void AddGridIndices(vector<uint32_t>& indices, uint32_t firstVertex, uint32_t rows, uint32_t columns, uint32_t rowStride, bool wrapColumns)
+    {
+        uint32_t quadColumns = wrapColumns ? columns : columns - 1;
+        for (uint32_t row = 0; row + 1 < rows; row++)
+        {
+            for (uint32_t column = 0; column < quadColumns; column++)
+            {
+                uint32_t nextColumn = (column + 1) % columns;
+                uint32_t a = firstVertex + row * rowStride + column;
+                uint32_t b = firstVertex + row * rowStride + nextColumn;
+                uint32_t c = firstVertex + (row + 1) * rowStride + column;
+                uint32_t d = firstVertex + (row + 1) * rowStride + nextColumn;
+                indices.insert(indices.end(), { a, b, c, b, d, c });
+            }
+        }
+    }
+}
+
+bool BuildMeshAsset(const MeshSource& source, const LodChainDesc& desc, MeshAsset& asset)
+{
+    if (!IsValidSource(source))
+        return false;
+
+    asset.positions = source.positions;
+    asset.indices = source.indices;
+    asset.lods.clear();
+    asset.lods.push_back({ 0, static_cast<uint32_t>(source.indices.size()), 0.0f });
+    ComputeBounds(asset.positions, asset.boundsCenter, asset.boundsRadius);
+
+    uint32_t vertexCount = static_cast<uint32_t>(asset.positions.size() / 3);
+    uint32_t maxLods = min(desc.maxLods, MeshAsset::MaxLods);
+    float maxError = desc.maxRelativeError * asset.boundsRadius;
+    float error = 0.0f;
+
+    vector<uint32_t> previous = source.indices;
+    vector<uint32_t> next;
+    while (asset.lods.size() < maxLods)
+    {
+        uint32_t targetTriangles = static_cast<uint32_t>(previous.size() / 3 * desc.reduction);
+        if (targetTriangles < desc.minTriangles)
+            break;
+
+        float stepError = SimplifyMesh(asset.positions.data(), vertexCount, previous.data(), static_cast<uint32_t>(previous.size()),
+            targetTriangles * 3, maxError - error, next);
+
+        // 오차 한도나 뒤집힘 검사에 막혀 10%도 못 줄였으면 더 만들어도 의미가 없다
+        if (next.empty() || next.size() * 10 > previous.size() * 9)
+            break;
+
+        error += stepError;
+        asset.lods.push_back({ static_cast<uint32_t>(asset.indices.size()), static_cast<uint32_t>(next.size()), error });
+        asset.indices.insert(asset.indices.end(), next.begin(), next.end());
+        previous.swap(next);
+    }
+
+    return true;
+}
+
+Task<bool> BuildMeshAssetAsync(Executor& executor, const MeshSource& source, const LodChainDesc& desc, MeshAsset& asset)
+{
+    co_await executor.Schedule();
+
+    co_return BuildMeshAsset(source, desc, asset);
+}
+
+bool LoadMeshAsset(const path& assetPath, MeshAsset& asset)
+{
+    ifstream file(assetPath, ios::binary);
+    if (!file)
+        return false;
+
+    uint32_t version = 0;
+    if (!file.read(reinterpret_cast<char*>(&version), sizeof(version)) || version != MeshAssetVersion)
+        return false;
+
+    MeshAssetHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+        return false;
+
+    if (header.vertexCount == 0 || header.lodCount == 0 || header.lodCount > MeshAsset::MaxLods)
+        return false;
+
+    asset.positions.resize(static_cast<size_t>(header.vertexCount) * 3);
+    asset.indices.resize(header.indexCount);
+    asset.lods.resize(header.lodCount);
+    copy(begin(header.boundsCenter), end(header.boundsCenter), asset.boundsCenter);
+    asset.boundsRadius = header.boundsRadius;
+
+    file.read(reinterpret_cast<char*>(asset.positions.data()), asset.positions.size() * sizeof(float));
+    file.read(reinterpret_cast<char*>(asset.indices.data()), asset.indices.size() * sizeof(uint32_t));
+    file.read(reinterpret_cast<char*>(asset.lods.data()), asset.lods.size() * sizeof(MeshLod));
+    if (!file)
+        return false;
+
+    // 잘린 파일이나 다른 형식이 범위 밖을 가리키지 않는지 확인한다
+    for (const MeshLod& lod : asset.lods)
+        if (lod.indexCount % 3 != 0 || lod.indexOffset > header.indexCount || lod.indexCount > header.indexCount - lod.indexOffset)
+            return false;
+
+    return all_of(asset.indices.begin(), asset.indices.end(), [&header](uint32_t index) { return index < header.vertexCount; });
+}
+
+bool SaveMeshAsset(const path& assetPath, const MeshAsset& asset)
+{
+    ofstream file(assetPath, ios::binary | ios::trunc);
+    if (!file)
+        return false;
+
+    MeshAssetHeader header;
+    header.vertexCount = static_cast<uint32_t>(asset.positions.size() / 3);
+    header.indexCount = static_cast<uint32_t>(asset.indices.size());
+    header.lodCount = static_cast<uint32_t>(asset.lods.size());
+    copy(begin(asset.boundsCenter), end(asset.boundsCenter), header.boundsCenter);
+    header.boundsRadius = asset.boundsRadius;
+
+    file.write(reinterpret_cast<const char*>(&MeshAssetVersion), sizeof(MeshAssetVersion));
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(asset.positions.data()), asset.positions.size() * sizeof(float));
+    file.write(reinterpret_cast<const char*>(asset.indices.data()), asset.indices.size() * sizeof(uint32_t));
+    file.write(reinterpret_cast<const char*>(asset.lods.data()), asset.lods.size() * sizeof(MeshLod));
+    return static_cast<bool>(file);
+}
+
+Task<bool> LoadOrBuildMeshAssetsAsync(Executor& executor, path directory, const vector<MeshSource>& sources, vector<MeshAsset>& assets, vector<bool>& built)
+{
+    co_await executor.Schedule();
+
+    error_code ec;
+    create_directories(directory, ec);
+    if (ec)
+        co_return false;
+
+    assets.resize(sources.size());
+    built.assign(sources.size(), false);
+
+    // 태스크가 참조로 받으므로 desc는 기다리는 동안 살아 있어야 한다
+    LodChainDesc lodChainDesc;
+    vector<Task<bool>> buildTasks;
+    vector<size_t> builtMeshes;
+    for (size_t i = 0; i < sources.size(); i++)
+    {
+        if (LoadMeshAsset(directory / (sources[i].name + ".mesh"), assets[i]))
+            continue;
+
+        buildTasks.push_back(BuildMeshAssetAsync(executor, sources[i], lodChainDesc, assets[i]));
+        builtMeshes.push_back(i);
+    }
+
+    vector<bool> results = co_await WhenAll(move(buildTasks));
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        if (!results[i])
+            co_return false;
+
+        // 저장에 실패해도 이번 실행에는 지장이 없다. 다음 시작에서 다시 만든다
+        SaveMeshAsset(directory / (sources[builtMeshes[i]].name + ".mesh"), assets[builtMeshes[i]]);
+        built[builtMeshes[i]] = true;
+    }
+
+    co_return true;
+}
+
+string FormatLodReport(const string& name, const MeshAsset& asset)
+{
+    string report = "Mesh " + name + ": " + to_string(asset.positions.size() / 3) + " vertices, radius " + to_string(asset.boundsRadius) + "\n";
+    for (size_t i = 0; i < asset.lods.size(); i++)
+    {
+        const MeshLod& lod = asset.lods[i];
+        char line[128];
+        snprintf(line, sizeof(line), "  LOD %zu: %7u triangles  error %.5f (%.3f%% of radius)\n",
+            i, lod.indexCount / 3, lod.error, asset.boundsRadius > 0.0f ? lod.error / asset.boundsRadius * 100.0f : 0.0f);
+        report += line;
+    }
+    return report;
+}
+
+MeshSource MakeBumpyTorus(uint32_t rings, uint32_t sides)
+{
+    const float majorRadius = 1.0f;
+    const float minorRadius = 0.35f;
+
+    MeshSource source;
+    source.name = "torus";
+    for (uint32_t ring = 0; ring < rings; ring++)
+    {
+        float u = 2.0f * Pi * ring / rings;
+        for (uint32_t side = 0; side < sides; side++)
+        {
+            float v = 2.0f * Pi * side / sides;
+            float r = minorRadius * (1.0f + 0.2f * sinf(6.0f * u) * sinf(4.0f * v));
+            source.positions.insert(source.positions.end(), { (majorRadius + r * cosf(v)) * cosf(u), r * sinf(v), (majorRadius + r * cosf(v)) * sinf(u) });
+        }
+    }
+
+    // 고리 방향도 감기므로 마지막 고리 뒤에 첫 고리를 한 번 더 잇는다
+    AddGridIndices(source.indices, 0, rings, sides, sides, true);
+    for (uint32_t side = 0; side < sides; side++)
+    {
+        uint32_t nextSide = (side + 1) % sides;
+        uint32_t a = (rings - 1) * sides + side;
+        uint32_t b = (rings - 1) * sides + nextSide;
+        source.indices.insert(source.indices.end(), { a, b, side, b, nextSide, side });
+    }
+    return source;
+}
+
+MeshSource MakeSphere(uint32_t rings, uint32_t segments)
+{
+    MeshSource source;
+    source.name = "sphere";
+
+    // 극은 정점 하나씩 두고, 그 사이 위도 줄마다 segments개
+    source.positions.insert(source.positions.end(), { 0.0f, 1.0f, 0.0f });
+    for (uint32_t ring = 1; ring < rings; ring++)
+    {
+        float theta = Pi * ring / rings;
+        for (uint32_t segment = 0; segment < segments; segment++)
+        {
+            float phi = 2.0f * Pi * segment / segments;
+            source.positions.insert(source.positions.end(), { sinf(theta) * cosf(phi), cosf(theta), sinf(theta) * sinf(phi) });
+        }
+    }
+    uint32_t southPole = static_cast<uint32_t>(source.positions.size() / 3);
+    source.positions.insert(source.positions.end(), { 0.0f, -1.0f, 0.0f });
+
+    for (uint32_t segment = 0; segment < segments; segment++)
+        source.indices.insert(source.indices.end(), { 0, 1 + (segment + 1) % segments, 1 + segment });
+
+    AddGridIndices(source.indices, 1, rings - 1, segments, segments, true);
+
+    uint32_t lastRing = 1 + (rings - 2) * segments;
+    for (uint32_t segment = 0; segment < segments; segment++)
+        source.indices.insert(source.indices.end(), { southPole, lastRing + segment, lastRing + (segment + 1) % segments });
+    return source;
+}
+
+MeshSource MakeTerrainPatch(uint32_t cells)
+{
+    MeshSource source;
+    source.name = "terrain";
+    for (uint32_t row = 0; row <= cells; row++)
+    {
+        float z = -1.0f + 2.0f * row / cells;
+        for (uint32_t column = 0; column <= cells; column++)
+        {
+            float x = -1.0f + 2.0f * column / cells;
+            float y = 0.15f * (sinf(3.0f * x) * cosf(4.0f * z) + 0.5f * sinf(7.0f * x + 2.0f * z));
+            source.positions.insert(source.positions.end(), { x, y, z });
+        }
+    }
+
+    AddGridIndices(source.indices, 0, cells + 1, cells + 1, cells + 1, false);
+    return source;
+}
+
+vector<MeshSource> MakeSceneMeshSources()
+{
+    vector<MeshSource> sources;
+    sources.push_back(MakeBumpyTorus(96, 48));
+    sources.push_back(MakeSphere(64, 128));
+    sources.push_back(MakeTerrainPatch(128));
+    return sources;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "Executor.h"
+#include "Task.h"
+
+// 에셋을 만들때 한 번 단순화해서 저장해두는 LOD 묶음
+// 모든 LOD가 정점 버퍼 하나를 같이 쓰고, 인덱스만 LOD 0부터 차례로 이어 붙여 둔다
+struct MeshLod
+{
+    uint32_t indexOffset;
+    uint32_t indexCount;
+    float error; // LOD 0 표면에서 벗어난 거리의 추정치. 메시 좌표 단위이고 LOD 0은 0
+};
+
+struct MeshAsset
+{
+    static const uint32_t MaxLods = 8;
+
+    std::vector<float> positions; // 정점마다 xyz
+    std::vector<uint32_t> indices;
+    std::vector<MeshLod> lods;    // 삼각형이 줄어드는 순서. error도 커지는 순서다
+
+    // LOD를 고를때 쓰는 경계 구
+    float boundsCenter[3];
+    float boundsRadius;
+};
+
+// 단순화하기 전 메시
+struct MeshSource
+{
+    std::string name;
+    std::vector<float> positions;
+    std::vector<uint32_t> indices;
+};
+
+struct LodChainDesc
+{
+    uint32_t maxLods = MeshAsset::MaxLods;
+    float reduction = 0.5f;       // LOD마다 이전 LOD 삼각형 수에 곱할 비율
+    float maxRelativeError = 0.1f; // 경계 구 반지름에 대한 비율. 이보다 많이 망가지는 LOD는 만들지 않는다
+    uint32_t minTriangles = 32;
+};
+
+// 이전 LOD를 줄여서 다음 LOD를 만든다. 오차는 단계마다 더해서 LOD 0 기준의 상한으로 쌓는다
+// 삼각형이 거의 줄지 않거나 오차가 한도에 닿으면 거기서 멈춘다
+bool BuildMeshAsset(const MeshSource& source, const LodChainDesc& desc, MeshAsset& asset);
+
+// 워커 스레드에서 BuildMeshAsset을 한다. 메시마다 하나씩 만들어 WhenAll로 기다리면 메시끼리 병렬로 줄인다
+Task<bool> BuildMeshAssetAsync(Executor& executor, const MeshSource& source, const LodChainDesc& desc, MeshAsset& asset);
+
+bool LoadMeshAsset(const std::filesystem::path& assetPath, MeshAsset& asset);
+bool SaveMeshAsset(const std::filesystem::path& assetPath, const MeshAsset& asset);
+
+// directory에 저장해둔 에셋을 읽고, 파일이 없거나 형식 버전이 바뀐 메시만 단순화해서 저장한다
+// 메시마다 워커 하나씩 맡아서 동시에 단순화한다. built[i]는 이번에 단순화한 메시인지
+// directory는 임시 경로를 넘겨도 되도록 값으로 받는다. sources와 결과는 끝날때까지 살아 있어야 한다
+Task<bool> LoadOrBuildMeshAssetsAsync(Executor& executor, std::filesystem::path directory, const std::vector<MeshSource>& sources, std::vector<MeshAsset>& assets, std::vector<bool>& built);
+
+// LOD마다 삼각형 수와 오차를 한 줄씩 적는다 (오차 대 삼각형 수 곡선)
+std::string FormatLodReport(const std::string& name, const MeshAsset& asset);
+
+// 에셋 파일이 없을때 쓰는 절차적 메시들
+// 울퉁불퉁한 토러스(닫힌 곡면), 구, 가장자리가 열린 지형 조각
+MeshSource MakeBumpyTorus(uint32_t rings, uint32_t sides);
+MeshSource MakeSphere(uint32_t rings, uint32_t segments);
+MeshSource MakeTerrainPatch(uint32_t cells);
+
+// MyWindow가 LOD 선택과 가림 컬링에 쓰는 메시들. 0번이 LOD 인스턴스로 그리는 메시다
+std::vector<MeshSource> MakeSceneMeshSources();
@@ -0,0 +1,324 @@
+#include "MeshSimplifier.h"
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <unordered_map>
+
+using namespace std;
+
+namespace
+{
+    // 열린 가장자리 평면의 가중치. 가장자리 정점이 안쪽으로 끌려가지 않을 만큼 크게 준다
+    const double BoundaryWeight = 10.0;
+
+    // 접은 뒤 삼각형 법선이 접기 전과 이 cos보다 벌어지면 뒤집힌 것으로 본다
+    const double FlipCosine = 0.05;
+
+    // 대칭 4x4 행렬의 위쪽 삼각형 10개와, 오차를 거리로 바꿀때 나눌 가중치 합
+    struct Quadric
+    {
+        double a2, ab, ac, ad;
+        double b2, bc, bd;
+        double c2, cd;
+        double d2;
+        double weight;
+
+        void AddPlane(double a, double b, double c, double d, double w)
+        {
+            a2 += w * a * a; ab += w * a * b; ac += w * a * c; ad += w * a * d;
+            b2 += w * b * b; bc += w * b * c; bd += w * b * d;
+            c2 += w * c * c; cd += w * c * d;
+            d2 += w * d * d;
+            weight += w;
+        }
+
+        void Add(const Quadric& other)
+        {
+            a2 += other.a2; ab += other.ab; ac += other.ac; ad += other.ad;
+            b2 += other.b2; bc += other.bc; bd += other.bd;
+            c2 += other.c2; cd += other.cd;
+            d2 += other.d2;
+            weight += other.weight;
+        }
+
+        // 평면들까지 거리 제곱의 가중 합
+        double Evaluate(double x, double y, double z) const
+        {
+            return a2 * x * x + 2.0 * ab * x * y + 2.0 * ac * x * z + 2.0 * ad * x
+                + b2 * y * y + 2.0 * bc * y * z + 2.0 * bd * y
+                + c2 * z * z + 2.0 * cd * z
+                + d2;
+        }
+    };
+
+    struct Vector3
+    {
+        double x, y, z;
+    };
+
+    Vector3 Subtract(const Vector3& a, const Vector3& b)
+    {
+        return { a.x - b.x, a.y - b.y, a.z - b.z };
+    }
+
+    Vector3 Cross(const Vector3& a, const Vector3& b)
+    {
+        return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+    }
+
+    double Dot(const Vector3& a, const Vector3& b)
+    {
+        return a.x * b.x + a.y * b.y + a.z * b.z;
+    }
+
+    double Length(const Vector3& v)
+    {
+        return sqrt(Dot(v, v));
+    }
+
+    // from을 to로 접는 후보. 정점 버전이 꺼낼때와 다르면 그 사이에 바뀐 것이라 버린다
+    struct Collapse
+    {
+        double error;
+        uint32_t from;
+        uint32_t to;
+        uint32_t fromVersion;
+        uint32_t toVersion;
+
+        bool operator>(const Collapse& other) const { return error > other.error; }
+    };
+
+    class Simplifier
+    {
+        vector<Vector3> positions;
+        vector<uint32_t> triangles;
+        vector<bool> triangleRemoved;
+        vector<vector<uint32_t>> vertexTriangles;
+        vector<Quadric> quadrics;
+        vector<uint32_t> versions;
+        vector<bool> vertexRemoved;
+        priority_queue<Collapse, vector<Collapse>, greater<Collapse>> heap;
+        uint32_t liveTriangleCount;
+
+    public:
+        Simplifier(const float* positions, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount)
+            : positions(vertexCount), triangles(indices, indices + indexCount), triangleRemoved(indexCount / 3, false),
+              vertexTriangles(vertexCount), quadrics(vertexCount, Quadric{}), versions(vertexCount, 0), vertexRemoved(vertexCount, false),
+              liveTriangleCount(indexCount / 3)
+        {
+            for (uint32_t i = 0; i < vertexCount; i++)
+                this->positions[i] = { positions[i * 3], positions[i * 3 + 1], positions[i * 3 + 2] };
+
+            for (uint32_t t = 0; t < liveTriangleCount; t++)
+            {
+                // 이미 한 점으로 뭉친 삼각형은 처음부터 뺀다
+                const uint32_t* v = &triangles[t * 3];
+                if (v[0] == v[1] || v[1] == v[2] || v[2] == v[0])
+                {
+                    triangleRemoved[t] = true;
+                    continue;
+                }
+                for (uint32_t k = 0; k < 3; k++)
+                    vertexTriangles[v[k]].push_back(t);
+            }
+            liveTriangleCount = static_cast<uint32_t>(count(triangleRemoved.begin(), triangleRemoved.end(), false));
+
+            BuildQuadrics();
+            for (uint32_t v = 0; v < vertexCount; v++)
+                PushCollapses(v, true);
+        }
+
+        float Run(uint32_t targetTriangleCount, float maxError)
+        {
+            double reachedError = 0.0;
+            while (liveTriangleCount > targetTriangleCount && !heap.empty())
+            {
+                Collapse collapse = heap.top();
+                if (collapse.error > maxError)
+                    break;
+                heap.pop();
+
+                if (vertexRemoved[collapse.from] || vertexRemoved[collapse.to] ||
+                    versions[collapse.from] != collapse.fromVersion || versions[collapse.to] != collapse.toVersion)
+                    continue;
+
+                if (FlipsTriangle(collapse.from, collapse.to))
+                    continue;
+
+                Apply(collapse.from, collapse.to);
+                reachedError = max(reachedError, collapse.error);
+            }
+            return static_cast<float>(reachedError);
+        }
+
+        void GetIndices(vector<uint32_t>& result) const
+        {
+            result.clear();
+            result.reserve(static_cast<size_t>(liveTriangleCount) * 3);
+            for (uint32_t t = 0; t < triangleRemoved.size(); t++)
+                if (!triangleRemoved[t])
+                    result.insert(result.end(), &triangles[t * 3], &triangles[t * 3] + 3);
+        }
+
+    private:
+        Vector3 GetNormal(uint32_t a, uint32_t b, uint32_t c) const
+        {
+            return Cross(Subtract(positions[b], positions[a]), Subtract(positions[c], positions[a]));
+        }
+
+        void BuildQuadrics()
+        {
+            // 면마다 평면을 면적 가중치로 세 정점에 더한다
+            // 한 삼각형에만 쓰인 엣지는 열린 가장자리라서 그 엣지를 지나고 면에 수직인 평면도 더한다
+            unordered_map<uint64_t, uint32_t> edgeUses;
+            edgeUses.reserve(triangles.size());
+            auto edgeKey = [](uint32_t a, uint32_t b) { return (static_cast<uint64_t>(min(a, b)) << 32) | max(a, b); };
+
+            for (uint32_t t = 0; t < triangleRemoved.size(); t++)
+                if (!triangleRemoved[t])
+                    for (uint32_t k = 0; k < 3; k++)
+                        edgeUses[edgeKey(triangles[t * 3 + k], triangles[t * 3 + (k + 1) % 3])]++;
+
+            for (uint32_t t = 0; t < triangleRemoved.size(); t++)
+            {
+                if (triangleRemoved[t])
+                    continue;
+
+                const uint32_t* v = &triangles[t * 3];
+                Vector3 normal = GetNormal(v[0], v[1], v[2]);
+                double doubleArea = Length(normal);
+                if (doubleArea <= 0.0)
+                    continue;
+
+                normal = { normal.x / doubleArea, normal.y / doubleArea, normal.z / doubleArea };
+                double d = -Dot(normal, positions[v[0]]);
+                for (uint32_t k = 0; k < 3; k++)
+                    quadrics[v[k]].AddPlane(normal.x, normal.y, normal.z, d, doubleArea * 0.5);
+
+                for (uint32_t k = 0; k < 3; k++)
+                {
+                    uint32_t a = v[k];
+                    uint32_t b = v[(k + 1) % 3];
+                    if (edgeUses[edgeKey(a, b)] != 1)
+                        continue;
+
+                    Vector3 edge = Subtract(positions[b], positions[a]);
+                    Vector3 side = Cross(edge, normal);
+                    double sideLength = Length(side);
+                    if (sideLength <= 0.0)
+                        continue;
+
+                    side = { side.x / sideLength, side.y / sideLength, side.z / sideLength };
+                    double sideD = -Dot(side, positions[a]);
+                    double w = BoundaryWeight * Dot(edge, edge);
+                    quadrics[a].AddPlane(side.x, side.y, side.z, sideD, w);
+                    quadrics[b].AddPlane(side.x, side.y, side.z, sideD, w);
+                }
+            }
+        }
+
+        double GetCollapseError(uint32_t from, uint32_t to) const
+        {
+            Quadric q = quadrics[from];
+            q.Add(quadrics[to]);
+            if (q.weight <= 0.0)
+                return 0.0;
+
+            const Vector3& p = positions[to];
+            return sqrt(max(q.Evaluate(p.x, p.y, p.z), 0.0) / q.weight);
+        }
+
+        // v와 엣지로 이어진 정점마다 두 방향 중 오차가 작은 쪽을 후보로 넣는다
+        // 처음 채울때는 엣지를 양 끝에서 두 번 보게 되므로 번호가 큰 이웃만 넣는다
+        void PushCollapses(uint32_t v, bool higherNeighborsOnly = false)
+        {
+            for (uint32_t t : vertexTriangles[v])
+            {
+                if (triangleRemoved[t])
+                    continue;
+
+                for (uint32_t k = 0; k < 3; k++)
+                {
+                    uint32_t w = triangles[t * 3 + k];
+                    if (w == v || (higherNeighborsOnly && w < v))
+                        continue;
+
+                    double toW = GetCollapseError(v, w);
+                    double toV = GetCollapseError(w, v);
+                    if (toW <= toV)
+                        heap.push({ toW, v, w, versions[v], versions[w] });
+                    else
+                        heap.push({ toV, w, v, versions[w], versions[v] });
+                }
+            }
+        }
+
+        // from을 to로 옮겼을때 from에 붙은 삼각형 중 뒤집히거나 납작해지는 것이 있는지
+        bool FlipsTriangle(uint32_t from, uint32_t to) const
+        {
+            for (uint32_t t : vertexTriangles[from])
+            {
+                if (triangleRemoved[t])
+                    continue;
+
+                const uint32_t* v = &triangles[t * 3];
+                if (v[0] == to || v[1] == to || v[2] == to)
+                    continue; // 접히면서 사라진다
+
+                uint32_t moved[3] = { v[0], v[1], v[2] };
+                for (uint32_t k = 0; k < 3; k++)
+                    if (moved[k] == from)
+                        moved[k] = to;
+
+                // 거의 직각으로 꺾이는 것도 막는다. 면적이 0이 되는 경우도 여기서 걸린다
+                Vector3 before = GetNormal(v[0], v[1], v[2]);
+                Vector3 after = GetNormal(moved[0], moved[1], moved[2]);
+                if (Dot(before, after) <= FlipCosine * Length(before) * Length(after))
+                    return true;
+            }
+            return false;
+        }
+
+        void Apply(uint32_t from, uint32_t to)
+        {
+            for (uint32_t t : vertexTriangles[from])
+            {
+                if (triangleRemoved[t])
+                    continue;
+
+                uint32_t* v = &triangles[t * 3];
+                if (v[0] == to || v[1] == to || v[2] == to)
+                {
+                    triangleRemoved[t] = true;
+                    liveTriangleCount--;
+                    continue;
+                }
+
+                for (uint32_t k = 0; k < 3; k++)
+                    if (v[k] == from)
+                        v[k] = to;
+                vertexTriangles[to].push_back(t);
+            }
+
+            // 지워진 삼각형 번호는 목록에서 빼둔다. 안 그러면 많이 접힌 정점의 목록이 계속 길어진다
+            auto& toTriangles = vertexTriangles[to];
+            toTriangles.erase(remove_if(toTriangles.begin(), toTriangles.end(), [this](uint32_t t) { return triangleRemoved[t]; }), toTriangles.end());
+
+            vector<uint32_t>().swap(vertexTriangles[from]);
+            vertexRemoved[from] = true;
+            quadrics[to].Add(quadrics[from]);
+
+            versions[to]++;
+            PushCollapses(to);
+        }
+    };
+}
+
+float SimplifyMesh(const float* positions, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount,
+    uint32_t targetIndexCount, float maxError, vector<uint32_t>& result)
+{
+    Simplifier simplifier(positions, vertexCount, indices, indexCount - indexCount % 3);
+    float error = simplifier.Run(targetIndexCount / 3, maxError);
+    simplifier.GetIndices(result);
+    return error;
+}
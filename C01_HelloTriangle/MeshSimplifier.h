@@ -0,0 +1,14 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// quadric error metric(Garland-Heckbert) 엣지 접기로 삼각형 수를 줄인다
+// 정점은 옮기지 않고 엣지를 한쪽 끝점으로 접기만 하므로, 결과 인덱스는 원래 정점 버퍼를 그대로 가리킨다
+// 그래서 한 메시의 LOD들이 정점 버퍼 하나를 같이 쓴다
+// 열린 가장자리는 면에 수직인 평면을 quadric에 더해서 안쪽으로 말려들지 않게 한다
+
+// positions는 정점마다 xyz 3개. indexCount는 3의 배수
+// 인덱스 수가 targetIndexCount 이하가 되거나, 다음 접기의 오차가 maxError를 넘으면 멈춘다
+// 반환값은 실제로 한 접기 중 가장 큰 오차 (원래 면들에서의 면적 가중 RMS 거리, 위치와 같은 단위)
+float SimplifyMesh(const float* positions, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount,
+    uint32_t targetIndexCount, float maxError, std::vector<uint32_t>& result);
@@ -1,29 +1,168 @@
 #include "MyWindow.h"
 #include <winrt/base.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
 #include <filesystem>
 #include <d3dcompiler.h>
 #include <DirectXMath.h>
+#include "AdapterCache.h"
+#include "AllocationTracker.h"
+#include "CommandStream.h"
+#include "ShaderCompiler.h"
+#include "StartupGraph.h"
 
 using namespace winrt;
 using namespace std;
 using namespace std::filesystem;
 using namespace DirectX;
 
+// FrameGraph에서 패스 사이의 의존성을 추적하는 리소스들
+// 프레임 사이에 따로 쓰는 버퍼는 번호를 나눠서, 다음 프레임 compute가 앞 프레임 그래픽스를 기다리지 않게 한다
+enum : ResourceId
+{
+    BackBufferResource,
+    ParticleResource,                                                    // 파티클 핑퐁 버퍼 번호를 더한다
+    SurfaceResource = ParticleResource + 2,                              // 추가 창 백 버퍼. 여기에 창 번호를 더한다
+    LightClusterResource = SurfaceResource + D3D12SurfaceBackend::MaxSurfaces, // 프레임 슬롯을 더한다
+};
+
+// 커맨드 캡처에서 오브젝트를 가리키는 번호. 캡처를 재생하는 쪽도 같은 번호로 등록한다
+enum : CommandObjectId
+{
+    VertexBufferObject,
+    TrianglePipelineObject,
+    TriangleRootSignatureObject,
+    BackBufferObject, // 여기에 백 버퍼 인덱스를 더한다. 리소스와 RTV가 같은 번호를 쓴다
+};
+
 struct Vertex
 {
     XMFLOAT3 position;
     XMFLOAT4 color;
 };
 
+// 회전하기 전의 삼각형. y에는 OnUpdate에서 aspectRatio를 곱한다
+const Vertex baseTriangleVertices[] =
+{
+    {{ 0.0f, 0.25f, 0.0f }, { 1.0f, 0.0f, 0.0f, 1.0f } },
+    {{ 0.25f, -0.25f, 0.0f }, { 0.0f, 1.0f, 0.0f, 1.0f } },
+    {{ -0.25f, -0.25f, 0.0f }, { 0.0f, 0.0f, 1.0f, 1.0f } },
+};
+
+// 프레임이 오래 멈췄다가 돌아왔을때 파티클이 한번에 튀지 않게 한다
+const float MaxParticleDeltaTime = 1.0f / 20.0f;
+
+// F8을 누르면 이만큼 프레임의 커맨드를 파일로 남긴다. 기록하는 동안 스트림이 힙에서 자라지 않게 미리 잡아둔다
+const uint32_t CommandCaptureFrames = 120;
+const size_t CommandCaptureReserveBytes = 1 << 20;
+
+// 처음 F8 캡처를 여기 남기고, 그 뒤 캡처는 이것과 명령 단위로 비교한다. 바뀐 것이 맞으면 지우고 다시 캡처한다
+const char* const CommandReferenceCaptureName = "commands_reference.cmds";
+
+// F7로 여는 추가 창 크기. 주 창과 비율이 같아서 공유 버텍스 버퍼를 그대로 그린다
+const uint32_t SurfaceWidth = 640;
+const uint32_t SurfaceHeight = 360;
+
+// 이만큼 지나면 arena와 큐의 목록들이 다 커졌다고 보고 프레임마다 힙 할당을 확인한다
+const uint64_t HeapAllocationWarmupFrames = 16;
+
+// LOD 데모. 앞쪽 인스턴스만 움직이며 와이어프레임으로 그리고, 나머지는 멀리 격자로 깔아서 고르는 비용을 잰다
+const uint32_t LodInstanceCount = 1 << 20;
+const uint32_t LodDrawnInstanceCount = 16;
+const uint32_t LodGridWidth = 1024;
+const float LodTanHalfFovY = 0.57735027f; // ClusteredLighting과 같은 60도
+const float LodNearZ = 0.1f;
+const float LodFarZ = 100.0f;
+const float LodPixelThreshold = 1.0f;
+const float LodHysteresis = 0.1f;
+
+// LOD마다 와이어프레임 색. 고울수록 붉다
+const float lodColors[MeshAsset::MaxLods][3] =
+{
+    { 1.0f, 0.2f, 0.2f }, { 1.0f, 0.5f, 0.1f }, { 1.0f, 0.9f, 0.1f }, { 0.5f, 1.0f, 0.2f },
+    { 0.2f, 1.0f, 0.6f }, { 0.2f, 0.8f, 1.0f }, { 0.3f, 0.4f, 1.0f }, { 0.7f, 0.3f, 1.0f },
+};
+
+// occlusion 데모. LOD 인스턴스 사이로 벽이 좌우로 지나가고, 그 뒤 바닥에 작은 상자를 격자로 깐다
+// 카메라는 LOD 데모와 같다
+const uint32_t OccluderWallCount = 3;
+const uint32_t OcclusionGridWidth = 32;
+const uint32_t OcclusionGridCount = OcclusionGridWidth * OcclusionGridWidth;
+
+// 0~1 단위 상자. 밖에서 볼때 화면에서 시계 방향으로 감긴다
+const float occluderBoxPositions[] =
+{
+    0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f,
+    0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+};
+const uint32_t occluderBoxIndices[] =
+{
+    2, 3, 1, 2, 1, 0, 7, 6, 4, 7, 4, 5, 6, 2, 0, 6, 0, 4,
+    3, 7, 5, 3, 5, 1, 6, 7, 3, 6, 3, 2, 0, 1, 5, 0, 5, 4,
+};
+
+// 그림자 캐시 데모. 바닥 상자와 벽이 정적 캐스터, LOD 인스턴스가 움직이는 캐스터다
+// 빛은 ShadowLightStepSeconds마다 다음 방향으로 바뀌고 그때마다 캐시 전체를 몇 프레임에 나눠 다시 그린다
+const ShadowCacheDesc shadowCacheDesc = { /*cascadeCount*/ 3, { 8.0f, 24.0f, 64.0f }, /*tilesPerSide*/ 8, /*maxStaticTilesPerFrame*/ 16 };
+const float shadowLightDirections[][3] =
+{
+    { 0.3f, -1.0f, 0.4f }, { -0.4f, -1.0f, 0.2f }, { 0.1f, -1.0f, -0.5f },
+};
+const float ShadowLightStepSeconds = 8.0f;
+const float ShadowFocusZ = 20.0f; // cascade 중심을 카메라 앞 이 깊이에 둔다
+
+// debugDraw의 viewProjection은 단위 행렬이라 뷰 공간 점을 CPU에서 바로 클립 좌표로 바꿔서 넣는다
+void ProjectViewPoint(float x, float y, float z, float aspectRatio, float clip[3])
+{
+    clip[0] = x / (z * LodTanHalfFovY * aspectRatio);
+    clip[1] = y / (z * LodTanHalfFovY);
+    clip[2] = z / LodFarZ;
+}
+
+// 뷰 공간 AABB의 모서리 12개. near 평면에 걸치면 그리지 않는다
+void AddViewBox(DebugDraw& debugDraw, const float minCorner[3], const float maxCorner[3], float aspectRatio, uint32_t color)
+{
+    if (minCorner[2] < LodNearZ)
+        return;
+
+    float corners[8][3];
+    for (uint32_t c = 0; c < 8; c++)
+        ProjectViewPoint((c & 1) ? maxCorner[0] : minCorner[0], (c & 2) ? maxCorner[1] : minCorner[1], (c & 4) ? maxCorner[2] : minCorner[2], aspectRatio, corners[c]);
+
+    // 한 축만 다른 꼭짓점끼리 잇는다
+    for (uint32_t c = 0; c < 8; c++)
+    {
+        for (uint32_t axis = 0; axis < 3; axis++)
+        {
+            uint32_t other = c | (1u << axis);
+            if (other != c)
+                debugDraw.AddLine(corners[c][0], corners[c][1], corners[c][2], corners[other][0], corners[other][1], corners[other][2], color);
+        }
+    }
+}
+
+// 벽은 토러스들 사이 깊이에서 좌우로 오간다
+void GetWallBounds(uint32_t wall, float time, float minCorner[3], float maxCorner[3])
+{
+    float x = 6.0f * sinf(time * 0.3f + wall * 2.1f);
+    minCorner[0] = x - 1.5f;
+    minCorner[1] = -3.0f;
+    minCorner[2] = 8.0f + wall * 6.0f;
+    maxCorner[0] = x + 1.5f;
+    maxCorner[1] = 2.5f;
+    maxCorner[2] = 8.5f + wall * 6.0f;
+}
+
 path& GetBasePath()
 {
     static optional<path> basePath;
     if (basePath) return *basePath;
 
-    std::vector<wchar_t> buffer;
-    buffer.resize(MAX_PATH);
-    DWORD nSize = GetModuleFileName(nullptr, buffer.data(), (DWORD)buffer.size());
-    path modulePath = buffer.data();
+    wchar_t buffer[MAX_PATH];
+    DWORD nSize = GetModuleFileName(nullptr, buffer, _countof(buffer));
+    path modulePath = buffer;
 
     basePath = modulePath.parent_path();
     return *basePath;
@@ -35,6 +174,10 @@ std::wstring GetAppPath(const std::wstring& relPath)
 }
 
 MyWindow::MyWindow()
+    : fenceWaiter(executor), fileReader(executor), hWnd(nullptr), windowInstance(nullptr), windowClassName(nullptr), windowShowCmd(SW_SHOWDEFAULT), initialized(false), adapterCacheHit(false), frameArenas(FrameCount), frameHeapAllocationStart(0), frameHeapAllocations(0), steadyHeapAllocationFrames(0), frameFenceValues{}, vertexDataBegin(nullptr), bindless(false), vertexBufferIndex(DescriptorIndexAllocator::InvalidIndex),
+      lodSelectMilliseconds(0.0), occlusionRenderMilliseconds(0.0), occlusionTestMilliseconds(0.0), shadowCache(shadowCacheDesc), shadowUpdateMilliseconds(0.0), frameCapture(GetAppPath(L"captures"), CaptureFormat::Png), capturing(false), frameNumber(0),
+      commandTee(d3d12Commands, commandRecorder), commandCaptureRequested(false), commandCaptureFramesLeft(0), commandCaptureStatus("off"),
+      surfaces(surfaceBackend, SurfaceResource), surfaceRequests(0), frameSubmissions(0)
 {
     aspectRatio = 1280.0f / 720.0f;
     viewport = CD3DX12_VIEWPORT(0.0f, 0.0f, 1280.0f, 720.0f);
@@ -93,7 +236,29 @@ void MyWindow::GetHardwareAdapter(IDXGIFactory1* pFactory, IDXGIAdapter1** ppAda
     *ppAdapter = adapter.detach();
 }
 
-bool MyWindow::LoadPipeline(HWND hWnd)
+bool MyWindow::GetCachedAdapter(IDXGIFactory4* pFactory, IDXGIAdapter1** ppAdapter)
+{
+    *ppAdapter = nullptr;
+
+    AdapterCacheEntry entry;
+    if (!LoadAdapterCache(GetAppPath(L"adapter.cache"), entry))
+        return false;
+
+    // 재부팅하면 LUID가 바뀔 수 있으므로 desc까지 같은지 확인한다
+    com_ptr<IDXGIAdapter1> adapter;
+    if (FAILED(pFactory->EnumAdapterByLuid(entry.luid, IID_PPV_ARGS(&adapter))))
+        return false;
+
+    DXGI_ADAPTER_DESC1 desc;
+    adapter->GetDesc1(&desc);
+    if (!IsSameAdapter(entry, desc))
+        return false;
+
+    *ppAdapter = adapter.detach();
+    return true;
+}
+
+bool MyWindow::CreateFactory()
 {
     UINT dxgiFactoryFlags = 0;
 
@@ -114,26 +279,76 @@ bool MyWindow::LoadPipeline(HWND hWnd)
 #endif
 
     // 2. factory만들기
-    com_ptr<IDXGIFactory4> factory;
     if (FAILED(CreateDXGIFactory2(dxgiFactoryFlags, IID_PPV_ARGS(&factory))))
         return false;
 
+    return true;
+}
+
+bool MyWindow::CreateDevice()
+{
     // 3. hardware adapter만들기
+    // 지난번에 고른 어댑터가 캐시에 있으면 어댑터마다 테스트 device를 만들어보지 않는다
     com_ptr<IDXGIAdapter1> hardwareAdapter;
-    GetHardwareAdapter(factory.get(), hardwareAdapter.put());
-    if (!hardwareAdapter) return false;
+    adapterCacheHit = GetCachedAdapter(factory.get(), hardwareAdapter.put());
 
     // 4. device 만들기
-    if (FAILED(D3D12CreateDevice(hardwareAdapter.get(), D3D_FEATURE_LEVEL_11_0, IID_PPV_ARGS(&device))))
+    if (!adapterCacheHit || FAILED(D3D12CreateDevice(hardwareAdapter.get(), D3D_FEATURE_LEVEL_11_0, IID_PPV_ARGS(&device))))
+    {
+        adapterCacheHit = false;
+        hardwareAdapter = nullptr;
+
+        GetHardwareAdapter(factory.get(), hardwareAdapter.put());
+        if (!hardwareAdapter) return false;
+
+        if (FAILED(D3D12CreateDevice(hardwareAdapter.get(), D3D_FEATURE_LEVEL_11_0, IID_PPV_ARGS(&device))))
+            return false;
+
+        // 캐시 저장은 실패해도 다음번에 다시 찾으면 되므로 무시한다
+        DXGI_ADAPTER_DESC1 desc;
+        hardwareAdapter->GetDesc1(&desc);
+        SaveAdapterCache(GetAppPath(L"adapter.cache"), MakeAdapterCacheEntry(desc));
+    }
+
+    // SM 6.6을 지원하면 bindless 모드로 그린다
+    bindless = BindlessHeap::IsSupported(device.get());
+
+    // 5. CommandQueue만들기 Swapchain을 위한 그래픽스 큐와 async compute 큐를 같이 만든다
+    if (!gpuQueues.Init(device.get()))
         return false;
 
-    // 5. CommandQueue만들기 Swapchain을 위해서 하나 만들어야 한다
-    D3D12_COMMAND_QUEUE_DESC queueDesc = {};
-    queueDesc.Type = D3D12_COMMAND_LIST_TYPE_DIRECT;
-    queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
-    if (FAILED(device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&commandQueue))))
+    return true;
+}
+
+bool MyWindow::CreateMainWindow()
+{
+    RECT windowRect{ 0, 0, 1280, 720 };
+    AdjustWindowRect(&windowRect, WS_OVERLAPPEDWINDOW, FALSE);
+
+    // Create the window and store a handle to it.
+    hWnd = CreateWindow(
+        windowClassName,
+        L"D3D12 Hello Window",
+        WS_OVERLAPPEDWINDOW,
+        CW_USEDEFAULT,
+        CW_USEDEFAULT,
+        windowRect.right - windowRect.left,
+        windowRect.bottom - windowRect.top,
+        nullptr,        // We have no parent window.
+        nullptr,        // We aren't using menus.
+        windowInstance,
+        this);
+
+    if (!hWnd)
         return false;
 
+    // device가 준비되기 전이라도 창부터 띄운다
+    ShowWindow(hWnd, windowShowCmd);
+    return true;
+}
+
+bool MyWindow::CreateSwapChain()
+{
     // 6. swap chain만들기, 윈도우 연결하기
     DXGI_SWAP_CHAIN_DESC1 swapChainDesc = {};
     swapChainDesc.BufferCount = FrameCount;
@@ -145,7 +360,7 @@ bool MyWindow::LoadPipeline(HWND hWnd)
     swapChainDesc.SampleDesc.Count = 1;
 
     com_ptr<IDXGISwapChain1> swapChain1;
-    if (FAILED(factory->CreateSwapChainForHwnd(commandQueue.get(), hWnd, &swapChainDesc, nullptr, nullptr, swapChain1.put())))
+    if (FAILED(factory->CreateSwapChainForHwnd(gpuQueues.GetQueue(QueueType::Graphics), hWnd, &swapChainDesc, nullptr, nullptr, swapChain1.put())))
         return false;
     
     if (FAILED(factory->MakeWindowAssociation(hWnd, DXGI_MWA_NO_ALT_ENTER)))
@@ -160,7 +375,8 @@ bool MyWindow::LoadPipeline(HWND hWnd)
     // 7. rtv용 descriptor heap만들기
     // Describe and create a render target view (RTV) descriptor heap.
     D3D12_DESCRIPTOR_HEAP_DESC rtvHeapDesc = {};
-    rtvHeapDesc.NumDescriptors = FrameCount;
+    // 추가 창들의 RTV도 여기 이어서 만든다
+    rtvHeapDesc.NumDescriptors = FrameCount * (1 + D3D12SurfaceBackend::MaxSurfaces);
     rtvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
     rtvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
     if (FAILED(device->CreateDescriptorHeap(&rtvHeapDesc, IID_PPV_ARGS(&rtvHeap))))
@@ -183,14 +399,41 @@ bool MyWindow::LoadPipeline(HWND hWnd)
         rtvHandle.Offset(1, rtvDescriptorSize);
     }
 
-    if (FAILED(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&commandAllocator))))
+    return true;
+}
+
+bool MyWindow::CreateCommandList()
+{
+    // 프레임 슬롯마다 할당자가 있어야 앞 프레임이 GPU에서 도는 동안 다음 프레임을 기록할 수 있다
+    for (UINT n = 0; n < FrameCount; n++)
+    {
+        if (FAILED(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&commandAllocators[n]))))
+            return false;
+    }
+
+    // 1. Create the command list.
+    if (FAILED(device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, commandAllocators[0].get(), nullptr, IID_PPV_ARGS(&commandList))))
+        return false;
+
+    // Command lists are created in the recording state, but there is nothing
+    // to record yet. The main loop expects it to be closed, so close it now.
+    if (FAILED(commandList->Close()))
         return false;
 
     return true;
 }
 
-bool MyWindow::LoadAssets()
+bool MyWindow::CreateRootSignature()
 {
+    if (bindless)
+    {
+        // root signature는 bindless 힙과 함께 한번만 만든다
+        if (!bindlessHeap.Init(device.get()))
+            return false;
+
+        rootSignature.copy_from(bindlessHeap.GetRootSignature());
+    }
+    else
     {
         // root signature는 무엇인가
         CD3DX12_ROOT_SIGNATURE_DESC rootSignatureDesc;
@@ -208,126 +451,353 @@ bool MyWindow::LoadAssets()
             return false;
     }
 
+    return true;
+}
+
+Task<bool> MyWindow::LoadShadersAsync()
+{
+    // bindless 셰이더는 ResourceDescriptorHeap을 쓰므로 DXC로 6.6 타겟으로 컴파일한다
+    if (bindless)
+        co_return co_await CompileShadersAsync(L"bindless.hlsl", "vs_6_6", "ps_6_6", vertexShaderBytecode, pixelShaderBytecode);
+
+    co_return co_await CompileShadersAsync(L"shaders.hlsl", "vs_5_0", "ps_5_0", vertexShaderBytecode, pixelShaderBytecode);
+}
+
+bool MyWindow::CreatePipelineState()
+{
+    // 파이프라인 스테이트 생성
+    // input layout 알려주기
+    D3D12_INPUT_ELEMENT_DESC inputElementDescs[] =
+    {   
+        // SemanticName, SemanticIndex, Format, InputSlot, AlignedByteOffset, InputSlotClass, InstanceDataStepRate
+
+        // POSITION은 ByteOffset이 0
+        { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+
+        // COLOR는 ByteOffset이 12
+        { "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
+    };
+
+    // Describe and create the graphics pipeline state object (PSO).
+    D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
+    // bindless 모드에서는 버텍스 셰이더가 SV_VertexID로 직접 읽으므로 input layout이 없다
+    if (!bindless)
+        psoDesc.InputLayout = { inputElementDescs, _countof(inputElementDescs) };
+    psoDesc.pRootSignature = rootSignature.get();
+    psoDesc.VS = CD3DX12_SHADER_BYTECODE(vertexShaderBytecode.data(), vertexShaderBytecode.size());
+    psoDesc.PS = CD3DX12_SHADER_BYTECODE(pixelShaderBytecode.data(), pixelShaderBytecode.size());
+    psoDesc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
+    psoDesc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
+    psoDesc.DepthStencilState.DepthEnable = FALSE;
+    psoDesc.DepthStencilState.StencilEnable = FALSE;
+    psoDesc.SampleMask = UINT_MAX;
+    psoDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+    psoDesc.NumRenderTargets = 1;
+    psoDesc.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM;
+    psoDesc.SampleDesc.Count = 1;
+
+    if (FAILED(device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&pipelineState))))
+        return false;
+
+    return true;
+}
+
+bool MyWindow::CreateVertexBuffer()
+{
+    Vertex triangleVertices[_countof(baseTriangleVertices)];
+    for (UINT i = 0; i < _countof(baseTriangleVertices); i++)
     {
-        // 파이프라인 스테이트 생성
-        com_ptr<ID3DBlob> vertexShader;
-        com_ptr<ID3DBlob> pixelShader;
+        triangleVertices[i] = baseTriangleVertices[i];
+        triangleVertices[i].position.y *= aspectRatio;
+    }
 
-#if defined(_DEBUG)
-        UINT compileFlags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
-#else
-        UINT compileFlags = 0;
-#endif
-        if (FAILED(D3DCompileFromFile(GetAppPath(L"shaders.hlsl").c_str(), /*pDefines*/ nullptr, /*pInclude*/ nullptr, "VSMain", "vs_5_0", compileFlags, 0, vertexShader.put(), /*ppErrorMsgs*/ nullptr)))
-            return false;
+    // OnUpdate가 매 프레임 고쳐 쓰므로 프레임 슬롯마다 삼각형 하나씩 둔다
+    const UINT vertexBufferSize = sizeof(triangleVertices) * FrameCount;
+
+    // Note: using upload heaps to transfer static data like vert buffers is not 
+    // recommended. Every time the GPU needs it, the upload heap will be marshalled 
+    // over. Please read up on Default Heap usage. An upload heap is used here for 
+    // code simplicity and because there are very few verts to actually transfer.
+    if (FAILED(device->CreateCommittedResource(
+        &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+        D3D12_HEAP_FLAG_NONE,
+        &CD3DX12_RESOURCE_DESC::Buffer(vertexBufferSize),
+        D3D12_RESOURCE_STATE_GENERIC_READ,
+        nullptr,
+        IID_PPV_ARGS(&vertexBuffer))))
+        return false;
 
-        if (FAILED(D3DCompileFromFile(GetAppPath(L"shaders.hlsl").c_str(), /*pDefines*/ nullptr, /*pInclude*/ nullptr, "PSMain", "ps_5_0", compileFlags, 0, pixelShader.put(), /*ppErrorMsgs*/ nullptr)))
-            return false;
+    // Copy the triangle data to the vertex buffer.
+    // 시뮬레이션 결과로 매 프레임 고쳐 쓰므로 Unmap하지 않는다
+    CD3DX12_RANGE readRange(0, 0);        // We do not intend to read from this resource on the CPU.
+    if (FAILED(vertexBuffer->Map(0, &readRange, reinterpret_cast<void**>(&vertexDataBegin))))
+        return false;
 
-        // input layout 알려주기
-        D3D12_INPUT_ELEMENT_DESC inputElementDescs[] =
-        {   
-            // SemanticName, SemanticIndex, Format, InputSlot, AlignedByteOffset, InputSlotClass, InstanceDataStepRate
+    for (UINT n = 0; n < FrameCount; n++)
+        memcpy(vertexDataBegin + n * sizeof(triangleVertices), triangleVertices, sizeof(triangleVertices));
 
-            // POSITION은 ByteOffset이 0
-            { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+    // 이후로는 OnUpdate가 여기에 고쳐 쓰고 PopulateCommandList에서 Upload로 올린다
+    const uint8_t* vertexBytes = reinterpret_cast<const uint8_t*>(triangleVertices);
+    vertexUploadData.assign(vertexBytes, vertexBytes + sizeof(triangleVertices));
 
-            // COLOR는 ByteOffset이 12
-            { "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
-        };
+    // Initialize the vertex buffer view.
+    vertexBufferView.BufferLocation = vertexBuffer->GetGPUVirtualAddress();
+    vertexBufferView.StrideInBytes = sizeof(Vertex); // 하나씩 크기
+    vertexBufferView.SizeInBytes = vertexBufferSize; // 총 크기
 
-        // Describe and create the graphics pipeline state object (PSO).
-        D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
-        psoDesc.InputLayout = { inputElementDescs, _countof(inputElementDescs) };
-        psoDesc.pRootSignature = rootSignature.get();
-        psoDesc.VS = CD3DX12_SHADER_BYTECODE(vertexShader.get());
-        psoDesc.PS = CD3DX12_SHADER_BYTECODE(pixelShader.get());
-        psoDesc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
-        psoDesc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
-        psoDesc.DepthStencilState.DepthEnable = FALSE;
-        psoDesc.DepthStencilState.StencilEnable = FALSE;
-        psoDesc.SampleMask = UINT_MAX;
-        psoDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
-        psoDesc.NumRenderTargets = 1;
-        psoDesc.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM;
-        psoDesc.SampleDesc.Count = 1;
-
-        if (FAILED(device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&pipelineState))))
+    // bindless 모드에서는 SRV를 힙에 만들고 그 인덱스만 셰이더에 넘긴다
+    if (bindless)
+    {
+        vertexBufferIndex = bindlessHeap.CreateStructuredBufferSrv(device.get(), vertexBuffer.get(), _countof(triangleVertices) * FrameCount, sizeof(Vertex));
+        if (vertexBufferIndex == DescriptorIndexAllocator::InvalidIndex)
             return false;
     }
 
-    // 1. Create the command list.
-    if (FAILED(device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, commandAllocator.get(), nullptr, IID_PPV_ARGS(&commandList))))
-        return false;
+    return true;
+}
 
-    // Command lists are created in the recording state, but there is nothing
-    // to record yet. The main loop expects it to be closed, so close it now.
-    if (FAILED(commandList->Close()))
+bool MyWindow::CreateFrameCapture()
+{
+    // 캡처 파일은 실행 파일 옆 captures 폴더에 쌓인다
+    error_code ec;
+    create_directories(GetAppPath(L"captures"), ec);
+    if (ec)
         return false;
 
-    // create vertex buffer
-    {
-        Vertex triangleVertices[] =
-        {
-            {{ 0.0f, 0.25f * aspectRatio, 0.0f }, { 1.0f, 0.0f, 0.0f, 1.0f } },
-            {{ 0.25f, -0.25f * aspectRatio, 0.0f }, { 0.0f, 1.0f, 0.0f, 1.0f } },
-            {{ -0.25f, -0.25f * aspectRatio, 0.0f }, { 0.0f, 0.0f, 1.0f, 1.0f } },
-        };
+    return frameCapture.Init(device.get(), renderTargets[0].get());
+}
 
-        const UINT vertexBufferSize = sizeof(triangleVertices);
-
-        // Note: using upload heaps to transfer static data like vert buffers is not 
-        // recommended. Every time the GPU needs it, the upload heap will be marshalled 
-        // over. Please read up on Default Heap usage. An upload heap is used here for 
-        // code simplicity and because there are very few verts to actually transfer.
-        if (FAILED(device->CreateCommittedResource(
-            &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
-            D3D12_HEAP_FLAG_NONE,
-            &CD3DX12_RESOURCE_DESC::Buffer(vertexBufferSize),
-            D3D12_RESOURCE_STATE_GENERIC_READ,
-            nullptr,
-            IID_PPV_ARGS(&vertexBuffer))))
-            return false;
+Task<bool> MyWindow::LoadParticleShadersAsync()
+{
+    FileReadResult source = co_await fileReader.ReadAsync(GetAppPath(L"particles.hlsl"));
+    if (!source.succeeded)
+        co_return false;
+
+    // 다섯 진입점을 워커 스레드에서 동시에 컴파일한다
+    vector<Task<bool>> compileTasks;
+    compileTasks.push_back(CompileShaderAsync(source.data, "particles.hlsl", "CSSimulate", "cs_5_0", particleShaders.simulate));
+    compileTasks.push_back(CompileShaderAsync(source.data, "particles.hlsl", "CSEmit", "cs_5_0", particleShaders.emit));
+    compileTasks.push_back(CompileShaderAsync(source.data, "particles.hlsl", "CSArgs", "cs_5_0", particleShaders.args));
+    compileTasks.push_back(CompileShaderAsync(source.data, "particles.hlsl", "VSMain", "vs_5_0", particleShaders.vertex));
+    compileTasks.push_back(CompileShaderAsync(source.data, "particles.hlsl", "PSMain", "ps_5_0", particleShaders.pixel));
+
+    vector<bool> results = co_await WhenAll(move(compileTasks));
+    for (bool succeeded : results)
+        if (!succeeded)
+            co_return false;
+
+    co_return true;
+}
 
-        // Copy the triangle data to the vertex buffer.
-        UINT8* pVertexDataBegin;
-        CD3DX12_RANGE readRange(0, 0);        // We do not intend to read from this resource on the CPU.
-        if (FAILED(vertexBuffer->Map(0, &readRange, reinterpret_cast<void**>(&pVertexDataBegin))))
-            return false;
+bool MyWindow::CreateParticles()
+{
+    return particles.Init(device.get(), particleShaders, DXGI_FORMAT_R8G8B8A8_UNORM, FrameCount);
+}
+
+Task<bool> MyWindow::LoadClusteredLightingShadersAsync()
+{
+    FileReadResult source = co_await fileReader.ReadAsync(GetAppPath(L"clusteredlights.hlsl"));
+    if (!source.succeeded)
+        co_return false;
+
+    vector<Task<bool>> compileTasks;
+    compileTasks.push_back(CompileShaderAsync(source.data, "clusteredlights.hlsl", "CSAssignLights", "cs_5_0", clusteredLightingShaders.assign));
+    compileTasks.push_back(CompileShaderAsync(source.data, "clusteredlights.hlsl", "VSFloor", "vs_5_0", clusteredLightingShaders.floorVertex));
+    compileTasks.push_back(CompileShaderAsync(source.data, "clusteredlights.hlsl", "PSFloor", "ps_5_0", clusteredLightingShaders.floorPixel));
+
+    vector<bool> results = co_await WhenAll(move(compileTasks));
+    for (bool succeeded : results)
+        if (!succeeded)
+            co_return false;
+
+    co_return true;
+}
+
+bool MyWindow::CreateClusteredLighting()
+{
+    // CPU 경로로 바꾸면 빛 배정을 z 슬라이스 단위로 나눠서 executor 워커에 맡긴다
+    return clusteredLighting.Init(device.get(), clusteredLightingShaders, DXGI_FORMAT_R8G8B8A8_UNORM, 1280, 720, &executor, FrameCount);
+}
+
+Task<bool> MyWindow::LoadDebugDrawShadersAsync()
+{
+    FileReadResult source = co_await fileReader.ReadAsync(GetAppPath(L"debugdraw.hlsl"));
+    if (!source.succeeded)
+        co_return false;
+
+    vector<Task<bool>> compileTasks;
+    compileTasks.push_back(CompileShaderAsync(source.data, "debugdraw.hlsl", "VSLine", "vs_5_0", debugDrawShaders.lineVertex));
+    compileTasks.push_back(CompileShaderAsync(source.data, "debugdraw.hlsl", "PSLine", "ps_5_0", debugDrawShaders.linePixel));
+    compileTasks.push_back(CompileShaderAsync(source.data, "debugdraw.hlsl", "VSText", "vs_5_0", debugDrawShaders.textVertex));
+    compileTasks.push_back(CompileShaderAsync(source.data, "debugdraw.hlsl", "PSText", "ps_5_0", debugDrawShaders.textPixel));
+
+    vector<bool> results = co_await WhenAll(move(compileTasks));
+    for (bool succeeded : results)
+        if (!succeeded)
+            co_return false;
+
+    co_return true;
+}
+
+bool MyWindow::CreateDebugDraw()
+{
+    return debugDrawRenderer.Init(device.get(), debugDrawShaders, DXGI_FORMAT_R8G8B8A8_UNORM, 1280, 720, FrameCount);
+}
+
+Task<bool> MyWindow::LoadMeshAssetsAsync()
+{
+    // 따로 에셋 빌드 단계가 없으므로 실행 파일 옆 meshes 폴더가 그 결과물이다
+    // 파일이 없거나 형식 버전이 바뀐 메시만 여기서 단순화해서 저장하고, 다음 시작부터는 읽기만 한다
+    vector<MeshSource> sources = MakeSceneMeshSources();
+    vector<bool> built;
+    if (!co_await LoadOrBuildMeshAssetsAsync(executor, GetAppPath(L"meshes"), sources, meshAssets, built))
+        co_return false;
+
+    // 오차 대 삼각형 수. 디버거 출력 창에서 볼 수 있다
+    string report;
+    for (size_t i = 0; i < sources.size(); i++)
+        report += FormatLodReport(sources[i].name + (built[i] ? " (built)" : " (loaded)"), meshAssets[i]);
+    OutputDebugStringA(report.c_str());
+
+    co_return true;
+}
 
-        memcpy(pVertexDataBegin, triangleVertices, sizeof(triangleVertices));
-        vertexBuffer->Unmap(0, nullptr);
+bool MyWindow::CreateLodInstances()
+{
+    lodSelector.SetMesh(meshAssets[0]);
 
-        // Initialize the vertex buffer view.
-        vertexBufferView.BufferLocation = vertexBuffer->GetGPUVirtualAddress();
-        vertexBufferView.StrideInBytes = sizeof(Vertex); // 하나씩 크기
-        vertexBufferView.SizeInBytes = vertexBufferSize; // 총 크기
+    // 앞쪽 LodDrawnInstanceCount개는 UpdateLodInstances에서 매 프레임 옮긴다
+    // 나머지는 바닥 아래에 격자로 깔아서 거리마다 다른 LOD가 골라지게 한다
+    lodInstances.Resize(LodInstanceCount);
+    for (uint32_t i = LodDrawnInstanceCount; i < LodInstanceCount; i++)
+    {
+        lodInstances.x[i] = (static_cast<float>(i % LodGridWidth) - LodGridWidth / 2) * 2.0f;
+        lodInstances.y[i] = -4.0f;
+        lodInstances.z[i] = static_cast<float>(i / LodGridWidth) * 2.0f;
+        lodInstances.scale[i] = 0.5f + 0.25f * static_cast<float>(i % 5);
     }
 
-    // Create synchronization objects.
+    instanceLods.assign(LodInstanceCount, 0);
+    return true;
+}
+
+bool MyWindow::CreateOcclusionCulling()
+{
+    occlusionCuller.Init();
+
+    // 앞쪽 LOD 인스턴스 경계는 UpdateOcclusion에서 매 프레임 채우고, 그 뒤는 바닥에 놓인 상자들이다
+    occlusionBounds.Resize(LodDrawnInstanceCount + OcclusionGridCount);
+    for (uint32_t i = 0; i < OcclusionGridCount; i++)
     {
-        // 2. fence 생성
-        if (FAILED(device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence))))
-            return false;
+        float x = (static_cast<float>(i % OcclusionGridWidth) - OcclusionGridWidth / 2) * 1.0f;
+        float z = 20.0f + static_cast<float>(i / OcclusionGridWidth) * 1.5f;
+        float minCorner[3] = { x, -1.5f, z };
+        float maxCorner[3] = { x + 0.4f, -1.1f, z + 0.4f };
+        occlusionBounds.Set(LodDrawnInstanceCount + i, minCorner, maxCorner);
+    }
 
-        fenceValue = 1;
+    occlusionVisible.assign(occlusionBounds.GetCount(), 1);
+    return true;
+}
 
-        // Create an event handle to use for frame synchronization.
+bool MyWindow::CreateShadowCache()
+{
+    // 벽이 정적 캐스터 0 ~ OccluderWallCount-1번이다. UpdateShadows에서 옮긴다
+    for (uint32_t i = 0; i < OccluderWallCount; i++)
+    {
+        ShadowCasterBounds bounds;
+        GetWallBounds(i, 0.0f, bounds.minCorner, bounds.maxCorner);
+        shadowCache.AddStaticCaster(bounds);
+    }
 
-        // 3. event 만들기
-        fenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
-        if (fenceEvent == nullptr)
+    // 바닥 상자는 CreateOcclusionCulling에서 깐 것을 그대로 쓴다
+    for (uint32_t i = LodDrawnInstanceCount; i < occlusionBounds.GetCount(); i++)
+    {
+        ShadowCasterBounds bounds =
         {
-            if (FAILED(HRESULT_FROM_WIN32(GetLastError())))
-                return false;
-        }
+            { occlusionBounds.minX[i], occlusionBounds.minY[i], occlusionBounds.minZ[i] },
+            { occlusionBounds.maxX[i], occlusionBounds.maxY[i], occlusionBounds.maxZ[i] },
+        };
+        shadowCache.AddStaticCaster(bounds);
+    }
 
-        WaitForPreviousFrame();
+    shadowDynamicCasters.resize(LodDrawnInstanceCount);
+    return true;
+}
+
+bool MyWindow::RegisterCommandObjects()
+{
+    // 캡처에 적힌 번호를 실제 오브젝트에 잇는다. 파일에는 번호만 남는다
+    d3d12Commands.SetQueues(&gpuQueues);
+    d3d12Commands.SetSwapChain(swapChain.get());
+    d3d12Commands.SetCommandList(commandList.get());
+    d3d12Commands.RegisterResource(VertexBufferObject, vertexBuffer.get(), vertexDataBegin);
+    d3d12Commands.RegisterPipelineState(TrianglePipelineObject, pipelineState.get());
+    d3d12Commands.RegisterRootSignature(TriangleRootSignatureObject, rootSignature.get());
+
+    CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHandle(rtvHeap->GetCPUDescriptorHandleForHeapStart());
+    for (UINT n = 0; n < FrameCount; n++)
+    {
+        d3d12Commands.RegisterResource(BackBufferObject + n, renderTargets[n].get());
+        d3d12Commands.RegisterRenderTargetView(BackBufferObject + n, rtvHandle);
+        rtvHandle.Offset(1, rtvDescriptorSize);
     }
 
     return true;
 }
 
+bool MyWindow::CreateSharedContext()
+{
+    // 추가 창은 디바이스, 큐, 파이프라인, 버텍스 버퍼, 힙을 주 창 것으로 쓴다
+    SharedRenderContext context = {};
+    context.factory = factory.get();
+    context.device = device.get();
+    context.queues = &gpuQueues;
+    for (UINT n = 0; n < FrameCount; n++)
+        context.commandAllocators.push_back(commandAllocators[n].get());
+    context.rtvHeap = rtvHeap.get();
+    context.rtvDescriptorSize = rtvDescriptorSize;
+    context.frameCount = FrameCount;
+    context.pipelineState = pipelineState.get();
+    context.rootSignature = rootSignature.get();
+    context.vertexBufferView = vertexBufferView;
+    context.vertexCount = _countof(baseTriangleVertices);
+    context.bindlessHeap = bindless ? bindlessHeap.GetHeap() : nullptr;
+    context.vertexBufferIndex = vertexBufferIndex;
+
+    surfaceBackend.SetContext(context, /*firstRtv*/ FrameCount);
+    return true;
+}
+
+Task<bool> MyWindow::CompileShadersAsync(const wchar_t* fileName, const char* vertexTarget, const char* pixelTarget, vector<uint8_t>& vertexShader, vector<uint8_t>& pixelShader)
+{
+    // 읽기가 끝날때까지 스레드를 잡고 있지 않는다
+    FileReadResult source = co_await fileReader.ReadAsync(GetAppPath(fileName));
+    if (!source.succeeded)
+        co_return false;
+
+    string sourceName = path(fileName).string();
+
+    // 두 셰이더는 서로 상관없으니 워커 스레드에서 동시에 컴파일한다
+    vector<Task<bool>> compileTasks;
+    compileTasks.push_back(CompileShaderAsync(source.data, sourceName.c_str(), "VSMain", vertexTarget, vertexShader));
+    compileTasks.push_back(CompileShaderAsync(source.data, sourceName.c_str(), "PSMain", pixelTarget, pixelShader));
+
+    vector<bool> results = co_await WhenAll(move(compileTasks));
+    for (bool succeeded : results)
+        if (!succeeded)
+            co_return false;
+
+    co_return true;
+}
+
+Task<bool> MyWindow::CompileShaderAsync(const vector<uint8_t>& source, const char* sourceName, const char* entryPoint, const char* target, vector<uint8_t>& shader)
+{
+    co_await executor.Schedule();
+
+    co_return CompileShader(source, sourceName, entryPoint, target, shader);
+}
+
 bool MyWindow::PopulateCommandList()
 {
     // Command list allocators can only be reset when the associated 
@@ -336,37 +806,82 @@ bool MyWindow::PopulateCommandList()
 
     // 커맨드 리스트 할당자는 연관된 커맨드 리스트들이 GPU에서 모두 수행을 마쳐야만 리셋할수 있다.
     // 앱은 반드시 펜스를 사용해서 GPU 수행 여부를 알아내야 한다
-    if (FAILED(commandAllocator->Reset()))
+    // 이 슬롯의 할당자를 마지막으로 쓴 프레임은 MoveToNextFrame에서 기다렸다
+    if (FAILED(commandAllocators[frameIndex]->Reset()))
         return false;
 
     // However, when ExecuteCommandList() is called on a particular command 
     // list, that command list can then be reset at any time and must be before 
     // re-recording.
-    if (FAILED(commandList->Reset(commandAllocator.get(), pipelineState.get())))
+    if (FAILED(commandList->Reset(commandAllocators[frameIndex].get(), pipelineState.get())))
         return false;
 
+    // 이 함수의 호출은 commands를 거친다. 하위 시스템이 직접 기록하는 곳은 External로 자리만 남긴다
+    ICommandBackend& commands = GetCommandBackend();
+
+    // OnUpdate에서 시뮬레이션 결과로 고친 정점을 이 슬롯 몫에 올린다. 직전 프레임은 다른 슬롯을 읽고 있을 수 있다
+    const uint32_t vertexUploadSize = static_cast<uint32_t>(vertexUploadData.size());
+    const uint32_t firstVertex = frameIndex * _countof(baseTriangleVertices);
+    commands.Upload(VertexBufferObject, frameIndex * vertexUploadSize, vertexUploadData.data(), vertexUploadSize);
+
     // Set necessary state.
-    commandList->SetGraphicsRootSignature(rootSignature.get());
-    commandList->RSSetViewports(1, &viewport);
-    commandList->RSSetScissorRects(1, &scissorRect);
+    // directly indexed 힙은 root signature보다 먼저 설정해야 한다
+    if (bindless)
+    {
+        commands.External("SetDescriptorHeaps");
+        ID3D12DescriptorHeap* heaps[] = { bindlessHeap.GetHeap() };
+        commandList->SetDescriptorHeaps(_countof(heaps), heaps);
+    }
 
-    // Indicate that the back buffer will be used as a render target.
-    auto transition0 = CD3DX12_RESOURCE_BARRIER::Transition(renderTargets[frameIndex].get(), D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET);
-    commandList->ResourceBarrier(1, &transition0);
+    commands.SetViewport({ viewport.TopLeftX, viewport.TopLeftY, viewport.Width, viewport.Height, viewport.MinDepth, viewport.MaxDepth });
+    commands.SetScissorRect({ scissorRect.left, scissorRect.top, scissorRect.right, scissorRect.bottom });
 
-    CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHandle(rtvHeap->GetCPUDescriptorHandleForHeapStart(), frameIndex, rtvDescriptorSize);
-    commandList->OMSetRenderTargets(1, &rtvHandle, /*RTsSingleHandleToDescriptorRange*/ FALSE, /*pDepthStencilDescriptor*/ nullptr);
+    // Indicate that the back buffer will be used as a render target.
+    CommandObjectId backBuffer = BackBufferObject + frameIndex;
+    commands.ResourceBarrier(backBuffer, D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    commands.SetRenderTarget(backBuffer);
 
     // Record commands.
     const float clearColor[] = { 0.0f, 0.2f, 0.4f, 1.0f };
-    commandList->ClearRenderTargetView(rtvHandle, clearColor, 0, nullptr);
-    commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-    commandList->IASetVertexBuffers(0, 1, &vertexBufferView);
-    commandList->DrawInstanced(3, 1, 0, 0);
+    commands.ClearRenderTarget(backBuffer, clearColor);
+
+    // 바닥은 클러스터별 빛 목록으로 칠한다. 삼각형과 파티클은 그 위에 그린다
+    commands.External("ClusteredLighting");
+    clusteredLighting.RecordDraw(commandList.get());
+
+    commands.SetPipelineState(TrianglePipelineObject);
+    commands.SetRootSignature(TriangleRootSignatureObject);
+    commands.SetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+    if (bindless)
+    {
+        // 드로우마다 바뀌는 것은 32비트 상수 몇개뿐이다
+        BindlessHeap::DrawConstants drawConstants = { vertexBufferIndex, firstVertex, /*materialIndex*/ 0, /*instanceIndex*/ 0 };
+        commands.SetRootConstants(BindlessHeap::DrawConstantsRootParameter, reinterpret_cast<const uint32_t*>(&drawConstants), BindlessHeap::DrawConstantCount);
+        commands.DrawInstanced(3, 1, 0, 0);
+    }
+    else
+    {
+        commands.SetVertexBuffer(VertexBufferObject, vertexBufferView.SizeInBytes, vertexBufferView.StrideInBytes);
+        commands.DrawInstanced(3, 1, firstVertex, 0);
+    }
+
+    // 파티클은 삼각형 위에 점으로 그린다. GPU 경로면 compute 큐가 써둔 indirect 인자로 그린다
+    commands.External("Particles");
+    particles.RecordDraw(commandList.get());
 
+    // 이번 프레임에 모인 디버그 선과 글자를 종류별로 한번씩 그린다
+    commands.External("DebugDraw");
+    CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHandle(rtvHeap->GetCPUDescriptorHandleForHeapStart(), frameIndex, rtvDescriptorSize);
+    debugDrawRenderer.Record(commandList.get(), rtvHandle, debugDraw, frameIndex);
+
+    // 캡처 중이면 readback 버퍼로 복사하면서 PRESENT 상태로 바꾼다
     // Indicate that the back buffer will now be used to present.
-    auto transition1 = CD3DX12_RESOURCE_BARRIER::Transition(renderTargets[frameIndex].get(), D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT);
-    commandList->ResourceBarrier(1, &transition1);
+    bool copied = capturing && frameCapture.RecordCopy(commandList.get(), renderTargets[frameIndex].get(), frameNumber);
+    if (copied)
+        commands.External("FrameCapture");
+    else
+        commands.ResourceBarrier(backBuffer, D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT);
 
     if (FAILED(commandList->Close()))
         return false;
@@ -374,76 +889,583 @@ bool MyWindow::PopulateCommandList()
     return true;
 }
 
-bool MyWindow::WaitForPreviousFrame()
+bool MyWindow::WaitForGpu()
 {
-    // WAITING FOR THE FRAME TO COMPLETE BEFORE CONTINUING IS NOT BEST PRACTICE.     <- 기다리는건 좋은 방식이 아니다. 그냥 간단하게 하려고 이렇게 했다
-    // This is code implemented as such for simplicity. The D3D12HelloFrameBuffering <- D3D12HelloFrameBuffering에서
-    // sample illustrates how to use fences for efficient resource usage and to
-    // maximize GPU utilization.
+    // 시작과 종료때만 GPU가 모든 작업을 마칠때까지 기다린다. 프레임 사이에는 MoveToNextFrame을 쓴다
 
     // Signal and increment the fence value.
-    const UINT64 origFenceValue = fenceValue;
-    if (FAILED(commandQueue->Signal(fence.get(), origFenceValue))) // 커맨드큐에 시그널을 넣는다. GPU가 실행하다가 fence를 트리거한다
+    // 타임라인 값은 FrameGraph가 큐별로 관리하므로 거기서 하나 받아온다
+    const UINT64 fenceValue = frameGraph.ReserveFenceValue(QueueType::Graphics);
+    if (!GetCommandBackend().Signal(QueueType::Graphics, fenceValue)) // 커맨드큐에 시그널을 넣는다. GPU가 실행하다가 fence를 트리거한다
+        return false;
+
+    // 만약 fenceValue보다 fence가 넘어섰다면 기다리지 않는다 (이미 끝났으니까)
+    if (!gpuQueues.WaitForValue(QueueType::Graphics, fenceValue))
+        return false;
+
+    // compute 큐에 마지막으로 제출한 작업도 끝나야 한다
+    if (!gpuQueues.WaitForValue(QueueType::Compute, frameGraph.GetStats(QueueType::Compute).lastSignaledValue))
         return false;
 
-    fenceValue++;
+    frameIndex = swapChain->GetCurrentBackBufferIndex();
+    return true;
+}
+
+bool MyWindow::MoveToNextFrame()
+{
+    // 이번 프레임이 끝나는 지점을 슬롯에 적어두고, 다음에 쓸 슬롯의 프레임만 기다린다
+    // 그래서 CPU는 FrameCount 프레임까지 앞서 가고, compute 큐의 다음 프레임이 그래픽스 큐의 앞 프레임과 겹친다
+    const UINT64 fenceValue = frameGraph.ReserveFenceValue(QueueType::Graphics);
+    if (!GetCommandBackend().Signal(QueueType::Graphics, fenceValue))
+        return false;
 
-    // Wait until the previous frame is finished.
-    if (fence->GetCompletedValue() < origFenceValue) // 만약 origFenceValue보다 fence가 넘어섰다면 기다리지 않는다 (이미 끝났으니까)
+    frameFenceValues[frameIndex][static_cast<uint32_t>(QueueType::Graphics)] = fenceValue;
+    frameFenceValues[frameIndex][static_cast<uint32_t>(QueueType::Compute)] = frameGraph.GetStats(QueueType::Compute).lastSignaledValue;
+
+    frameIndex = swapChain->GetCurrentBackBufferIndex();
+    for (uint32_t q = 0; q < QueueTypeCount; q++)
     {
-        // 그럼 여기 윗줄과 WaitForSingleObject Completion이 일어나면 어떻게 되는건가. 상관없나보다
-        if (FAILED(fence->SetEventOnCompletion(origFenceValue, fenceEvent)))
+        if (!gpuQueues.WaitForValue(static_cast<QueueType>(q), frameFenceValues[frameIndex][q]))
             return false;
-
-        // fenceEvent를 기다린다
-        WaitForSingleObject(fenceEvent, INFINITE);
     }
 
-    frameIndex = swapChain->GetCurrentBackBufferIndex();
     return true;
 }
 
-bool MyWindow::OnInit(HWND hWnd)
+ICommandBackend& MyWindow::GetCommandBackend()
 {
-    if (!LoadPipeline(hWnd))
-        return false;
-    
-    if (!LoadAssets())
+    if (commandCaptureFramesLeft > 0)
+        return commandTee;
+
+    return d3d12Commands;
+}
+
+void MyWindow::StartCommandCapture()
+{
+    if (commandCaptureRequested || commandCaptureFramesLeft > 0)
+        return;
+
+    // 기록 버퍼를 미리 잡아둬서 캡처하는 동안에도 프레임 안에서 힙 할당이 생기지 않게 한다
+    // 기록은 OnRender가 프레임 슬롯 0에서 시작한다. 백버퍼 번호와 업로드 위치가 슬롯마다 달라서 참조 캡처와 맞춰야 한다
+    commandRecorder.Clear();
+    commandRecorder.Reserve(CommandCaptureReserveBytes);
+    commandCaptureRequested = true;
+    commandCaptureStatus = "waiting";
+}
+
+void MyWindow::FinishCommandCapture()
+{
+    // 파일에 쓴 것을 다시 읽어서 재생해야 형식까지 확인된다
+    path capturePath = path(GetAppPath(L"captures")) / ("commands_" + to_string(frameNumber) + ".cmds");
+    vector<uint8_t> loaded;
+    if (!SaveCommandCapture(capturePath, commandRecorder.GetStream()) || !LoadCommandCapture(capturePath, loaded))
+    {
+        commandCaptureStatus = "save failed";
+        return;
+    }
+
+    // GPU 없이 기록 백엔드로 재생하면 제출 경로의 CPU 비용만 남는다
+    // 다시 기록한 바이트가 원본과 같아야 재생이 빠짐없이 되었다는 뜻이다
+    CommandStreamWriter replayed;
+    replayed.Reserve(loaded.size());
+    CommandReplayStats replayStats = {};
+    chrono::steady_clock::time_point replayStart = chrono::steady_clock::now();
+    bool replayedAll = ReplayCommandStream(loaded, replayed, &replayStats);
+    double replayMilliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - replayStart).count();
+    bool roundTrip = replayedAll && replayed.GetStream() == loaded;
+
+    // 참조 캡처와 명령 단위로 비교해서 빌드나 설정 사이에 제출 경로가 바뀌었는지 본다. 참조가 없으면 이번 것을 참조로 남긴다
+    char comparison[160];
+    path referencePath = path(GetAppPath(L"captures")) / CommandReferenceCaptureName;
+    vector<uint8_t> reference;
+    CommandStreamDiff diff = {};
+    if (!LoadCommandCapture(referencePath, reference))
+        snprintf(comparison, sizeof(comparison), "%s", SaveCommandCapture(referencePath, loaded) ? "saved as reference" : "reference save failed");
+    else if (!CompareCommandStreams(reference, loaded, diff))
+        snprintf(comparison, sizeof(comparison), "reference unreadable");
+    else if (diff.identical)
+        snprintf(comparison, sizeof(comparison), "matches reference");
+    else
+        snprintf(comparison, sizeof(comparison), "differs from reference at command %llu (%s vs %s)",
+            static_cast<unsigned long long>(diff.commandIndex), GetCommandTypeName(diff.referenceType), GetCommandTypeName(diff.capturedType));
+
+    char status[384];
+    snprintf(status, sizeof(status), "%u frames, %llu commands, %zu KB, replay %.3f ms (%s), %s",
+        replayStats.frameCount, static_cast<unsigned long long>(replayStats.commandCount), loaded.size() / 1024, replayMilliseconds,
+        roundTrip ? "round trip ok" : "ROUND TRIP MISMATCH", comparison);
+    commandCaptureStatus = status;
+
+    char message[512];
+    snprintf(message, sizeof(message), "command capture %s: %s\n", capturePath.string().c_str(), status);
+    OutputDebugStringA(message);
+}
+
+bool MyWindow::OnInit(HINSTANCE hInstance, LPCWSTR className, int nShowCmd)
+{
+    windowInstance = hInstance;
+    windowClassName = className;
+    windowShowCmd = nShowCmd;
+
+    // 단계와 의존성은 StartupStages.cpp에 있다. StartupBenchmark가 같은 그래프를 대역으로 잰다
+    StartupGraph startupGraph;
+    AddStartupStages(startupGraph, *this);
+
+    bool succeeded = startupGraph.Run(executor);
+
+    // 시작 시간 분석용. 디버거 출력 창에서 볼 수 있다
+    string report = startupGraph.FormatReport();
+    report += adapterCacheHit ? "  adapter cache hit\n" : "  adapter cache miss\n";
+    OutputDebugStringA(report.c_str());
+
+    if (!succeeded)
         return false;
 
+    // 시뮬레이션은 렌더와 따로 고정 틱으로 돌고, OnUpdate에서 최신 스냅샷만 가져온다
+    simulation.Start();
+    lastFrameTime = chrono::steady_clock::now();
+    startTime = lastFrameTime;
+
+    initialized = true;
     return true;
 }
 
 void MyWindow::OnDestroy()
 {
+    if (!initialized)
+        return;
+
+    simulation.Stop();
+
     // Ensure that the GPU is no longer referencing resources that are about to be
     // cleaned up by the destructor.
-    WaitForPreviousFrame();
-    
-    CloseHandle(fenceEvent);
+    WaitForGpu();
+
+    // 아직 인코더로 넘기지 않은 캡처를 마저 쓴다
+    frameCapture.Flush(gpuQueues.GetCompletedValue(QueueType::Graphics));
+    frameCapture.Destroy();
+
+    gpuQueues.Destroy();
 }
 
 
 void MyWindow::OnUpdate()
 {
-    // do nothing
+    if (!initialized)
+        return;
+
+    // 여기서부터 OnRender의 제출까지는 예열이 끝나면 워커 스레드까지 포함해서 힙 할당이 없어야 한다
+    frameHeapAllocationStart = GetHeapAllocationCount();
+
+    // 락 없이 가장 최근에 완성된 시뮬레이션 스냅샷을 받아서 지금 시각으로 보간한다
+    SimulationState state = simulation.AcquireInterpolated(chrono::steady_clock::now());
+
+    float sinAngle = sinf(state.angle);
+    float cosAngle = cosf(state.angle);
+
+    // CPU 쪽 사본을 고치고, 버퍼에는 PopulateCommandList의 Upload가 올린다
+    Vertex* vertices = reinterpret_cast<Vertex*>(vertexUploadData.data());
+    float minCorner[3] = { FLT_MAX, FLT_MAX, 0.5f };
+    float maxCorner[3] = { -FLT_MAX, -FLT_MAX, 0.5f };
+    for (UINT i = 0; i < _countof(baseTriangleVertices); i++)
+    {
+        const XMFLOAT3& position = baseTriangleVertices[i].position;
+        vertices[i].position.x = position.x * cosAngle - position.y * sinAngle;
+        vertices[i].position.y = (position.x * sinAngle + position.y * cosAngle) * aspectRatio;
+
+        minCorner[0] = min(minCorner[0], vertices[i].position.x);
+        minCorner[1] = min(minCorner[1], vertices[i].position.y);
+        maxCorner[0] = max(maxCorner[0], vertices[i].position.x);
+        maxCorner[1] = max(maxCorner[1], vertices[i].position.y);
+    }
+
+    // 삼각형의 경계 상자와 상태 표시
+    debugDraw.AddBox(minCorner, maxCorner, DebugDraw::MakeColor(1.0f, 1.0f, 0.0f));
+
+    float time = chrono::duration<float>(chrono::steady_clock::now() - startTime).count();
+    UpdateLodInstances(time);
+    UpdateOcclusion(time);
+    UpdateShadows(time);
+    DrawLodInstances(time);
+
+    uint32_t lodHistogram[MeshAsset::MaxLods] = {};
+    for (uint8_t lod : instanceLods)
+        lodHistogram[lod]++;
+
+    char lodStatus[192];
+    int lodStatusLength = snprintf(lodStatus, sizeof(lodStatus), "LOD: %u instances %.2f ms (%s), per LOD",
+        lodInstances.GetCount(), lodSelectMilliseconds, lodSelector.GetSimdPath() == LodSimdPath::Avx2 ? "AVX2" : "scalar");
+    for (uint32_t lod = 0; lod < lodSelector.GetLodCount() && lodStatusLength < static_cast<int>(sizeof(lodStatus)); lod++)
+        lodStatusLength += snprintf(lodStatus + lodStatusLength, sizeof(lodStatus) - lodStatusLength, " %u", lodHistogram[lod]);
+
+    const OcclusionStats& occlusionStats = occlusionCuller.GetStats();
+    char occlusionStatus[192];
+    snprintf(occlusionStatus, sizeof(occlusionStatus), "occlusion: %u/%u visible, raster %.2f ms (%u tris), test %.2f ms (%s)",
+        occlusionStats.visibleObjects, occlusionStats.testedObjects, occlusionRenderMilliseconds, occlusionStats.rasterizedTriangles,
+        occlusionTestMilliseconds, occlusionCuller.GetSimdPath() == OcclusionSimdPath::Avx2 ? "AVX2" : "scalar");
+
+    const ShadowCacheStats& shadowStats = shadowCache.GetStats();
+    char shadowStatus[192];
+    snprintf(shadowStatus, sizeof(shadowStatus), "shadow cache: %u/%u tiles redrawn (%u deferred, %u fall back), %u copied, %u dynamic, caster draws %u + %u (uncached %u), %.2f ms",
+        shadowStats.staticTiles, shadowStats.totalTiles, shadowStats.pendingTiles, shadowStats.unsampleableTiles, shadowStats.copyTiles, shadowStats.dynamicTiles,
+        shadowStats.staticCasterDraws, shadowStats.dynamicCasterDraws, shadowStats.uncachedCasterDraws, shadowUpdateMilliseconds);
+
+    const DebugDrawStats& debugDrawStats = debugDraw.GetStats();
+    char lightStatus[128];
+    if (clusteredLighting.UsesGpu())
+        snprintf(lightStatus, sizeof(lightStatus), "GPU, %u lights", clusteredLighting.GetLightCount());
+    else
+        snprintf(lightStatus, sizeof(lightStatus), "CPU %.2f ms, %u lights, max %u per cluster", clusteredLighting.GetCpuAssignMilliseconds(), clusteredLighting.GetLightCount(), clusteredLighting.GetCpuStats().maxLightsInCluster);
+
+    char frameStatus[128];
+    snprintf(frameStatus, sizeof(frameStatus), "frame heap allocations: %llu, steady frames with allocations: %llu, arena %zu KB",
+        static_cast<unsigned long long>(frameHeapAllocations), static_cast<unsigned long long>(steadyHeapAllocationFrames), frameArenas.GetCurrent().GetStats().peakBytes / 1024);
+
+    // 추가 창 하나가 더 잡는 메모리는 백 버퍼와 RTV 칸뿐이다
+    uint32_t surfaceCount = surfaces.GetSurfaceCount();
+    char surfaceStatus[160];
+    snprintf(surfaceStatus, sizeof(surfaceStatus), "%u extra, %llu KB per window, %llu graphics submits last frame",
+        surfaceCount, static_cast<unsigned long long>(surfaceCount > 0 ? surfaces.GetTotalMemory() / surfaceCount / 1024 : 0),
+        static_cast<unsigned long long>(frameSubmissions));
+
+    // 읽기 전에 덮어쓴 스냅샷이 많으면 렌더가 시뮬레이션보다 느린 것이다
+    const SimulationStats simulationStats = simulation.GetStats();
+    char simulationStatus[192];
+    snprintf(simulationStatus, sizeof(simulationStatus), "simulation: %llu ticks, %llu published, %llu overwritten, %llu acquired, latency %.2f ms (max %.2f)",
+        static_cast<unsigned long long>(simulationStats.tickCount), static_cast<unsigned long long>(simulationStats.publishCount),
+        static_cast<unsigned long long>(simulationStats.overwrittenCount), static_cast<unsigned long long>(simulationStats.acquireCount),
+        simulationStats.lastLatencyMs, simulationStats.maxLatencyMs);
+
+    char status[1536];
+    snprintf(status, sizeof(status), "F7 windows: %s\nF8 command capture: %s\nF9 light culling: %s\nF11 particles: %s\nF12 capture: %s\n%s\n%s\n%s\n%s\n%s\ndebug draw: %u draws, %u line vertices",
+        surfaceStatus,
+        commandCaptureStatus.c_str(),
+        lightStatus,
+        particles.UsesGpu() ? "GPU" : "CPU",
+        capturing ? "on" : "off",
+        lodStatus,
+        occlusionStatus,
+        shadowStatus,
+        frameStatus,
+        simulationStatus,
+        debugDrawStats.drawCount,
+        debugDrawStats.vertexCounts[static_cast<uint32_t>(DebugDrawStream::DepthLines)] + debugDrawStats.vertexCounts[static_cast<uint32_t>(DebugDrawStream::OverlayLines)]);
+    debugDraw.AddText(8.0f, 8.0f, status, DebugDraw::MakeColor(1.0f, 1.0f, 1.0f));
+}
+
+void MyWindow::UpdateLodInstances(float time)
+{
+    // 앞쪽 인스턴스들은 4x4로 서서 각자 다가왔다 멀어진다
+    for (uint32_t i = 0; i < LodDrawnInstanceCount; i++)
+    {
+        lodInstances.x[i] = (static_cast<float>(i % 4) - 1.5f) * 3.0f;
+        lodInstances.y[i] = (static_cast<float>(i / 4) - 1.5f) * 1.5f;
+        lodInstances.z[i] = 4.0f + 40.0f * (0.5f + 0.5f * sinf(time * 0.4f + i * 0.7f));
+    }
+
+    // 카메라는 ClusteredLighting과 같은 뷰 공간 원점이다
+    LodCamera camera = { 0.0f, 0.0f, 0.0f, viewport.Height / (2.0f * LodTanHalfFovY), LodPixelThreshold, LodHysteresis };
+    chrono::steady_clock::time_point selectStart = chrono::steady_clock::now();
+    lodSelector.Select(lodInstances, camera, instanceLods.data(), &executor);
+    lodSelectMilliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - selectStart).count();
+}
+
+void MyWindow::UpdateOcclusion(float time)
+{
+    OcclusionCamera camera = { LodNearZ, LodTanHalfFovY * aspectRatio, LodTanHalfFovY };
+
+    // 벽은 단위 상자를 늘려서 옮긴 것이다
+    chrono::steady_clock::time_point renderStart = chrono::steady_clock::now();
+    occlusionCuller.BeginFrame(camera);
+    for (uint32_t i = 0; i < OccluderWallCount; i++)
+    {
+        float minCorner[3], maxCorner[3];
+        GetWallBounds(i, time, minCorner, maxCorner);
+        float transform[12] =
+        {
+            maxCorner[0] - minCorner[0], 0.0f, 0.0f, minCorner[0],
+            0.0f, maxCorner[1] - minCorner[1], 0.0f, minCorner[1],
+            0.0f, 0.0f, maxCorner[2] - minCorner[2], minCorner[2],
+        };
+        occlusionCuller.AddOccluder(occluderBoxPositions, 8, occluderBoxIndices, _countof(occluderBoxIndices), transform);
+        AddViewBox(debugDraw, minCorner, maxCorner, aspectRatio, DebugDraw::MakeColor(1.0f, 1.0f, 1.0f));
+    }
+    occlusionCuller.Render(&executor);
+
+    // 토러스는 어떻게 돌아가도 경계 구 안에 있으므로 구를 감싸는 상자로 본다
+    chrono::steady_clock::time_point testStart = chrono::steady_clock::now();
+    const MeshAsset& mesh = meshAssets[0];
+    for (uint32_t i = 0; i < LodDrawnInstanceCount; i++)
+    {
+        float scale = lodInstances.scale[i];
+        float radius = mesh.boundsRadius * scale;
+        float center[3] =
+        {
+            lodInstances.x[i] + mesh.boundsCenter[0] * scale,
+            lodInstances.y[i] + mesh.boundsCenter[1] * scale,
+            lodInstances.z[i] + mesh.boundsCenter[2] * scale,
+        };
+        float minCorner[3] = { center[0] - radius, center[1] - radius, center[2] - radius };
+        float maxCorner[3] = { center[0] + radius, center[1] + radius, center[2] + radius };
+        occlusionBounds.Set(i, minCorner, maxCorner);
+    }
+    occlusionCuller.TestBounds(occlusionBounds, occlusionVisible.data(), &executor);
+    chrono::steady_clock::time_point testEnd = chrono::steady_clock::now();
+
+    occlusionRenderMilliseconds = chrono::duration<double, milli>(testStart - renderStart).count();
+    occlusionTestMilliseconds = chrono::duration<double, milli>(testEnd - testStart).count();
+
+    // 바닥 상자는 보이면 초록, 가려지면 어두운 빨강
+    uint32_t visibleColor = DebugDraw::MakeColor(0.2f, 1.0f, 0.3f);
+    uint32_t culledColor = DebugDraw::MakeColor(0.4f, 0.1f, 0.1f);
+    for (uint32_t i = LodDrawnInstanceCount; i < occlusionBounds.GetCount(); i++)
+    {
+        float minCorner[3] = { occlusionBounds.minX[i], occlusionBounds.minY[i], occlusionBounds.minZ[i] };
+        float maxCorner[3] = { occlusionBounds.maxX[i], occlusionBounds.maxY[i], occlusionBounds.maxZ[i] };
+        AddViewBox(debugDraw, minCorner, maxCorner, aspectRatio, occlusionVisible[i] ? visibleColor : culledColor);
+    }
+}
+
+void MyWindow::UpdateShadows(float time)
+{
+    chrono::steady_clock::time_point updateStart = chrono::steady_clock::now();
+
+    uint32_t lightStep = static_cast<uint32_t>(time / ShadowLightStepSeconds) % _countof(shadowLightDirections);
+    shadowCache.SetLightDirection(shadowLightDirections[lightStep]);
+
+    for (uint32_t i = 0; i < OccluderWallCount; i++)
+    {
+        ShadowCasterBounds bounds;
+        GetWallBounds(i, time, bounds.minCorner, bounds.maxCorner);
+        shadowCache.MoveStaticCaster(i, bounds);
+    }
+
+    // UpdateOcclusion이 이번 프레임 LOD 인스턴스 경계를 채워 두었다
+    for (uint32_t i = 0; i < LodDrawnInstanceCount; i++)
+    {
+        shadowDynamicCasters[i] =
+        {
+            { occlusionBounds.minX[i], occlusionBounds.minY[i], occlusionBounds.minZ[i] },
+            { occlusionBounds.maxX[i], occlusionBounds.maxY[i], occlusionBounds.maxZ[i] },
+        };
+    }
+
+    const float focus[3] = { 0.0f, 0.0f, ShadowFocusZ };
+    shadowCache.Update(focus, shadowDynamicCasters.data(), static_cast<uint32_t>(shadowDynamicCasters.size()));
+    shadowUpdateMilliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - updateStart).count();
+
+    // 아직 깊이 패스가 없어서 아틀라스 대신 칸 상태를 왼쪽 아래에 cascade별로 그린다
+    // 노랑: 이번에 다시 그린 칸, 하늘색: 움직이는 캐스터를 덧그린 칸, 주황: 미뤘지만 낡은 내용을 샘플하는 칸
+    // 빨강: 미뤄서 다음 cascade로 넘기는 칸, 회색: 캐시를 그대로 쓴 칸
+    const ShadowCacheDesc& desc = shadowCache.GetDesc();
+    const float tileHeight = 0.025f;
+    const float tileWidth = tileHeight / aspectRatio;
+    const float cascadeGap = tileWidth;
+    uint32_t renderedColor = DebugDraw::MakeColor(1.0f, 0.9f, 0.1f);
+    uint32_t dynamicColor = DebugDraw::MakeColor(0.2f, 0.8f, 1.0f);
+    uint32_t staleColor = DebugDraw::MakeColor(1.0f, 0.5f, 0.1f);
+    uint32_t fallbackColor = DebugDraw::MakeColor(1.0f, 0.2f, 0.2f);
+    uint32_t cachedColor = DebugDraw::MakeColor(0.3f, 0.3f, 0.3f);
+    for (uint32_t c = 0; c < desc.cascadeCount; c++)
+    {
+        float left = -0.97f + c * (desc.tilesPerSide * tileWidth + cascadeGap);
+        for (uint32_t y = 0; y < desc.tilesPerSide; y++)
+        {
+            for (uint32_t x = 0; x < desc.tilesPerSide; x++)
+            {
+                uint32_t color = cachedColor;
+                if (!shadowCache.IsSlotSampleable(c, x, y))
+                    color = fallbackColor;
+                else if (!shadowCache.IsSlotCached(c, x, y))
+                    color = staleColor;
+                else if (shadowCache.IsSlotRendered(c, x, y))
+                    color = renderedColor;
+                else if (shadowCache.IsSlotDynamic(c, x, y))
+                    color = dynamicColor;
+
+                // 칸 사이가 보이게 조금 줄여서 그린다
+                float x0 = left + x * tileWidth;
+                float y0 = -0.97f + y * tileHeight;
+                float x1 = x0 + tileWidth * 0.8f;
+                float y1 = y0 + tileHeight * 0.8f;
+                debugDraw.AddLine(x0, y0, 0.0f, x1, y0, 0.0f, color, DebugDepth::Overlay);
+                debugDraw.AddLine(x1, y0, 0.0f, x1, y1, 0.0f, color, DebugDepth::Overlay);
+                debugDraw.AddLine(x1, y1, 0.0f, x0, y1, 0.0f, color, DebugDepth::Overlay);
+                debugDraw.AddLine(x0, y1, 0.0f, x0, y0, 0.0f, color, DebugDepth::Overlay);
+            }
+        }
+    }
+}
+
+void MyWindow::DrawLodInstances(float time)
+{
+    const MeshAsset& mesh = meshAssets[0];
+    float spinSin = sinf(time * 0.5f);
+    float spinCos = cosf(time * 0.5f);
+    const float tiltSin = 0.8660254f; // 60도 눕혀서 구멍이 보이게 한다
+    const float tiltCos = 0.5f;
+
+    for (uint32_t i = 0; i < LodDrawnInstanceCount; i++)
+    {
+        float scale = lodInstances.scale[i];
+        // 벽에 완전히 가려진 인스턴스는 그리지 않는다
+        if (lodInstances.z[i] - mesh.boundsRadius * scale < LodNearZ || !occlusionVisible[i])
+            continue;
+
+        const MeshLod& lod = mesh.lods[instanceLods[i]];
+        const float* color = lodColors[instanceLods[i]];
+        uint32_t packedColor = DebugDraw::MakeColor(color[0], color[1], color[2]);
 
+        const uint32_t* indices = &mesh.indices[lod.indexOffset];
+        for (uint32_t t = 0; t < lod.indexCount; t += 3)
+        {
+            float projected[3][3];
+            for (uint32_t k = 0; k < 3; k++)
+            {
+                const float* position = &mesh.positions[indices[t + k] * 3];
+                float x = position[0] * spinCos - position[2] * spinSin;
+                float z = position[0] * spinSin + position[2] * spinCos;
+                float y = position[1] * tiltCos - z * tiltSin;
+                z = position[1] * tiltSin + z * tiltCos;
+
+                ProjectViewPoint(lodInstances.x[i] + x * scale, lodInstances.y[i] + y * scale, lodInstances.z[i] + z * scale, aspectRatio, projected[k]);
+            }
+
+            // 닫힌 메시에서는 엣지마다 양쪽 삼각형이 반대 방향으로 지나가므로 한 방향만 그린다
+            for (uint32_t k = 0; k < 3; k++)
+            {
+                uint32_t next = (k + 1) % 3;
+                if (indices[t + k] < indices[t + next])
+                    debugDraw.AddLine(projected[k][0], projected[k][1], projected[k][2], projected[next][0], projected[next][1], projected[next][2], packedColor);
+            }
+        }
+    }
 }
 
 bool MyWindow::OnRender()
 {
+    // 창은 초기화가 끝나기 전에 먼저 뜬다
+    if (!initialized)
+        return true;
+
+    chrono::steady_clock::time_point now = chrono::steady_clock::now();
+    float deltaTime = min(chrono::duration<float>(now - lastFrameTime).count(), MaxParticleDeltaTime);
+    lastFrameTime = now;
+
+    // GPU 경로면 compute 커맨드 리스트를 기록하고, CPU 경로면 여기서 시뮬레이션까지 끝낸다
+    // 이 슬롯을 마지막으로 쓴 프레임은 MoveToNextFrame에서 기다렸다
+    if (!particles.Update(deltaTime, frameIndex))
+        return false;
+
+    // 빛 배정도 같은 식이다. CPU 경로면 워커 스레드에서 배정까지 끝내고 돌아온다
+    if (!clusteredLighting.Update(deltaTime, frameIndex))
+        return false;
+
+    // 이번 프레임 임시 데이터를 둘 arena. arena도 FrameCount개라서 다시 쓸 arena의 프레임은 이미 끝나 있다
+    const uint64_t completedGraphicsValue = gpuQueues.GetCompletedValue(QueueType::Graphics);
+    LinearArena* frameArena = frameArenas.BeginFrame(completedGraphicsValue);
+    if (!frameArena)
+        return false;
+
+    // Free한 bindless 인덱스 중 GPU가 다 읽은 것을 다시 나눠줄 수 있게 한다
+    if (bindless)
+        bindlessHeap.Reclaim(completedGraphicsValue);
+
+    // F7로 부탁한 창은 프레임을 만들기 전에 연다. 아직 기록 중인 커맨드 리스트가 없는 때다
+    bool openedSurface = surfaceRequests > 0;
+    for (; surfaceRequests > 0; surfaceRequests--)
+    {
+        // 뒤에 연 창일수록 드물게 그려서 창마다 pacing이 따로인 것을 보인다
+        SurfacePacing pacing = { /*syncInterval*/ 1, /*frameInterval*/ surfaces.GetSurfaceCount() + 1 };
+        if (surfaces.AddSurface(SurfaceWidth, SurfaceHeight, pacing) == SurfaceSet::InvalidSurface)
+            OutputDebugStringA("failed to open another window\n");
+    }
+
+    // F8로 캡처하는 동안은 아래 호출이 모두 commandRecorder에도 기록된다
+    if (commandCaptureRequested && frameIndex == 0)
+    {
+        commandCaptureRequested = false;
+        commandCaptureFramesLeft = CommandCaptureFrames;
+        commandCaptureStatus = "recording";
+    }
+
+    ICommandBackend& commands = GetCommandBackend();
+    commands.BeginFrame(frameNumber);
+
+    // 이번 프레임의 패스들을 등록한다. compute 패스는 QueueType::Compute로 등록하면
+    // 읽고 쓰는 리소스를 보고 큐 사이의 Wait/Signal이 자동으로 들어간다
+    frameGraph.BeginFrame(frameArena);
+    // 파티클은 지난 프레임 결과를 읽어서 다른 핑퐁 버퍼에 쓰고, 클러스터 목록은 슬롯마다 따로 쓴다
+    // 그래서 compute 패스는 두 프레임 전 그래픽스만 기다리고 바로 앞 프레임 그래픽스와는 겹친다
+    ResourceId particleResult = ParticleResource + particles.GetResultBufferIndex();
+    ResourceId lightClusters = LightClusterResource + frameIndex;
+    if (particles.UsesGpu())
+    {
+        uint32_t particlePass = frameGraph.AddPass("Particles", QueueType::Compute, /*reads*/ { ParticleResource + 1 - particles.GetResultBufferIndex() }, /*writes*/ { particleResult });
+        gpuQueues.SetPassCommandList(particlePass, particles.GetComputeCommandList());
+    }
+    if (clusteredLighting.UsesGpu())
+    {
+        uint32_t lightCullingPass = frameGraph.AddPass("LightCulling", QueueType::Compute, /*reads*/ {}, /*writes*/ { lightClusters });
+        gpuQueues.SetPassCommandList(lightCullingPass, clusteredLighting.GetComputeCommandList());
+    }
+    uint32_t trianglePass = frameGraph.AddPass("Triangle", QueueType::Graphics, /*reads*/ { particleResult, lightClusters }, /*writes*/ { BackBufferResource });
+
     // Record all the commands we need to render the scene into the command list.
-    PopulateCommandList();
+    if (!PopulateCommandList())
+        return false;
+
+    gpuQueues.SetPassCommandList(trianglePass, commandList.get());
+
+    // 추가 창 패스는 삼각형 패스 뒤에 이어 붙여서 같은 ExecuteCommandLists로 나간다
+    if (!surfaces.Record(frameGraph, commands, frameNumber, frameIndex))
+        return false;
 
     // Execute the command list.
-    ID3D12CommandList* ppCommandLists[] = { commandList.get() };
-    commandQueue->ExecuteCommandLists(_countof(ppCommandLists), ppCommandLists);
+    uint64_t submissionsBefore = gpuQueues.GetSubmissionCount(QueueType::Graphics);
+    frameGraph.Compile();
+    if (!frameGraph.Submit(commands))
+        return false;
+
+    frameSubmissions = gpuQueues.GetSubmissionCount(QueueType::Graphics) - submissionsBefore;
+
+    frameArenas.EndFrame(frameGraph.GetStats(QueueType::Graphics).lastSignaledValue);
+    // 창을 연 프레임과 F12 캡처를 파일로 쓰는 동안은 사용자가 부탁한 일(스왑체인 생성, 인코더 스레드의 버퍼)이 할당하므로 세지 않는다
+    frameHeapAllocations = GetHeapAllocationCount() - frameHeapAllocationStart;
+    ReadbackRing::Stats captureRingStats = frameCapture.GetRingStats();
+    CaptureEncoderStats captureEncoderStats = frameCapture.GetEncoderStats();
+    bool captureBusy = capturing || captureRingStats.capturedCount > captureEncoderStats.encodedCount + captureEncoderStats.failedCount + captureRingStats.discardedCount;
+    if (frameNumber >= HeapAllocationWarmupFrames && !openedSurface && !captureBusy && frameHeapAllocations > 0 && steadyHeapAllocationFrames++ == 0)
+    {
+        // 처음 한 번만 알린다. 이후 횟수는 상태 표시에 나온다
+        char message[128];
+        snprintf(message, sizeof(message), "frame %llu: %llu heap allocations while building the frame\n",
+            static_cast<unsigned long long>(frameNumber), static_cast<unsigned long long>(frameHeapAllocations));
+        OutputDebugStringA(message);
+    }
+
+    // 복사는 삼각형 패스 커맨드 리스트에 들어 있다. 추가 창 패스도 같은 그래픽스 큐에서 그 뒤에 나가므로
+    // 그래픽스 큐의 마지막 시그널 값이 지나면 복사도 끝난 것이다
+    frameCapture.Submit(frameGraph.GetStats(QueueType::Graphics).lastSignaledValue);
 
     //// Present the frame.
-    if (FAILED(swapChain->Present(1, 0)))
+    if (!commands.Present(1))
         return false;
 
-    WaitForPreviousFrame();
+    // 추가 창은 각자의 스왑체인이 준비됐을때만 그렸으므로 여기서 막히지 않는다
+    if (!surfaces.Present())
+        return false;
+
+    if (!MoveToNextFrame())
+        return false;
+
+    if (commandCaptureFramesLeft > 0 && --commandCaptureFramesLeft == 0)
+        FinishCommandCapture();
+
+    // 몇 프레임 전에 복사한 슬롯 중 끝난 것만 인코더로 넘긴다
+    if (!frameCapture.Poll(gpuQueues.GetCompletedValue(QueueType::Graphics)))
+        return false;
+
+    frameNumber++;
     return true;
 }
 
@@ -466,6 +1488,26 @@ LRESULT CALLBACK MyWindow::WindowProc(HWND hWnd, UINT message, WPARAM wParam, LP
         }
         return 0;
 
+    case WM_KEYDOWN:
+        if (MyWindow* myWindow = reinterpret_cast<MyWindow*>(GetWindowLongPtr(hWnd, GWLP_USERDATA)))
+        {
+            // F12: 프레임 캡처, F11: 파티클을 compute 셰이더와 CPU(AVX2) 경로 사이에서 바꾼다
+            // F9: 빛 배정을 compute 셰이더와 CPU(AVX2, 워커 스레드) 경로 사이에서 바꾼다. F10은 WM_SYSKEYDOWN으로 와서 쓰지 않는다
+            // F8: 다음 CommandCaptureFrames 프레임의 커맨드 스트림을 캡처해서 파일로 남기고, 재생해 보고 참조 캡처와 비교한다
+            // F7: 같은 디바이스를 쓰는 창을 하나 더 연다 (최대 D3D12SurfaceBackend::MaxSurfaces개)
+            if (wParam == VK_F12)
+                myWindow->capturing = !myWindow->capturing;
+            else if (wParam == VK_F11)
+                myWindow->particles.SetUseGpu(!myWindow->particles.UsesGpu());
+            else if (wParam == VK_F9)
+                myWindow->clusteredLighting.SetUseGpu(!myWindow->clusteredLighting.UsesGpu());
+            else if (wParam == VK_F8)
+                myWindow->StartCommandCapture();
+            else if (wParam == VK_F7 && myWindow->surfaces.GetSurfaceCount() + myWindow->surfaceRequests < D3D12SurfaceBackend::MaxSurfaces)
+                myWindow->surfaceRequests++;
+        }
+        return 0;
+
     case WM_DESTROY:
         PostQuitMessage(0);
         return 0;
@@ -4,32 +4,147 @@
 #include <directx/d3d12.h>
 #include <directx/d3dx12.h>
 #include <dxgi1_6.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "AsyncFileReader.h"
+#include "BindlessHeap.h"
+#include "ClusteredLighting.h"
+#include "CommandStream.h"
+#include "D3D12CommandBackend.h"
+#include "D3D12SurfaceBackend.h"
+#include "DebugDraw.h"
+#include "DebugDrawRenderer.h"
+#include "Executor.h"
+#include "FenceWaiter.h"
+#include "FrameArena.h"
+#include "FrameCapture.h"
+#include "FrameGraph.h"
+#include "GpuQueues.h"
+#include "LodSelector.h"
+#include "MeshAsset.h"
+#include "OcclusionCuller.h"
+#include "ParticleSystem.h"
+#include "ShadowCache.h"
+#include "SimulationThread.h"
+#include "StartupStages.h"
+#include "SurfaceSet.h"
+#include "Task.h"
 
-class MyWindow
+class MyWindow : private IStartupStages
 {    
     static const UINT FrameCount = 2;
 
+    // 코루틴 실행기. fenceWaiter, fileReader보다 먼저 만들어지고 나중에 없어져야 한다
+    Executor executor;
+    FenceWaiter fenceWaiter;
+    AsyncFileReader fileReader;
+
+    HWND hWnd;
+    HINSTANCE windowInstance; // OnInit에서 받아서 CreateMainWindow가 쓴다
+    LPCWSTR windowClassName;
+    int windowShowCmd;
+    bool initialized;     // 창이 먼저 뜨므로 초기화가 끝나기 전에 WM_PAINT가 올 수 있다
+    bool adapterCacheHit; // 이번 시작에서 어댑터 캐시를 썼는지
+
+    winrt::com_ptr<IDXGIFactory4> factory;
     winrt::com_ptr<ID3D12Device> device;
-    winrt::com_ptr<ID3D12CommandQueue> commandQueue;
+    GpuQueues gpuQueues; // 그래픽스 큐, async compute 큐와 각각의 fence
+    FrameGraph frameGraph;
+
+    // 프레임을 만드는 동안의 임시 데이터. 그 프레임의 그래픽스 fence가 지나면 다시 쓴다
+    FrameArenas frameArenas;
+    uint64_t frameHeapAllocationStart;   // OnUpdate를 시작할때 모든 스레드의 힙 할당 수
+    uint64_t frameHeapAllocations;      // 지난 프레임에 OnUpdate 시작부터 제출까지 워커를 포함한 모든 스레드가 한 힙 할당
+    uint64_t steadyHeapAllocationFrames; // 예열이 끝난 뒤 힙 할당이 있었던 프레임 수. 0이어야 한다
+
     winrt::com_ptr<IDXGISwapChain3> swapChain;
     winrt::com_ptr<ID3D12DescriptorHeap> rtvHeap;
     winrt::com_ptr<ID3D12Resource> renderTargets[FrameCount];
-    winrt::com_ptr<ID3D12CommandAllocator> commandAllocator;
+    winrt::com_ptr<ID3D12CommandAllocator> commandAllocators[FrameCount];
+
+    // 프레임 슬롯마다 그 프레임 끝에서 큐별로 signal한 값. 슬롯을 다시 쓰기 전에 이 값까지만 기다린다
+    uint64_t frameFenceValues[FrameCount][QueueTypeCount];
 
-    // LoadAssets에서 만듦
+    // CreateCommandList, CreatePipelineState에서 만듦
     winrt::com_ptr<ID3D12GraphicsCommandList> commandList;
-    winrt::com_ptr<ID3D12Fence> fence;
     winrt::com_ptr<ID3D12PipelineState> pipelineState; // 이걸 초기화하지 않는다.
 
     winrt::com_ptr<ID3D12RootSignature> rootSignature;
     winrt::com_ptr<ID3D12Resource> vertexBuffer;
     D3D12_VERTEX_BUFFER_VIEW vertexBufferView;
+    UINT8* vertexDataBegin; // upload 힙이라 계속 Map해둔다. 쓰는 것은 d3d12Commands의 Upload뿐이다
+    std::vector<uint8_t> vertexUploadData; // OnUpdate가 고쳐 쓰는 CPU 쪽 정점
+
+    // bindless 모드일때는 rootSignature가 bindlessHeap의 것이고, 버텍스 버퍼를 인덱스로 넘긴다
+    bool bindless;
+    BindlessHeap bindlessHeap;
+    uint32_t vertexBufferIndex;
+
+    // Shaders 스테이지에서 컴파일해서 PipelineState 스테이지에서 쓴다
+    std::vector<uint8_t> vertexShaderBytecode;
+    std::vector<uint8_t> pixelShaderBytecode;
+
+    // compute 셰이더 파티클. ParticleShaders 스테이지에서 컴파일해서 Particles 스테이지에서 쓴다
+    ParticleSystem particles;
+    ParticleSystem::Shaders particleShaders;
+    std::chrono::steady_clock::time_point lastFrameTime;
+
+    // 바닥을 비추는 clustered 조명. ClusteredLightingShaders 스테이지에서 컴파일해서 ClusteredLighting 스테이지에서 쓴다
+    ClusteredLighting clusteredLighting;
+    ClusteredLighting::Shaders clusteredLightingShaders;
 
-    HANDLE fenceEvent;
+    // 아무 스레드에서나 넣는 디버그 선/글자. PopulateCommandList에서 스트림마다 한번씩 그린다
+    DebugDraw debugDraw;
+    DebugDrawRenderer debugDrawRenderer;
+    DebugDrawRenderer::Shaders debugDrawShaders;
+
+    // 시작할때 읽거나 단순화한 LOD 메시. MeshAssets 스테이지에서 채운다
+    std::vector<MeshAsset> meshAssets;
+
+    // 첫 메시를 쓰는 인스턴스들의 LOD를 매 프레임 화면 크기로 고른다. 앞쪽 몇 개만 와이어프레임으로 그린다
+    LodSelector lodSelector;
+    LodInstances lodInstances;
+    std::vector<uint8_t> instanceLods;
+    double lodSelectMilliseconds;
+
+    // 벽 몇 개를 CPU로 래스터해서 LOD 인스턴스와 바닥 상자들이 가려졌는지 본다. 가려진 인스턴스는 그리지 않는다
+    OcclusionCuller occlusionCuller;
+    OcclusionBounds occlusionBounds;
+    std::vector<uint8_t> occlusionVisible;
+    double occlusionRenderMilliseconds;
+    double occlusionTestMilliseconds;
+
+    // 그림자 맵 타일 캐시. 정적 캐스터는 벽과 바닥 상자, 움직이는 캐스터는 앞쪽 LOD 인스턴스다
+    ShadowCache shadowCache;
+    std::vector<ShadowCasterBounds> shadowDynamicCasters;
+    double shadowUpdateMilliseconds;
+    std::chrono::steady_clock::time_point startTime;
 
     UINT frameIndex;
     UINT rtvDescriptorSize;
-    UINT fenceValue;
+
+    // 윈도우 스레드와 따로 고정 틱으로 돌아가는 시뮬레이션
+    SimulationThread simulation;
+
+    // F12로 켜고 끄는 프레임 캡처. 렌더 스레드는 readback을 기다리지 않는다
+    FrameCapture frameCapture;
+    bool capturing;
+    uint64_t frameNumber;
+
+    // 프레임을 만드는 호출은 GetCommandBackend()를 거친다. F8로 캡처하는 동안만 commandTee가 commandRecorder에도 적는다
+    D3D12CommandBackend d3d12Commands;
+    CommandStreamWriter commandRecorder;
+    CommandTee commandTee;
+    bool commandCaptureRequested; // F8을 눌렀고 프레임 슬롯 0이 오기를 기다린다
+    uint32_t commandCaptureFramesLeft;
+    std::string commandCaptureStatus;
+
+    // F7로 여는 추가 창들. 디바이스 단위 오브젝트는 SharedContext 스테이지에서 넘긴 것을 같이 쓴다
+    D3D12SurfaceBackend surfaceBackend;
+    SurfaceSet surfaces;
+    uint32_t surfaceRequests;  // 다음 프레임 전에 열 창 수
+    uint64_t frameSubmissions; // 지난 프레임에 그래픽스 큐에 한 ExecuteCommandLists 횟수
 
     FLOAT aspectRatio;
     CD3DX12_VIEWPORT viewport;
@@ -40,18 +155,50 @@ public:
 
 private:
     void GetHardwareAdapter(IDXGIFactory1* pFactory, IDXGIAdapter1** ppAdapter, bool requestHighPerformanceAdapter = false);
+    bool GetCachedAdapter(IDXGIFactory4* pFactory, IDXGIAdapter1** ppAdapter);
 
-    bool LoadPipeline(HWND hWnd);
-    bool LoadAssets();
+    // 초기화 단계들. OnInit에서 AddStartupStages로 의존성에 맞춰 동시에 실행한다
+    bool CreateFactory() override;
+    bool CreateDevice() override;
+    bool CreateMainWindow() override;
+    bool CreateSwapChain() override;
+    bool CreateCommandList() override;
+    bool CreateRootSignature() override;
+    Task<bool> LoadShadersAsync() override;
+    bool CreatePipelineState() override;
+    bool CreateVertexBuffer() override;
+    bool CreateFrameCapture() override;
+    Task<bool> LoadParticleShadersAsync() override;
+    bool CreateParticles() override;
+    Task<bool> LoadClusteredLightingShadersAsync() override;
+    bool CreateClusteredLighting() override;
+    Task<bool> LoadDebugDrawShadersAsync() override;
+    bool CreateDebugDraw() override;
+    Task<bool> LoadMeshAssetsAsync() override;
+    bool CreateLodInstances() override;
+    bool CreateOcclusionCulling() override;
+    bool CreateShadowCache() override;
+    bool RegisterCommandObjects() override;
+    bool CreateSharedContext() override;
+    Task<bool> CompileShadersAsync(const wchar_t* fileName, const char* vertexTarget, const char* pixelTarget, std::vector<uint8_t>& vertexShader, std::vector<uint8_t>& pixelShader);
+    Task<bool> CompileShaderAsync(const std::vector<uint8_t>& source, const char* sourceName, const char* entryPoint, const char* target, std::vector<uint8_t>& shader);
     bool PopulateCommandList();
-    bool WaitForPreviousFrame();
+    bool WaitForGpu() override;
+    bool MoveToNextFrame();
+    ICommandBackend& GetCommandBackend();
+    void StartCommandCapture();
+    void FinishCommandCapture();
 
 public:
-    bool OnInit(HWND hWnd);
+    bool OnInit(HINSTANCE hInstance, LPCWSTR className, int nShowCmd);
     void OnDestroy();
 
 private:
     void OnUpdate();
+    void UpdateLodInstances(float time);
+    void UpdateOcclusion(float time);
+    void UpdateShadows(float time);
+    void DrawLodInstances(float time);
     bool OnRender();
 
 public:
@@ -0,0 +1,712 @@
+#include "OcclusionCuller.h"
+#include "CpuFeatures.h"
+#include "FrameArena.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define OCCLUSION_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#define OCCLUSION_AVX2_TARGET
+#else
+// 이 함수만 AVX2로 만든다. FMA는 켜지 않는다 (스칼라 경로와 결과가 달라진다)
+#define OCCLUSION_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+
+using namespace std;
+
+namespace
+{
+    uint32_t RoundUp(uint32_t value, uint32_t multiple)
+    {
+        return (value + multiple - 1) / multiple * multiple;
+    }
+}
+
+void OcclusionBounds::Resize(uint32_t count)
+{
+    minX.resize(count);
+    minY.resize(count);
+    minZ.resize(count);
+    maxX.resize(count);
+    maxY.resize(count);
+    maxZ.resize(count);
+}
+
+void OcclusionBounds::Set(uint32_t index, const float minCorner[3], const float maxCorner[3])
+{
+    minX[index] = minCorner[0];
+    minY[index] = minCorner[1];
+    minZ[index] = minCorner[2];
+    maxX[index] = maxCorner[0];
+    maxY[index] = maxCorner[1];
+    maxZ[index] = maxCorner[2];
+}
+
+void OcclusionCuller::ScreenTriangles::Clear()
+{
+    for (uint32_t k = 0; k < 3; k++)
+    {
+        x[k].clear();
+        y[k].clear();
+        depth[k].clear();
+    }
+    count = 0;
+}
+
+void OcclusionCuller::ScreenTriangles::Add(const float x[3], const float y[3], const float depth[3])
+{
+    for (uint32_t k = 0; k < 3; k++)
+    {
+        this->x[k].push_back(x[k]);
+        this->y[k].push_back(y[k]);
+        this->depth[k].push_back(depth[k]);
+    }
+    count++;
+}
+
+void OcclusionCuller::ScreenTriangles::Pad()
+{
+    // 세 꼭짓점이 같은 점이라 면적이 0이고 설정에서 버려진다
+    uint32_t paddedCount = RoundUp(count, 8);
+    for (uint32_t k = 0; k < 3; k++)
+    {
+        x[k].resize(paddedCount, 0.0f);
+        y[k].resize(paddedCount, 0.0f);
+        depth[k].resize(paddedCount, 0.0f);
+    }
+}
+
+void OcclusionCuller::TriangleSetup::Resize(uint32_t count)
+{
+    for (uint32_t k = 0; k < 3; k++)
+    {
+        edgeA[k].resize(count);
+        edgeB[k].resize(count);
+        edgeC[k].resize(count);
+    }
+    depthA.resize(count);
+    depthB.resize(count);
+    depthC.resize(count);
+    minX.resize(count);
+    minY.resize(count);
+    maxX.resize(count);
+    maxY.resize(count);
+}
+
+OcclusionCuller::OcclusionCuller()
+    : width(0), height(0), tilesX(0), tilesY(0), camera{}, simdPath(OcclusionSimdPath::Scalar), stats{}
+{
+    SetSimdPath(OcclusionSimdPath::Avx2);
+}
+
+void OcclusionCuller::Init(uint32_t width, uint32_t height)
+{
+    this->width = RoundUp(max(width, 1u), TileWidth);
+    this->height = RoundUp(max(height, 1u), TileHeight);
+    tilesX = this->width / TileWidth;
+    tilesY = this->height / TileHeight;
+    depthBuffer.assign(static_cast<size_t>(this->width) * this->height, 0.0f);
+
+    // 1x1이 될때까지 반씩 줄인다. 홀수면 올려서 가장자리 텍셀이 덜 덮는다
+    levelWidths.assign(1, this->width);
+    levelHeights.assign(1, this->height);
+    while (levelWidths.back() > 1 || levelHeights.back() > 1)
+    {
+        levelWidths.push_back((levelWidths.back() + 1) / 2);
+        levelHeights.push_back((levelHeights.back() + 1) / 2);
+    }
+
+    minLevels.assign(levelWidths.size(), {});
+    maxLevels.assign(levelWidths.size(), {});
+    for (size_t level = 1; level < levelWidths.size(); level++)
+    {
+        minLevels[level].assign(static_cast<size_t>(levelWidths[level]) * levelHeights[level], 0.0f);
+        maxLevels[level].assign(static_cast<size_t>(levelWidths[level]) * levelHeights[level], 0.0f);
+    }
+}
+
+void OcclusionCuller::SetSimdPath(OcclusionSimdPath path)
+{
+    simdPath = (path == OcclusionSimdPath::Avx2 && !IsAvx2Supported()) ? OcclusionSimdPath::Scalar : path;
+}
+
+void OcclusionCuller::BeginFrame(const OcclusionCamera& camera)
+{
+    this->camera = camera;
+    triangles.Clear();
+    stats = {};
+}
+
+void OcclusionCuller::AddOccluder(const float* positions, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount, const float transform[12])
+{
+    viewPositions.resize(static_cast<size_t>(vertexCount) * 3);
+    for (uint32_t i = 0; i < vertexCount; i++)
+    {
+        const float* p = &positions[i * 3];
+        for (uint32_t row = 0; row < 3; row++)
+            viewPositions[i * 3 + row] = transform[row * 4] * p[0] + transform[row * 4 + 1] * p[1] + transform[row * 4 + 2] * p[2] + transform[row * 4 + 3];
+    }
+
+    for (uint32_t i = 0; i + 2 < indexCount; i += 3)
+    {
+        float view[3][3];
+        for (uint32_t k = 0; k < 3; k++)
+            copy_n(&viewPositions[indices[i + k] * 3], 3, view[k]);
+
+        stats.occluderTriangles++;
+        AddClippedTriangle(view);
+    }
+}
+
+void OcclusionCuller::AddClippedTriangle(const float (&view)[3][3])
+{
+    uint32_t insideCount = 0;
+    for (uint32_t k = 0; k < 3; k++)
+        if (view[k][2] >= camera.nearZ)
+            insideCount++;
+
+    if (insideCount == 3)
+    {
+        ProjectTriangle(view);
+        return;
+    }
+    if (insideCount == 0)
+        return;
+
+    // near 평면으로 잘라서 남은 다각형(꼭짓점 3~4개)을 부채꼴로 나눈다. 감긴 방향은 그대로다
+    stats.clippedTriangles++;
+    float polygon[4][3];
+    uint32_t polygonCount = 0;
+    for (uint32_t k = 0; k < 3; k++)
+    {
+        const float* a = view[k];
+        const float* b = view[(k + 1) % 3];
+        bool aInside = a[2] >= camera.nearZ;
+        bool bInside = b[2] >= camera.nearZ;
+
+        if (aInside)
+            copy_n(a, 3, polygon[polygonCount++]);
+
+        if (aInside != bInside)
+        {
+            float t = (camera.nearZ - a[2]) / (b[2] - a[2]);
+            polygon[polygonCount][0] = a[0] + (b[0] - a[0]) * t;
+            polygon[polygonCount][1] = a[1] + (b[1] - a[1]) * t;
+            polygon[polygonCount][2] = camera.nearZ;
+            polygonCount++;
+        }
+    }
+
+    for (uint32_t k = 1; k + 1 < polygonCount; k++)
+    {
+        float fan[3][3];
+        copy_n(polygon[0], 3, fan[0]);
+        copy_n(polygon[k], 3, fan[1]);
+        copy_n(polygon[k + 1], 3, fan[2]);
+        ProjectTriangle(fan);
+    }
+}
+
+void OcclusionCuller::ProjectTriangle(const float (&view)[3][3])
+{
+    float x[3], y[3], depth[3];
+    for (uint32_t k = 0; k < 3; k++)
+    {
+        float ndcX = view[k][0] / (view[k][2] * camera.tanHalfFovX);
+        float ndcY = view[k][1] / (view[k][2] * camera.tanHalfFovY);
+        x[k] = (ndcX * 0.5f + 0.5f) * width;
+        y[k] = (0.5f - ndcY * 0.5f) * height;
+        depth[k] = camera.nearZ / view[k][2];
+    }
+    triangles.Add(x, y, depth);
+}
+
+void OcclusionCuller::Render(Executor* executor)
+{
+    triangles.Pad();
+    setup.Resize(static_cast<uint32_t>(triangles.x[0].size()));
+
+    uint32_t tileCount = tilesX * tilesY;
+    uint32_t chunkCount = (triangles.count + TrianglesPerBinningTask - 1) / TrianglesPerBinningTask;
+    if (bins.size() < static_cast<size_t>(chunkCount) * tileCount)
+        bins.resize(static_cast<size_t>(chunkCount) * tileCount);
+    chunkRasterized.assign(chunkCount, 0);
+
+    if (executor)
+    {
+        // 분류가 다 끝나야 타일마다 모든 묶음의 목록을 볼 수 있다. 태스크 배열은 스레드 임시 메모리에 둔다
+        ScratchScope scratch;
+        ArenaVector<Task<void>> tasks(ArenaAllocator<Task<void>>(&scratch.GetArena()));
+        tasks.reserve(chunkCount);
+        for (uint32_t chunk = 0; chunk < chunkCount; chunk++)
+            tasks.push_back(BinChunkAsync(*executor, chunk));
+        SyncWait(WhenAll(move(tasks)));
+
+        // 옮기고 나면 비어 있으므로 다시 잡는다
+        tasks.clear();
+        tasks.reserve(tilesY);
+        for (uint32_t tileY = 0; tileY < tilesY; tileY++)
+            tasks.push_back(RasterizeTileRowAsync(*executor, tileY));
+        SyncWait(WhenAll(move(tasks)));
+    }
+    else
+    {
+        for (uint32_t chunk = 0; chunk < chunkCount; chunk++)
+            BinChunk(chunk);
+        for (uint32_t tileY = 0; tileY < tilesY; tileY++)
+            RasterizeTileRow(tileY);
+    }
+
+    for (uint32_t chunk = 0; chunk < chunkCount; chunk++)
+    {
+        stats.rasterizedTriangles += chunkRasterized[chunk];
+        for (uint32_t tile = 0; tile < tileCount; tile++)
+            stats.binnedTriangles += static_cast<uint32_t>(bins[chunk * tileCount + tile].size());
+    }
+
+    BuildPyramid();
+}
+
+Task<void> OcclusionCuller::BinChunkAsync(Executor& executor, uint32_t chunk)
+{
+    co_await executor.Schedule();
+
+    BinChunk(chunk);
+}
+
+void OcclusionCuller::BinChunk(uint32_t chunk)
+{
+    uint32_t begin = chunk * TrianglesPerBinningTask;
+    uint32_t end = min(begin + TrianglesPerBinningTask, triangles.count);
+
+    // 묶음 크기가 8의 배수라서 AVX2는 채워둔 삼각형까지 8개씩 돈다
+    if (simdPath == OcclusionSimdPath::Avx2)
+        SetupAvx2(begin, RoundUp(end, 8));
+    else
+        SetupScalar(begin, end);
+
+    uint32_t tileCount = tilesX * tilesY;
+    vector<uint32_t>* chunkBins = &bins[static_cast<size_t>(chunk) * tileCount];
+    for (uint32_t tile = 0; tile < tileCount; tile++)
+        chunkBins[tile].clear();
+
+    uint32_t rasterized = 0;
+    for (uint32_t triangle = begin; triangle < end; triangle++)
+    {
+        if (setup.minX[triangle] > setup.maxX[triangle])
+            continue;
+
+        uint32_t tileX0 = setup.minX[triangle] / TileWidth;
+        uint32_t tileX1 = setup.maxX[triangle] / TileWidth;
+        uint32_t tileY0 = setup.minY[triangle] / TileHeight;
+        uint32_t tileY1 = setup.maxY[triangle] / TileHeight;
+        for (uint32_t tileY = tileY0; tileY <= tileY1; tileY++)
+            for (uint32_t tileX = tileX0; tileX <= tileX1; tileX++)
+                chunkBins[tileY * tilesX + tileX].push_back(triangle);
+        rasterized++;
+    }
+    chunkRasterized[chunk] = rasterized;
+}
+
+void OcclusionCuller::SetupScalar(uint32_t begin, uint32_t end)
+{
+    float maxPixelX = static_cast<float>(width - 1);
+    float maxPixelY = static_cast<float>(height - 1);
+
+    for (uint32_t i = begin; i < end; i++)
+    {
+        float x0 = triangles.x[0][i], x1 = triangles.x[1][i], x2 = triangles.x[2][i];
+        float y0 = triangles.y[0][i], y1 = triangles.y[1][i], y2 = triangles.y[2][i];
+        float d0 = triangles.depth[0][i], d1 = triangles.depth[1][i], d2 = triangles.depth[2][i];
+
+        // y가 아래로 가는 화면에서 양수면 시계 방향(앞면)이다
+        float area = (x1 - x0) * (y2 - y0) - (x2 - x0) * (y1 - y0);
+
+        // 엣지 i는 꼭짓점 i에서 i+1로 간다. 세 엣지 함수의 합이 면적의 두 배라서 앞면이면 안쪽에서 모두 양수다
+        setup.edgeA[0][i] = y0 - y1;
+        setup.edgeB[0][i] = x1 - x0;
+        setup.edgeC[0][i] = x0 * y1 - x1 * y0;
+        setup.edgeA[1][i] = y1 - y2;
+        setup.edgeB[1][i] = x2 - x1;
+        setup.edgeC[1][i] = x1 * y2 - x2 * y1;
+        setup.edgeA[2][i] = y2 - y0;
+        setup.edgeB[2][i] = x0 - x2;
+        setup.edgeC[2][i] = x2 * y0 - x0 * y2;
+
+        float depthA = ((d1 - d0) * (y2 - y0) - (d2 - d0) * (y1 - y0)) / area;
+        float depthB = ((d2 - d0) * (x1 - x0) - (d1 - d0) * (x2 - x0)) / area;
+        setup.depthA[i] = depthA;
+        setup.depthB[i] = depthB;
+        setup.depthC[i] = (d0 - depthA * x0) - depthB * y0;
+
+        // 중심(+0.5)이 경계 상자에 드는 픽셀. 정수로 바꾸기 전에 화면 바로 바깥까지로 자른다
+        float minX = min(max(ceilf(min(min(x0, x1), x2) - 0.5f), 0.0f), static_cast<float>(width));
+        float minY = min(max(ceilf(min(min(y0, y1), y2) - 0.5f), 0.0f), static_cast<float>(height));
+        float maxX = max(min(floorf(max(max(x0, x1), x2) - 0.5f), maxPixelX), -1.0f);
+        float maxY = max(min(floorf(max(max(y0, y1), y2) - 0.5f), maxPixelY), -1.0f);
+
+        bool accepted = area > 0.0f && minX <= maxX && minY <= maxY;
+        setup.minX[i] = accepted ? static_cast<int32_t>(minX) : 0;
+        setup.minY[i] = accepted ? static_cast<int32_t>(minY) : 0;
+        setup.maxX[i] = accepted ? static_cast<int32_t>(maxX) : -1;
+        setup.maxY[i] = accepted ? static_cast<int32_t>(maxY) : -1;
+    }
+}
+
+#if OCCLUSION_SIMD_X86
+OCCLUSION_AVX2_TARGET void OcclusionCuller::SetupAvx2(uint32_t begin, uint32_t end)
+{
+    // 삼각형 8개씩. SetupScalar와 같은 연산을 같은 순서로 한다
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 minusOne = _mm256_set1_ps(-1.0f);
+    const __m256 screenWidth = _mm256_set1_ps(static_cast<float>(width));
+    const __m256 screenHeight = _mm256_set1_ps(static_cast<float>(height));
+    const __m256 maxPixelX = _mm256_set1_ps(static_cast<float>(width - 1));
+    const __m256 maxPixelY = _mm256_set1_ps(static_cast<float>(height - 1));
+    const __m256i rejectedMin = _mm256_setzero_si256();
+    const __m256i rejectedMax = _mm256_set1_epi32(-1);
+
+    for (uint32_t i = begin; i < end; i += 8)
+    {
+        __m256 x0 = _mm256_loadu_ps(&triangles.x[0][i]), x1 = _mm256_loadu_ps(&triangles.x[1][i]), x2 = _mm256_loadu_ps(&triangles.x[2][i]);
+        __m256 y0 = _mm256_loadu_ps(&triangles.y[0][i]), y1 = _mm256_loadu_ps(&triangles.y[1][i]), y2 = _mm256_loadu_ps(&triangles.y[2][i]);
+        __m256 d0 = _mm256_loadu_ps(&triangles.depth[0][i]), d1 = _mm256_loadu_ps(&triangles.depth[1][i]), d2 = _mm256_loadu_ps(&triangles.depth[2][i]);
+
+        __m256 x10 = _mm256_sub_ps(x1, x0);
+        __m256 x20 = _mm256_sub_ps(x2, x0);
+        __m256 y10 = _mm256_sub_ps(y1, y0);
+        __m256 y20 = _mm256_sub_ps(y2, y0);
+        __m256 area = _mm256_sub_ps(_mm256_mul_ps(x10, y20), _mm256_mul_ps(x20, y10));
+
+        _mm256_storeu_ps(&setup.edgeA[0][i], _mm256_sub_ps(y0, y1));
+        _mm256_storeu_ps(&setup.edgeB[0][i], x10);
+        _mm256_storeu_ps(&setup.edgeC[0][i], _mm256_sub_ps(_mm256_mul_ps(x0, y1), _mm256_mul_ps(x1, y0)));
+        _mm256_storeu_ps(&setup.edgeA[1][i], _mm256_sub_ps(y1, y2));
+        _mm256_storeu_ps(&setup.edgeB[1][i], _mm256_sub_ps(x2, x1));
+        _mm256_storeu_ps(&setup.edgeC[1][i], _mm256_sub_ps(_mm256_mul_ps(x1, y2), _mm256_mul_ps(x2, y1)));
+        _mm256_storeu_ps(&setup.edgeA[2][i], _mm256_sub_ps(y2, y0));
+        _mm256_storeu_ps(&setup.edgeB[2][i], _mm256_sub_ps(x0, x2));
+        _mm256_storeu_ps(&setup.edgeC[2][i], _mm256_sub_ps(_mm256_mul_ps(x2, y0), _mm256_mul_ps(x0, y2)));
+
+        __m256 d10 = _mm256_sub_ps(d1, d0);
+        __m256 d20 = _mm256_sub_ps(d2, d0);
+        __m256 depthA = _mm256_div_ps(_mm256_sub_ps(_mm256_mul_ps(d10, y20), _mm256_mul_ps(d20, y10)), area);
+        __m256 depthB = _mm256_div_ps(_mm256_sub_ps(_mm256_mul_ps(d20, x10), _mm256_mul_ps(d10, x20)), area);
+        _mm256_storeu_ps(&setup.depthA[i], depthA);
+        _mm256_storeu_ps(&setup.depthB[i], depthB);
+        _mm256_storeu_ps(&setup.depthC[i], _mm256_sub_ps(_mm256_sub_ps(d0, _mm256_mul_ps(depthA, x0)), _mm256_mul_ps(depthB, y0)));
+
+        __m256 minX = _mm256_min_ps(_mm256_max_ps(_mm256_ceil_ps(_mm256_sub_ps(_mm256_min_ps(_mm256_min_ps(x0, x1), x2), half)), zero), screenWidth);
+        __m256 minY = _mm256_min_ps(_mm256_max_ps(_mm256_ceil_ps(_mm256_sub_ps(_mm256_min_ps(_mm256_min_ps(y0, y1), y2), half)), zero), screenHeight);
+        __m256 maxX = _mm256_max_ps(_mm256_min_ps(_mm256_floor_ps(_mm256_sub_ps(_mm256_max_ps(_mm256_max_ps(x0, x1), x2), half)), maxPixelX), minusOne);
+        __m256 maxY = _mm256_max_ps(_mm256_min_ps(_mm256_floor_ps(_mm256_sub_ps(_mm256_max_ps(_mm256_max_ps(y0, y1), y2), half)), maxPixelY), minusOne);
+
+        __m256 accepted = _mm256_and_ps(_mm256_cmp_ps(area, zero, _CMP_GT_OQ),
+            _mm256_and_ps(_mm256_cmp_ps(minX, maxX, _CMP_LE_OQ), _mm256_cmp_ps(minY, maxY, _CMP_LE_OQ)));
+        __m256i acceptedMask = _mm256_castps_si256(accepted);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&setup.minX[i]), _mm256_blendv_epi8(rejectedMin, _mm256_cvttps_epi32(minX), acceptedMask));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&setup.minY[i]), _mm256_blendv_epi8(rejectedMin, _mm256_cvttps_epi32(minY), acceptedMask));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&setup.maxX[i]), _mm256_blendv_epi8(rejectedMax, _mm256_cvttps_epi32(maxX), acceptedMask));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&setup.maxY[i]), _mm256_blendv_epi8(rejectedMax, _mm256_cvttps_epi32(maxY), acceptedMask));
+    }
+}
+#else
+void OcclusionCuller::SetupAvx2(uint32_t begin, uint32_t end)
+{
+    SetupScalar(begin, min(end, triangles.count));
+}
+#endif
+
+Task<void> OcclusionCuller::RasterizeTileRowAsync(Executor& executor, uint32_t tileY)
+{
+    co_await executor.Schedule();
+
+    RasterizeTileRow(tileY);
+}
+
+void OcclusionCuller::RasterizeTileRow(uint32_t tileY)
+{
+    for (uint32_t tileX = 0; tileX < tilesX; tileX++)
+        RasterizeTile(tileX, tileY);
+}
+
+void OcclusionCuller::RasterizeTile(uint32_t tileX, uint32_t tileY)
+{
+    int32_t x0 = static_cast<int32_t>(tileX * TileWidth);
+    int32_t y0 = static_cast<int32_t>(tileY * TileHeight);
+    int32_t x1 = x0 + static_cast<int32_t>(TileWidth) - 1;
+    int32_t y1 = y0 + static_cast<int32_t>(TileHeight) - 1;
+
+    for (int32_t y = y0; y <= y1; y++)
+        fill_n(&depthBuffer[static_cast<size_t>(y) * width + x0], TileWidth, 0.0f);
+
+    uint32_t tileCount = tilesX * tilesY;
+    uint32_t chunkCount = static_cast<uint32_t>(chunkRasterized.size());
+    for (uint32_t chunk = 0; chunk < chunkCount; chunk++)
+    {
+        for (uint32_t triangle : bins[static_cast<size_t>(chunk) * tileCount + tileY * tilesX + tileX])
+        {
+            int32_t rectX0 = max(x0, setup.minX[triangle]);
+            int32_t rectY0 = max(y0, setup.minY[triangle]);
+            int32_t rectX1 = min(x1, setup.maxX[triangle]);
+            int32_t rectY1 = min(y1, setup.maxY[triangle]);
+
+            if (simdPath == OcclusionSimdPath::Avx2)
+                RasterizeTriangleAvx2(triangle, rectX0, rectY0, rectX1, rectY1);
+            else
+                RasterizeTriangleScalar(triangle, rectX0, rectY0, rectX1, rectY1);
+        }
+    }
+}
+
+void OcclusionCuller::RasterizeTriangleScalar(uint32_t triangle, int32_t x0, int32_t y0, int32_t x1, int32_t y1)
+{
+    float a0 = setup.edgeA[0][triangle], b0 = setup.edgeB[0][triangle], c0 = setup.edgeC[0][triangle];
+    float a1 = setup.edgeA[1][triangle], b1 = setup.edgeB[1][triangle], c1 = setup.edgeC[1][triangle];
+    float a2 = setup.edgeA[2][triangle], b2 = setup.edgeB[2][triangle], c2 = setup.edgeC[2][triangle];
+    float depthA = setup.depthA[triangle], depthB = setup.depthB[triangle], depthC = setup.depthC[triangle];
+
+    for (int32_t y = y0; y <= y1; y++)
+    {
+        float py = static_cast<float>(y) + 0.5f;
+        float* row = &depthBuffer[static_cast<size_t>(y) * width];
+        for (int32_t x = x0; x <= x1; x++)
+        {
+            // 경계 위의 픽셀은 양쪽 삼각형이 다 칠한다. 틈이 생기는 것보다 낫다
+            float px = static_cast<float>(x) + 0.5f;
+            float e0 = (a0 * px + b0 * py) + c0;
+            float e1 = (a1 * px + b1 * py) + c1;
+            float e2 = (a2 * px + b2 * py) + c2;
+            if (e0 >= 0.0f && e1 >= 0.0f && e2 >= 0.0f)
+            {
+                float depth = (depthA * px + depthB * py) + depthC;
+                if (depth > row[x])
+                    row[x] = depth;
+            }
+        }
+    }
+}
+
+#if OCCLUSION_SIMD_X86
+OCCLUSION_AVX2_TARGET void OcclusionCuller::RasterizeTriangleAvx2(uint32_t triangle, int32_t x0, int32_t y0, int32_t x1, int32_t y1)
+{
+    // 가로 8픽셀씩. 타일이 8픽셀 경계에서 시작하므로 x0을 내려서 맞추고, 범위 밖 레인은 마스크로 끈다
+    // RasterizeTriangleScalar와 같은 연산을 같은 순서로 한다
+    const __m256 a0 = _mm256_set1_ps(setup.edgeA[0][triangle]), b0 = _mm256_set1_ps(setup.edgeB[0][triangle]), c0 = _mm256_set1_ps(setup.edgeC[0][triangle]);
+    const __m256 a1 = _mm256_set1_ps(setup.edgeA[1][triangle]), b1 = _mm256_set1_ps(setup.edgeB[1][triangle]), c1 = _mm256_set1_ps(setup.edgeC[1][triangle]);
+    const __m256 a2 = _mm256_set1_ps(setup.edgeA[2][triangle]), b2 = _mm256_set1_ps(setup.edgeB[2][triangle]), c2 = _mm256_set1_ps(setup.edgeC[2][triangle]);
+    const __m256 depthA = _mm256_set1_ps(setup.depthA[triangle]), depthB = _mm256_set1_ps(setup.depthB[triangle]), depthC = _mm256_set1_ps(setup.depthC[triangle]);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256i laneOffsets = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i firstX = _mm256_set1_epi32(x0 - 1);
+    const __m256i lastX = _mm256_set1_epi32(x1 + 1);
+
+    int32_t alignedX0 = x0 & ~7;
+    for (int32_t y = y0; y <= y1; y++)
+    {
+        __m256 py = _mm256_set1_ps(static_cast<float>(y) + 0.5f);
+        __m256 b0py = _mm256_mul_ps(b0, py);
+        __m256 b1py = _mm256_mul_ps(b1, py);
+        __m256 b2py = _mm256_mul_ps(b2, py);
+        __m256 depthBpy = _mm256_mul_ps(depthB, py);
+        float* row = &depthBuffer[static_cast<size_t>(y) * width];
+
+        for (int32_t x = alignedX0; x <= x1; x += 8)
+        {
+            __m256i pixelX = _mm256_add_epi32(_mm256_set1_epi32(x), laneOffsets);
+            __m256 px = _mm256_add_ps(_mm256_cvtepi32_ps(pixelX), half);
+            __m256i inRange = _mm256_and_si256(_mm256_cmpgt_epi32(pixelX, firstX), _mm256_cmpgt_epi32(lastX, pixelX));
+
+            __m256 e0 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a0, px), b0py), c0);
+            __m256 e1 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a1, px), b1py), c1);
+            __m256 e2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a2, px), b2py), c2);
+            __m256 inside = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(e0, zero, _CMP_GE_OQ), _mm256_cmp_ps(e1, zero, _CMP_GE_OQ)), _mm256_cmp_ps(e2, zero, _CMP_GE_OQ));
+            inside = _mm256_and_ps(inside, _mm256_castsi256_ps(inRange));
+            if (_mm256_testz_ps(inside, inside))
+                continue;
+
+            __m256 depth = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(depthA, px), depthBpy), depthC);
+            __m256 old = _mm256_loadu_ps(&row[x]);
+            __m256 closer = _mm256_and_ps(inside, _mm256_cmp_ps(depth, old, _CMP_GT_OQ));
+            _mm256_storeu_ps(&row[x], _mm256_blendv_ps(old, depth, closer));
+        }
+    }
+}
+#else
+void OcclusionCuller::RasterizeTriangleAvx2(uint32_t triangle, int32_t x0, int32_t y0, int32_t x1, int32_t y1)
+{
+    RasterizeTriangleScalar(triangle, x0, y0, x1, y1);
+}
+#endif
+
+void OcclusionCuller::BuildPyramid()
+{
+    for (size_t level = 1; level < levelWidths.size(); level++)
+    {
+        uint32_t levelWidth = levelWidths[level];
+        uint32_t levelHeight = levelHeights[level];
+        uint32_t sourceWidth = levelWidths[level - 1];
+        uint32_t sourceHeight = levelHeights[level - 1];
+
+        for (uint32_t y = 0; y < levelHeight; y++)
+        {
+            // 홀수 크기의 마지막 텍셀은 원본에 하나뿐인 줄/칸을 두 번 읽는다
+            uint32_t sourceY0 = y * 2;
+            uint32_t sourceY1 = min(sourceY0 + 1, sourceHeight - 1);
+            for (uint32_t x = 0; x < levelWidth; x++)
+            {
+                uint32_t sourceX0 = x * 2;
+                uint32_t sourceX1 = min(sourceX0 + 1, sourceWidth - 1);
+                uint32_t level0 = static_cast<uint32_t>(level - 1);
+
+                float minDepth = min(min(GetMinDepth(level0, sourceX0, sourceY0), GetMinDepth(level0, sourceX1, sourceY0)),
+                    min(GetMinDepth(level0, sourceX0, sourceY1), GetMinDepth(level0, sourceX1, sourceY1)));
+                float maxDepth = max(max(GetMaxDepth(level0, sourceX0, sourceY0), GetMaxDepth(level0, sourceX1, sourceY0)),
+                    max(GetMaxDepth(level0, sourceX0, sourceY1), GetMaxDepth(level0, sourceX1, sourceY1)));
+
+                minLevels[level][static_cast<size_t>(y) * levelWidth + x] = minDepth;
+                maxLevels[level][static_cast<size_t>(y) * levelWidth + x] = maxDepth;
+            }
+        }
+    }
+}
+
+float OcclusionCuller::GetMinDepth(uint32_t level, uint32_t x, uint32_t y) const
+{
+    return level == 0 ? depthBuffer[static_cast<size_t>(y) * width + x] : minLevels[level][static_cast<size_t>(y) * levelWidths[level] + x];
+}
+
+float OcclusionCuller::GetMaxDepth(uint32_t level, uint32_t x, uint32_t y) const
+{
+    return level == 0 ? depthBuffer[static_cast<size_t>(y) * width + x] : maxLevels[level][static_cast<size_t>(y) * levelWidths[level] + x];
+}
+
+bool OcclusionCuller::IsRectVisible(uint32_t level, uint32_t texelX, uint32_t texelY, int32_t x0, int32_t y0, int32_t x1, int32_t y1, float depth) const
+{
+    // 텍셀 안 모든 occluder보다 가깝거나 같으면 보이고, 모든 occluder보다 멀면 이 텍셀에서는 가려진다
+    // 레벨 0은 min과 max가 같아서 둘 중 하나로 끝난다
+    if (depth >= GetMaxDepth(level, texelX, texelY))
+        return true;
+    if (depth < GetMinDepth(level, texelX, texelY) || level == 0)
+        return false;
+
+    // 사각형과 겹치는 자식 텍셀만 내려간다
+    uint32_t childLevel = level - 1;
+    uint32_t childX0 = max(texelX * 2, static_cast<uint32_t>(x0) >> childLevel);
+    uint32_t childY0 = max(texelY * 2, static_cast<uint32_t>(y0) >> childLevel);
+    uint32_t childX1 = min(texelX * 2 + 1, static_cast<uint32_t>(x1) >> childLevel);
+    uint32_t childY1 = min(texelY * 2 + 1, static_cast<uint32_t>(y1) >> childLevel);
+    for (uint32_t childY = childY0; childY <= childY1; childY++)
+        for (uint32_t childX = childX0; childX <= childX1; childX++)
+            if (IsRectVisible(childLevel, childX, childY, x0, y0, x1, y1, depth))
+                return true;
+
+    return false;
+}
+
+bool OcclusionCuller::IsVisible(const float minCorner[3], const float maxCorner[3]) const
+{
+    // 카메라 뒤에 있으면 안 보이고, near 평면에 걸치면 투영할 수 없으니 보이는 것으로 한다
+    if (maxCorner[2] <= camera.nearZ)
+        return false;
+    if (minCorner[2] <= camera.nearZ)
+        return true;
+
+    // 8 꼭짓점을 투영해서 화면 사각형을 잡는다
+    float minScreenX = FLT_MAX, minScreenY = FLT_MAX;
+    float maxScreenX = -FLT_MAX, maxScreenY = -FLT_MAX;
+    for (uint32_t corner = 0; corner < 8; corner++)
+    {
+        float x = (corner & 1) ? maxCorner[0] : minCorner[0];
+        float y = (corner & 2) ? maxCorner[1] : minCorner[1];
+        float z = (corner & 4) ? maxCorner[2] : minCorner[2];
+        float screenX = (x / (z * camera.tanHalfFovX) * 0.5f + 0.5f) * width;
+        float screenY = (0.5f - y / (z * camera.tanHalfFovY) * 0.5f) * height;
+        minScreenX = min(minScreenX, screenX);
+        minScreenY = min(minScreenY, screenY);
+        maxScreenX = max(maxScreenX, screenX);
+        maxScreenY = max(maxScreenY, screenY);
+    }
+
+    // 화면 밖이면 절두체에서 걸러진다
+    if (maxScreenX < 0.0f || maxScreenY < 0.0f || minScreenX >= width || minScreenY >= height)
+        return false;
+
+    // 사각형이 걸치는 픽셀(포함)을 가장 가까운 면의 깊이로 본다
+    int32_t x0 = static_cast<int32_t>(max(minScreenX, 0.0f));
+    int32_t y0 = static_cast<int32_t>(max(minScreenY, 0.0f));
+    int32_t x1 = static_cast<int32_t>(min(maxScreenX, static_cast<float>(width - 1)));
+    int32_t y1 = static_cast<int32_t>(min(maxScreenY, static_cast<float>(height - 1)));
+    float depth = camera.nearZ / minCorner[2];
+
+    // 사각형이 2x2 텍셀 안에 드는 레벨에서 시작한다
+    uint32_t level = 0;
+    while (level + 1 < levelWidths.size() && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1))
+        level++;
+
+    for (uint32_t texelY = static_cast<uint32_t>(y0) >> level; texelY <= static_cast<uint32_t>(y1) >> level; texelY++)
+        for (uint32_t texelX = static_cast<uint32_t>(x0) >> level; texelX <= static_cast<uint32_t>(x1) >> level; texelX++)
+            if (IsRectVisible(level, texelX, texelY, x0, y0, x1, y1, depth))
+                return true;
+
+    return false;
+}
+
+void OcclusionCuller::TestBounds(const OcclusionBounds& bounds, uint8_t* visible, Executor* executor)
+{
+    uint32_t count = bounds.GetCount();
+    uint32_t visibleCount = 0;
+
+    if (!executor || count <= ObjectsPerTestTask)
+    {
+        visibleCount = TestRange(bounds, visible, 0, count);
+    }
+    else
+    {
+        // 구간마다 visible의 다른 칸을 쓰므로 락 없이 나눈다
+        ScratchScope scratch;
+        uint32_t taskCount = (count + ObjectsPerTestTask - 1) / ObjectsPerTestTask;
+        ArenaVector<uint32_t> visibleCounts(taskCount, 0, ArenaAllocator<uint32_t>(&scratch.GetArena()));
+        ArenaVector<Task<void>> tasks(ArenaAllocator<Task<void>>(&scratch.GetArena()));
+        tasks.reserve(taskCount);
+        for (uint32_t task = 0; task < taskCount; task++)
+        {
+            uint32_t begin = task * ObjectsPerTestTask;
+            tasks.push_back(TestRangeAsync(*executor, bounds, visible, begin, min(begin + ObjectsPerTestTask, count), visibleCounts[task]));
+        }
+        SyncWait(WhenAll(move(tasks)));
+
+        for (uint32_t taskVisibleCount : visibleCounts)
+            visibleCount += taskVisibleCount;
+    }
+
+    stats.testedObjects = count;
+    stats.visibleObjects = visibleCount;
+}
+
+Task<void> OcclusionCuller::TestRangeAsync(Executor& executor, const OcclusionBounds& bounds, uint8_t* visible, uint32_t begin, uint32_t end, uint32_t& visibleCount)
+{
+    co_await executor.Schedule();
+
+    visibleCount = TestRange(bounds, visible, begin, end);
+}
+
+uint32_t OcclusionCuller::TestRange(const OcclusionBounds& bounds, uint8_t* visible, uint32_t begin, uint32_t end) const
+{
+    uint32_t visibleCount = 0;
+    for (uint32_t i = begin; i < end; i++)
+    {
+        float minCorner[3] = { bounds.minX[i], bounds.minY[i], bounds.minZ[i] };
+        float maxCorner[3] = { bounds.maxX[i], bounds.maxY[i], bounds.maxZ[i] };
+        visible[i] = IsVisible(minCorner, maxCorner) ? 1 : 0;
+        visibleCount += visible[i];
+    }
+    return visibleCount;
+}
@@ -0,0 +1,160 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Executor.h"
+#include "Task.h"
+
+// 카메라는 뷰 공간 원점에서 +z를 본다 (+y가 위). ClusterGridDesc와 같은 약속이다
+struct OcclusionCamera
+{
+    float nearZ;
+    float tanHalfFovX;
+    float tanHalfFovY;
+};
+
+// 검사할 물체들의 뷰 공간 AABB. 성분별로 나눠 둔다
+struct OcclusionBounds
+{
+    std::vector<float> minX, minY, minZ;
+    std::vector<float> maxX, maxY, maxZ;
+
+    uint32_t GetCount() const { return static_cast<uint32_t>(minX.size()); }
+    void Resize(uint32_t count);
+    void Set(uint32_t index, const float minCorner[3], const float maxCorner[3]);
+};
+
+enum class OcclusionSimdPath
+{
+    Scalar,
+    Avx2,
+};
+
+struct OcclusionStats
+{
+    uint32_t occluderTriangles;   // AddOccluder로 들어온 삼각형
+    uint32_t clippedTriangles;    // near 평면에 걸려서 잘린 삼각형
+    uint32_t rasterizedTriangles; // 뒷면, 화면 밖, 면적 0을 빼고 남은 삼각형
+    uint32_t binnedTriangles;     // 타일마다 센 삼각형 합. 여러 타일에 걸치면 여러 번 센다
+    uint32_t testedObjects;
+    uint32_t visibleObjects;
+};
+
+// CPU 소프트웨어 래스터라이저로 가리는 물체(occluder)를 저해상도 깊이 버퍼에 그리고,
+// min/max 깊이 피라미드로 물체 AABB가 완전히 가려졌는지 본다
+// 깊이는 nearZ / viewZ라서 가까울수록 크고(near에서 1) 아무것도 없는 곳은 0이다. 화면 공간에서 선형이라 평면으로 보간된다
+//
+// 1. 삼각형 설정: 8개씩 AVX2로 엣지 함수, 깊이 평면, 픽셀 범위를 구하고 뒷면(화면에서 반시계)과 면적 0을 버린다
+// 2. 타일 분류: 삼각형마다 걸치는 TileWidth x TileHeight 타일 목록에 넣는다. 삼각형 묶음마다 워커 하나가 자기 목록에 넣는다
+// 3. 래스터: 타일마다 워커 하나가 가로 8픽셀씩 엣지 함수를 보고 더 가까운 깊이를 남긴다. 타일끼리 겹치지 않아서 락이 없다
+// 4. 피라미드: 2x2씩 줄여가며 가장 먼 깊이(min)와 가장 가까운 깊이(max)를 둔다
+// 5. 검사: AABB를 화면 사각형과 가장 가까운 깊이로 줄이고, 사각형이 몇 텍셀만 덮는 레벨에서 시작해 필요한 곳만 내려간다
+//
+// 깊이는 최댓값만 남기므로 그리는 순서, 스레드 수, 스칼라/AVX2에 상관없이 버퍼가 비트 단위로 같다
+// 픽셀 중심으로만 판정하므로 픽셀보다 작은 틈은 막힌 것으로 볼 수 있다. 저해상도 컬링에서 흔히 받아들이는 근사다
+class OcclusionCuller
+{
+public:
+    static const uint32_t TileWidth = 32;  // 8픽셀 묶음 4개
+    static const uint32_t TileHeight = 16;
+    static const uint32_t DefaultWidth = 320;
+    static const uint32_t DefaultHeight = 192;
+    static const uint32_t TrianglesPerBinningTask = 1024;
+    static const uint32_t ObjectsPerTestTask = 2048;
+
+private:
+    uint32_t width;
+    uint32_t height;
+    uint32_t tilesX;
+    uint32_t tilesY;
+    OcclusionCamera camera;
+    OcclusionSimdPath simdPath;
+    OcclusionStats stats;
+
+    // 투영한 삼각형. 꼭짓점마다 화면 픽셀 좌표(y는 아래로)와 깊이. 8의 배수까지 면적 0인 삼각형으로 채운다
+    struct ScreenTriangles
+    {
+        std::vector<float> x[3];
+        std::vector<float> y[3];
+        std::vector<float> depth[3];
+        uint32_t count = 0;
+
+        void Clear();
+        void Add(const float x[3], const float y[3], const float depth[3]);
+        void Pad();
+    };
+
+    // 설정이 끝난 삼각형. 픽셀 중심 (px, py)에서 edge = a * px + b * py + c, depth도 같은 꼴이다
+    struct TriangleSetup
+    {
+        std::vector<float> edgeA[3], edgeB[3], edgeC[3];
+        std::vector<float> depthA, depthB, depthC;
+        std::vector<int32_t> minX, minY, maxX, maxY; // 중심이 삼각형 경계 상자에 드는 픽셀 범위 (포함)
+
+        void Resize(uint32_t count);
+    };
+
+    std::vector<float> viewPositions; // AddOccluder에서 정점을 한 번씩만 옮기려고 잠깐 쓴다
+    ScreenTriangles triangles;
+    TriangleSetup setup;
+
+    // bins[묶음 * 타일 수 + 타일]. 묶음마다 자기 칸에만 쓰므로 분류도 락 없이 나눈다
+    std::vector<std::vector<uint32_t>> bins;
+    std::vector<uint32_t> chunkRasterized;
+
+    std::vector<float> depthBuffer;
+    std::vector<std::vector<float>> minLevels; // 0번은 depthBuffer와 같으므로 비워두고 1번부터 쓴다
+    std::vector<std::vector<float>> maxLevels;
+    std::vector<uint32_t> levelWidths;
+    std::vector<uint32_t> levelHeights;
+
+public:
+    OcclusionCuller();
+
+    // width는 TileWidth, height는 TileHeight의 배수로 올린다
+    void Init(uint32_t width = DefaultWidth, uint32_t height = DefaultHeight);
+
+    void SetSimdPath(OcclusionSimdPath path);
+    OcclusionSimdPath GetSimdPath() const { return simdPath; }
+
+    // 이번 프레임 occluder를 비운다
+    void BeginFrame(const OcclusionCamera& camera);
+
+    // transform은 메시 좌표를 뷰 공간으로 보내는 3x4 행렬 (행 우선, 마지막 열이 이동)
+    // 앞면은 화면에서 시계 방향으로 감긴 삼각형이다 (D3D 기본값과 같다)
+    void AddOccluder(const float* positions, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount, const float transform[12]);
+
+    // 들어온 occluder를 깊이 버퍼와 피라미드에 그린다. executor가 있으면 분류와 래스터를 워커들이 나눠서 한다
+    void Render(Executor* executor = nullptr);
+
+    // visible에 물체마다 1(보일 수 있음) 또는 0(화면 밖이거나 완전히 가려짐)을 쓴다
+    void TestBounds(const OcclusionBounds& bounds, uint8_t* visible, Executor* executor = nullptr);
+    bool IsVisible(const float minCorner[3], const float maxCorner[3]) const;
+
+    uint32_t GetWidth() const { return width; }
+    uint32_t GetHeight() const { return height; }
+    const std::vector<float>& GetDepthBuffer() const { return depthBuffer; }
+    const OcclusionStats& GetStats() const { return stats; }
+
+private:
+    void AddClippedTriangle(const float (&view)[3][3]);
+    void ProjectTriangle(const float (&view)[3][3]);
+
+    Task<void> BinChunkAsync(Executor& executor, uint32_t chunk);
+    void BinChunk(uint32_t chunk);
+    void SetupScalar(uint32_t begin, uint32_t end);
+    void SetupAvx2(uint32_t begin, uint32_t end);
+
+    Task<void> RasterizeTileRowAsync(Executor& executor, uint32_t tileY);
+    void RasterizeTileRow(uint32_t tileY);
+    void RasterizeTile(uint32_t tileX, uint32_t tileY);
+    void RasterizeTriangleScalar(uint32_t triangle, int32_t x0, int32_t y0, int32_t x1, int32_t y1);
+    void RasterizeTriangleAvx2(uint32_t triangle, int32_t x0, int32_t y0, int32_t x1, int32_t y1);
+
+    void BuildPyramid();
+    float GetMinDepth(uint32_t level, uint32_t x, uint32_t y) const;
+    float GetMaxDepth(uint32_t level, uint32_t x, uint32_t y) const;
+    bool IsRectVisible(uint32_t level, uint32_t texelX, uint32_t texelY, int32_t x0, int32_t y0, int32_t x1, int32_t y1, float depth) const;
+
+    Task<void> TestRangeAsync(Executor& executor, const OcclusionBounds& bounds, uint8_t* visible, uint32_t begin, uint32_t end, uint32_t& visibleCount);
+    uint32_t TestRange(const OcclusionBounds& bounds, uint8_t* visible, uint32_t begin, uint32_t end) const;
+};
@@ -0,0 +1,261 @@
+#include "ParticleSimulation.h"
+#include "CpuFeatures.h"
+#include <algorithm>
+#include <array>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define PARTICLE_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#define PARTICLE_AVX2_TARGET
+#else
+// 파일 전체를 AVX2로 빌드하지 않고 이 함수만 AVX2로 만든다. FMA는 켜지 않는다 (스칼라 경로와 결과가 달라진다)
+#define PARTICLE_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+
+using namespace std;
+
+namespace
+{
+    // particles.hlsl과 같은 값이어야 한다
+    const float Gravity = -1.2f;
+    const float FloorY = -1.0f;
+    const float Restitution = 0.5f;
+    const float EmitterX = 0.0f;
+    const float EmitterY = -0.6f;
+    const float SpreadX = 0.8f;
+    const float LaunchSpeed = 0.8f;
+    const float LaunchSpread = 0.6f;
+    const float MinLifetime = 1.5f;
+    const float LifetimeRange = 1.5f;
+
+    uint32_t PcgHash(uint32_t value)
+    {
+        uint32_t state = value * 747796405u + 2891336453u;
+        uint32_t word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+        return (word >> 22u) ^ word;
+    }
+
+    // 24비트만 써서 [0, 1) float로 정확히 바꾼다
+    float ToUnitFloat(uint32_t hash)
+    {
+        return static_cast<float>(hash >> 8) * (1.0f / 16777216.0f);
+    }
+
+    uint32_t RoundUpToSimdWidth(uint32_t value)
+    {
+        return (value + 7) & ~7u;
+    }
+
+#if PARTICLE_SIMD_X86
+    // 8비트 생존 마스크 -> 살아있는 레인을 앞으로 모으는 permute 인덱스
+    const array<array<uint32_t, 8>, 256>& GetCompactTable()
+    {
+        static const auto table = []
+        {
+            array<array<uint32_t, 8>, 256> t = {};
+            for (uint32_t mask = 0; mask < 256; mask++)
+            {
+                uint32_t n = 0;
+                for (uint32_t lane = 0; lane < 8; lane++)
+                    if (mask & (1u << lane))
+                        t[mask][n++] = lane;
+            }
+            return t;
+        }();
+        return table;
+    }
+#endif
+}
+
+ParticleSimulation::ParticleSimulation()
+    : capacity(0), count(0), nextId(0), seed(0), simdPath(ParticleSimdPath::Scalar)
+{
+}
+
+void ParticleSimulation::Reset(uint32_t capacity, uint32_t seed)
+{
+    this->capacity = capacity;
+    this->seed = seed;
+    count = 0;
+    nextId = 0;
+
+    // SIMD 경로는 마지막 8개 묶음을 넘어서 읽고 쓰므로 8의 배수로 잡는다
+    uint32_t paddedCapacity = RoundUpToSimdWidth(capacity);
+    positionX.assign(paddedCapacity, 0.0f);
+    positionY.assign(paddedCapacity, 0.0f);
+    velocityX.assign(paddedCapacity, 0.0f);
+    velocityY.assign(paddedCapacity, 0.0f);
+    age.assign(paddedCapacity, 0.0f);
+    lifetime.assign(paddedCapacity, 0.0f);
+    id.assign(paddedCapacity, 0);
+
+    SetSimdPath(ParticleSimdPath::Avx2);
+}
+
+void ParticleSimulation::SetSimdPath(ParticleSimdPath path)
+{
+    simdPath = (path == ParticleSimdPath::Avx2 && !IsAvx2Supported()) ? ParticleSimdPath::Scalar : path;
+}
+
+bool ParticleSimulation::IsAvx2Supported()
+{
+    return ::IsAvx2Supported();
+}
+
+void ParticleSimulation::EmitParticle(uint32_t particleId, uint32_t seed, GpuParticle& particle)
+{
+    uint32_t hash0 = PcgHash(particleId ^ seed);
+    uint32_t hash1 = PcgHash(hash0);
+    uint32_t hash2 = PcgHash(hash1);
+
+    particle.positionX = EmitterX;
+    particle.positionY = EmitterY;
+    particle.velocityX = (ToUnitFloat(hash0) - 0.5f) * SpreadX;
+    particle.velocityY = LaunchSpeed + ToUnitFloat(hash1) * LaunchSpread;
+    particle.age = 0.0f;
+    particle.lifetime = MinLifetime + ToUnitFloat(hash2) * LifetimeRange;
+    particle.id = particleId;
+    particle.padding = 0;
+}
+
+bool ParticleSimulation::SimulateParticle(GpuParticle& particle, float deltaTime)
+{
+    particle.velocityY = particle.velocityY + Gravity * deltaTime;
+    particle.positionX = particle.positionX + particle.velocityX * deltaTime;
+    particle.positionY = particle.positionY + particle.velocityY * deltaTime;
+
+    // 바닥에 닿으면 튕긴다
+    if (particle.positionY < FloorY)
+    {
+        particle.positionY = FloorY;
+        particle.velocityY = -particle.velocityY * Restitution;
+    }
+
+    particle.age = particle.age + deltaTime;
+    return particle.age < particle.lifetime;
+}
+
+void ParticleSimulation::Update(float deltaTime, uint32_t emitCount)
+{
+    if (simdPath == ParticleSimdPath::Avx2)
+        SimulateAvx2(deltaTime);
+    else
+        SimulateScalar(deltaTime);
+
+    Emit(emitCount);
+}
+
+void ParticleSimulation::SimulateScalar(float deltaTime)
+{
+    // 죽은 파티클을 빼면서 앞으로 당긴다. 순서는 유지된다
+    uint32_t writeIndex = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        GpuParticle particle = { positionX[i], positionY[i], velocityX[i], velocityY[i], age[i], lifetime[i], id[i], 0 };
+        if (!SimulateParticle(particle, deltaTime))
+            continue;
+
+        positionX[writeIndex] = particle.positionX;
+        positionY[writeIndex] = particle.positionY;
+        velocityX[writeIndex] = particle.velocityX;
+        velocityY[writeIndex] = particle.velocityY;
+        age[writeIndex] = particle.age;
+        lifetime[writeIndex] = particle.lifetime;
+        id[writeIndex] = particle.id;
+        writeIndex++;
+    }
+
+    count = writeIndex;
+}
+
+#if PARTICLE_SIMD_X86
+PARTICLE_AVX2_TARGET void ParticleSimulation::SimulateAvx2(float deltaTime)
+{
+    const auto& compactTable = GetCompactTable();
+
+    // SimulateParticle과 같은 연산을 같은 순서로 한다. mul + add를 fma로 합치지 않는다
+    const __m256 dt = _mm256_set1_ps(deltaTime);
+    const __m256 gravityDt = _mm256_set1_ps(Gravity * deltaTime);
+    const __m256 floorY = _mm256_set1_ps(FloorY);
+    const __m256 restitution = _mm256_set1_ps(Restitution);
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    const __m256i laneIndex = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+    uint32_t writeIndex = 0;
+    for (uint32_t i = 0; i < count; i += 8)
+    {
+        __m256 px = _mm256_loadu_ps(&positionX[i]);
+        __m256 py = _mm256_loadu_ps(&positionY[i]);
+        __m256 vx = _mm256_loadu_ps(&velocityX[i]);
+        __m256 vy = _mm256_loadu_ps(&velocityY[i]);
+        __m256 a = _mm256_loadu_ps(&age[i]);
+        __m256 life = _mm256_loadu_ps(&lifetime[i]);
+        __m256i ids = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&id[i]));
+
+        vy = _mm256_add_ps(vy, gravityDt);
+        px = _mm256_add_ps(px, _mm256_mul_ps(vx, dt));
+        py = _mm256_add_ps(py, _mm256_mul_ps(vy, dt));
+
+        __m256 below = _mm256_cmp_ps(py, floorY, _CMP_LT_OQ);
+        py = _mm256_blendv_ps(py, floorY, below);
+        vy = _mm256_blendv_ps(vy, _mm256_mul_ps(_mm256_xor_ps(vy, signMask), restitution), below);
+
+        a = _mm256_add_ps(a, dt);
+
+        // 마지막 묶음에서 count를 넘는 레인은 죽은 것으로 친다
+        __m256i valid = _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(count - i)), laneIndex);
+        __m256 alive = _mm256_and_ps(_mm256_cmp_ps(a, life, _CMP_LT_OQ), _mm256_castsi256_ps(valid));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_ps(alive));
+
+        // 살아있는 레인을 앞으로 모아서 writeIndex에 통째로 쓴다
+        // writeIndex <= i 이므로 이미 읽은 자리만 덮어쓴다
+        __m256i permute = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(compactTable[mask].data()));
+        _mm256_storeu_ps(&positionX[writeIndex], _mm256_permutevar8x32_ps(px, permute));
+        _mm256_storeu_ps(&positionY[writeIndex], _mm256_permutevar8x32_ps(py, permute));
+        _mm256_storeu_ps(&velocityX[writeIndex], _mm256_permutevar8x32_ps(vx, permute));
+        _mm256_storeu_ps(&velocityY[writeIndex], _mm256_permutevar8x32_ps(vy, permute));
+        _mm256_storeu_ps(&age[writeIndex], _mm256_permutevar8x32_ps(a, permute));
+        _mm256_storeu_ps(&lifetime[writeIndex], _mm256_permutevar8x32_ps(life, permute));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&id[writeIndex]), _mm256_permutevar8x32_epi32(ids, permute));
+
+        writeIndex += static_cast<uint32_t>(_mm_popcnt_u32(mask));
+    }
+
+    count = writeIndex;
+}
+#else
+void ParticleSimulation::SimulateAvx2(float deltaTime)
+{
+    SimulateScalar(deltaTime);
+}
+#endif
+
+void ParticleSimulation::Emit(uint32_t emitCount)
+{
+    // 꽉 차면 뒤쪽 id를 버린다. GPU 쪽도 같은 id를 버린다
+    uint32_t emitted = min(emitCount, capacity - count);
+    for (uint32_t i = 0; i < emitted; i++)
+    {
+        GpuParticle particle;
+        EmitParticle(nextId + i, seed, particle);
+
+        positionX[count] = particle.positionX;
+        positionY[count] = particle.positionY;
+        velocityX[count] = particle.velocityX;
+        velocityY[count] = particle.velocityY;
+        age[count] = particle.age;
+        lifetime[count] = particle.lifetime;
+        id[count] = particle.id;
+        count++;
+    }
+
+    nextId += emitCount;
+}
+
+void ParticleSimulation::Write(GpuParticle* output) const
+{
+    for (uint32_t i = 0; i < count; i++)
+        output[i] = { positionX[i], positionY[i], velocityX[i], velocityY[i], age[i], lifetime[i], id[i], 0 };
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// particles.hlsl의 Particle과 맞아야 한다. GPU 버퍼와 CPU 업로드 버퍼 모두 이 레이아웃이다
+struct GpuParticle
+{
+    float positionX;
+    float positionY;
+    float velocityX;
+    float velocityY;
+    float age;
+    float lifetime;
+    uint32_t id;
+    uint32_t padding;
+};
+
+// particles.hlsl의 ParticleConstants와 맞아야 한다
+struct ParticleConstants
+{
+    float deltaTime;
+    uint32_t emitCount;
+    uint32_t emitBaseId; // 이번 프레임 첫 파티클의 id. 같은 id면 CPU, GPU 모두 같은 초기값이 나온다
+    uint32_t seed;
+    uint32_t capacity;
+    uint32_t sourceIndex; // 핑퐁 버퍼 중 이번 프레임에 읽을 쪽
+    uint32_t reset;       // 1이면 카운터와 indirect 인자만 초기화한다
+    uint32_t padding;
+};
+
+enum class ParticleSimdPath
+{
+    Scalar,
+    Avx2,
+};
+
+// 파티클 시뮬레이션의 CPU 구현. GPU 경로(particles.hlsl)와 같은 순서, 같은 연산으로 계산한다
+// 한 프레임 = 살아있는 파티클 시뮬레이션 + 죽은 파티클 제거(compact) + 새 파티클 방출
+// GPU 쪽은 atomic append로 compact하므로 순서는 다를 수 있고, id로 맞춰 비교하면 된다
+// SIMD 계산을 위해 SoA로 들고 있고, 배열 크기는 8의 배수로 잡는다
+class ParticleSimulation
+{
+    std::vector<float> positionX;
+    std::vector<float> positionY;
+    std::vector<float> velocityX;
+    std::vector<float> velocityY;
+    std::vector<float> age;
+    std::vector<float> lifetime;
+    std::vector<uint32_t> id;
+
+    uint32_t capacity;
+    uint32_t count;
+    uint32_t nextId;
+    uint32_t seed;
+    ParticleSimdPath simdPath;
+
+public:
+    ParticleSimulation();
+
+    // AVX2를 지원하면 Avx2 경로를 쓴다
+    void Reset(uint32_t capacity, uint32_t seed);
+
+    void Update(float deltaTime, uint32_t emitCount);
+
+    void SetSimdPath(ParticleSimdPath path);
+    ParticleSimdPath GetSimdPath() const { return simdPath; }
+    static bool IsAvx2Supported();
+
+    uint32_t GetCount() const { return count; }
+    uint32_t GetCapacity() const { return capacity; }
+    uint32_t GetNextId() const { return nextId; } // 다음에 방출할 파티클의 id
+    uint32_t GetSeed() const { return seed; }
+
+    // 업로드 버퍼에 GPU 레이아웃으로 쓴다. output은 GetCount()개 이상이어야 한다
+    void Write(GpuParticle* output) const;
+
+    // 한 파티클의 계산. GPU 셰이더와 한 줄씩 대응한다
+    static void EmitParticle(uint32_t particleId, uint32_t seed, GpuParticle& particle);
+    static bool SimulateParticle(GpuParticle& particle, float deltaTime);
+
+private:
+    void SimulateScalar(float deltaTime);
+    void SimulateAvx2(float deltaTime);
+    void Emit(uint32_t emitCount);
+};
@@ -0,0 +1,349 @@
+#include "ParticleSystem.h"
+#include <directx/d3dx12.h>
+
+using namespace winrt;
+using namespace std;
+
+ParticleSystem::ParticleSystem()
+    : currentFrame(0), capacity(0), seed(0), nextEmitId(0), sourceIndex(0), emitAccumulator(0.0f),
+      useGpu(true), needsReset(true)
+{
+}
+
+bool ParticleSystem::Init(ID3D12Device* device, const Shaders& shaders, DXGI_FORMAT renderTargetFormat, uint32_t frameCount, uint32_t capacity, uint32_t seed)
+{
+    this->capacity = capacity;
+    this->seed = seed;
+    frames.resize(frameCount);
+
+    if (!CreateComputePipeline(device, shaders))
+        return false;
+
+    if (!CreateDrawPipeline(device, shaders, renderTargetFormat))
+        return false;
+
+    if (!CreateBuffers(device))
+        return false;
+
+    for (Frame& frame : frames)
+    {
+        if (FAILED(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COMPUTE, IID_PPV_ARGS(&frame.computeAllocator))))
+            return false;
+    }
+
+    if (FAILED(device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_COMPUTE, frames[0].computeAllocator.get(), nullptr, IID_PPV_ARGS(&computeCommandList))))
+        return false;
+
+    if (FAILED(computeCommandList->Close()))
+        return false;
+
+    Reset();
+    return true;
+}
+
+bool ParticleSystem::CreateComputePipeline(ID3D12Device* device, const Shaders& shaders)
+{
+    // descriptor 힙 없이 root UAV로만 버퍼를 넘긴다
+    CD3DX12_ROOT_PARAMETER rootParameters[ComputeRootParameterCount];
+    rootParameters[ConstantsParameter].InitAsConstants(sizeof(ParticleConstants) / 4, /*shaderRegister*/ 0);
+    rootParameters[SourceParticlesParameter].InitAsUnorderedAccessView(0);
+    rootParameters[DestParticlesParameter].InitAsUnorderedAccessView(1);
+    rootParameters[CountersParameter].InitAsUnorderedAccessView(2);
+    rootParameters[IndirectArgsParameter].InitAsUnorderedAccessView(3);
+
+    CD3DX12_ROOT_SIGNATURE_DESC rootSignatureDesc;
+    rootSignatureDesc.Init(_countof(rootParameters), rootParameters, /*numStaticSamplers*/ 0, /*pStaticSamplers*/ nullptr, D3D12_ROOT_SIGNATURE_FLAG_NONE);
+
+    com_ptr<ID3DBlob> signature;
+    com_ptr<ID3DBlob> error;
+    if (FAILED(D3D12SerializeRootSignature(&rootSignatureDesc, D3D_ROOT_SIGNATURE_VERSION_1, signature.put(), error.put())))
+        return false;
+
+    if (FAILED(device->CreateRootSignature(/*nodeMask*/0, signature->GetBufferPointer(), signature->GetBufferSize(), IID_PPV_ARGS(&computeRootSignature))))
+        return false;
+
+    const pair<const vector<uint8_t>*, com_ptr<ID3D12PipelineState>*> pipelines[] =
+    {
+        { &shaders.simulate, &simulatePipelineState },
+        { &shaders.emit, &emitPipelineState },
+        { &shaders.args, &argsPipelineState },
+    };
+
+    for (const auto& [bytecode, pipelineState] : pipelines)
+    {
+        D3D12_COMPUTE_PIPELINE_STATE_DESC psoDesc = {};
+        psoDesc.pRootSignature = computeRootSignature.get();
+        psoDesc.CS = CD3DX12_SHADER_BYTECODE(bytecode->data(), bytecode->size());
+        if (FAILED(device->CreateComputePipelineState(&psoDesc, IID_PPV_ARGS(pipelineState->put()))))
+            return false;
+    }
+
+    // 인자만 바뀌고 root 인자는 바꾸지 않으므로 root signature 없이 만든다
+    D3D12_INDIRECT_ARGUMENT_DESC dispatchArgument = {};
+    dispatchArgument.Type = D3D12_INDIRECT_ARGUMENT_TYPE_DISPATCH;
+
+    D3D12_COMMAND_SIGNATURE_DESC dispatchSignatureDesc = {};
+    dispatchSignatureDesc.ByteStride = sizeof(D3D12_DISPATCH_ARGUMENTS);
+    dispatchSignatureDesc.NumArgumentDescs = 1;
+    dispatchSignatureDesc.pArgumentDescs = &dispatchArgument;
+    if (FAILED(device->CreateCommandSignature(&dispatchSignatureDesc, nullptr, IID_PPV_ARGS(&dispatchSignature))))
+        return false;
+
+    return true;
+}
+
+bool ParticleSystem::CreateDrawPipeline(ID3D12Device* device, const Shaders& shaders, DXGI_FORMAT renderTargetFormat)
+{
+    // 버텍스 셰이더가 SV_VertexID로 파티클 버퍼를 직접 읽는다
+    CD3DX12_ROOT_PARAMETER rootParameters[1];
+    rootParameters[0].InitAsShaderResourceView(0, 0, D3D12_SHADER_VISIBILITY_VERTEX);
+
+    CD3DX12_ROOT_SIGNATURE_DESC rootSignatureDesc;
+    rootSignatureDesc.Init(_countof(rootParameters), rootParameters, /*numStaticSamplers*/ 0, /*pStaticSamplers*/ nullptr, D3D12_ROOT_SIGNATURE_FLAG_NONE);
+
+    com_ptr<ID3DBlob> signature;
+    com_ptr<ID3DBlob> error;
+    if (FAILED(D3D12SerializeRootSignature(&rootSignatureDesc, D3D_ROOT_SIGNATURE_VERSION_1, signature.put(), error.put())))
+        return false;
+
+    if (FAILED(device->CreateRootSignature(/*nodeMask*/0, signature->GetBufferPointer(), signature->GetBufferSize(), IID_PPV_ARGS(&drawRootSignature))))
+        return false;
+
+    D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
+    psoDesc.pRootSignature = drawRootSignature.get();
+    psoDesc.VS = CD3DX12_SHADER_BYTECODE(shaders.vertex.data(), shaders.vertex.size());
+    psoDesc.PS = CD3DX12_SHADER_BYTECODE(shaders.pixel.data(), shaders.pixel.size());
+    psoDesc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
+    psoDesc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
+    psoDesc.DepthStencilState.DepthEnable = FALSE;
+    psoDesc.DepthStencilState.StencilEnable = FALSE;
+    psoDesc.SampleMask = UINT_MAX;
+    psoDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_POINT;
+    psoDesc.NumRenderTargets = 1;
+    psoDesc.RTVFormats[0] = renderTargetFormat;
+    psoDesc.SampleDesc.Count = 1;
+
+    if (FAILED(device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&drawPipelineState))))
+        return false;
+
+    D3D12_INDIRECT_ARGUMENT_DESC drawArgument = {};
+    drawArgument.Type = D3D12_INDIRECT_ARGUMENT_TYPE_DRAW;
+
+    D3D12_COMMAND_SIGNATURE_DESC drawSignatureDesc = {};
+    drawSignatureDesc.ByteStride = sizeof(D3D12_DRAW_ARGUMENTS);
+    drawSignatureDesc.NumArgumentDescs = 1;
+    drawSignatureDesc.pArgumentDescs = &drawArgument;
+    if (FAILED(device->CreateCommandSignature(&drawSignatureDesc, nullptr, IID_PPV_ARGS(&drawSignature))))
+        return false;
+
+    return true;
+}
+
+bool ParticleSystem::CreateBuffers(ID3D12Device* device)
+{
+    const UINT64 particleBufferSize = static_cast<UINT64>(capacity) * sizeof(GpuParticle);
+
+    // 버퍼는 COMMON 상태로 만들고 상태 전환은 암묵적 promotion에 맡긴다 (RecordCompute 참고)
+    for (auto& buffer : particleBuffers)
+    {
+        if (FAILED(device->CreateCommittedResource(
+            &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+            D3D12_HEAP_FLAG_NONE,
+            &CD3DX12_RESOURCE_DESC::Buffer(particleBufferSize, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS),
+            D3D12_RESOURCE_STATE_COMMON,
+            nullptr,
+            IID_PPV_ARGS(&buffer))))
+            return false;
+    }
+
+    if (FAILED(device->CreateCommittedResource(
+        &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+        D3D12_HEAP_FLAG_NONE,
+        &CD3DX12_RESOURCE_DESC::Buffer(16, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS),
+        D3D12_RESOURCE_STATE_COMMON,
+        nullptr,
+        IID_PPV_ARGS(&counterBuffer))))
+        return false;
+
+    for (auto& buffer : indirectArgsBuffers)
+    {
+        if (FAILED(device->CreateCommittedResource(
+            &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+            D3D12_HEAP_FLAG_NONE,
+            &CD3DX12_RESOURCE_DESC::Buffer(DrawArgsOffset + sizeof(D3D12_DRAW_ARGUMENTS), D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS),
+            D3D12_RESOURCE_STATE_COMMON,
+            nullptr,
+            IID_PPV_ARGS(&buffer))))
+            return false;
+    }
+
+    // CPU 경로용 업로드 버퍼. 그 슬롯의 이전 프레임이 끝난 뒤에 고쳐 쓴다
+    for (Frame& frame : frames)
+    {
+        if (FAILED(device->CreateCommittedResource(
+            &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+            D3D12_HEAP_FLAG_NONE,
+            &CD3DX12_RESOURCE_DESC::Buffer(particleBufferSize),
+            D3D12_RESOURCE_STATE_GENERIC_READ,
+            nullptr,
+            IID_PPV_ARGS(&frame.uploadBuffer))))
+            return false;
+
+        CD3DX12_RANGE readRange(0, 0);
+        if (FAILED(frame.uploadBuffer->Map(0, &readRange, reinterpret_cast<void**>(&frame.uploadParticles))))
+            return false;
+    }
+
+    return true;
+}
+
+void ParticleSystem::Reset()
+{
+    cpuSimulation.Reset(capacity, seed);
+    nextEmitId = 0;
+    emitAccumulator = 0.0f;
+    needsReset = true;
+}
+
+void ParticleSystem::SetUseGpu(bool useGpu)
+{
+    if (this->useGpu == useGpu)
+        return;
+
+    this->useGpu = useGpu;
+    Reset();
+}
+
+bool ParticleSystem::Update(float deltaTime, uint32_t frameSlot)
+{
+    currentFrame = frameSlot;
+
+    // 방출 개수는 두 경로가 같은 값을 쓴다
+    emitAccumulator += EmitRate * deltaTime;
+    uint32_t emitCount = static_cast<uint32_t>(emitAccumulator);
+    emitAccumulator -= static_cast<float>(emitCount);
+
+    if (!useGpu)
+    {
+        cpuSimulation.Update(deltaTime, emitCount);
+        cpuSimulation.Write(frames[frameSlot].uploadParticles);
+        return true;
+    }
+
+    ParticleConstants constants = {};
+    constants.deltaTime = deltaTime;
+    constants.emitCount = emitCount;
+    constants.emitBaseId = nextEmitId;
+    constants.seed = seed;
+    constants.capacity = capacity;
+    constants.sourceIndex = sourceIndex;
+
+    if (!RecordCompute(constants))
+        return false;
+
+    nextEmitId += emitCount;
+    sourceIndex = 1 - sourceIndex;
+    return true;
+}
+
+bool ParticleSystem::RecordCompute(const ParticleConstants& constants)
+{
+    ID3D12CommandAllocator* computeAllocator = frames[currentFrame].computeAllocator.get();
+    if (FAILED(computeAllocator->Reset()))
+        return false;
+
+    if (FAILED(computeCommandList->Reset(computeAllocator, simulatePipelineState.get())))
+        return false;
+
+    ID3D12Resource* source = particleBuffers[constants.sourceIndex].get();
+    ID3D12Resource* dest = particleBuffers[1 - constants.sourceIndex].get();
+    ID3D12Resource* sourceArgs = indirectArgsBuffers[constants.sourceIndex].get();
+    ID3D12Resource* destArgs = indirectArgsBuffers[1 - constants.sourceIndex].get();
+
+    computeCommandList->SetComputeRootSignature(computeRootSignature.get());
+    computeCommandList->SetComputeRootUnorderedAccessView(SourceParticlesParameter, source->GetGPUVirtualAddress());
+    computeCommandList->SetComputeRootUnorderedAccessView(DestParticlesParameter, dest->GetGPUVirtualAddress());
+    computeCommandList->SetComputeRootUnorderedAccessView(CountersParameter, counterBuffer->GetGPUVirtualAddress());
+
+    // 버퍼는 ExecuteCommandLists가 끝나면 COMMON으로 돌아가고(decay), 커맨드 리스트에서 처음 쓸때 그 용도로 올라간다(promotion)
+    // 그래서 커맨드 리스트 사이의 상태는 맞추지 않고, 한 리스트 안에서 용도가 바뀔 때만 전환한다
+
+    // 카운터를 0으로, source 쪽 dispatch 인자를 0 그룹으로 만들어서 빈 상태에서 시작한다
+    if (needsReset)
+    {
+        computeCommandList->SetComputeRootUnorderedAccessView(IndirectArgsParameter, sourceArgs->GetGPUVirtualAddress());
+
+        ParticleConstants resetConstants = constants;
+        resetConstants.reset = 1;
+        computeCommandList->SetComputeRoot32BitConstants(ConstantsParameter, sizeof(ParticleConstants) / 4, &resetConstants, 0);
+
+        computeCommandList->SetPipelineState(argsPipelineState.get());
+        computeCommandList->Dispatch(1, 1, 1);
+
+        D3D12_RESOURCE_BARRIER barriers[] =
+        {
+            CD3DX12_RESOURCE_BARRIER::UAV(counterBuffer.get()),
+            CD3DX12_RESOURCE_BARRIER::Transition(sourceArgs, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT),
+        };
+        computeCommandList->ResourceBarrier(_countof(barriers), barriers);
+        computeCommandList->SetPipelineState(simulatePipelineState.get());
+        needsReset = false;
+    }
+
+    computeCommandList->SetComputeRoot32BitConstants(ConstantsParameter, sizeof(ParticleConstants) / 4, &constants, 0);
+
+    // 1. 시뮬레이션 + compact. 그룹 수는 지난 프레임 CSArgs가 살아있는 수에 맞춰 써뒀다
+    computeCommandList->ExecuteIndirect(dispatchSignature.get(), 1, sourceArgs, DispatchArgsOffset, nullptr, 0);
+
+    // 2. 방출. 시뮬레이션이 올려둔 dest 카운터 뒤에 붙인다
+    D3D12_RESOURCE_BARRIER afterSimulate[] =
+    {
+        CD3DX12_RESOURCE_BARRIER::UAV(dest),
+        CD3DX12_RESOURCE_BARRIER::UAV(counterBuffer.get()),
+    };
+    computeCommandList->ResourceBarrier(_countof(afterSimulate), afterSimulate);
+
+    if (constants.emitCount > 0)
+    {
+        computeCommandList->SetPipelineState(emitPipelineState.get());
+        computeCommandList->Dispatch((constants.emitCount + ThreadGroupSize - 1) / ThreadGroupSize, 1, 1);
+    }
+
+    // 3. 그리기 인자와 다음 프레임 dispatch 인자는 dest 쪽 인자 버퍼에 쓴다. 이 리스트에서 처음 쓰므로 UAV로 올라간다
+    // CSEmit이 읽은 dest 카운터를 CSArgs가 고쳐 쓰므로 카운터에도 UAV 배리어가 있어야 한다
+    D3D12_RESOURCE_BARRIER beforeArgs[] =
+    {
+        CD3DX12_RESOURCE_BARRIER::UAV(dest),
+        CD3DX12_RESOURCE_BARRIER::UAV(counterBuffer.get()),
+    };
+    computeCommandList->ResourceBarrier(_countof(beforeArgs), beforeArgs);
+
+    computeCommandList->SetComputeRootUnorderedAccessView(IndirectArgsParameter, destArgs->GetGPUVirtualAddress());
+    computeCommandList->SetPipelineState(argsPipelineState.get());
+    computeCommandList->Dispatch(1, 1, 1);
+
+    // dest와 인자 버퍼는 이 리스트가 끝나면 COMMON이 되고, 그래픽스 큐에서 SRV와 INDIRECT_ARGUMENT로 올라간다
+    if (FAILED(computeCommandList->Close()))
+        return false;
+
+    return true;
+}
+
+void ParticleSystem::RecordDraw(ID3D12GraphicsCommandList* commandList)
+{
+    commandList->SetPipelineState(drawPipelineState.get());
+    commandList->SetGraphicsRootSignature(drawRootSignature.get());
+    commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_POINTLIST);
+
+    if (useGpu)
+    {
+        // Update에서 sourceIndex를 넘겼으므로 이번 프레임 결과는 source 쪽에 있다
+        commandList->SetGraphicsRootShaderResourceView(0, particleBuffers[sourceIndex]->GetGPUVirtualAddress());
+        commandList->ExecuteIndirect(drawSignature.get(), 1, indirectArgsBuffers[sourceIndex].get(), DrawArgsOffset, nullptr, 0);
+    }
+    else
+    {
+        commandList->SetGraphicsRootShaderResourceView(0, frames[currentFrame].uploadBuffer->GetGPUVirtualAddress());
+        commandList->DrawInstanced(cpuSimulation.GetCount(), 1, 0, 0);
+    }
+}
@@ -0,0 +1,116 @@
+#pragma once
+#include <Windows.h>
+#include <winrt/base.h>
+#include <directx/d3d12.h>
+#include <vector>
+#include "ParticleSimulation.h"
+
+// 백만개 단위 파티클을 compute 셰이더로 방출/시뮬레이션/compact하고 indirect 인자로 그린다
+// CPU 경로(ParticleSimulation, AVX2)로 바꾸면 같은 시뮬레이션을 CPU에서 돌려 업로드 버퍼로 그린다
+// GPU 경로의 compute 커맨드 리스트는 async compute 큐에서 실행되고, FrameGraph가 그래픽스 큐와 동기화한다
+// 여러 프레임이 동시에 GPU에 있을 수 있으므로 CPU가 고쳐 쓰는 것(커맨드 할당자, 업로드 버퍼)은 프레임 슬롯마다 따로 둔다
+class ParticleSystem
+{
+public:
+    static const uint32_t DefaultCapacity = 1 << 20;
+    static const UINT ThreadGroupSize = 256;
+
+    // particles.hlsl의 DISPATCH_ARGS_OFFSET, DRAW_ARGS_OFFSET과 맞아야 한다
+    static const UINT DispatchArgsOffset = 0;
+    static const UINT DrawArgsOffset = 16;
+
+    struct Shaders
+    {
+        std::vector<uint8_t> simulate;
+        std::vector<uint8_t> emit;
+        std::vector<uint8_t> args;
+        std::vector<uint8_t> vertex;
+        std::vector<uint8_t> pixel;
+    };
+
+private:
+    enum ComputeRootParameter
+    {
+        ConstantsParameter,
+        SourceParticlesParameter,
+        DestParticlesParameter,
+        CountersParameter,
+        IndirectArgsParameter,
+        ComputeRootParameterCount,
+    };
+
+    winrt::com_ptr<ID3D12RootSignature> computeRootSignature;
+    winrt::com_ptr<ID3D12PipelineState> simulatePipelineState;
+    winrt::com_ptr<ID3D12PipelineState> emitPipelineState;
+    winrt::com_ptr<ID3D12PipelineState> argsPipelineState;
+    winrt::com_ptr<ID3D12CommandSignature> dispatchSignature;
+    winrt::com_ptr<ID3D12CommandSignature> drawSignature;
+
+    winrt::com_ptr<ID3D12RootSignature> drawRootSignature;
+    winrt::com_ptr<ID3D12PipelineState> drawPipelineState;
+
+    // 핑퐁. indirect 인자도 파티클 버퍼마다 하나씩 두어서, 그 버퍼에 파티클을 쓴 패스가 인자도 함께 쓴다
+    // 그래서 compute 큐가 다음 프레임을 진행하는 동안 그래픽스 큐는 지난 프레임 버퍼와 인자로 그릴 수 있다
+    winrt::com_ptr<ID3D12Resource> particleBuffers[2];
+    winrt::com_ptr<ID3D12Resource> indirectArgsBuffers[2];
+    winrt::com_ptr<ID3D12Resource> counterBuffer; // compute 큐에서만 쓴다
+
+    // CPU 경로 업로드 버퍼는 계속 Map해둔다
+    struct Frame
+    {
+        winrt::com_ptr<ID3D12CommandAllocator> computeAllocator;
+        winrt::com_ptr<ID3D12Resource> uploadBuffer;
+        GpuParticle* uploadParticles;
+    };
+
+    std::vector<Frame> frames;
+    uint32_t currentFrame; // 마지막 Update의 프레임 슬롯. RecordDraw가 쓴다
+    winrt::com_ptr<ID3D12GraphicsCommandList> computeCommandList;
+
+    ParticleSimulation cpuSimulation;
+
+    uint32_t capacity;
+    uint32_t seed;
+    uint32_t nextEmitId;
+    uint32_t sourceIndex;
+    float emitAccumulator;
+    bool useGpu;
+    bool needsReset; // 다음 GPU 프레임에서 카운터와 indirect 인자를 초기화한다
+
+public:
+    static const uint32_t DefaultSeed = 0x9E3779B9;
+
+    // 초당 방출 개수. 평균 수명 2.25초라서 백만개 정도가 살아있게 된다
+    static constexpr float EmitRate = 450000.0f;
+
+    ParticleSystem();
+
+    bool Init(ID3D12Device* device, const Shaders& shaders, DXGI_FORMAT renderTargetFormat, uint32_t frameCount, uint32_t capacity = DefaultCapacity, uint32_t seed = DefaultSeed);
+
+    // GPU/CPU를 바꾸면 두 경로 모두 같은 시드로 처음부터 다시 시작한다
+    void SetUseGpu(bool useGpu);
+    bool UsesGpu() const { return useGpu; }
+
+    // 한 프레임 진행한다. GPU 경로면 compute 커맨드 리스트를 기록하고, CPU 경로면 바로 계산해서 업로드 버퍼에 쓴다
+    // frameSlot을 마지막으로 쓴 프레임의 GPU 작업이 끝난 뒤에 불러야 한다
+    bool Update(float deltaTime, uint32_t frameSlot);
+
+    // GPU 경로에서 이번 프레임 결과가 든 핑퐁 버퍼 번호(0, 1). 다음 Update는 이 버퍼를 읽고 다른 쪽에 쓴다
+    uint32_t GetResultBufferIndex() const { return sourceIndex; }
+
+    // GPU 경로일때 compute 큐에 제출할 커맨드 리스트
+    ID3D12CommandList* GetComputeCommandList() { return computeCommandList.get(); }
+
+    // 렌더 타겟이 설정된 그래픽스 커맨드 리스트에 그린다. root signature와 PSO를 바꾼다
+    void RecordDraw(ID3D12GraphicsCommandList* commandList);
+
+    // CPU 경로에서 살아있는 파티클 수. GPU 경로는 읽어오지 않는다
+    uint32_t GetCpuParticleCount() const { return cpuSimulation.GetCount(); }
+
+private:
+    bool CreateComputePipeline(ID3D12Device* device, const Shaders& shaders);
+    bool CreateDrawPipeline(ID3D12Device* device, const Shaders& shaders, DXGI_FORMAT renderTargetFormat);
+    bool CreateBuffers(ID3D12Device* device);
+    bool RecordCompute(const ParticleConstants& constants);
+    void Reset();
+};
@@ -0,0 +1,88 @@
+#include "ReadbackRing.h"
+
+using namespace std;
+
+ReadbackRing::ReadbackRing(uint32_t slotCount)
+    : nextSlot(0), stats{}
+{
+    Reset(slotCount);
+}
+
+void ReadbackRing::Reset(uint32_t slotCount)
+{
+    lock_guard<mutex> lock(slotMutex);
+    slots.assign(slotCount, { SlotState::Free, 0, 0 });
+    copyingSlots.clear();
+    nextSlot = 0;
+    stats = {};
+}
+
+uint32_t ReadbackRing::Acquire(uint64_t frameNumber)
+{
+    lock_guard<mutex> lock(slotMutex);
+
+    // 순서대로 돌아가며 써야 Retire가 제출 순서와 맞는다
+    if (slots.empty() || slots[nextSlot].state != SlotState::Free)
+    {
+        stats.droppedCount++;
+        return InvalidSlot;
+    }
+
+    uint32_t slot = nextSlot;
+    nextSlot = (nextSlot + 1) % static_cast<uint32_t>(slots.size());
+
+    slots[slot].state = SlotState::Copying;
+    slots[slot].frameNumber = frameNumber;
+    slots[slot].fenceValue = UINT64_MAX; // Submit 전에는 끝나지 않은 것으로 본다
+    return slot;
+}
+
+void ReadbackRing::Submit(uint32_t slot, uint64_t fenceValue)
+{
+    lock_guard<mutex> lock(slotMutex);
+    slots[slot].fenceValue = fenceValue;
+    copyingSlots.push_back(slot);
+    stats.capturedCount++;
+}
+
+void ReadbackRing::Retire(uint64_t completedFenceValue, vector<RetiredSlot>& retiredSlots)
+{
+    lock_guard<mutex> lock(slotMutex);
+
+    while (!copyingSlots.empty() && slots[copyingSlots.front()].fenceValue <= completedFenceValue)
+    {
+        uint32_t slot = copyingSlots.front();
+        copyingSlots.pop_front();
+
+        slots[slot].state = SlotState::Encoding;
+        retiredSlots.push_back({ slot, slots[slot].frameNumber });
+        stats.retiredCount++;
+    }
+}
+
+void ReadbackRing::Release(uint32_t slot)
+{
+    lock_guard<mutex> lock(slotMutex);
+    slots[slot].state = SlotState::Free;
+    stats.releasedCount++;
+}
+
+void ReadbackRing::Discard(uint32_t slot)
+{
+    lock_guard<mutex> lock(slotMutex);
+    slots[slot].state = SlotState::Free;
+    stats.releasedCount++;
+    stats.discardedCount++;
+}
+
+ReadbackRing::SlotState ReadbackRing::GetState(uint32_t slot)
+{
+    lock_guard<mutex> lock(slotMutex);
+    return slots[slot].state;
+}
+
+ReadbackRing::Stats ReadbackRing::GetStats()
+{
+    lock_guard<mutex> lock(slotMutex);
+    return stats;
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+// readback 버퍼 슬롯들의 상태를 관리한다
+// 슬롯은 Free -> Copying(GPU 복사 제출, fence 대기) -> Encoding(Map해서 인코딩 중) -> Free 순서로 돈다
+// fence가 지난 슬롯만 꺼내주므로 Map할때 GPU를 기다리지 않는다. 빈 슬롯이 없으면 그 프레임은 건너뛴다
+class ReadbackRing
+{
+public:
+    enum class SlotState : uint8_t
+    {
+        Free,
+        Copying,
+        Encoding,
+    };
+
+    struct RetiredSlot
+    {
+        uint32_t slot;
+        uint64_t frameNumber;
+    };
+
+    struct Stats
+    {
+        uint64_t capturedCount;
+        uint64_t droppedCount; // 빈 슬롯이 없어서 건너뛴 프레임
+        uint64_t retiredCount;
+        uint64_t releasedCount;
+        uint64_t discardedCount; // 읽지 못하고 돌려준 슬롯 (Map 실패 등). releasedCount에도 들어간다
+    };
+
+    static const uint32_t InvalidSlot = UINT32_MAX;
+
+private:
+    struct Slot
+    {
+        SlotState state;
+        uint64_t frameNumber;
+        uint64_t fenceValue;
+    };
+
+    std::mutex slotMutex; // Release는 인코딩 워커 스레드에서 불린다
+    std::vector<Slot> slots;
+    std::deque<uint32_t> copyingSlots; // 제출 순서
+    uint32_t nextSlot;
+    Stats stats;
+
+public:
+    explicit ReadbackRing(uint32_t slotCount = 0);
+
+    void Reset(uint32_t slotCount);
+    uint32_t GetSlotCount() const { return static_cast<uint32_t>(slots.size()); }
+
+    // 이번 프레임 복사에 쓸 슬롯. 다음 차례 슬롯이 아직 안 비었으면 InvalidSlot
+    uint32_t Acquire(uint64_t frameNumber);
+
+    // 복사 커맨드를 제출했고 fenceValue가 지나면 읽을 수 있다
+    void Submit(uint32_t slot, uint64_t fenceValue);
+
+    // completedFenceValue까지 끝난 슬롯을 제출 순서대로 꺼낸다. 꺼낸 슬롯은 Encoding 상태가 된다
+    void Retire(uint64_t completedFenceValue, std::vector<RetiredSlot>& retiredSlots);
+
+    // 인코더가 슬롯 내용을 다 읽었다. 아무 스레드에서나 불러도 된다
+    void Release(uint32_t slot);
+
+    // 내용을 읽지 못하고 슬롯을 돌려준다
+    void Discard(uint32_t slot);
+
+    SlotState GetState(uint32_t slot);
+    Stats GetStats();
+};
@@ -0,0 +1,74 @@
+#include "ShaderCompiler.h"
+#include <Windows.h>
+#include <winrt/base.h>
+#include <d3dcompiler.h>
+#include <dxcapi.h>
+#include <cstring>
+#include <string>
+
+using namespace winrt;
+using namespace std;
+
+namespace
+{
+    bool CompileShaderFxc(const vector<uint8_t>& source, const char* sourceName, const char* entryPoint, const char* target, vector<uint8_t>& bytecode)
+    {
+#if defined(_DEBUG)
+        UINT compileFlags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+#else
+        UINT compileFlags = 0;
+#endif
+        com_ptr<ID3DBlob> shader;
+        if (FAILED(D3DCompile(source.data(), source.size(), sourceName, /*pDefines*/ nullptr, /*pInclude*/ nullptr, entryPoint, target, compileFlags, 0, shader.put(), /*ppErrorMsgs*/ nullptr)))
+            return false;
+
+        auto begin = static_cast<const uint8_t*>(shader->GetBufferPointer());
+        bytecode.assign(begin, begin + shader->GetBufferSize());
+        return true;
+    }
+
+    bool CompileShaderDxc(const vector<uint8_t>& source, const char* entryPoint, const char* target, vector<uint8_t>& bytecode)
+    {
+        // DXC 컴파일러 객체는 스레드에 안전하지 않으므로 부를때마다 만든다
+        com_ptr<IDxcCompiler3> compiler;
+        if (FAILED(DxcCreateInstance(CLSID_DxcCompiler, IID_PPV_ARGS(&compiler))))
+            return false;
+
+        wstring entryPointW(entryPoint, entryPoint + strlen(entryPoint));
+        wstring targetW(target, target + strlen(target));
+
+        vector<LPCWSTR> arguments = { L"-E", entryPointW.c_str(), L"-T", targetW.c_str() };
+#if defined(_DEBUG)
+        arguments.push_back(DXC_ARG_DEBUG);
+        arguments.push_back(DXC_ARG_SKIP_OPTIMIZATIONS);
+        arguments.push_back(L"-Qembed_debug");
+#endif
+
+        DxcBuffer sourceBuffer = { source.data(), source.size(), DXC_CP_UTF8 };
+
+        com_ptr<IDxcResult> result;
+        if (FAILED(compiler->Compile(&sourceBuffer, arguments.data(), static_cast<UINT32>(arguments.size()), /*pIncludeHandler*/ nullptr, IID_PPV_ARGS(&result))))
+            return false;
+
+        HRESULT status;
+        if (FAILED(result->GetStatus(&status)) || FAILED(status))
+            return false;
+
+        com_ptr<IDxcBlob> shader;
+        if (FAILED(result->GetOutput(DXC_OUT_OBJECT, IID_PPV_ARGS(&shader), nullptr)) || !shader)
+            return false;
+
+        auto begin = static_cast<const uint8_t*>(shader->GetBufferPointer());
+        bytecode.assign(begin, begin + shader->GetBufferSize());
+        return true;
+    }
+}
+
+bool CompileShader(const vector<uint8_t>& source, const char* sourceName, const char* entryPoint, const char* target, vector<uint8_t>& bytecode)
+{
+    // "vs_6_6"처럼 major 버전이 네번째 글자에 있다
+    if (strlen(target) >= 4 && '6' <= target[3])
+        return CompileShaderDxc(source, entryPoint, target, bytecode);
+
+    return CompileShaderFxc(source, sourceName, entryPoint, target, bytecode);
+}
@@ -0,0 +1,7 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// HLSL 소스를 바이트코드로 컴파일한다
+// target이 5.x이면 D3DCompile(FXC), 6.x이면 DXC를 쓴다. 어느 스레드에서 불러도 된다
+bool CompileShader(const std::vector<uint8_t>& source, const char* sourceName, const char* entryPoint, const char* target, std::vector<uint8_t>& bytecode);
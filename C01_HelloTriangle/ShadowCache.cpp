@@ -0,0 +1,393 @@
+#include "ShadowCache.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace
+{
+    float Dot(const float a[3], const float b[3])
+    {
+        return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    }
+
+    void Cross(const float a[3], const float b[3], float result[3])
+    {
+        result[0] = a[1] * b[2] - a[2] * b[1];
+        result[1] = a[2] * b[0] - a[0] * b[2];
+        result[2] = a[0] * b[1] - a[1] * b[0];
+    }
+
+    void Normalize(float v[3])
+    {
+        float length = sqrtf(Dot(v, v));
+        if (length > 0.0f)
+        {
+            v[0] /= length;
+            v[1] /= length;
+            v[2] /= length;
+        }
+    }
+
+    // 음수 타일 좌표도 0 ~ count-1 칸으로 보낸다
+    uint32_t WrapTile(int32_t tile, uint32_t count)
+    {
+        int32_t wrapped = tile % static_cast<int32_t>(count);
+        return static_cast<uint32_t>(wrapped < 0 ? wrapped + static_cast<int32_t>(count) : wrapped);
+    }
+}
+
+ShadowCache::ShadowCache(const ShadowCacheDesc& desc)
+    : desc(desc), lightRight{ 1.0f, 0.0f, 0.0f }, lightUp{ 0.0f, 0.0f, 1.0f }, lightForward{ 0.0f, -1.0f, 0.0f }, lightChanged(true), cascades{}, stats{}
+{
+    if (this->desc.cascadeCount > ShadowCacheDesc::MaxCascades)
+        this->desc.cascadeCount = ShadowCacheDesc::MaxCascades;
+    if (this->desc.tilesPerSide == 0)
+        this->desc.tilesPerSide = 1;
+
+    uint32_t slotCount = this->desc.cascadeCount * this->desc.tilesPerSide * this->desc.tilesPerSide;
+    slots.assign(slotCount, Slot{});
+    slotTiles.assign(slotCount, -1);
+    schedule.sampleableSlots.assign(slotCount, 0);
+    stats.totalTiles = slotCount;
+
+    for (uint32_t c = 0; c < this->desc.cascadeCount; c++)
+        cascades[c].tileSize = 2.0f * this->desc.cascadeHalfExtents[c] / this->desc.tilesPerSide;
+}
+
+uint32_t ShadowCache::AddStaticCaster(const ShadowCasterBounds& bounds)
+{
+    Rect rect = ToLightRect(bounds);
+    staticBounds.push_back(bounds);
+    staticRects.push_back(rect);
+    pendingDirty.push_back(rect);
+    return static_cast<uint32_t>(staticBounds.size() - 1);
+}
+
+void ShadowCache::MoveStaticCaster(uint32_t caster, const ShadowCasterBounds& bounds)
+{
+    // 옛 자리에서는 그림자가 사라지고 새 자리에는 생긴다
+    Rect rect = ToLightRect(bounds);
+    pendingDirty.push_back(staticRects[caster]);
+    pendingDirty.push_back(rect);
+    staticBounds[caster] = bounds;
+    staticRects[caster] = rect;
+}
+
+void ShadowCache::SetLightDirection(const float direction[3])
+{
+    float forward[3] = { direction[0], direction[1], direction[2] };
+    Normalize(forward);
+    if (forward[0] == lightForward[0] && forward[1] == lightForward[1] && forward[2] == lightForward[2])
+        return;
+
+    // 빛이 거의 수직이면 기준 축을 바꾼다
+    float reference[3] = { 0.0f, 1.0f, 0.0f };
+    if (fabsf(forward[1]) > 0.99f)
+    {
+        reference[0] = 1.0f;
+        reference[1] = 0.0f;
+    }
+
+    lightForward[0] = forward[0];
+    lightForward[1] = forward[1];
+    lightForward[2] = forward[2];
+    Cross(reference, lightForward, lightRight);
+    Normalize(lightRight);
+    Cross(lightForward, lightRight, lightUp);
+    lightChanged = true;
+}
+
+ShadowCache::Rect ShadowCache::ToLightRect(const ShadowCasterBounds& bounds) const
+{
+    // 상자를 축에 투영하면 중심의 투영 ± 반 변을 축 성분 크기로 더한 것이다
+    float center[3], extent[3];
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        center[i] = (bounds.minCorner[i] + bounds.maxCorner[i]) * 0.5f;
+        extent[i] = (bounds.maxCorner[i] - bounds.minCorner[i]) * 0.5f;
+    }
+
+    float x = Dot(center, lightRight);
+    float y = Dot(center, lightUp);
+    float extentX = fabsf(lightRight[0]) * extent[0] + fabsf(lightRight[1]) * extent[1] + fabsf(lightRight[2]) * extent[2];
+    float extentY = fabsf(lightUp[0]) * extent[0] + fabsf(lightUp[1]) * extent[1] + fabsf(lightUp[2]) * extent[2];
+    return { x - extentX, y - extentY, x + extentX, y + extentY };
+}
+
+bool ShadowCache::GetTileRange(uint32_t cascade, const Rect& rect, int32_t& x0, int32_t& y0, int32_t& x1, int32_t& y1) const
+{
+    const Cascade& c = cascades[cascade];
+    int32_t last = static_cast<int32_t>(desc.tilesPerSide) - 1;
+
+    x0 = max(static_cast<int32_t>(floorf(rect.minX / c.tileSize)), c.originX);
+    y0 = max(static_cast<int32_t>(floorf(rect.minY / c.tileSize)), c.originY);
+    x1 = min(static_cast<int32_t>(floorf(rect.maxX / c.tileSize)), c.originX + last);
+    y1 = min(static_cast<int32_t>(floorf(rect.maxY / c.tileSize)), c.originY + last);
+    return x0 <= x1 && y0 <= y1;
+}
+
+uint32_t ShadowCache::GetSlotForTile(uint32_t cascade, int32_t tileX, int32_t tileY) const
+{
+    return GetSlotIndex(cascade, WrapTile(tileX, desc.tilesPerSide), WrapTile(tileY, desc.tilesPerSide));
+}
+
+ShadowTile ShadowCache::MakeTile(uint32_t cascade, uint32_t slotX, uint32_t slotY) const
+{
+    const Slot& slot = slots[GetSlotIndex(cascade, slotX, slotY)];
+    float tileSize = cascades[cascade].tileSize;
+
+    ShadowTile tile = {};
+    tile.cascade = cascade;
+    tile.slotX = slotX;
+    tile.slotY = slotY;
+    tile.tileX = slot.tileX;
+    tile.tileY = slot.tileY;
+    tile.lightMin[0] = slot.tileX * tileSize;
+    tile.lightMin[1] = slot.tileY * tileSize;
+    tile.lightMax[0] = tile.lightMin[0] + tileSize;
+    tile.lightMax[1] = tile.lightMin[1] + tileSize;
+    return tile;
+}
+
+void ShadowCache::MarkDirty(const Rect& rect)
+{
+    for (uint32_t c = 0; c < desc.cascadeCount; c++)
+    {
+        int32_t x0, y0, x1, y1;
+        if (!GetTileRange(c, rect, x0, y0, x1, y1))
+            continue;
+
+        for (int32_t y = y0; y <= y1; y++)
+            for (int32_t x = x0; x <= x1; x++)
+                slots[GetSlotForTile(c, x, y)].cached = false;
+    }
+}
+
+void ShadowCache::CollectCasters(const vector<Rect>& rects, vector<ShadowTile>& tiles, vector<uint32_t>& casters)
+{
+    fill(slotTiles.begin(), slotTiles.end(), -1);
+    for (uint32_t i = 0; i < tiles.size(); i++)
+        slotTiles[GetSlotIndex(tiles[i].cascade, tiles[i].slotX, tiles[i].slotY)] = static_cast<int32_t>(i);
+
+    // 한 번은 세고, 자리를 나눈 뒤 한 번 더 돌며 채운다
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (uint32_t r = 0; r < rects.size(); r++)
+        {
+            for (uint32_t c = 0; c < desc.cascadeCount; c++)
+            {
+                int32_t x0, y0, x1, y1;
+                if (!GetTileRange(c, rects[r], x0, y0, x1, y1))
+                    continue;
+
+                for (int32_t y = y0; y <= y1; y++)
+                {
+                    for (int32_t x = x0; x <= x1; x++)
+                    {
+                        int32_t tileIndex = slotTiles[GetSlotForTile(c, x, y)];
+                        if (tileIndex < 0)
+                            continue;
+
+                        if (pass == 0)
+                            tiles[tileIndex].casterCount++;
+                        else
+                            casters[casterCursors[tileIndex]++] = r;
+                    }
+                }
+            }
+        }
+
+        if (pass == 0)
+        {
+            uint32_t total = 0;
+            casterCursors.resize(tiles.size());
+            for (uint32_t i = 0; i < tiles.size(); i++)
+            {
+                tiles[i].firstCaster = total;
+                casterCursors[i] = total;
+                total += tiles[i].casterCount;
+            }
+            casters.resize(total);
+        }
+    }
+}
+
+const ShadowSchedule& ShadowCache::Update(const float cameraPosition[3], const ShadowCasterBounds* dynamicCasters, uint32_t dynamicCount)
+{
+    // 빛 공간이 바뀌면 쌓인 사각형도 옛 공간 것이라 버리고 전부 다시 그린다
+    if (lightChanged)
+    {
+        for (uint32_t i = 0; i < staticBounds.size(); i++)
+            staticRects[i] = ToLightRect(staticBounds[i]);
+
+        for (Slot& slot : slots)
+        {
+            slot.cached = false;
+            slot.sampleable = false;
+        }
+
+        pendingDirty.clear();
+        lightChanged = false;
+        stats.lightInvalidations++;
+    }
+
+    // cascade를 카메라 쪽으로 타일 단위로 맞춘다. 칸에 걸린 타일이 바뀐 곳만 캐시가 틀어진다
+    float cameraX = Dot(cameraPosition, lightRight);
+    float cameraY = Dot(cameraPosition, lightUp);
+    int32_t halfTiles = static_cast<int32_t>(desc.tilesPerSide / 2);
+    for (uint32_t c = 0; c < desc.cascadeCount; c++)
+    {
+        Cascade& cascade = cascades[c];
+        cascade.originX = static_cast<int32_t>(floorf(cameraX / cascade.tileSize)) - halfTiles;
+        cascade.originY = static_cast<int32_t>(floorf(cameraY / cascade.tileSize)) - halfTiles;
+
+        for (uint32_t y = 0; y < desc.tilesPerSide; y++)
+        {
+            for (uint32_t x = 0; x < desc.tilesPerSide; x++)
+            {
+                int32_t tileX = cascade.originX + static_cast<int32_t>(x);
+                int32_t tileY = cascade.originY + static_cast<int32_t>(y);
+                Slot& slot = slots[GetSlotForTile(c, tileX, tileY)];
+                if (slot.tileX != tileX || slot.tileY != tileY)
+                {
+                    slot.tileX = tileX;
+                    slot.tileY = tileY;
+                    slot.cached = false;
+                    slot.sampleable = false;
+                }
+            }
+        }
+    }
+
+    for (const Rect& rect : pendingDirty)
+        MarkDirty(rect);
+    pendingDirty.clear();
+
+    // 상한까지만 다시 그린다. 샘플할 수 없는 칸을 먼저, 낡기만 한 칸을 그 다음에 가까운 cascade부터 고른다
+    for (Slot& slot : slots)
+        slot.rendered = false;
+
+    schedule.staticTiles.clear();
+    stats.pendingTiles = 0;
+    stats.unsampleableTiles = 0;
+    for (int pass = 0; pass < 2; pass++)
+    {
+        bool exposedPass = pass == 0;
+        for (uint32_t c = 0; c < desc.cascadeCount; c++)
+        {
+            for (uint32_t y = 0; y < desc.tilesPerSide; y++)
+            {
+                for (uint32_t x = 0; x < desc.tilesPerSide; x++)
+                {
+                    Slot& slot = slots[GetSlotIndex(c, x, y)];
+                    if (slot.cached || slot.sampleable == exposedPass)
+                        continue;
+
+                    if (schedule.staticTiles.size() >= desc.maxStaticTilesPerFrame)
+                    {
+                        stats.pendingTiles++;
+                        stats.unsampleableTiles += exposedPass ? 1 : 0;
+                        continue;
+                    }
+
+                    schedule.staticTiles.push_back(MakeTile(c, x, y));
+                    slot.cached = true;
+                    slot.sampleable = true;
+                    slot.rendered = true;
+                }
+            }
+        }
+    }
+    CollectCasters(staticRects, schedule.staticTiles, schedule.staticCasters);
+
+    // 움직이는 캐스터가 걸친 칸
+    dynamicRects.resize(dynamicCount);
+    for (uint32_t i = 0; i < dynamicCount; i++)
+        dynamicRects[i] = ToLightRect(dynamicCasters[i]);
+
+    for (Slot& slot : slots)
+        slot.hasDynamic = false;
+
+    for (const Rect& rect : dynamicRects)
+    {
+        for (uint32_t c = 0; c < desc.cascadeCount; c++)
+        {
+            int32_t x0, y0, x1, y1;
+            if (!GetTileRange(c, rect, x0, y0, x1, y1))
+                continue;
+
+            for (int32_t y = y0; y <= y1; y++)
+                for (int32_t x = x0; x <= x1; x++)
+                    slots[GetSlotForTile(c, x, y)].hasDynamic = true;
+        }
+    }
+
+    // 캐시를 다시 그렸거나, 덧그릴 것이 있거나, 지난 프레임에 덧그린 칸은 캐시에서 다시 복사한다
+    // 샘플하지 않는 칸은 복사하거나 덧그려도 보이지 않으므로 건너뛴다. 나중에 그릴때 복사한다
+    schedule.copyTiles.clear();
+    schedule.dynamicTiles.clear();
+    for (uint32_t c = 0; c < desc.cascadeCount; c++)
+    {
+        for (uint32_t y = 0; y < desc.tilesPerSide; y++)
+        {
+            for (uint32_t x = 0; x < desc.tilesPerSide; x++)
+            {
+                uint32_t slotIndex = GetSlotIndex(c, x, y);
+                Slot& slot = slots[slotIndex];
+                schedule.sampleableSlots[slotIndex] = slot.sampleable ? 1 : 0;
+                if (!slot.sampleable)
+                {
+                    slot.hasDynamic = false;
+                    slot.hadDynamic = false;
+                    continue;
+                }
+
+                if (slot.rendered || slot.hasDynamic || slot.hadDynamic)
+                    schedule.copyTiles.push_back(MakeTile(c, x, y));
+                if (slot.hasDynamic)
+                    schedule.dynamicTiles.push_back(MakeTile(c, x, y));
+                slot.hadDynamic = slot.hasDynamic;
+            }
+        }
+    }
+    CollectCasters(dynamicRects, schedule.dynamicTiles, schedule.dynamicCasters);
+
+    // 캐시 없이 그린다면 cascade마다 걸치는 캐스터를 모두 그린다
+    stats.uncachedCasterDraws = 0;
+    for (uint32_t c = 0; c < desc.cascadeCount; c++)
+    {
+        int32_t x0, y0, x1, y1;
+        for (const Rect& rect : staticRects)
+            stats.uncachedCasterDraws += GetTileRange(c, rect, x0, y0, x1, y1) ? 1 : 0;
+        for (const Rect& rect : dynamicRects)
+            stats.uncachedCasterDraws += GetTileRange(c, rect, x0, y0, x1, y1) ? 1 : 0;
+    }
+
+    stats.staticTiles = static_cast<uint32_t>(schedule.staticTiles.size());
+    stats.copyTiles = static_cast<uint32_t>(schedule.copyTiles.size());
+    stats.dynamicTiles = static_cast<uint32_t>(schedule.dynamicTiles.size());
+    stats.staticCasterDraws = static_cast<uint32_t>(schedule.staticCasters.size());
+    stats.dynamicCasterDraws = static_cast<uint32_t>(schedule.dynamicCasters.size());
+    return schedule;
+}
+
+uint32_t ShadowCache::GetSampleCascade(const float worldPosition[3]) const
+{
+    float x = Dot(worldPosition, lightRight);
+    float y = Dot(worldPosition, lightUp);
+    for (uint32_t c = 0; c < desc.cascadeCount; c++)
+    {
+        const Cascade& cascade = cascades[c];
+        int32_t tileX = static_cast<int32_t>(floorf(x / cascade.tileSize));
+        int32_t tileY = static_cast<int32_t>(floorf(y / cascade.tileSize));
+        int32_t last = static_cast<int32_t>(desc.tilesPerSide) - 1;
+        if (tileX < cascade.originX || tileX > cascade.originX + last || tileY < cascade.originY || tileY > cascade.originY + last)
+            continue;
+
+        if (slots[GetSlotForTile(c, tileX, tileY)].sampleable)
+            return c;
+    }
+
+    return desc.cascadeCount;
+}
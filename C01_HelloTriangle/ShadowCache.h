@@ -0,0 +1,153 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// 그림자를 드리우는 물체의 월드 AABB
+struct ShadowCasterBounds
+{
+    float minCorner[3];
+    float maxCorner[3];
+};
+
+struct ShadowCacheDesc
+{
+    static const uint32_t MaxCascades = 4;
+
+    uint32_t cascadeCount;
+    float cascadeHalfExtents[MaxCascades]; // 빛 공간에서 cascade가 덮는 정사각형의 반 변. 가까운 cascade부터
+    uint32_t tilesPerSide;                 // cascade 하나를 tilesPerSide x tilesPerSide 타일로 나눈다
+    uint32_t maxStaticTilesPerFrame;       // 한 프레임에 정적 캐스터를 다시 그릴 타일 상한. 넘는 타일은 다음 프레임으로 미룬다
+};
+
+// 아틀라스 타일 하나에 할 일
+// 아틀라스에서의 자리는 (cascade * tilesPerSide + slotX, slotY) 칸이고, 빛 공간 lightMin ~ lightMax를 정사영으로 그린다
+struct ShadowTile
+{
+    uint32_t cascade;
+    uint32_t slotX, slotY;
+    int32_t tileX, tileY;    // 빛 공간 타일 좌표
+    float lightMin[2];
+    float lightMax[2];
+    uint32_t firstCaster;    // 캐스터 목록에서 이 타일 몫의 시작
+    uint32_t casterCount;
+};
+
+// 한 프레임의 아틀라스 작업. 이 순서로 실행한다
+// 1. staticTiles: 캐시 아틀라스의 그 칸을 지우고 정적 캐스터를 다시 그린다
+// 2. copyTiles: 캐시 아틀라스에서 실제로 샘플하는 아틀라스로 복사한다
+// 3. dynamicTiles: 복사한 칸 위에 움직이는 캐스터를 덧그린다
+// sampleableSlots가 0인 칸은 아직 다른 타일(또는 옛 빛 공간)의 깊이를 담고 있다
+// 셰이더는 그 칸을 샘플하지 않고 같은 위치를 다음 cascade에서 찾는다. 마지막 cascade까지 없으면 그림자가 없다고 본다
+struct ShadowSchedule
+{
+    std::vector<ShadowTile> staticTiles;
+    std::vector<ShadowTile> copyTiles; // firstCaster, casterCount는 쓰지 않는다
+    std::vector<ShadowTile> dynamicTiles;
+    std::vector<uint8_t> sampleableSlots; // 칸마다 1 또는 0. cascade, slotY, slotX 순
+    std::vector<uint32_t> staticCasters;  // AddStaticCaster가 준 번호
+    std::vector<uint32_t> dynamicCasters; // Update에 넘긴 배열의 인덱스
+};
+
+struct ShadowCacheStats
+{
+    uint32_t totalTiles;
+    uint32_t staticTiles;
+    uint32_t copyTiles;
+    uint32_t dynamicTiles;
+    uint32_t pendingTiles;         // 상한에 걸려서 다음 프레임으로 미룬 타일
+    uint32_t unsampleableTiles;    // 미룬 타일 중 지금 타일을 아직 못 그려서 다음 cascade로 넘기는 칸
+    uint32_t staticCasterDraws;    // 타일마다 그린 캐스터 수의 합
+    uint32_t dynamicCasterDraws;
+    uint32_t uncachedCasterDraws;  // 캐시 없이 매 프레임 모든 cascade를 다시 그릴때의 캐스터 수 (cascade마다 한 번)
+    uint64_t lightInvalidations;
+};
+
+// cascade 그림자 맵을 타일로 나눠 정적 캐스터 깊이를 캐시하고 바뀐 타일만 다시 그리게 한다
+// - 타일은 빛 공간 좌표로 고정되어 있고 아틀라스 칸은 좌표를 tilesPerSide로 나눈 나머지로 정한다 (토러스 주소)
+//   카메라를 따라 cascade가 움직여도 남아 있는 타일은 칸이 그대로라서 새로 들어온 줄만 그린다
+// - 정적 캐스터를 옮기거나 더하면 옛 자리와 새 자리를 덮는 타일만 더럽힌다
+// - 빛 방향이 바뀌면 빛 공간 자체가 바뀌므로 모두 더럽힌다
+// - 움직이는 캐스터는 캐시하지 않고 매 프레임 캐시를 복사한 칸 위에 덧그린다. 지난 프레임에 덧그린 칸도 복사해서 지운다
+// - 상한을 넘으면 새로 드러난 칸(샘플할 수 없는 칸)을 먼저 그리고, 캐스터가 움직여서 낡은 칸은 그 다음에 다시 그린다
+// GPU를 건드리지 않으므로 D3D12 없이 스케줄만 검증할 수 있다
+class ShadowCache
+{
+    struct Rect
+    {
+        float minX, minY, maxX, maxY;
+    };
+
+    struct Slot
+    {
+        int32_t tileX, tileY; // 이번 프레임에 이 칸이 보여줄 타일
+        bool cached;          // 캐시 아틀라스의 내용이 그 타일의 정적 캐스터와 맞는지
+        bool sampleable;      // 캐시 아틀라스가 그 타일을 담고 있는지. 캐스터가 움직여 낡았어도 타일이 같으면 샘플해도 된다
+        bool hadDynamic;      // 지난 프레임에 움직이는 캐스터를 덧그렸는지
+        bool hasDynamic;
+        bool rendered;        // 이번 프레임에 정적 캐스터를 다시 그렸는지
+    };
+
+    struct Cascade
+    {
+        float tileSize;
+        int32_t originX, originY; // 덮는 타일 범위의 시작
+    };
+
+    ShadowCacheDesc desc;
+    float lightRight[3], lightUp[3], lightForward[3];
+    bool lightChanged;
+
+    std::vector<Rect> staticRects;   // 정적 캐스터의 빛 공간 사각형
+    std::vector<ShadowCasterBounds> staticBounds;
+    std::vector<Rect> pendingDirty;  // 다음 Update에서 더럽힐 빛 공간 사각형
+    std::vector<Rect> dynamicRects;
+    std::vector<Slot> slots;         // cascade, slotY, slotX 순
+    std::vector<int32_t> slotTiles;  // 칸 -> 이번에 모은 타일 인덱스, 없으면 -1
+    std::vector<uint32_t> casterCursors;
+    Cascade cascades[ShadowCacheDesc::MaxCascades];
+
+    ShadowSchedule schedule;
+    ShadowCacheStats stats;
+
+public:
+    explicit ShadowCache(const ShadowCacheDesc& desc);
+
+    // 정적 캐스터 번호를 돌려준다
+    uint32_t AddStaticCaster(const ShadowCasterBounds& bounds);
+    void MoveStaticCaster(uint32_t caster, const ShadowCasterBounds& bounds);
+    uint32_t GetStaticCasterCount() const { return static_cast<uint32_t>(staticBounds.size()); }
+
+    // 빛이 비추는 방향. 길이는 상관없다
+    void SetLightDirection(const float direction[3]);
+
+    // 카메라 위치로 cascade를 옮기고 이번 프레임 작업을 정한다. 결과는 다음 Update까지 유효하다
+    const ShadowSchedule& Update(const float cameraPosition[3], const ShadowCasterBounds* dynamicCasters, uint32_t dynamicCount);
+
+    const ShadowSchedule& GetSchedule() const { return schedule; }
+    const ShadowCacheStats& GetStats() const { return stats; }
+    const ShadowCacheDesc& GetDesc() const { return desc; }
+
+    // 마지막 Update 기준 칸 상태. 디버그 표시용
+    bool IsSlotCached(uint32_t cascade, uint32_t slotX, uint32_t slotY) const { return slots[GetSlotIndex(cascade, slotX, slotY)].cached; }
+    bool IsSlotRendered(uint32_t cascade, uint32_t slotX, uint32_t slotY) const { return slots[GetSlotIndex(cascade, slotX, slotY)].rendered; }
+    bool IsSlotDynamic(uint32_t cascade, uint32_t slotX, uint32_t slotY) const { return slots[GetSlotIndex(cascade, slotX, slotY)].hasDynamic; }
+    bool IsSlotSampleable(uint32_t cascade, uint32_t slotX, uint32_t slotY) const { return slots[GetSlotIndex(cascade, slotX, slotY)].sampleable; }
+
+    // 셰이더와 같은 규칙으로 월드 위치를 샘플할 cascade를 고른다. 덮는 칸이 샘플할 수 있는 가장 가까운 cascade
+    // 어느 cascade에서도 샘플할 수 없으면 cascadeCount
+    uint32_t GetSampleCascade(const float worldPosition[3]) const;
+
+private:
+    uint32_t GetSlotIndex(uint32_t cascade, uint32_t slotX, uint32_t slotY) const { return (cascade * desc.tilesPerSide + slotY) * desc.tilesPerSide + slotX; }
+    Rect ToLightRect(const ShadowCasterBounds& bounds) const;
+
+    // rect가 cascade에서 덮는 타일 범위. 이번 프레임 범위 밖이면 false
+    bool GetTileRange(uint32_t cascade, const Rect& rect, int32_t& x0, int32_t& y0, int32_t& x1, int32_t& y1) const;
+    uint32_t GetSlotForTile(uint32_t cascade, int32_t tileX, int32_t tileY) const;
+
+    ShadowTile MakeTile(uint32_t cascade, uint32_t slotX, uint32_t slotY) const;
+    void MarkDirty(const Rect& rect);
+
+    // tiles에 든 칸마다 겹치는 rects의 인덱스를 모아 casters에 이어 붙인다
+    void CollectCasters(const std::vector<Rect>& rects, std::vector<ShadowTile>& tiles, std::vector<uint32_t>& casters);
+};
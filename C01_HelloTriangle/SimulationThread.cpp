@@ -0,0 +1,128 @@
+#include "SimulationThread.h"
+#include <algorithm>
+
+using namespace std;
+using namespace std::chrono;
+
+namespace
+{
+    const float AngularSpeed = 1.0f; // 라디안/초
+
+    // 너무 밀렸을때 한번에 따라잡는 최대 틱 수. 넘으면 시간을 버린다
+    const uint32_t MaxCatchUpTicks = 5;
+}
+
+SimulationThread::SimulationThread(uint32_t ticksPerSecond)
+    : stopping(false),
+      tickDuration(duration_cast<steady_clock::duration>(duration<double>(1.0 / ticksPerSecond))),
+      tickCount(0), publishCount(0), overwrittenCount(0),
+      acquireCount(0), lastLatencyMs(0.0), maxLatencyMs(0.0)
+{
+}
+
+SimulationThread::~SimulationThread()
+{
+    Stop();
+}
+
+void SimulationThread::Start()
+{
+    // 첫 Acquire에서 바로 쓸 수 있게 0번 틱을 먼저 내보낸다
+    SimulationSnapshot& snapshot = snapshots.GetWriteSlot();
+    snapshot.previous = {};
+    snapshot.current = {};
+    snapshot.currentTime = steady_clock::now();
+    snapshot.publishTime = snapshot.currentTime;
+    snapshots.Publish();
+
+    stopping = false;
+    thread = std::thread([this] { Run(); });
+}
+
+void SimulationThread::Stop()
+{
+    if (!thread.joinable())
+        return;
+
+    stopping = true;
+    thread.join();
+}
+
+void SimulationThread::Step(const SimulationState& previous, SimulationState& next, float deltaSeconds)
+{
+    next.tick = previous.tick + 1;
+    next.angle = previous.angle + AngularSpeed * deltaSeconds;
+}
+
+void SimulationThread::Run()
+{
+    const float deltaSeconds = duration<float>(tickDuration).count();
+
+    SimulationState current = {};
+    steady_clock::time_point currentTime = steady_clock::now();
+
+    while (!stopping)
+    {
+        this_thread::sleep_until(currentTime + tickDuration);
+
+        // 밀린 만큼 고정 간격으로 여러 틱을 진행하고, 마지막 두 틱만 내보낸다
+        steady_clock::time_point now = steady_clock::now();
+        SimulationState previous = current;
+        uint32_t steps = 0;
+        while (currentTime + tickDuration <= now)
+        {
+            if (steps == MaxCatchUpTicks)
+            {
+                currentTime = now;
+                break;
+            }
+
+            previous = current;
+            Step(previous, current, deltaSeconds);
+            currentTime += tickDuration;
+            steps++;
+        }
+
+        if (steps == 0)
+            continue;
+
+        tickCount += steps;
+
+        SimulationSnapshot& snapshot = snapshots.GetWriteSlot();
+        snapshot.previous = previous;
+        snapshot.current = current;
+        snapshot.currentTime = currentTime;
+        snapshot.publishTime = steady_clock::now();
+
+        publishCount++;
+        if (snapshots.Publish())
+            overwrittenCount++;
+    }
+}
+
+SimulationState SimulationThread::AcquireInterpolated(steady_clock::time_point now)
+{
+    if (snapshots.Acquire())
+    {
+        acquireCount++;
+        lastLatencyMs = duration<double, milli>(now - snapshots.GetReadSlot().publishTime).count();
+        maxLatencyMs = max(maxLatencyMs, lastLatencyMs);
+    }
+
+    const SimulationSnapshot& snapshot = snapshots.GetReadSlot();
+
+    // current 틱 시각부터 한 틱 동안 previous -> current로 보간한다
+    // 렌더는 시뮬레이션보다 최대 한 틱 늦게 보이지만 틱 간격에 상관없이 부드럽게 움직인다
+    float alpha = duration<float>(now - snapshot.currentTime).count() / duration<float>(tickDuration).count();
+    alpha = clamp(alpha, 0.0f, 1.0f);
+
+    SimulationState state;
+    state.tick = snapshot.current.tick;
+    state.angle = snapshot.previous.angle + (snapshot.current.angle - snapshot.previous.angle) * alpha;
+    return state;
+}
+
+SimulationStats SimulationThread::GetStats() const
+{
+    return { tickCount, publishCount, overwrittenCount, acquireCount, lastLatencyMs, maxLatencyMs };
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include "TripleBuffer.h"
+
+// 시뮬레이션 한 틱의 결과
+struct SimulationState
+{
+    uint64_t tick;
+    float angle; // 삼각형 회전 (라디안)
+};
+
+// 렌더 쪽으로 넘기는 스냅샷. 보간을 위해 직전 틱과 현재 틱을 같이 담는다
+struct SimulationSnapshot
+{
+    SimulationState previous;
+    SimulationState current;
+    std::chrono::steady_clock::time_point currentTime; // current 틱의 시뮬레이션 시각
+    std::chrono::steady_clock::time_point publishTime; // 실제로 Publish한 시각
+};
+
+struct SimulationStats
+{
+    uint64_t tickCount;
+    uint64_t publishCount;
+    uint64_t overwrittenCount; // 렌더 쪽이 읽기 전에 덮어쓴 스냅샷
+    uint64_t acquireCount;
+    double lastLatencyMs;      // Publish에서 렌더 쪽 Acquire까지
+    double maxLatencyMs;
+};
+
+// 윈도우 스레드와 따로 고정 간격으로 시뮬레이션을 돌리고 결과를 트리플 버퍼로 넘긴다
+// 렌더 쪽은 락 없이 가장 최근 스냅샷을 받아 두 틱 사이를 보간한다
+class SimulationThread
+{
+    TripleBuffer<SimulationSnapshot> snapshots;
+    std::thread thread;
+    std::atomic<bool> stopping;
+    std::chrono::steady_clock::duration tickDuration;
+
+    // 쓰는 쪽 통계
+    std::atomic<uint64_t> tickCount;
+    std::atomic<uint64_t> publishCount;
+    std::atomic<uint64_t> overwrittenCount;
+
+    // 읽는 쪽 통계. 렌더 스레드만 건드린다
+    uint64_t acquireCount;
+    double lastLatencyMs;
+    double maxLatencyMs;
+
+public:
+    static const uint32_t DefaultTicksPerSecond = 60;
+
+    explicit SimulationThread(uint32_t ticksPerSecond = DefaultTicksPerSecond);
+    ~SimulationThread();
+
+    SimulationThread(const SimulationThread&) = delete;
+    SimulationThread& operator=(const SimulationThread&) = delete;
+
+    void Start();
+    void Stop();
+
+    // 렌더 스레드에서 부른다. 새 스냅샷이 있으면 가져오고, 최근 스냅샷을 now 시점으로 보간한다
+    SimulationState AcquireInterpolated(std::chrono::steady_clock::time_point now);
+
+    SimulationStats GetStats() const;
+
+private:
+    void Run();
+    static void Step(const SimulationState& previous, SimulationState& next, float deltaSeconds);
+};
@@ -0,0 +1,220 @@
+#include "StartupGraph.h"
+#include <cstdio>
+
+using namespace std;
+
+void StartupGraph::MainThreadQueue::Post(coroutine_handle<> handle)
+{
+    {
+        lock_guard<mutex> lock(queueMutex);
+        readyQueue.push_back(handle);
+    }
+    cv.notify_one();
+}
+
+void StartupGraph::MainThreadQueue::Finish()
+{
+    lock_guard<mutex> lock(queueMutex);
+    finished = true;
+    cv.notify_one();
+}
+
+void StartupGraph::MainThreadQueue::Pump()
+{
+    for (;;)
+    {
+        coroutine_handle<> handle;
+        {
+            unique_lock<mutex> lock(queueMutex);
+            cv.wait(lock, [this] { return finished || !readyQueue.empty(); });
+
+            if (readyQueue.empty())
+                return;
+
+            handle = readyQueue.front();
+            readyQueue.pop_front();
+        }
+
+        handle.resume();
+    }
+}
+
+void StartupGraph::MainThreadQueue::Reset()
+{
+    lock_guard<mutex> lock(queueMutex);
+    finished = false;
+    readyQueue.clear();
+}
+
+StartupGraph::StartupGraph()
+    : totalMs(0.0)
+{
+}
+
+StartupGraph::StageId StartupGraph::AddStage(const char* name, StageThread thread, initializer_list<StageId> dependencies, function<bool()> run)
+{
+    auto stage = make_unique<Stage>();
+    stage->timing = { name, thread, false, false, false, 0.0, 0.0 };
+    stage->dependencies = dependencies;
+    stage->run = move(run);
+
+    stages.push_back(move(stage));
+    return static_cast<StageId>(stages.size() - 1);
+}
+
+StartupGraph::StageId StartupGraph::AddAsyncStage(const char* name, StageThread thread, initializer_list<StageId> dependencies, function<Task<bool>()> runAsync)
+{
+    auto stage = make_unique<Stage>();
+    stage->timing = { name, thread, false, false, false, 0.0, 0.0 };
+    stage->dependencies = dependencies;
+    stage->runAsync = move(runAsync);
+
+    stages.push_back(move(stage));
+    return static_cast<StageId>(stages.size() - 1);
+}
+
+double StartupGraph::GetElapsedMs() const
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - startTime).count();
+}
+
+Task<void> StartupGraph::RunStage(Stage& stage, Executor& executor)
+{
+    bool dependenciesSucceeded = true;
+    for (StageId dependency : stage.dependencies)
+    {
+        co_await stages[dependency]->done;
+        dependenciesSucceeded = dependenciesSucceeded && stages[dependency]->timing.succeeded;
+    }
+
+    if (dependenciesSucceeded)
+    {
+        if (stage.timing.thread == StageThread::Main)
+            co_await mainThreadQueue.Schedule();
+        else
+            co_await executor.Schedule();
+
+        stage.timing.ran = true;
+        stage.timing.startMs = GetElapsedMs();
+
+        // 예외가 나면 실패한 스테이지로 친다. 여기서 잡지 않으면 done이 Set되지 않아서 기다리던 스테이지와 Run이 멈춘다
+        try
+        {
+            if (stage.runAsync)
+                stage.timing.succeeded = co_await stage.runAsync();
+            else
+                stage.timing.succeeded = stage.run();
+        }
+        catch (...)
+        {
+            stage.timing.succeeded = false;
+        }
+
+        stage.timing.endMs = GetElapsedMs();
+    }
+
+    // 이 스테이지를 기다리던 스테이지들이 이어서 실행된다
+    stage.done.Set();
+}
+
+bool StartupGraph::Run(Executor& executor)
+{
+    startTime = chrono::steady_clock::now();
+    mainThreadQueue.Reset();
+
+    vector<Task<void>> stageTasks;
+    stageTasks.reserve(stages.size());
+    for (auto& stage : stages)
+        stageTasks.push_back(RunStage(*stage, executor));
+
+    auto runAll = [&]() -> detail::DetachedTask
+    {
+        co_await WhenAll(move(stageTasks));
+        mainThreadQueue.Finish();
+    };
+
+    runAll();
+
+    // 이 스레드는 Main 스테이지를 실행하면서 전체가 끝나기를 기다린다
+    mainThreadQueue.Pump();
+
+    totalMs = GetElapsedMs();
+    MarkCriticalPath();
+
+    for (auto& stage : stages)
+        if (!stage->timing.succeeded)
+            return false;
+
+    return true;
+}
+
+void StartupGraph::MarkCriticalPath()
+{
+    // 가장 늦게 끝난 스테이지에서 시작해서, 매번 가장 늦게 끝난 의존 스테이지를 따라간다
+    StageId current = UINT32_MAX;
+    for (StageId id = 0; id < stages.size(); id++)
+    {
+        if (!stages[id]->timing.ran)
+            continue;
+
+        if (current == UINT32_MAX || stages[current]->timing.endMs < stages[id]->timing.endMs)
+            current = id;
+    }
+
+    while (current != UINT32_MAX)
+    {
+        stages[current]->timing.critical = true;
+
+        StageId next = UINT32_MAX;
+        for (StageId dependency : stages[current]->dependencies)
+        {
+            if (next == UINT32_MAX || stages[next]->timing.endMs < stages[dependency]->timing.endMs)
+                next = dependency;
+        }
+
+        current = next;
+    }
+}
+
+vector<StageTiming> StartupGraph::GetTimings() const
+{
+    vector<StageTiming> timings;
+    timings.reserve(stages.size());
+    for (auto& stage : stages)
+        timings.push_back(stage->timing);
+
+    return timings;
+}
+
+string StartupGraph::FormatReport() const
+{
+    string report;
+    char line[256];
+
+    snprintf(line, sizeof(line), "Startup %.2f ms\n", totalMs);
+    report += line;
+
+    for (auto& stage : stages)
+    {
+        const StageTiming& timing = stage->timing;
+        if (!timing.ran)
+        {
+            snprintf(line, sizeof(line), "  %-16s skipped\n", timing.name);
+        }
+        else
+        {
+            snprintf(line, sizeof(line), "  %-16s %-6s %8.2f -> %8.2f ms (%7.2f ms)%s%s\n",
+                timing.name,
+                timing.thread == StageThread::Main ? "main" : "worker",
+                timing.startMs,
+                timing.endMs,
+                timing.endMs - timing.startMs,
+                timing.critical ? " *" : "",
+                timing.succeeded ? "" : " FAILED");
+        }
+
+        report += line;
+    }
+
+    return report;
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Executor.h"
+#include "Task.h"
+
+// 스테이지가 실행될 스레드
+// 창 만들기나 swap chain처럼 윈도우 스레드에서 해야 하는 일은 Main으로 등록한다
+enum class StageThread
+{
+    Worker,
+    Main,
+};
+
+struct StageTiming
+{
+    const char* name;
+    StageThread thread;
+    bool ran;       // 의존하는 스테이지가 실패하면 실행하지 않는다
+    bool succeeded;
+    bool critical;  // 전체 시작 시간을 결정한 경로 위에 있는지
+    double startMs; // Run을 부른 시점 기준
+    double endMs;
+};
+
+// 초기화 단계들을 의존성 그래프로 등록하고, 서로 상관없는 단계는 동시에 실행한다
+// 스테이지마다 시간을 재서 어디가 시작 시간을 잡아먹는지 보여준다
+class StartupGraph
+{
+public:
+    using StageId = uint32_t;
+
+private:
+    struct Stage
+    {
+        StageTiming timing;
+        std::vector<StageId> dependencies;
+        std::function<bool()> run;
+        std::function<Task<bool>()> runAsync;
+        AsyncEvent done;
+    };
+
+    // Run을 부른 스레드에서 Main 스테이지를 실행하기 위한 큐
+    class MainThreadQueue
+    {
+        std::mutex queueMutex;
+        std::condition_variable cv;
+        std::deque<std::coroutine_handle<>> readyQueue;
+        bool finished = false;
+
+    public:
+        void Post(std::coroutine_handle<> handle);
+        void Finish();
+        void Pump();
+        void Reset();
+
+        struct ScheduleAwaiter
+        {
+            MainThreadQueue& queue;
+
+            bool await_ready() noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle) { queue.Post(handle); }
+            void await_resume() noexcept {}
+        };
+
+        ScheduleAwaiter Schedule() { return ScheduleAwaiter{ *this }; }
+    };
+
+    std::vector<std::unique_ptr<Stage>> stages; // AsyncEvent는 옮길 수 없으므로 포인터로 들고 있는다
+    MainThreadQueue mainThreadQueue;
+    std::chrono::steady_clock::time_point startTime;
+    double totalMs;
+
+public:
+    StartupGraph();
+
+    StageId AddStage(const char* name, StageThread thread, std::initializer_list<StageId> dependencies, std::function<bool()> run);
+
+    // 코루틴으로 된 스테이지. 파일 읽기나 fence를 기다리는 동안 워커 스레드를 잡지 않는다
+    StageId AddAsyncStage(const char* name, StageThread thread, std::initializer_list<StageId> dependencies, std::function<Task<bool>()> runAsync);
+
+    // 모든 스테이지가 끝날때까지 Main 스테이지를 실행하면서 기다린다. 하나라도 실패하면 false
+    bool Run(Executor& executor);
+
+    std::vector<StageTiming> GetTimings() const;
+    const StageTiming& GetTiming(StageId stage) const { return stages[stage]->timing; }
+    double GetTotalMs() const { return totalMs; }
+
+    // 스테이지별 시작/끝 시간과 critical path를 표로 만든다
+    std::string FormatReport() const;
+
+private:
+    Task<void> RunStage(Stage& stage, Executor& executor);
+    double GetElapsedMs() const;
+    void MarkCriticalPath();
+};
@@ -0,0 +1,38 @@
+#include "StartupStages.h"
+
+using namespace std;
+
+void AddStartupStages(StartupGraph& graph, IStartupStages& stages)
+{
+    // 서로 상관없는 초기화 단계는 동시에 진행한다
+    // 창은 device와 상관없이 바로 띄우고, 셰이더 읽기/컴파일은 창, swap chain과 겹쳐서 진행된다
+    auto factoryStage = graph.AddStage("Factory", StageThread::Worker, {}, [&stages] { return stages.CreateFactory(); });
+    auto deviceStage = graph.AddStage("Device", StageThread::Worker, { factoryStage }, [&stages] { return stages.CreateDevice(); });
+    auto windowStage = graph.AddStage("Window", StageThread::Main, {}, [&stages] { return stages.CreateMainWindow(); });
+
+    // swap chain은 창을 만든 스레드에서 만든다. 다른 스레드에서 만들면 창 메시지를 기다리다 멈출 수 있다
+    auto swapChainStage = graph.AddStage("SwapChain", StageThread::Main, { deviceStage, windowStage }, [&stages] { return stages.CreateSwapChain(); });
+    auto commandListStage = graph.AddStage("CommandList", StageThread::Worker, { deviceStage }, [&stages] { return stages.CreateCommandList(); });
+    auto rootSignatureStage = graph.AddStage("RootSignature", StageThread::Worker, { deviceStage }, [&stages] { return stages.CreateRootSignature(); });
+
+    // 어떤 셰이더를 쓸지는 device의 SM 지원 여부로 정해진다
+    auto shaderStage = graph.AddAsyncStage("Shaders", StageThread::Worker, { deviceStage }, [&stages] { return stages.LoadShadersAsync(); });
+    auto pipelineStage = graph.AddStage("PipelineState", StageThread::Worker, { shaderStage, rootSignatureStage }, [&stages] { return stages.CreatePipelineState(); });
+    auto vertexBufferStage = graph.AddStage("VertexBuffer", StageThread::Worker, { rootSignatureStage }, [&stages] { return stages.CreateVertexBuffer(); });
+    auto particleShaderStage = graph.AddAsyncStage("ParticleShaders", StageThread::Worker, {}, [&stages] { return stages.LoadParticleShadersAsync(); });
+    auto particlesStage = graph.AddStage("Particles", StageThread::Worker, { deviceStage, particleShaderStage }, [&stages] { return stages.CreateParticles(); });
+    auto clusteredLightingShaderStage = graph.AddAsyncStage("ClusteredLightingShaders", StageThread::Worker, {}, [&stages] { return stages.LoadClusteredLightingShadersAsync(); });
+    auto clusteredLightingStage = graph.AddStage("ClusteredLighting", StageThread::Worker, { deviceStage, clusteredLightingShaderStage }, [&stages] { return stages.CreateClusteredLighting(); });
+    auto debugDrawShaderStage = graph.AddAsyncStage("DebugDrawShaders", StageThread::Worker, {}, [&stages] { return stages.LoadDebugDrawShadersAsync(); });
+    auto debugDrawStage = graph.AddStage("DebugDraw", StageThread::Worker, { deviceStage, debugDrawShaderStage }, [&stages] { return stages.CreateDebugDraw(); });
+    auto frameCaptureStage = graph.AddStage("FrameCapture", StageThread::Worker, { swapChainStage }, [&stages] { return stages.CreateFrameCapture(); });
+    auto meshAssetStage = graph.AddAsyncStage("MeshAssets", StageThread::Worker, {}, [&stages] { return stages.LoadMeshAssetsAsync(); });
+    auto lodInstanceStage = graph.AddStage("LodInstances", StageThread::Worker, { meshAssetStage }, [&stages] { return stages.CreateLodInstances(); });
+    auto occlusionStage = graph.AddStage("OcclusionCulling", StageThread::Worker, {}, [&stages] { return stages.CreateOcclusionCulling(); });
+    auto shadowCacheStage = graph.AddStage("ShadowCache", StageThread::Worker, { occlusionStage }, [&stages] { return stages.CreateShadowCache(); });
+    auto commandObjectStage = graph.AddStage("CommandObjects", StageThread::Worker, { swapChainStage, commandListStage, pipelineStage, vertexBufferStage }, [&stages] { return stages.RegisterCommandObjects(); });
+    auto sharedContextStage = graph.AddStage("SharedContext", StageThread::Worker, { swapChainStage, commandListStage, pipelineStage, vertexBufferStage }, [&stages] { return stages.CreateSharedContext(); });
+
+    // fence와 event는 GpuQueues에서 만들었다
+    graph.AddStage("FirstSync", StageThread::Worker, { swapChainStage, commandListStage, pipelineStage, vertexBufferStage, particlesStage, clusteredLightingStage, debugDrawStage, frameCaptureStage, lodInstanceStage, occlusionStage, shadowCacheStage, commandObjectStage, sharedContextStage }, [&stages] { return stages.WaitForGpu(); });
+}
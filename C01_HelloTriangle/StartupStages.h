@@ -0,0 +1,37 @@
+#pragma once
+#include "StartupGraph.h"
+
+// MyWindow::OnInit의 초기화 단계들
+// MyWindow가 D3D12로 구현하고, StartupBenchmark는 창과 GPU 없이 같은 그래프를 대역으로 돌린다
+class IStartupStages
+{
+public:
+    virtual ~IStartupStages() = default;
+
+    virtual bool CreateFactory() = 0;
+    virtual bool CreateDevice() = 0;
+    virtual bool CreateMainWindow() = 0;
+    virtual bool CreateSwapChain() = 0;
+    virtual bool CreateCommandList() = 0;
+    virtual bool CreateRootSignature() = 0;
+    virtual Task<bool> LoadShadersAsync() = 0;
+    virtual bool CreatePipelineState() = 0;
+    virtual bool CreateVertexBuffer() = 0;
+    virtual Task<bool> LoadParticleShadersAsync() = 0;
+    virtual bool CreateParticles() = 0;
+    virtual Task<bool> LoadClusteredLightingShadersAsync() = 0;
+    virtual bool CreateClusteredLighting() = 0;
+    virtual Task<bool> LoadDebugDrawShadersAsync() = 0;
+    virtual bool CreateDebugDraw() = 0;
+    virtual bool CreateFrameCapture() = 0;
+    virtual Task<bool> LoadMeshAssetsAsync() = 0;
+    virtual bool CreateLodInstances() = 0;
+    virtual bool CreateOcclusionCulling() = 0;
+    virtual bool CreateShadowCache() = 0;
+    virtual bool RegisterCommandObjects() = 0;
+    virtual bool CreateSharedContext() = 0;
+    virtual bool WaitForGpu() = 0;
+};
+
+// 단계들을 의존성에 맞춰 graph에 등록한다. stages는 graph.Run이 끝날때까지 살아 있어야 한다
+void AddStartupStages(StartupGraph& graph, IStartupStages& stages);
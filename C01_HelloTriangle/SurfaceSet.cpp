@@ -0,0 +1,117 @@
+#include "SurfaceSet.h"
+
+using namespace std;
+
+namespace
+{
+    // 커밋된 리소스는 64KB 단위로 잡힌다
+    const uint64_t ResourcePlacementAlignment = 64 * 1024;
+}
+
+SurfaceSet::SurfaceSet(ISurfaceBackend& backend, ResourceId firstResource)
+    : backend(backend), firstResource(firstResource)
+{
+}
+
+uint32_t SurfaceSet::AddSurface(uint32_t width, uint32_t height, const SurfacePacing& pacing)
+{
+    Surface surface = {};
+    surface.id = static_cast<uint32_t>(surfaces.size());
+    surface.pacing = pacing;
+    if (surface.pacing.frameInterval == 0)
+        surface.pacing.frameInterval = 1;
+
+    if (!backend.CreateSurface(surface.id, width, height, surface.memory))
+        return InvalidSurface;
+
+    surfaces.push_back(surface);
+    return surface.id;
+}
+
+bool SurfaceSet::Record(FrameGraph& frameGraph, ICommandBackend& commands, uint64_t frameNumber, uint32_t frameSlot)
+{
+    for (Surface& surface : surfaces)
+    {
+        surface.recorded = false;
+        if (frameNumber % surface.pacing.frameInterval != 0)
+            continue;
+
+        // 준비 안 된 창을 기다리면 다른 창까지 같이 늦어지므로 이번 차례만 건너뛴다
+        if (!backend.IsSurfaceReady(surface.id))
+        {
+            surface.stats.notReadyFrames++;
+            continue;
+        }
+
+        // 이름은 FrameGraph가 포인터로 들고 있으므로 고정 문자열을 쓴다
+        uint32_t pass = frameGraph.AddPass("Surface", QueueType::Graphics, /*reads*/ {}, /*writes*/ { firstResource + surface.id });
+        if (!backend.RecordSurface(surface.id, frameSlot, pass, commands))
+            return false;
+
+        surface.recorded = true;
+        surface.stats.recordedFrames++;
+    }
+
+    return true;
+}
+
+bool SurfaceSet::Present()
+{
+    for (Surface& surface : surfaces)
+    {
+        if (!surface.recorded)
+            continue;
+
+        if (!backend.Present(surface.id, surface.pacing.syncInterval))
+            return false;
+
+        surface.stats.presentedFrames++;
+    }
+
+    return true;
+}
+
+uint64_t SurfaceSet::GetTotalMemory() const
+{
+    uint64_t total = 0;
+    for (const Surface& surface : surfaces)
+        total += surface.memory.GetTotal();
+    return total;
+}
+
+NullSurfaceBackend::NullSurfaceBackend(uint32_t bufferCount, uint32_t descriptorSize, uint32_t readyInterval)
+    : bufferCount(bufferCount), descriptorSize(descriptorSize), readyInterval(readyInterval == 0 ? 1 : readyInterval), recordCount(0), presentCount(0)
+{
+}
+
+bool NullSurfaceBackend::CreateSurface(uint32_t surface, uint32_t width, uint32_t height, SurfaceMemory& memory)
+{
+    // R8G8B8A8 백 버퍼
+    uint64_t bufferBytes = static_cast<uint64_t>(width) * height * 4;
+    bufferBytes = (bufferBytes + ResourcePlacementAlignment - 1) / ResourcePlacementAlignment * ResourcePlacementAlignment;
+
+    memory.backBufferBytes = bufferBytes * bufferCount;
+    memory.descriptorBytes = static_cast<uint64_t>(descriptorSize) * bufferCount;
+
+    if (readyQueries.size() <= surface)
+        readyQueries.resize(surface + 1, 0);
+    return true;
+}
+
+bool NullSurfaceBackend::IsSurfaceReady(uint32_t surface)
+{
+    return readyQueries[surface]++ % readyInterval == 0;
+}
+
+bool NullSurfaceBackend::RecordSurface(uint32_t /*surface*/, uint32_t /*frameSlot*/, uint32_t /*passIndex*/, ICommandBackend& commands)
+{
+    commands.External("Surface");
+    recordCount++;
+    return true;
+}
+
+bool NullSurfaceBackend::Present(uint32_t /*surface*/, uint32_t /*syncInterval*/)
+{
+    presentCount++;
+    return true;
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "CommandStream.h"
+
+// 창 하나를 얼마나 자주 그리고 Present할지
+struct SurfacePacing
+{
+    uint32_t syncInterval;  // Present에 넘기는 값. 0이면 vblank를 기다리지 않는다
+    uint32_t frameInterval; // 주 창 몇 프레임에 한 번 그릴지. 1이면 매 프레임
+};
+
+// 창 하나가 따로 잡은 메모리. PSO, 루트 시그니처, 버텍스 버퍼, 커맨드 할당자는 공유하므로 들어가지 않는다
+// 창마다 커맨드 리스트 오브젝트도 하나씩 있지만 드라이버가 크기를 알려주지 않아서 세지 않는다
+struct SurfaceMemory
+{
+    uint64_t backBufferBytes;
+    uint64_t descriptorBytes; // 공유 RTV 힙에서 쓰는 칸
+
+    uint64_t GetTotal() const { return backBufferBytes + descriptorBytes; }
+};
+
+struct SurfaceStats
+{
+    uint64_t recordedFrames;
+    uint64_t presentedFrames;
+    uint64_t notReadyFrames; // 차례였지만 스왑체인이 아직 새 프레임을 받을 수 없어서 건너뛴 프레임
+};
+
+// 창에 딸린 GPU 오브젝트(스왑체인, 백 버퍼, 커맨드 리스트)를 만들고, 기록하고, Present하는 쪽
+// D3D12에서는 D3D12SurfaceBackend가 구현하고, D3D12가 없는 환경에서는 NullSurfaceBackend로 횟수와 메모리를 잴 수 있다
+class ISurfaceBackend
+{
+public:
+    virtual ~ISurfaceBackend() = default;
+
+    virtual bool CreateSurface(uint32_t surface, uint32_t width, uint32_t height, SurfaceMemory& memory) = 0;
+
+    // 스왑체인이 프레임을 하나 더 받을 수 있는지 기다리지 않고 답한다. true면 이번 프레임에 꼭 Present해야 한다
+    virtual bool IsSurfaceReady(uint32_t surface) = 0;
+
+    // 이 창의 커맨드 리스트를 frameSlot의 공유 자원으로 기록하고 passIndex 패스가 제출될때 함께 나가게 한다
+    // 창 커맨드 리스트는 따로 기록하므로 commands에는 External("Surface")로 자리만 남긴다
+    virtual bool RecordSurface(uint32_t surface, uint32_t frameSlot, uint32_t passIndex, ICommandBackend& commands) = 0;
+    virtual bool Present(uint32_t surface, uint32_t syncInterval) = 0;
+};
+
+// 주 창과 디바이스를 같이 쓰는 추가 창들
+// 창마다 그래픽스 패스를 하나씩 주 창 패스 뒤에 등록한다. 사이에 Wait/Signal이 없으므로
+// 큐 백엔드가 주 창 커맨드 리스트와 묶어서 한 번의 ExecuteCommandLists로 제출한다
+// Present는 창마다 자기 pacing으로 따로 한다
+class SurfaceSet
+{
+    struct Surface
+    {
+        uint32_t id;
+        SurfacePacing pacing;
+        SurfaceMemory memory;
+        SurfaceStats stats;
+        bool recorded; // 이번 프레임에 기록해서 Present할 차례
+    };
+
+    ISurfaceBackend& backend;
+    std::vector<Surface> surfaces;
+    ResourceId firstResource; // 창마다 백 버퍼를 이 번호부터 차례로 FrameGraph 리소스로 쓴다
+
+public:
+    static const uint32_t InvalidSurface = UINT32_MAX;
+
+    SurfaceSet(ISurfaceBackend& backend, ResourceId firstResource);
+
+    // 프레임 밖에서 부른다. 실패하면 InvalidSurface
+    uint32_t AddSurface(uint32_t width, uint32_t height, const SurfacePacing& pacing);
+
+    // 주 창 패스를 등록한 뒤에 부른다. 이번 프레임이 차례이고 준비된 창만 패스를 등록하고 기록한다
+    bool Record(FrameGraph& frameGraph, ICommandBackend& commands, uint64_t frameNumber, uint32_t frameSlot);
+
+    // FrameGraph::Submit 뒤에 부른다
+    bool Present();
+
+    uint32_t GetSurfaceCount() const { return static_cast<uint32_t>(surfaces.size()); }
+    const SurfaceStats& GetStats(uint32_t index) const { return surfaces[index].stats; }
+    const SurfaceMemory& GetMemory(uint32_t index) const { return surfaces[index].memory; }
+    uint64_t GetTotalMemory() const;
+};
+
+// GPU 없이 창을 흉내 내는 백엔드. 메모리는 D3D12 기본 배치(64KB 정렬)로 계산하고 호출 횟수만 센다
+// 같은 FrameGraph를 CommandStreamWriter로 제출하면 창 수에 따른 제출 횟수도 함께 볼 수 있다
+class NullSurfaceBackend : public ISurfaceBackend
+{
+    uint32_t bufferCount;
+    uint32_t descriptorSize;
+    uint32_t readyInterval;             // 창마다 이 횟수에 한 번만 준비됐다고 답한다. 1이면 늘 준비됨
+    std::vector<uint64_t> readyQueries; // 창별 IsSurfaceReady 호출 수
+    uint64_t recordCount;
+    uint64_t presentCount;
+
+public:
+    NullSurfaceBackend(uint32_t bufferCount, uint32_t descriptorSize, uint32_t readyInterval = 1);
+
+    uint64_t GetRecordCount() const { return recordCount; }
+    uint64_t GetPresentCount() const { return presentCount; }
+
+    bool CreateSurface(uint32_t surface, uint32_t width, uint32_t height, SurfaceMemory& memory) override;
+    bool IsSurfaceReady(uint32_t surface) override;
+    bool RecordSurface(uint32_t surface, uint32_t frameSlot, uint32_t passIndex, ICommandBackend& commands) override;
+    bool Present(uint32_t surface, uint32_t syncInterval) override;
+};
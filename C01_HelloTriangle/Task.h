@@ -0,0 +1,474 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// co_await로 이어 쓸 수 있는 코루틴 태스크
+// 처음 co_await(또는 SyncWait)될때 시작하고, 끝나면 기다리던 코루틴을 바로 이어서 실행한다
+template<typename T = void>
+class Task;
+
+namespace detail
+{
+    // 코루틴 프레임을 크기별 목록에 모아 두고 돌려 쓴다. 매 프레임 만드는 태스크가 힙을 건드리지 않게 한다
+    // 프레임은 만든 스레드와 다른 워커 스레드에서 끝나기도 하므로 크기마다 락을 둔다. 받은 메모리는 힙에 돌려주지 않는다
+    class CoroutineFramePool
+    {
+        static const size_t Granularity = 64;
+        static const size_t ClassCount = 32; // 이보다 큰 프레임은 보통 힙을 쓴다
+
+        struct FreeFrame
+        {
+            FreeFrame* next;
+        };
+
+        struct SizeClass
+        {
+            std::mutex mutex;
+            FreeFrame* head = nullptr;
+        };
+
+        static SizeClass* GetSizeClasses()
+        {
+            // 다른 정적 객체가 종료 중에 프레임을 돌려줄 수도 있으므로 부수지 않는다
+            static SizeClass* sizeClasses = new SizeClass[ClassCount];
+            return sizeClasses;
+        }
+
+    public:
+        static void* Allocate(size_t size)
+        {
+            size_t sizeClass = (size + Granularity - 1) / Granularity;
+            if (sizeClass == 0 || sizeClass > ClassCount)
+                return ::operator new(size);
+
+            SizeClass& entry = GetSizeClasses()[sizeClass - 1];
+            {
+                std::lock_guard<std::mutex> lock(entry.mutex);
+                if (FreeFrame* frame = entry.head)
+                {
+                    entry.head = frame->next;
+                    return frame;
+                }
+            }
+            return ::operator new(sizeClass * Granularity);
+        }
+
+        static void Free(void* pointer, size_t size) noexcept
+        {
+            size_t sizeClass = (size + Granularity - 1) / Granularity;
+            if (sizeClass == 0 || sizeClass > ClassCount)
+            {
+                ::operator delete(pointer);
+                return;
+            }
+
+            SizeClass& entry = GetSizeClasses()[sizeClass - 1];
+            FreeFrame* frame = static_cast<FreeFrame*>(pointer);
+            std::lock_guard<std::mutex> lock(entry.mutex);
+            frame->next = entry.head;
+            entry.head = frame;
+        }
+    };
+
+    struct TaskPromiseBase
+    {
+        std::coroutine_handle<> continuation;
+        std::exception_ptr exception;
+
+        static void* operator new(size_t size) { return CoroutineFramePool::Allocate(size); }
+        static void operator delete(void* pointer, size_t size) noexcept { CoroutineFramePool::Free(pointer, size); }
+
+        struct FinalAwaiter
+        {
+            bool await_ready() noexcept { return false; }
+
+            template<typename Promise>
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+            {
+                // 스택을 쌓지 않고 기다리던 코루틴으로 넘어간다
+                std::coroutine_handle<> continuation = handle.promise().continuation;
+                return continuation ? continuation : std::noop_coroutine();
+            }
+
+            void await_resume() noexcept {}
+        };
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        FinalAwaiter final_suspend() noexcept { return {}; }
+        void unhandled_exception() { exception = std::current_exception(); }
+    };
+
+    template<typename T>
+    struct TaskPromise : TaskPromiseBase
+    {
+        std::optional<T> value;
+
+        Task<T> get_return_object();
+
+        template<typename U>
+        void return_value(U&& result) { value.emplace(std::forward<U>(result)); }
+
+        T GetResult()
+        {
+            if (exception)
+                std::rethrow_exception(exception);
+
+            return std::move(*value);
+        }
+    };
+
+    template<>
+    struct TaskPromise<void> : TaskPromiseBase
+    {
+        Task<void> get_return_object();
+
+        void return_void() {}
+
+        void GetResult()
+        {
+            if (exception)
+                std::rethrow_exception(exception);
+        }
+    };
+
+    // 시작하자마자 실행되고, 끝나면 스스로 정리되는 코루틴. SyncWait, WhenAll 내부에서만 쓴다
+    struct DetachedTask
+    {
+        struct promise_type
+        {
+            static void* operator new(size_t size) { return CoroutineFramePool::Allocate(size); }
+            static void operator delete(void* pointer, size_t size) noexcept { CoroutineFramePool::Free(pointer, size); }
+
+            DetachedTask get_return_object() { return {}; }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() { std::terminate(); }
+        };
+    };
+
+    // Start로 시작하고, 끝나면 자기 프레임을 먼저 풀에 돌려놓은 다음 complete를 부른다. SyncWait, WhenAll 내부에서만 쓴다
+    // 끝났다는 알림을 받은 스레드가 바로 다음 프레임 일을 시작해도 아직 안 돌려놓은 프레임 때문에 풀이 더 커지지 않는다
+    struct CompletionTask
+    {
+        struct promise_type
+        {
+            void (*complete)(void* context) = nullptr;
+            void* context = nullptr;
+
+            static void* operator new(size_t size) { return CoroutineFramePool::Allocate(size); }
+            static void operator delete(void* pointer, size_t size) noexcept { CoroutineFramePool::Free(pointer, size); }
+
+            struct FinalAwaiter
+            {
+                bool await_ready() noexcept { return false; }
+
+                void await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+                {
+                    void (*complete)(void*) = handle.promise().complete;
+                    void* context = handle.promise().context;
+                    handle.destroy();
+                    complete(context);
+                }
+
+                void await_resume() noexcept {}
+            };
+
+            CompletionTask get_return_object() { return CompletionTask{ std::coroutine_handle<promise_type>::from_promise(*this) }; }
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            FinalAwaiter final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() { std::terminate(); }
+        };
+
+        std::coroutine_handle<promise_type> handle;
+
+        void Start(void (*complete)(void* context), void* context)
+        {
+            handle.promise().complete = complete;
+            handle.promise().context = context;
+            handle.resume();
+        }
+    };
+}
+
+template<typename T>
+class Task
+{
+public:
+    using promise_type = detail::TaskPromise<T>;
+
+private:
+    std::coroutine_handle<promise_type> handle;
+
+public:
+    Task() : handle(nullptr) {}
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+    Task(Task&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+    Task(const Task&) = delete;
+
+    Task& operator=(Task&& other) noexcept
+    {
+        if (this != &other)
+        {
+            if (handle)
+                handle.destroy();
+
+            handle = std::exchange(other.handle, nullptr);
+        }
+        return *this;
+    }
+
+    Task& operator=(const Task&) = delete;
+
+    ~Task()
+    {
+        if (handle)
+            handle.destroy();
+    }
+
+    struct Awaiter
+    {
+        std::coroutine_handle<promise_type> handle;
+
+        bool await_ready() noexcept { return !handle || handle.done(); }
+
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaitingCoroutine) noexcept
+        {
+            handle.promise().continuation = awaitingCoroutine;
+            return handle;
+        }
+
+        // 기본 생성했거나 옮겨 간 빈 태스크는 기다리던 코루틴에 예외로 알린다
+        T await_resume()
+        {
+            if (!handle)
+                throw std::logic_error("co_await on an empty Task");
+
+            return handle.promise().GetResult();
+        }
+    };
+
+    Awaiter operator co_await() const noexcept { return Awaiter{ handle }; }
+};
+
+template<typename T>
+Task<T> detail::TaskPromise<T>::get_return_object()
+{
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> detail::TaskPromise<void>::get_return_object()
+{
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+// 한번 Set되면 계속 Set 상태로 남는 이벤트. 여러 코루틴이 동시에 기다릴 수 있다
+// Set을 부른 스레드에서 기다리던 코루틴들이 이어서 실행된다
+class AsyncEvent
+{
+    std::mutex mutex;
+    bool set = false;
+    std::vector<std::coroutine_handle<>> waiters;
+
+public:
+    void Set()
+    {
+        std::vector<std::coroutine_handle<>> readyWaiters;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            set = true;
+            readyWaiters.swap(waiters);
+        }
+
+        for (auto waiter : readyWaiters)
+            waiter.resume();
+    }
+
+    bool IsSet()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return set;
+    }
+
+    struct Awaiter
+    {
+        AsyncEvent& event;
+
+        bool await_ready() { return event.IsSet(); }
+
+        bool await_suspend(std::coroutine_handle<> handle)
+        {
+            std::lock_guard<std::mutex> lock(event.mutex);
+            if (event.set)
+                return false;
+
+            event.waiters.push_back(handle);
+            return true;
+        }
+
+        void await_resume() noexcept {}
+    };
+
+    Awaiter operator co_await() { return Awaiter{ *this }; }
+};
+
+// 코루틴이 아닌 곳(OnInit 등)에서 태스크가 끝날때까지 기다린다
+template<typename T>
+T SyncWait(Task<T> task)
+{
+    struct WaitState
+    {
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool done = false;
+    };
+
+    WaitState state;
+    std::exception_ptr exception;
+    std::optional<std::conditional_t<std::is_void_v<T>, bool, T>> result;
+
+    auto run = [&]() -> detail::CompletionTask
+    {
+        try
+        {
+            if constexpr (std::is_void_v<T>)
+                co_await task;
+            else
+                result.emplace(co_await task);
+        }
+        catch (...)
+        {
+            exception = std::current_exception();
+        }
+    };
+
+    run().Start([](void* context)
+    {
+        WaitState& state = *static_cast<WaitState*>(context);
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.done = true;
+        state.cv.notify_all();
+    }, &state);
+
+    {
+        std::unique_lock<std::mutex> lock(state.mutex);
+        state.cv.wait(lock, [&] { return state.done; });
+    }
+
+    if (exception)
+        std::rethrow_exception(exception);
+
+    if constexpr (!std::is_void_v<T>)
+        return std::move(*result);
+}
+
+namespace detail
+{
+    struct WhenAllState
+    {
+        std::atomic<size_t> remaining;
+        std::coroutine_handle<> continuation;
+        std::exception_ptr exception;
+        std::mutex exceptionMutex;
+    };
+
+    inline CompletionTask RunWhenAllTask(Task<void>& task, WhenAllState& state)
+    {
+        try
+        {
+            co_await task;
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(state.exceptionMutex);
+            if (!state.exception)
+                state.exception = std::current_exception();
+        }
+    }
+
+    inline void CompleteWhenAllTask(void* context)
+    {
+        WhenAllState& state = *static_cast<WhenAllState*>(context);
+        if (state.remaining.fetch_sub(1) == 1)
+            state.continuation.resume();
+    }
+
+    template<typename Allocator>
+    struct WhenAllAwaiter
+    {
+        std::vector<Task<void>, Allocator>& tasks;
+        WhenAllState state;
+
+        explicit WhenAllAwaiter(std::vector<Task<void>, Allocator>& tasks) : tasks(tasks) {}
+
+        bool await_ready() noexcept { return tasks.empty(); }
+
+        bool await_suspend(std::coroutine_handle<> awaitingCoroutine)
+        {
+            // 모든 태스크를 시작한 다음에 1을 빼서, 시작하는 도중에 다 끝나버려도 안전하게 한다
+            state.continuation = awaitingCoroutine;
+            state.remaining = tasks.size() + 1;
+
+            for (auto& task : tasks)
+                RunWhenAllTask(task, state).Start(CompleteWhenAllTask, &state);
+
+            return state.remaining.fetch_sub(1) != 1;
+        }
+
+        void await_resume()
+        {
+            if (state.exception)
+                std::rethrow_exception(state.exception);
+        }
+    };
+
+    template<typename T>
+    Task<void> StoreResult(Task<T> task, std::optional<T>& result)
+    {
+        result.emplace(co_await task);
+    }
+}
+
+// 태스크들을 한꺼번에 진행시키고 모두 끝나면 이어서 실행한다
+inline Task<void> WhenAll(std::vector<Task<void>> tasks)
+{
+    co_await detail::WhenAllAwaiter{ tasks };
+}
+
+// 태스크 배열을 ArenaVector 등 다른 할당자에 둔 경우. 매 프레임 나누는 일은 배열을 스레드 임시 메모리에 둔다
+template<typename Allocator>
+Task<void> WhenAll(std::vector<Task<void>, Allocator> tasks)
+{
+    co_await detail::WhenAllAwaiter{ tasks };
+}
+
+template<typename T>
+Task<std::vector<T>> WhenAll(std::vector<Task<T>> tasks)
+{
+    std::vector<std::optional<T>> storedResults(tasks.size());
+
+    std::vector<Task<void>> storeTasks;
+    storeTasks.reserve(tasks.size());
+    for (size_t i = 0; i < tasks.size(); i++)
+        storeTasks.push_back(detail::StoreResult(std::move(tasks[i]), storedResults[i]));
+
+    co_await WhenAll(std::move(storeTasks));
+
+    std::vector<T> results;
+    results.reserve(storedResults.size());
+    for (auto& storedResult : storedResults)
+        results.push_back(std::move(*storedResult));
+
+    co_return results;
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+// 벤치마크 실행 파일들이 같이 쓰는 시간 측정
+// 같은 작업을 repeats번 돌려서 가장 빠른 시간을 ms로 돌려준다. 처음 한 번은 캐시와 힙을 데우는 용도로 버린다
+template<typename Function>
+double MeasureMilliseconds(int repeats, Function&& function)
+{
+    function();
+
+    double best = 0.0;
+    for (int i = 0; i < repeats; i++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (i == 0 || elapsed < best)
+            best = elapsed;
+    }
+    return best;
+}
+
+// 최적화로 계산이 사라지지 않게 결과(체크섬 등 스칼라)를 volatile에 섞어둔다
+inline volatile uint64_t benchmarkSink = 0;
+
+template<typename T>
+void KeepResult(T value)
+{
+    benchmarkSink = benchmarkSink + static_cast<uint64_t>(value);
+}
@@ -0,0 +1,235 @@
+#include "Benchmark.h"
+#include "DescriptorIndexAllocator.h"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+using namespace std;
+
+// 드로우마다 리소스를 묶는 CPU 비용을 bindless와 descriptor table 방식으로 비교한다
+// D3D12 호출은 리눅스에서 부를 수 없으므로 드라이버가 하는 일 중 앱 쪽에서 보이는 부분만 흉내낸다
+//  - table: 재료의 descriptor들을 CPU 힙에서 shader visible 링으로 복사(CopyDescriptorsSimple)하고 table 핸들을 기록
+//  - bindless: 재료를 만들때 힙에 한번만 쓰고 인덱스들은 재료 버퍼에 둔다. 드로우마다 BindlessHeap::DrawConstants
+//    모양의 상수 4개만 기록한다
+// 재료를 바꿔 끼우는 스트리밍도 같이 재서, bindless 쪽의 Free/Reclaim 비용까지 포함한다
+
+namespace
+{
+    const uint32_t FrameCount = 2;
+    const uint32_t MaterialCount = 4096;
+    const uint32_t DescriptorSize = 32; // 흔한 CBV/SRV/UAV descriptor 크기
+    const uint32_t MaxDescriptorsPerDraw = 8;
+    const int Frames = 32;
+
+    struct Descriptor
+    {
+        uint8_t bytes[DescriptorSize];
+    };
+
+    enum class BindCommand : uint8_t
+    {
+        SetDescriptorTable,
+        SetRootConstants,
+        Draw,
+    };
+
+    // 커맨드 리스트 대신 바이트만 쌓는다
+    class CommandBytes
+    {
+        vector<uint8_t> bytes;
+
+    public:
+        void Reserve(size_t size) { bytes.reserve(size); }
+        void Clear() { bytes.clear(); }
+        size_t GetSize() const { return bytes.size(); }
+
+        template<typename T>
+        void Write(const T& value)
+        {
+            size_t offset = bytes.size();
+            bytes.resize(offset + sizeof(T));
+            memcpy(bytes.data() + offset, &value, sizeof(T));
+        }
+
+        void WriteBytes(const void* data, size_t size)
+        {
+            size_t offset = bytes.size();
+            bytes.resize(offset + size);
+            memcpy(bytes.data() + offset, data, size);
+        }
+    };
+
+    Descriptor MakeDescriptor(uint32_t seed)
+    {
+        Descriptor descriptor;
+        for (uint32_t i = 0; i < DescriptorSize; i++)
+            descriptor.bytes[i] = static_cast<uint8_t>(seed * 31 + i);
+        return descriptor;
+    }
+
+    struct BindingResult
+    {
+        double milliseconds;
+        size_t commandBytesPerFrame;
+        bool succeeded;
+    };
+
+    // 드로우마다 재료의 descriptor들을 이번 프레임 링 구간에 복사하고 그 시작 핸들을 넘긴다
+    BindingResult RunTable(uint32_t drawCount, uint32_t descriptorsPerDraw, uint32_t streamedPerFrame)
+    {
+        vector<Descriptor> cpuHeap(MaterialCount * descriptorsPerDraw);
+        for (uint32_t i = 0; i < cpuHeap.size(); i++)
+            cpuHeap[i] = MakeDescriptor(i);
+
+        // 프레임 슬롯마다 드로우 수만큼 자리를 둔다
+        const uint64_t ringBase = 0x100000000ull;
+        vector<Descriptor> ring(static_cast<size_t>(FrameCount) * drawCount * descriptorsPerDraw);
+        CommandBytes commands;
+        commands.Reserve(static_cast<size_t>(drawCount) * 64);
+
+        uint32_t streamCursor = 0;
+        uint32_t generation = 0;
+        BindingResult result = {};
+        result.succeeded = true;
+        result.milliseconds = MeasureMilliseconds(3, [&]
+        {
+            for (int frame = 0; frame < Frames; frame++)
+            {
+                // 스트리밍: 재료의 CPU 쪽 descriptor만 고치면 다음 복사 때 반영된다
+                generation++;
+                for (uint32_t s = 0; s < streamedPerFrame; s++)
+                {
+                    uint32_t material = (streamCursor++) % MaterialCount;
+                    for (uint32_t d = 0; d < descriptorsPerDraw; d++)
+                        cpuHeap[material * descriptorsPerDraw + d] = MakeDescriptor(generation + d);
+                }
+
+                commands.Clear();
+                uint32_t slot = frame % FrameCount;
+                size_t cursor = static_cast<size_t>(slot) * drawCount * descriptorsPerDraw;
+                for (uint32_t draw = 0; draw < drawCount; draw++)
+                {
+                    uint32_t material = (draw * 7919u) % MaterialCount;
+                    memcpy(&ring[cursor], &cpuHeap[material * descriptorsPerDraw], descriptorsPerDraw * sizeof(Descriptor));
+
+                    uint64_t gpuHandle = ringBase + cursor * DescriptorSize;
+                    commands.Write(BindCommand::SetDescriptorTable);
+                    commands.Write(uint32_t(0));
+                    commands.Write(gpuHandle);
+                    commands.Write(BindCommand::Draw);
+                    commands.Write(uint32_t(3));
+                    cursor += descriptorsPerDraw;
+                }
+            }
+        });
+
+        KeepResult(ring[ring.size() / 2].bytes[0]);
+        result.commandBytesPerFrame = commands.GetSize();
+        return result;
+    }
+
+    // 재료를 만들때 받은 인덱스는 재료 버퍼(셰이더가 materialIndex로 읽는다)에 두고, 드로우마다 상수 4개만 넘긴다
+    // 스트리밍으로 바뀐 재료는 새 인덱스를 받고, 옛 인덱스는 그 프레임 fence 값으로 Free해서 GPU가 다 읽은 뒤에 다시 쓴다
+    BindingResult RunBindless(uint32_t drawCount, uint32_t descriptorsPerDraw, uint32_t streamedPerFrame)
+    {
+        // 재료 전체 + 아직 GPU가 읽고 있을 수 있는 FrameCount + 1 프레임 몫의 교체분
+        uint32_t capacity = (MaterialCount + streamedPerFrame * (FrameCount + 1)) * descriptorsPerDraw;
+        DescriptorIndexAllocator allocator(capacity);
+        vector<Descriptor> heap(capacity);
+        vector<uint32_t> materialIndices(MaterialCount * descriptorsPerDraw); // 재료 버퍼. 업로드 힙이라고 본다
+        for (uint32_t i = 0; i < materialIndices.size(); i++)
+        {
+            materialIndices[i] = allocator.Allocate();
+            heap[materialIndices[i]] = MakeDescriptor(i);
+        }
+
+        CommandBytes commands;
+        commands.Reserve(static_cast<size_t>(drawCount) * 64);
+
+        uint32_t streamCursor = 0;
+        uint32_t generation = 0;
+        uint64_t fenceValue = 0;
+        BindingResult result = {};
+        result.succeeded = true;
+        result.milliseconds = MeasureMilliseconds(3, [&]
+        {
+            for (int frame = 0; frame < Frames; frame++)
+            {
+                // FrameCount 프레임 전까지 GPU가 끝냈다고 본다
+                fenceValue++;
+                if (fenceValue > FrameCount)
+                    allocator.Reclaim(fenceValue - FrameCount);
+
+                generation++;
+                for (uint32_t s = 0; s < streamedPerFrame; s++)
+                {
+                    uint32_t material = (streamCursor++) % MaterialCount;
+                    for (uint32_t d = 0; d < descriptorsPerDraw; d++)
+                    {
+                        uint32_t& index = materialIndices[material * descriptorsPerDraw + d];
+                        uint32_t newIndex = allocator.Allocate();
+                        if (newIndex == DescriptorIndexAllocator::InvalidIndex)
+                        {
+                            result.succeeded = false;
+                            continue;
+                        }
+
+                        heap[newIndex] = MakeDescriptor(generation + d);
+                        allocator.Free(index, fenceValue);
+                        index = newIndex;
+                    }
+                }
+
+                commands.Clear();
+                for (uint32_t draw = 0; draw < drawCount; draw++)
+                {
+                    uint32_t material = (draw * 7919u) % MaterialCount;
+                    const uint32_t drawConstants[4] = { /*vertexBufferIndex*/ 0, /*firstVertex*/ 0, material, draw };
+                    commands.Write(BindCommand::SetRootConstants);
+                    commands.Write(uint32_t(4));
+                    commands.WriteBytes(drawConstants, sizeof(drawConstants));
+                    commands.Write(BindCommand::Draw);
+                    commands.Write(uint32_t(3));
+                }
+            }
+        });
+
+        KeepResult(heap[heap.size() / 2].bytes[0] + materialIndices[materialIndices.size() / 2]);
+        result.commandBytesPerFrame = commands.GetSize();
+        return result;
+    }
+}
+
+int main()
+{
+    printf("%d frames per run, %u materials, %u bytes per descriptor\n", Frames, MaterialCount, DescriptorSize);
+    printf("%8s %6s %8s | %12s %10s | %12s %10s\n", "draws", "descs", "streamed", "table ns", "bytes", "bindless ns", "bytes");
+
+    bool succeeded = true;
+    const uint32_t drawCounts[] = { 1000, 10000, 100000 };
+    const uint32_t descriptorCounts[] = { 1, 4, MaxDescriptorsPerDraw };
+    const uint32_t streamedCounts[] = { 0, 64 };
+    for (uint32_t drawCount : drawCounts)
+    {
+        for (uint32_t descriptorsPerDraw : descriptorCounts)
+        {
+            for (uint32_t streamedPerFrame : streamedCounts)
+            {
+                BindingResult table = RunTable(drawCount, descriptorsPerDraw, streamedPerFrame);
+                BindingResult bindless = RunBindless(drawCount, descriptorsPerDraw, streamedPerFrame);
+                succeeded = succeeded && table.succeeded && bindless.succeeded;
+
+                // 드로우 하나당 ns, 프레임 하나의 커맨드 바이트
+                double draws = static_cast<double>(drawCount) * Frames;
+                printf("%8u %6u %8u | %12.2f %10zu | %12.2f %10zu\n", drawCount, descriptorsPerDraw, streamedPerFrame,
+                    table.milliseconds * 1e6 / draws, table.commandBytesPerFrame,
+                    bindless.milliseconds * 1e6 / draws, bindless.commandBytesPerFrame);
+            }
+        }
+    }
+
+    if (!succeeded)
+        printf("bindless index allocator ran out of slots\n");
+
+    return succeeded ? 0 : 1;
+}
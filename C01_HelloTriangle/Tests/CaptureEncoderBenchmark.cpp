@@ -0,0 +1,186 @@
+#include "Benchmark.h"
+#include "CaptureEncoder.h"
+#include "ReadbackRing.h"
+#include <algorithm>
+#include <thread>
+
+using namespace std;
+using namespace std::chrono;
+using namespace std::filesystem;
+
+// F12 캡처 경로를 GPU 없이 잰다
+//  - encode: 720p, 1080p 프레임을 인코더 스레드 수를 바꿔가며 PNG 파일로 쓴다. 입력 픽셀 기준 MB/s와 frames/s
+//  - ring: 60fps로 도는 렌더 스레드가 FrameCapture처럼 ReadbackRing 슬롯에 복사하고, GPU fence가 lag 프레임 뒤에 지난다고 본다
+//    인코더가 슬롯을 늦게 돌려주거나 fence가 늦으면 빈 슬롯이 없어서 프레임이 버려진다
+
+namespace
+{
+    const uint32_t EncodeFrames = 16;
+    const uint32_t RingFrames = 120;
+    const uint32_t RingSlotCount = 4; // FrameCapture::DefaultSlotCount
+    const duration<double, milli> FrameInterval(1000.0 / 60.0);
+
+    struct Resolution
+    {
+        const char* name;
+        uint32_t width;
+        uint32_t height;
+    };
+
+    const Resolution Resolutions[] = { { "720p", 1280, 720 }, { "1080p", 1920, 1080 } };
+
+    // readback 버퍼처럼 줄마다 256바이트로 정렬한 RGBA8 이미지
+    struct ReadbackImage
+    {
+        uint32_t width;
+        uint32_t height;
+        uint32_t rowPitch;
+        vector<uint8_t> pixels;
+
+        ReadbackImage(uint32_t width, uint32_t height, uint32_t seed)
+            : width(width), height(height), rowPitch((width * 4 + 255) / 256 * 256), pixels(static_cast<size_t>(rowPitch) * height)
+        {
+            for (uint32_t y = 0; y < height; y++)
+                for (uint32_t x = 0; x < width * 4; x++)
+                    pixels[static_cast<size_t>(y) * rowPitch + x] = static_cast<uint8_t>(x * 7 + y * 3 + seed);
+        }
+
+        CaptureFrame GetFrame(uint64_t frameNumber) const
+        {
+            return { frameNumber, width, height, rowPitch, pixels.data() };
+        }
+    };
+
+    vector<uint32_t> GetThreadCounts()
+    {
+        uint32_t maxThreads = max(2u, thread::hardware_concurrency());
+        vector<uint32_t> counts;
+        for (uint32_t count = 1; count < maxThreads; count *= 2)
+            counts.push_back(count);
+        counts.push_back(maxThreads);
+        return counts;
+    }
+
+    void ResetDirectory(const path& directory)
+    {
+        remove_all(directory);
+        create_directories(directory);
+    }
+
+    void MeasureEncode(const path& directory)
+    {
+        printf("encode: %u PNG frames per run\n", EncodeFrames);
+        printf("%-6s %8s | %10s %10s %10s\n", "size", "threads", "ms", "MB/s", "frames/s");
+
+        for (const Resolution& resolution : Resolutions)
+        {
+            ReadbackImage image(resolution.width, resolution.height, 1);
+            double frameMegabytes = resolution.width * resolution.height * 4 / (1024.0 * 1024.0);
+
+            for (uint32_t threadCount : GetThreadCounts())
+            {
+                ResetDirectory(directory);
+                CaptureEncoder encoder(directory, CaptureFormat::Png, threadCount);
+
+                // 파일 이름이 프레임 번호라서 반복마다 새 번호를 쓴다
+                uint64_t nextFrame = 0;
+                double milliseconds = MeasureMilliseconds(3, [&]
+                {
+                    for (uint32_t i = 0; i < EncodeFrames; i++)
+                        encoder.Encode(image.GetFrame(nextFrame++), [] {});
+                    encoder.Flush();
+                });
+
+                double seconds = milliseconds / 1000.0;
+                printf("%-6s %8u | %10.2f %10.1f %10.1f\n", resolution.name, threadCount, milliseconds,
+                    frameMegabytes * EncodeFrames / seconds, EncodeFrames / seconds);
+                KeepResult(encoder.GetStats().encodedBytes);
+            }
+        }
+    }
+
+    struct RingResult
+    {
+        ReadbackRing::Stats ring;
+        CaptureEncoderStats encoder;
+    };
+
+    // FrameCapture::RecordCopy/Submit/Poll과 같은 순서로 부른다. 프레임 i는 fence 값 i + 1에서 끝난다
+    RingResult RunRing(const path& directory, const Resolution& resolution, uint32_t threadCount, uint32_t fenceLag)
+    {
+        ResetDirectory(directory);
+        vector<ReadbackImage> slotImages;
+        for (uint32_t slot = 0; slot < RingSlotCount; slot++)
+            slotImages.emplace_back(resolution.width, resolution.height, slot);
+
+        ReadbackRing ring(RingSlotCount);
+        vector<ReadbackRing::RetiredSlot> retiredSlots;
+        RingResult result = {};
+        {
+            CaptureEncoder encoder(directory, CaptureFormat::Png, threadCount);
+            auto poll = [&](uint64_t completedFenceValue)
+            {
+                retiredSlots.clear();
+                ring.Retire(completedFenceValue, retiredSlots);
+                for (const ReadbackRing::RetiredSlot& retired : retiredSlots)
+                {
+                    uint32_t slot = retired.slot;
+                    encoder.Encode(slotImages[slot].GetFrame(retired.frameNumber), [&ring, slot] { ring.Release(slot); });
+                }
+            };
+
+            steady_clock::time_point nextFrame = steady_clock::now();
+            for (uint64_t frame = 0; frame < RingFrames; frame++)
+            {
+                // GPU는 fenceLag 프레임 뒤에 있다
+                poll(frame + 1 > fenceLag ? frame + 1 - fenceLag : 0);
+
+                uint32_t slot = ring.Acquire(frame);
+                if (slot != ReadbackRing::InvalidSlot)
+                    ring.Submit(slot, frame + 1);
+
+                nextFrame += duration_cast<steady_clock::duration>(FrameInterval);
+                this_thread::sleep_until(nextFrame);
+            }
+
+            // 종료할때처럼 남은 슬롯을 다 쓴다
+            poll(RingFrames);
+            encoder.Flush();
+            result.encoder = encoder.GetStats();
+        }
+
+        result.ring = ring.GetStats();
+        return result;
+    }
+
+    void MeasureRing(const path& directory)
+    {
+        printf("\nring: %u slots, %u frames at 60 fps, 1080p PNG\n", RingSlotCount, RingFrames);
+        printf("%8s %8s | %8s %8s %8s %8s\n", "threads", "lag", "captured", "dropped", "encoded", "drop %");
+
+        const Resolution& resolution = Resolutions[1];
+        vector<uint32_t> threadCounts = GetThreadCounts();
+        for (uint32_t threadCount : { threadCounts.front(), threadCounts.back() })
+        {
+            for (uint32_t fenceLag : { 1u, 2u, 3u, 4u })
+            {
+                RingResult result = RunRing(directory, resolution, threadCount, fenceLag);
+                printf("%8u %8u | %8llu %8llu %8llu %7.1f%%\n", threadCount, fenceLag,
+                    static_cast<unsigned long long>(result.ring.capturedCount), static_cast<unsigned long long>(result.ring.droppedCount),
+                    static_cast<unsigned long long>(result.encoder.encodedCount), 100.0 * result.ring.droppedCount / RingFrames);
+            }
+        }
+    }
+}
+
+int main()
+{
+    path directory = temp_directory_path() / "capture_encoder_benchmark";
+    printf("%u hardware threads\n", thread::hardware_concurrency());
+
+    MeasureEncode(directory);
+    MeasureRing(directory);
+
+    remove_all(directory);
+    return 0;
+}
@@ -0,0 +1,269 @@
+#include "CaptureEncoder.h"
+#include "TestCheck.h"
+#include <atomic>
+#include <cstring>
+#include <fstream>
+
+using namespace std;
+using namespace std::filesystem;
+
+namespace
+{
+    // 인코더와 따로 짠 비트 단위 CRC-32와 Adler-32. 표준 검사값으로 먼저 확인한다
+    uint32_t ReferenceCrc32(const uint8_t* data, size_t size)
+    {
+        uint32_t crc = 0xFFFFFFFFu;
+        for (size_t i = 0; i < size; i++)
+        {
+            crc ^= data[i];
+            for (int bit = 0; bit < 8; bit++)
+                crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+        }
+        return ~crc;
+    }
+
+    uint32_t ReferenceAdler32(const uint8_t* data, size_t size)
+    {
+        uint32_t a = 1, b = 0;
+        for (size_t i = 0; i < size; i++)
+        {
+            a = (a + data[i]) % 65521;
+            b = (b + a) % 65521;
+        }
+        return (b << 16) | a;
+    }
+
+    uint32_t ReadU32BE(const uint8_t* data)
+    {
+        return (uint32_t(data[0]) << 24) | (uint32_t(data[1]) << 16) | (uint32_t(data[2]) << 8) | data[3];
+    }
+
+    uint32_t ReadU32LE(const uint8_t* data)
+    {
+        return data[0] | (uint32_t(data[1]) << 8) | (uint32_t(data[2]) << 16) | (uint32_t(data[3]) << 24);
+    }
+
+    // readback 버퍼처럼 줄마다 256바이트 정렬된 이미지. 줄 끝 여백에는 인코더가 읽으면 안 되는 값을 채운다
+    struct TestImage
+    {
+        uint32_t width;
+        uint32_t height;
+        uint32_t rowPitch;
+        vector<uint8_t> pixels;
+
+        TestImage(uint32_t width, uint32_t height)
+            : width(width), height(height), rowPitch((width * 4 + 255) & ~255u), pixels(static_cast<size_t>(rowPitch) * height, 0xCD)
+        {
+            for (uint32_t y = 0; y < height; y++)
+            {
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    uint8_t* pixel = &pixels[static_cast<size_t>(rowPitch) * y + x * 4];
+                    pixel[0] = static_cast<uint8_t>(x * 7 + y);
+                    pixel[1] = static_cast<uint8_t>(y * 13);
+                    pixel[2] = static_cast<uint8_t>(x ^ y);
+                    pixel[3] = 255;
+                }
+            }
+        }
+
+        CaptureFrame GetFrame(uint64_t frameNumber) const
+        {
+            return { frameNumber, width, height, rowPitch, pixels.data() };
+        }
+
+        // PNG scanline 모양. 줄마다 filter 바이트 0이 붙는다
+        vector<uint8_t> GetScanlines() const
+        {
+            vector<uint8_t> scanlines;
+            for (uint32_t y = 0; y < height; y++)
+            {
+                scanlines.push_back(0);
+                const uint8_t* row = &pixels[static_cast<size_t>(rowPitch) * y];
+                scanlines.insert(scanlines.end(), row, row + width * 4);
+            }
+            return scanlines;
+        }
+    };
+
+    struct DecodedPng
+    {
+        bool valid;
+        uint32_t width;
+        uint32_t height;
+        uint32_t storedBlocks;
+        vector<uint8_t> scanlines;
+    };
+
+    // 청크 CRC, zlib 헤더, stored 블록의 LEN/NLEN, Adler-32를 모두 확인하면서 푼다
+    DecodedPng DecodeStoredPng(const vector<uint8_t>& png)
+    {
+        static const uint8_t signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+        DecodedPng decoded = {};
+        if (png.size() < sizeof(signature) || memcmp(png.data(), signature, sizeof(signature)) != 0)
+            return decoded;
+
+        vector<uint8_t> zlib;
+        bool sawEnd = false;
+        size_t offset = sizeof(signature);
+        while (offset + 12 <= png.size())
+        {
+            uint32_t length = ReadU32BE(&png[offset]);
+            if (offset + 12 + length > png.size())
+                return decoded;
+
+            const uint8_t* type = &png[offset + 4];
+            const uint8_t* data = type + 4;
+            if (ReadU32BE(data + length) != ReferenceCrc32(type, 4 + length))
+                return decoded;
+
+            if (memcmp(type, "IHDR", 4) == 0)
+            {
+                decoded.width = ReadU32BE(data);
+                decoded.height = ReadU32BE(data + 4);
+                if (length != 13 || data[8] != 8 || data[9] != 6)
+                    return decoded;
+            }
+            else if (memcmp(type, "IDAT", 4) == 0)
+            {
+                zlib.insert(zlib.end(), data, data + length);
+            }
+            else if (memcmp(type, "IEND", 4) == 0)
+            {
+                sawEnd = true;
+            }
+
+            offset += 12 + length;
+        }
+
+        if (!sawEnd || offset != png.size() || zlib.size() < 6)
+            return decoded;
+
+        // CMF/FLG는 31의 배수, 압축 방식 8(deflate)
+        if ((zlib[0] & 0x0F) != 8 || ((zlib[0] << 8) | zlib[1]) % 31 != 0)
+            return decoded;
+
+        size_t position = 2;
+        bool finalBlock = false;
+        while (!finalBlock)
+        {
+            if (position + 5 > zlib.size() - 4)
+                return decoded;
+
+            uint8_t blockHeader = zlib[position];
+            finalBlock = (blockHeader & 1) != 0;
+            if ((blockHeader >> 1) != 0) // stored 블록만 쓴다
+                return decoded;
+
+            uint32_t length = zlib[position + 1] | (zlib[position + 2] << 8);
+            uint32_t inverted = zlib[position + 3] | (zlib[position + 4] << 8);
+            if ((length ^ 0xFFFF) != inverted || position + 5 + length > zlib.size() - 4)
+                return decoded;
+
+            decoded.scanlines.insert(decoded.scanlines.end(), zlib.begin() + position + 5, zlib.begin() + position + 5 + length);
+            decoded.storedBlocks++;
+            position += 5 + length;
+        }
+
+        if (position != zlib.size() - 4 || ReadU32BE(&zlib[position]) != ReferenceAdler32(decoded.scanlines.data(), decoded.scanlines.size()))
+            return decoded;
+
+        decoded.valid = true;
+        return decoded;
+    }
+}
+
+TEST(ReferenceChecksumsMatchStandardValues)
+{
+    const char* digits = "123456789";
+    CHECK(ReferenceCrc32(reinterpret_cast<const uint8_t*>(digits), 9) == 0xCBF43926u);
+
+    const char* wikipedia = "Wikipedia";
+    CHECK(ReferenceAdler32(reinterpret_cast<const uint8_t*>(wikipedia), 9) == 0x11E60398u);
+}
+
+TEST(SmallPngRoundTrips)
+{
+    TestImage image(3, 2);
+    vector<uint8_t> png;
+    CaptureEncoder::EncodePng(image.GetFrame(1), png);
+
+    DecodedPng decoded = DecodeStoredPng(png);
+    CHECK(decoded.valid);
+    CHECK(decoded.width == 3);
+    CHECK(decoded.height == 2);
+    CHECK(decoded.storedBlocks == 1);
+    CHECK(decoded.scanlines == image.GetScanlines());
+
+    // 빈 IEND 청크의 CRC는 모든 PNG에서 같다
+    CHECK(png.size() >= 12);
+    CHECK(ReadU32BE(&png[png.size() - 4]) == 0xAE426082u);
+}
+
+TEST(LargePngSplitsStoredBlocks)
+{
+    // scanline이 65535바이트를 넘어서 stored 블록이 여러 개가 되고, Adler-32도 5552바이트 블록을 여러 번 돈다
+    TestImage image(200, 120);
+    vector<uint8_t> png;
+    CaptureEncoder::EncodePng(image.GetFrame(2), png);
+
+    DecodedPng decoded = DecodeStoredPng(png);
+    vector<uint8_t> scanlines = image.GetScanlines();
+    CHECK(decoded.valid);
+    CHECK(decoded.storedBlocks == (scanlines.size() + 65534) / 65535);
+    CHECK(decoded.scanlines == scanlines);
+}
+
+TEST(RawKeepsHeaderAndPackedRows)
+{
+    TestImage image(5, 3);
+    vector<uint8_t> raw;
+    CaptureEncoder::EncodeRaw(image.GetFrame(0x100000007ull), raw);
+
+    CHECK(raw.size() == 16 + 5 * 3 * 4);
+    CHECK(ReadU32LE(&raw[0]) == 0x57415246u);
+    CHECK(ReadU32LE(&raw[4]) == 5);
+    CHECK(ReadU32LE(&raw[8]) == 3);
+    CHECK(ReadU32LE(&raw[12]) == 7);
+
+    bool rowsMatch = true;
+    for (uint32_t y = 0; y < 3; y++)
+        rowsMatch = rowsMatch && memcmp(&raw[16 + y * 20], &image.pixels[image.rowPitch * y], 20) == 0;
+    CHECK(rowsMatch);
+}
+
+TEST(EncoderThreadsWriteSameBytes)
+{
+    path directory = temp_directory_path() / "capture_encoder_tests";
+    remove_all(directory);
+    create_directories(directory);
+
+    TestImage image(64, 48);
+    atomic<int> readCount{ 0 };
+    {
+        CaptureEncoder encoder(directory, CaptureFormat::Png, 2);
+        for (uint64_t frame = 0; frame < 8; frame++)
+            encoder.Encode(image.GetFrame(frame), [&readCount] { readCount++; });
+        encoder.Flush();
+
+        CaptureEncoderStats stats = encoder.GetStats();
+        CHECK(stats.encodedCount == 8);
+        CHECK(stats.failedCount == 0);
+    }
+    CHECK(readCount == 8);
+
+    vector<uint8_t> expected;
+    CaptureEncoder::EncodePng(image.GetFrame(5), expected);
+
+    ifstream file(directory / "frame_000005.png", ios::binary);
+    vector<uint8_t> written((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    CHECK(written == expected);
+
+    remove_all(directory);
+}
+
+int main()
+{
+    return RunTests();
+}
@@ -0,0 +1,87 @@
+#include "Benchmark.h"
+#include "ClusteredLights.h"
+#include <cmath>
+#include <random>
+#include <thread>
+
+using namespace std;
+
+// 격자 크기와 빛 수를 바꿔 가며 LightClusters::Assign의 스칼라, AVX2, AVX2 + 워커 스레드 경로를 비교한다
+
+namespace
+{
+    const int Repeats = 10;
+
+    vector<GpuLight> MakeLights(uint32_t lightCount, uint32_t seed)
+    {
+        mt19937 random(seed);
+        uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+        vector<GpuLight> lights(lightCount);
+        for (GpuLight& light : lights)
+        {
+            light.positionX = (unit(random) - 0.5f) * 50.0f;
+            light.positionY = -1.5f + unit(random) * 2.0f;
+            light.positionZ = 1.0f + unit(random) * 80.0f;
+            light.range = 1.5f + unit(random) * 3.0f;
+            light.colorR = light.colorG = light.colorB = 1.0f;
+            light.type = unit(random) < 0.3f ? LightType::Spot : LightType::Point;
+
+            float angle = unit(random) * 6.28f;
+            light.directionX = 0.3f * cosf(angle);
+            light.directionY = -sqrtf(1.0f - 0.09f);
+            light.directionZ = 0.3f * sinf(angle);
+            light.cosOuterAngle = cosf(0.3f + unit(random) * 0.8f);
+        }
+        return lights;
+    }
+
+    double MeasureAssign(LightClusters& clusters, ClusterSimdPath path, const vector<GpuLight>& lights, Executor* executor)
+    {
+        clusters.SetSimdPath(path);
+        double ms = MeasureMilliseconds(Repeats, [&] { clusters.Assign(lights.data(), static_cast<uint32_t>(lights.size()), executor); });
+        KeepResult(clusters.GetStats().assignedLights);
+        return ms;
+    }
+}
+
+int main()
+{
+    Executor executor;
+    bool avx2 = false;
+    {
+        LightClusters probe;
+        probe.SetSimdPath(ClusterSimdPath::Avx2);
+        avx2 = probe.GetSimdPath() == ClusterSimdPath::Avx2;
+    }
+
+    printf("%u hardware threads, AVX2 %s\n", thread::hardware_concurrency(), avx2 ? "supported" : "not supported");
+    printf("%12s %6s | %10s %10s %12s | %12s %8s\n", "grid", "lights", "scalar ms", "avx2 ms", "avx2+mt ms", "assigned", "max");
+
+    struct Grid
+    {
+        uint32_t tilesX, tilesY, slices;
+    };
+
+    for (Grid grid : { Grid{ 16, 9, 24 }, Grid{ 32, 18, 32 }, Grid{ 64, 36, 48 } })
+    {
+        for (uint32_t lightCount : { 256u, 1024u, 4096u })
+        {
+            float tanHalfFovY = tanf(0.5236f);
+            ClusterGridDesc desc = { grid.tilesX, grid.tilesY, grid.slices, 0.1f, 100.0f, tanHalfFovY * 16.0f / 9.0f, tanHalfFovY };
+            LightClusters clusters;
+            clusters.Build(desc);
+            vector<GpuLight> lights = MakeLights(lightCount, lightCount);
+
+            double scalarMs = MeasureAssign(clusters, ClusterSimdPath::Scalar, lights, nullptr);
+            double avx2Ms = avx2 ? MeasureAssign(clusters, ClusterSimdPath::Avx2, lights, nullptr) : 0.0;
+            double threadedMs = MeasureAssign(clusters, ClusterSimdPath::Avx2, lights, &executor);
+
+            char gridName[32];
+            snprintf(gridName, sizeof(gridName), "%ux%ux%u", grid.tilesX, grid.tilesY, grid.slices);
+            printf("%12s %6u | %10.3f %10.3f %12.3f | %12llu %8u\n", gridName, lightCount, scalarMs, avx2Ms, threadedMs,
+                static_cast<unsigned long long>(clusters.GetStats().assignedLights), clusters.GetStats().maxLightsInCluster);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,204 @@
+#include "ClusteredLights.h"
+#include "TestCheck.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace std;
+
+namespace
+{
+    // 바닥 근처에 흩어진 점광원과 아래를 비추는 스포트라이트
+    vector<GpuLight> MakeLights(uint32_t lightCount, uint32_t seed)
+    {
+        mt19937 random(seed);
+        uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+        vector<GpuLight> lights(lightCount);
+        for (GpuLight& light : lights)
+        {
+            light.positionX = (unit(random) - 0.5f) * 50.0f;
+            light.positionY = -1.5f + unit(random) * 2.0f;
+            light.positionZ = 1.0f + unit(random) * 80.0f;
+            light.range = 1.5f + unit(random) * 3.0f;
+            light.colorR = light.colorG = light.colorB = 1.0f;
+            light.type = unit(random) < 0.3f ? LightType::Spot : LightType::Point;
+
+            float angle = unit(random) * 6.28f;
+            light.directionX = 0.3f * cosf(angle);
+            light.directionY = -sqrtf(1.0f - 0.09f);
+            light.directionZ = 0.3f * sinf(angle);
+            light.cosOuterAngle = cosf(0.3f + unit(random) * 0.8f);
+        }
+        return lights;
+    }
+
+    ClusterGridDesc MakeGrid(uint32_t tilesX, uint32_t tilesY, uint32_t slices)
+    {
+        float tanHalfFovY = tanf(0.5236f);
+        return { tilesX, tilesY, slices, 0.1f, 100.0f, tanHalfFovY * 16.0f / 9.0f, tanHalfFovY };
+    }
+
+    // 모든 클러스터에 대해 모든 빛의 구와 AABB를 직접 비교한 결과
+    struct BruteForce
+    {
+        vector<uint32_t> counts;  // 잘리기 전 수
+        vector<uint32_t> indices; // LightClusters와 같은 고정 칸 레이아웃. 잘린 뒤 목록
+        uint64_t assignedLights = 0;
+        uint32_t overflowedClusters = 0;
+    };
+
+    BruteForce AssignBruteForce(const vector<ClusterBounds>& bounds, const vector<GpuLight>& lights, uint32_t maxLightsPerCluster)
+    {
+        BruteForce result;
+        result.counts.assign(bounds.size(), 0);
+        result.indices.assign(bounds.size() * maxLightsPerCluster, 0);
+
+        for (size_t cluster = 0; cluster < bounds.size(); cluster++)
+        {
+            const ClusterBounds& box = bounds[cluster];
+            for (uint32_t i = 0; i < lights.size(); i++)
+            {
+                float x, y, z, radius;
+                LightClusters::ComputeCullSphere(lights[i], x, y, z, radius);
+
+                float dx = max(max(box.minX - x, x - box.maxX), 0.0f);
+                float dy = max(max(box.minY - y, y - box.maxY), 0.0f);
+                float dz = max(max(box.minZ - z, z - box.maxZ), 0.0f);
+                if (dx * dx + dy * dy + dz * dz > radius * radius)
+                    continue;
+
+                uint32_t& count = result.counts[cluster];
+                if (count < maxLightsPerCluster)
+                    result.indices[cluster * maxLightsPerCluster + count] = i;
+                count++;
+            }
+
+            result.assignedLights += result.counts[cluster];
+            result.overflowedClusters += result.counts[cluster] > maxLightsPerCluster ? 1 : 0;
+        }
+        return result;
+    }
+
+    // 개수는 잘린 수로, 목록은 그 개수만큼만 비교한다. 나머지 칸은 쓰레기일 수 있다
+    uint32_t CountMismatchedClusters(const LightClusters& clusters, const BruteForce& expected)
+    {
+        uint32_t maxLights = clusters.GetMaxLightsPerCluster();
+        uint32_t mismatched = 0;
+        for (uint32_t cluster = 0; cluster < clusters.GetClusterCount(); cluster++)
+        {
+            uint32_t count = min(expected.counts[cluster], maxLights);
+            auto actual = clusters.GetLightIndices().begin() + static_cast<size_t>(cluster) * maxLights;
+            auto reference = expected.indices.begin() + static_cast<size_t>(cluster) * maxLights;
+            bool same = clusters.GetLightCounts()[cluster] == count && equal(reference, reference + count, actual);
+            mismatched += same ? 0 : 1;
+        }
+        return mismatched;
+    }
+
+    void CheckAllPaths(const ClusterGridDesc& grid, const vector<GpuLight>& lights, uint32_t maxLightsPerCluster, Executor& executor)
+    {
+        LightClusters clusters;
+        clusters.Build(grid, maxLightsPerCluster);
+        BruteForce expected = AssignBruteForce(clusters.GetBounds(), lights, maxLightsPerCluster);
+
+        ClusterSimdPath paths[] = { ClusterSimdPath::Scalar, ClusterSimdPath::Avx2 };
+        for (ClusterSimdPath path : paths)
+        {
+            clusters.SetSimdPath(path);
+            if (clusters.GetSimdPath() != path)
+            {
+                printf("  AVX2 not supported, skipped\n");
+                continue;
+            }
+
+            for (Executor* assignExecutor : { static_cast<Executor*>(nullptr), &executor })
+            {
+                clusters.Assign(lights.data(), static_cast<uint32_t>(lights.size()), assignExecutor);
+                CHECK(CountMismatchedClusters(clusters, expected) == 0);
+                CHECK(clusters.GetStats().assignedLights == expected.assignedLights);
+                CHECK(clusters.GetStats().overflowedClusters == expected.overflowedClusters);
+                CHECK(clusters.GetStats().maxLightsInCluster == *max_element(expected.counts.begin(), expected.counts.end()));
+            }
+        }
+    }
+}
+
+TEST(AllPathsMatchBruteForce)
+{
+    Executor executor(4);
+    CheckAllPaths(MakeGrid(16, 9, 24), MakeLights(1024, 1), LightClusters::DefaultMaxLightsPerCluster, executor);
+
+    // 8의 배수가 아닌 빛 수. 패딩 구가 어디에도 들어가지 않아야 한다
+    CheckAllPaths(MakeGrid(32, 18, 32), MakeLights(1021, 2), LightClusters::DefaultMaxLightsPerCluster, executor);
+}
+
+TEST(OverflowKeepsFirstLightsInOrder)
+{
+    Executor executor(4);
+    LightClusters clusters;
+    clusters.Build(MakeGrid(8, 6, 12), 16);
+    vector<GpuLight> lights = MakeLights(2000, 3);
+
+    CheckAllPaths(clusters.GetDesc(), lights, 16, executor);
+
+    clusters.Assign(lights.data(), static_cast<uint32_t>(lights.size()));
+    CHECK(clusters.GetStats().overflowedClusters > 0);
+    CHECK(clusters.GetStats().maxLightsInCluster > 16);
+}
+
+TEST(PointLightCenterIsInItsCluster)
+{
+    // 셰이더 쪽 찾기로 빛 중심 픽셀의 클러스터를 구하면 그 빛이 들어 있어야 한다
+    const float width = 1280.0f;
+    const float height = 720.0f;
+    ClusterGridDesc grid = MakeGrid(16, 9, 24);
+    LightClusters clusters;
+    clusters.Build(grid);
+    vector<GpuLight> lights = MakeLights(1024, 4);
+    clusters.Assign(lights.data(), static_cast<uint32_t>(lights.size()));
+
+    uint32_t checkedLights = 0;
+    uint32_t missingLights = 0;
+    for (uint32_t i = 0; i < lights.size(); i++)
+    {
+        const GpuLight& light = lights[i];
+        float ndcX = light.positionX / (light.positionZ * grid.tanHalfFovX);
+        float ndcY = light.positionY / (light.positionZ * grid.tanHalfFovY);
+        if (light.type != LightType::Point || fabsf(ndcX) >= 1.0f || fabsf(ndcY) >= 1.0f)
+            continue;
+
+        uint32_t cluster = clusters.GetClusterIndex((ndcX + 1.0f) * 0.5f * width, (1.0f - ndcY) * 0.5f * height, light.positionZ, width, height);
+        auto begin = clusters.GetLightIndices().begin() + static_cast<size_t>(cluster) * clusters.GetMaxLightsPerCluster();
+        auto end = begin + clusters.GetLightCounts()[cluster];
+        missingLights += find(begin, end, i) != end ? 0 : 1;
+        checkedLights++;
+    }
+
+    CHECK(checkedLights > 100);
+    CHECK(missingLights == 0);
+}
+
+TEST(SliceLookupMatchesBounds)
+{
+    ClusterGridDesc grid = MakeGrid(16, 9, 24);
+    LightClusters clusters;
+    clusters.Build(grid);
+
+    // 슬라이스 AABB의 z 범위 가운데를 찾으면 그 슬라이스가 나와야 한다
+    uint32_t wrongSlices = 0;
+    for (uint32_t slice = 0; slice < grid.slices; slice++)
+    {
+        const ClusterBounds& box = clusters.GetBounds()[static_cast<size_t>(slice) * grid.tilesX * grid.tilesY];
+        wrongSlices += clusters.GetSlice(sqrtf(box.minZ * box.maxZ)) == slice ? 0 : 1;
+    }
+
+    CHECK(wrongSlices == 0);
+    CHECK(clusters.GetSlice(grid.nearZ * 0.5f) == 0);
+    CHECK(clusters.GetSlice(grid.farZ * 2.0f) == grid.slices - 1);
+}
+
+int main()
+{
+    return RunTests();
+}
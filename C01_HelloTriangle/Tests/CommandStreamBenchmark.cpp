@@ -0,0 +1,99 @@
+#include "Benchmark.h"
+#include "CommandStream.h"
+
+using namespace std;
+
+// F8 캡처를 다시 재생하는 비용을 잰다
+//  - record: MyWindow::OnRender와 같은 호출을 FrameGraph::Submit까지 거쳐 CommandStreamWriter에 적는다
+//  - replay: 적은 스트림을 ReplayCommandStream으로 다른 CommandStreamWriter에 넘긴다. GPU가 없으므로 읽고 다시 부르는 비용만 남는다
+// 프레임마다 드로우 수(draws)를 바꿔서 명령이 많을때 명령당 비용이 그대로인지 본다
+
+namespace
+{
+    const uint32_t FrameCounts[] = { 60, 600, 3600 };
+    const uint32_t DrawCounts[] = { 1, 16, 128 };
+
+    // CommandStreamTests의 RecordFrames처럼 compute 패스 하나, 그래픽스 패스 하나에 드로우를 draws번 넣는다
+    void RecordFrames(ICommandBackend& backend, uint32_t frameCount, uint32_t draws)
+    {
+        FrameGraph frameGraph;
+        for (uint32_t frame = 0; frame < frameCount; frame++)
+        {
+            backend.BeginFrame(frame);
+            frameGraph.BeginFrame();
+            frameGraph.AddPass("Particles", QueueType::Compute, {}, { 1 });
+            frameGraph.AddPass("Triangle", QueueType::Graphics, { 1 }, { 2 });
+
+            uint8_t vertices[84];
+            for (uint32_t i = 0; i < sizeof(vertices); i++)
+                vertices[i] = static_cast<uint8_t>(i + frame);
+
+            uint32_t slot = frame % 2;
+            backend.Upload(0, slot * sizeof(vertices), vertices, sizeof(vertices));
+            backend.SetViewport({ 0.0f, 0.0f, 1280.0f, 720.0f, 0.0f, 1.0f });
+            backend.SetScissorRect({ 0, 0, 1280, 720 });
+            backend.ResourceBarrier(3 + slot, 0, 4);
+            backend.SetRenderTarget(3 + slot);
+            const float clearColor[4] = { 0.0f, 0.2f, 0.4f, 1.0f };
+            backend.ClearRenderTarget(3 + slot, clearColor);
+            backend.External("ClusteredLighting");
+            backend.SetPipelineState(1);
+            backend.SetRootSignature(2);
+            backend.SetPrimitiveTopology(4);
+            for (uint32_t draw = 0; draw < draws; draw++)
+            {
+                const uint32_t rootConstants[4] = { 1, slot * 3, draw, 0 };
+                backend.SetRootConstants(0, rootConstants, 4);
+                backend.DrawInstanced(3, 1, 0, 0);
+            }
+            backend.External("DebugDraw");
+            backend.ResourceBarrier(3 + slot, 4, 0);
+
+            frameGraph.Compile();
+            frameGraph.Submit(backend);
+            backend.Present(1);
+            backend.Signal(QueueType::Graphics, frameGraph.ReserveFenceValue(QueueType::Graphics));
+        }
+    }
+}
+
+int main()
+{
+    bool succeeded = true;
+    printf("%6s %6s | %10s %10s | %10s %10s | %10s %12s %10s\n", "frames", "draws", "commands", "stream KB",
+        "record ms", "us/frame", "replay ms", "commands/s", "us/frame");
+
+    for (uint32_t draws : DrawCounts)
+    {
+        for (uint32_t frameCount : FrameCounts)
+        {
+            CommandStreamWriter recorder;
+            double recordMs = MeasureMilliseconds(3, [&]
+            {
+                recorder.Clear();
+                RecordFrames(recorder, frameCount, draws);
+            });
+
+            // 재생 목적지는 버퍼를 남겨두고 비우므로 두 번째부터는 할당하지 않는다
+            const vector<uint8_t>& stream = recorder.GetStream();
+            CommandStreamWriter replayed;
+            CommandReplayStats stats = {};
+            double replayMs = MeasureMilliseconds(5, [&]
+            {
+                replayed.Clear();
+                succeeded = ReplayCommandStream(stream, replayed, &stats) && succeeded;
+            });
+            succeeded = succeeded && replayed.GetStream() == stream && stats.frameCount == frameCount;
+
+            printf("%6u %6u | %10llu %10.1f | %10.3f %10.2f | %10.3f %12.0f %10.2f\n", frameCount, draws,
+                static_cast<unsigned long long>(stats.commandCount), stream.size() / 1024.0,
+                recordMs, recordMs * 1000.0 / frameCount,
+                replayMs, stats.commandCount / (replayMs / 1000.0), replayMs * 1000.0 / frameCount);
+            KeepResult(replayed.GetTotalCommandCount());
+        }
+    }
+
+    if (!succeeded)
+        printf("replayed stream did not match the recording\n");
+    return succeeded ? 0 : 1;
+}
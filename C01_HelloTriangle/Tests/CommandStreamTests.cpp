@@ -0,0 +1,202 @@
+#include "CommandStream.h"
+#include "TestCheck.h"
+#include <filesystem>
+
+using namespace std;
+using namespace std::filesystem;
+
+namespace
+{
+    struct CaptureOptions
+    {
+        uint64_t firstFrame = 0;
+        uint8_t uploadSeed = 0;     // 정점 내용. 캡처마다 달라도 비교에는 안 걸려야 한다
+        uint64_t skippedFenceValues = 0; // 캡처 전에 이미 쓴 타임라인 값
+        bool extraWaits = false;    // GPU가 늦어서 생략되지 않은 wait
+        uint32_t changedFrame = UINT32_MAX; // 이 프레임의 삼각형 드로우만 정점 수를 바꾼다
+    };
+
+    // MyWindow의 한 프레임과 같은 순서로 부른다. 큐 호출은 FrameGraph::Submit이 넣는다
+    void RecordFrames(ICommandBackend& backend, uint32_t frameCount, const CaptureOptions& options)
+    {
+        FrameGraph frameGraph;
+        for (uint64_t i = 0; i < options.skippedFenceValues; i++)
+        {
+            frameGraph.ReserveFenceValue(QueueType::Graphics);
+            frameGraph.ReserveFenceValue(QueueType::Compute);
+        }
+
+        for (uint32_t frame = 0; frame < frameCount; frame++)
+        {
+            backend.BeginFrame(options.firstFrame + frame);
+            frameGraph.BeginFrame();
+            frameGraph.AddPass("Particles", QueueType::Compute, {}, { 1 });
+            frameGraph.AddPass("Triangle", QueueType::Graphics, { 1 }, { 2 });
+
+            uint8_t vertices[84];
+            for (uint32_t i = 0; i < sizeof(vertices); i++)
+                vertices[i] = static_cast<uint8_t>(i + frame + options.uploadSeed);
+
+            uint32_t slot = frame % 2;
+            backend.Upload(0, slot * sizeof(vertices), vertices, sizeof(vertices));
+            backend.SetViewport({ 0.0f, 0.0f, 1280.0f, 720.0f, 0.0f, 1.0f });
+            backend.SetScissorRect({ 0, 0, 1280, 720 });
+            backend.ResourceBarrier(3 + slot, 0, 4);
+            backend.SetRenderTarget(3 + slot);
+            const float clearColor[4] = { 0.0f, 0.2f, 0.4f, 1.0f };
+            backend.ClearRenderTarget(3 + slot, clearColor);
+            backend.External("ClusteredLighting");
+            backend.SetPipelineState(1);
+            backend.SetRootSignature(2);
+            backend.SetPrimitiveTopology(4);
+            const uint32_t rootConstants[4] = { 1, slot * 3, 0, 0 };
+            backend.SetRootConstants(0, rootConstants, 4);
+            backend.DrawInstanced(frame == options.changedFrame ? 6 : 3, 1, 0, 0);
+            backend.External("DebugDraw");
+            backend.ResourceBarrier(3 + slot, 4, 0);
+
+            frameGraph.Compile();
+            frameGraph.Submit(backend);
+            if (options.extraWaits)
+                backend.Wait(QueueType::Graphics, QueueType::Compute, frameGraph.GetStats(QueueType::Compute).lastSignaledValue);
+            backend.Present(1);
+
+            // MyWindow::MoveToNextFrame처럼 프레임 끝 Signal도 FrameGraph 타임라인에서 받는다
+            backend.Signal(QueueType::Graphics, frameGraph.ReserveFenceValue(QueueType::Graphics));
+        }
+    }
+
+    vector<uint8_t> Capture(uint32_t frameCount, const CaptureOptions& options)
+    {
+        CommandStreamWriter writer;
+        RecordFrames(writer, frameCount, options);
+        return writer.GetStream();
+    }
+}
+
+TEST(TeeRecordsWhatPrimaryReceives)
+{
+    CommandStreamWriter primary, recorder;
+    CommandTee tee(primary, recorder);
+    RecordFrames(tee, 30, {});
+
+    CHECK(!recorder.GetStream().empty());
+    CHECK(primary.GetStream() == recorder.GetStream());
+    CHECK(recorder.GetFrameCount() == 30);
+    CHECK(recorder.GetCommandCount(CommandType::DrawInstanced) == 30);
+    CHECK(recorder.GetCommandCount(CommandType::ExecutePass) == 60);
+
+    // Wait/Signal마다 모아둔 패스를 한 번에 제출한다
+    CHECK(recorder.GetSubmissionCount(QueueType::Graphics) == 30);
+    CHECK(recorder.GetSubmissionCount(QueueType::Compute) == 30);
+}
+
+TEST(SaveLoadReplayReproducesStream)
+{
+    vector<uint8_t> stream = Capture(120, {});
+    path capturePath = temp_directory_path() / "command_stream_tests.cmds";
+    CHECK(SaveCommandCapture(capturePath, stream));
+
+    vector<uint8_t> loaded;
+    CHECK(LoadCommandCapture(capturePath, loaded));
+    CHECK(loaded == stream);
+
+    CommandStreamWriter replayed;
+    CommandReplayStats stats = {};
+    CHECK(ReplayCommandStream(loaded, replayed, &stats));
+    CHECK(replayed.GetStream() == stream);
+    CHECK(stats.frameCount == 120);
+    CHECK(stats.commandCount == replayed.GetTotalCommandCount());
+
+    remove(capturePath);
+}
+
+TEST(BrokenStreamsFailToReplay)
+{
+    vector<uint8_t> stream = Capture(4, {});
+    CommandStreamWriter replayed;
+
+    vector<uint8_t> truncated(stream.begin(), stream.end() - 3);
+    CHECK(!ReplayCommandStream(truncated, replayed));
+
+    vector<uint8_t> badType = stream;
+    badType[0] = 200;
+    CHECK(!ReplayCommandStream(badType, replayed));
+
+    // 큐 번호가 범위를 벗어나면 IQueueBackend에 넘기지 않는다
+    CommandStreamWriter writer;
+    writer.Signal(QueueType::Graphics, 1);
+    vector<uint8_t> badQueue = writer.GetStream();
+    badQueue[1] = QueueTypeCount;
+    CHECK(!ReplayCommandStream(badQueue, replayed));
+
+    CommandStreamDiff diff = {};
+    CHECK(!CompareCommandStreams(stream, truncated, diff));
+}
+
+TEST(CompareIgnoresValuesThatChangePerCapture)
+{
+    vector<uint8_t> reference = Capture(60, {});
+
+    // 시작 프레임, 정점 내용, fence 시작 값, 생략되지 않은 wait만 다른 캡처
+    CaptureOptions options;
+    options.firstFrame = 5000;
+    options.uploadSeed = 77;
+    options.skippedFenceValues = 321;
+    options.extraWaits = true;
+    vector<uint8_t> captured = Capture(60, options);
+    CHECK(captured != reference);
+
+    CommandStreamDiff diff = {};
+    CHECK(CompareCommandStreams(reference, captured, diff));
+    CHECK(diff.identical);
+    CHECK(diff.referenceType == CommandType::Count);
+    CHECK(diff.capturedType == CommandType::Count);
+
+    CommandStreamWriter counter;
+    RecordFrames(counter, 60, {});
+    CHECK(diff.commandIndex == counter.GetTotalCommandCount() - counter.GetCommandCount(CommandType::QueueWait));
+}
+
+TEST(CompareFindsFirstChangedCommand)
+{
+    vector<uint8_t> reference = Capture(60, {});
+    CaptureOptions options;
+    options.firstFrame = 99;
+    options.changedFrame = 17;
+    vector<uint8_t> captured = Capture(60, options);
+
+    CommandStreamDiff diff = {};
+    CHECK(CompareCommandStreams(reference, captured, diff));
+    CHECK(!diff.identical);
+    CHECK(diff.referenceType == CommandType::DrawInstanced);
+    CHECK(diff.capturedType == CommandType::DrawInstanced);
+
+    // 17 프레임 앞까지의 명령 수 + 그 프레임에서 드로우 앞의 명령 12개
+    CommandStreamWriter counter;
+    RecordFrames(counter, 17, {});
+    uint64_t commandsBefore = counter.GetTotalCommandCount() - counter.GetCommandCount(CommandType::QueueWait);
+    CHECK(diff.commandIndex == commandsBefore + 12);
+}
+
+TEST(CompareReportsShorterStream)
+{
+    vector<uint8_t> reference = Capture(10, {});
+    vector<uint8_t> captured = Capture(9, {});
+
+    CommandStreamDiff diff = {};
+    CHECK(CompareCommandStreams(reference, captured, diff));
+    CHECK(!diff.identical);
+    CHECK(diff.referenceType == CommandType::BeginFrame);
+    CHECK(diff.capturedType == CommandType::Count);
+
+    CommandStreamWriter counter;
+    RecordFrames(counter, 9, {});
+    CHECK(diff.commandIndex == counter.GetTotalCommandCount() - counter.GetCommandCount(CommandType::QueueWait));
+
+    CHECK(CompareCommandStreams(captured, reference, diff));
+    CHECK(diff.referenceType == CommandType::Count);
+    CHECK(diff.capturedType == CommandType::BeginFrame);
+}
+
+int main() { return RunTests(); }
@@ -0,0 +1,95 @@
+#include "Benchmark.h"
+#include "DebugDraw.h"
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// 한 프레임에 선분 수십만 개를 여러 스레드가 나눠 넣고 Flush하는 비용을 잰다
+//  - append: 스레드를 띄워서 다 넣고 join할 때까지. 스레드 생성 비용도 들어간다
+//  - flush: 스레드 청크를 업로드 메모리에 이어 붙이는 시간
+
+namespace
+{
+    const int Repeats = 5;
+
+    struct Result
+    {
+        double appendMs;
+        double flushMs;
+    };
+
+    Result Measure(DebugDraw& debugDraw, NullDebugDrawBackend& backend, uint32_t segmentCount, uint32_t threadCount)
+    {
+        Result result = {};
+        uint32_t perThread = segmentCount / threadCount;
+
+        // 두 측정이 같은 프레임을 보도록 append와 flush를 한 번에 돌리고 따로 최소값을 고른다
+        for (int repeat = 0; repeat <= Repeats; repeat++)
+        {
+            auto start = chrono::steady_clock::now();
+            vector<thread> writers;
+            for (uint32_t t = 0; t < threadCount; t++)
+            {
+                writers.emplace_back([&debugDraw, perThread, t]
+                {
+                    float minCorner[3] = { 0.0f, 0.0f, 0.0f };
+                    for (uint32_t i = 0; i < perThread; i++)
+                    {
+                        float x = static_cast<float>(i);
+                        if (i % 64 == 0)
+                        {
+                            float maxCorner[3] = { x, x, x };
+                            debugDraw.AddBox(minCorner, maxCorner, 0xFF00FF00);
+                        }
+                        else
+                        {
+                            debugDraw.AddLine(x, static_cast<float>(t), 0.0f, x + 1.0f, static_cast<float>(t), 0.0f, 0xFFFFFFFF, (i & 1) ? DebugDepth::Tested : DebugDepth::Overlay);
+                        }
+                    }
+                });
+            }
+            for (thread& writer : writers)
+                writer.join();
+            auto appended = chrono::steady_clock::now();
+
+            backend.BeginFrame();
+            debugDraw.Flush(backend);
+            auto flushed = chrono::steady_clock::now();
+
+            // 처음 한 번은 청크가 커지는 프레임이라 버린다
+            if (repeat == 0)
+                continue;
+
+            double appendMs = chrono::duration<double, milli>(appended - start).count();
+            double flushMs = chrono::duration<double, milli>(flushed - appended).count();
+            result.appendMs = (repeat == 1 || appendMs < result.appendMs) ? appendMs : result.appendMs;
+            result.flushMs = (repeat == 1 || flushMs < result.flushMs) ? flushMs : result.flushMs;
+        }
+
+        KeepResult(debugDraw.GetStats().vertexCounts[0]);
+        return result;
+    }
+}
+
+int main()
+{
+    printf("%u hardware threads\n", thread::hardware_concurrency());
+    printf("%10s %8s | %10s %10s %12s %10s\n", "segments", "threads", "append ms", "flush ms", "vertices", "MB");
+
+    NullDebugDrawBackend backend(512ull * 1024 * 1024);
+    for (uint32_t segmentCount : { 100000u, 400000u, 1000000u })
+    {
+        for (uint32_t threadCount : { 1u, 2u, 4u, 8u })
+        {
+            DebugDraw debugDraw;
+            Result result = Measure(debugDraw, backend, segmentCount, threadCount);
+
+            const DebugDrawStats& stats = debugDraw.GetStats();
+            uint32_t vertexCount = stats.vertexCounts[0] + stats.vertexCounts[1];
+            printf("%10u %8u | %10.3f %10.3f %12u %10.1f\n", segmentCount, threadCount, result.appendMs, result.flushMs,
+                vertexCount, backend.GetUploadedBytes() / (1024.0 * 1024.0));
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,146 @@
+#include "DebugDraw.h"
+#include "TestCheck.h"
+#include <thread>
+
+using namespace std;
+
+namespace
+{
+    const uint32_t WriterThreads = 8;
+
+    // 선 하나에 (스레드, 순번)을 적어둔다. Flush가 이어 붙인 결과에서 빠지거나 겹친 선을 찾는다
+    void AddNumberedLines(DebugDraw& debugDraw, uint32_t thread, uint32_t lineCount)
+    {
+        for (uint32_t i = 0; i < lineCount; i++)
+        {
+            DebugDepth depth = (i % 3 == 0) ? DebugDepth::Overlay : DebugDepth::Tested;
+            debugDraw.AddLine(static_cast<float>(thread), static_cast<float>(i), 0.0f, static_cast<float>(thread), static_cast<float>(i), 1.0f, thread, depth);
+        }
+    }
+
+    // 스트림 안에서 스레드마다 순번이 빠짐없이 차례로 나오는지 본다
+    bool CheckNumberedLines(const NullDebugDrawBackend& backend, DebugDrawStream stream, uint32_t lineCount)
+    {
+        const DebugLineVertex* vertices = static_cast<const DebugLineVertex*>(backend.GetStreamData(stream));
+        uint32_t vertexCount = backend.GetStreamVertexCount(stream);
+        if (!vertices || vertexCount % 2 != 0)
+            return false;
+
+        vector<uint32_t> nextIndex(WriterThreads, 0);
+        for (uint32_t v = 0; v < vertexCount; v += 2)
+        {
+            uint32_t thread = vertices[v].color;
+            if (thread >= WriterThreads || vertices[v + 1].color != thread || vertices[v].z != 0.0f || vertices[v + 1].z != 1.0f)
+                return false;
+
+            // 이 스트림으로 들어간 다음 순번을 찾는다
+            uint32_t& index = nextIndex[thread];
+            while (index < lineCount && ((index % 3 == 0) != (stream == DebugDrawStream::OverlayLines)))
+                index++;
+            if (vertices[v].y != static_cast<float>(index))
+                return false;
+            index++;
+        }
+
+        for (uint32_t thread = 0; thread < WriterThreads; thread++)
+        {
+            uint32_t& index = nextIndex[thread];
+            while (index < lineCount && ((index % 3 == 0) != (stream == DebugDrawStream::OverlayLines)))
+                index++;
+            if (index != lineCount)
+                return false;
+        }
+        return true;
+    }
+}
+
+TEST(ThreadsAppendWithoutLosingLines)
+{
+    const uint32_t lineCount = 30000;
+    DebugDraw debugDraw;
+    NullDebugDrawBackend backend(64 * 1024 * 1024);
+
+    // 프레임마다 새 스레드를 띄운다. 끝난 스레드의 청크를 물려받아도 지난 프레임 선이 섞이지 않아야 한다
+    uint32_t badFrames = 0;
+    for (uint32_t frame = 0; frame < 4; frame++)
+    {
+        vector<thread> writers;
+        for (uint32_t t = 0; t < WriterThreads; t++)
+            writers.emplace_back([&debugDraw, t] { AddNumberedLines(debugDraw, t, lineCount); });
+        for (thread& writer : writers)
+            writer.join();
+
+        backend.BeginFrame();
+        debugDraw.Flush(backend);
+
+        const DebugDrawStats& stats = debugDraw.GetStats();
+        bool good = stats.drawCount == 2 && stats.droppedVertices == 0;
+        good = good && stats.vertexCounts[0] + stats.vertexCounts[1] == WriterThreads * lineCount * 2;
+        good = good && CheckNumberedLines(backend, DebugDrawStream::DepthLines, lineCount);
+        good = good && CheckNumberedLines(backend, DebugDrawStream::OverlayLines, lineCount);
+        badFrames += good ? 0 : 1;
+    }
+
+    CHECK(badFrames == 0);
+    CHECK(backend.GetDrawCount() == 8);
+}
+
+TEST(PerThreadLimitDropsExtraVertices)
+{
+    DebugDraw debugDraw(100);
+    NullDebugDrawBackend backend(1024 * 1024);
+
+    AddNumberedLines(debugDraw, 0, 80); // Overlay 27개, Tested 53개 중 50개(100 버텍스)까지만 들어간다
+    debugDraw.Flush(backend);
+
+    const DebugDrawStats& stats = debugDraw.GetStats();
+    CHECK(stats.vertexCounts[static_cast<uint32_t>(DebugDrawStream::DepthLines)] == 100);
+    CHECK(stats.vertexCounts[static_cast<uint32_t>(DebugDrawStream::OverlayLines)] == 54);
+    CHECK(stats.droppedVertices == 6);
+}
+
+TEST(SmallUploadDropsStreamAndRecovers)
+{
+    DebugDraw debugDraw;
+    NullDebugDrawBackend backend(1000 * sizeof(DebugLineVertex));
+
+    for (uint32_t i = 0; i < 600; i++)
+        debugDraw.AddLine(0, 0, 0, 1, 1, 1, 0xFFFFFFFF);
+    debugDraw.Flush(backend);
+    CHECK(debugDraw.GetStats().drawCount == 0);
+    CHECK(debugDraw.GetStats().droppedVertices == 1200);
+
+    // 버린 선은 청크에 남지 않고, 버린 수도 다른 통계처럼 Flush마다 새로 센다
+    backend.BeginFrame();
+    debugDraw.AddLine(0, 0, 0, 1, 1, 1, 0xFFFFFFFF);
+    debugDraw.Flush(backend);
+    CHECK(debugDraw.GetStats().drawCount == 1);
+    CHECK(debugDraw.GetStats().droppedVertices == 0);
+    CHECK(backend.GetStreamVertexCount(DebugDrawStream::DepthLines) == 2);
+}
+
+TEST(TextBuildsSixVerticesPerGlyph)
+{
+    DebugDraw debugDraw;
+    NullDebugDrawBackend backend(1024 * 1024);
+
+    // 공백과 줄바꿈은 버텍스를 만들지 않고, 아틀라스에 없는 글자는 '?'로 그린다
+    debugDraw.AddText(10.0f, 20.0f, "ab c\n\x01", 0xFFFFFFFF, 2.0f);
+    debugDraw.Flush(backend);
+
+    const DebugTextVertex* vertices = static_cast<const DebugTextVertex*>(backend.GetStreamData(DebugDrawStream::Text));
+    CHECK(backend.GetStreamVertexCount(DebugDrawStream::Text) == 4 * 6);
+    CHECK(vertices[0].x == 10.0f && vertices[0].y == 20.0f);
+    CHECK(vertices[12].x == 10.0f + 3 * DebugDraw::GlyphWidth * 2.0f);
+
+    // 둘째 줄 '?'
+    uint32_t glyph = '?' - DebugDraw::FirstGlyph;
+    CHECK(vertices[18].y == 20.0f + DebugDraw::GlyphHeight * 2.0f);
+    CHECK(vertices[18].u == static_cast<float>((glyph % DebugDraw::AtlasColumns) * DebugDraw::GlyphWidth));
+    CHECK(vertices[18].v == static_cast<float>((glyph / DebugDraw::AtlasColumns) * DebugDraw::GlyphHeight));
+}
+
+int main()
+{
+    return RunTests();
+}
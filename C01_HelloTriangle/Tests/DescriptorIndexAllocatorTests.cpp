@@ -0,0 +1,97 @@
+#include "DescriptorIndexAllocator.h"
+#include "TestCheck.h"
+#include <algorithm>
+
+using namespace std;
+
+TEST(AllocatesUntilCapacity)
+{
+    DescriptorIndexAllocator allocator(4);
+    for (uint32_t i = 0; i < 4; i++)
+        CHECK(allocator.Allocate() == i);
+
+    CHECK(allocator.Allocate() == DescriptorIndexAllocator::InvalidIndex);
+    CHECK(allocator.GetAllocatedCount() == 4);
+}
+
+TEST(FreedIndexWaitsForFence)
+{
+    DescriptorIndexAllocator allocator(2);
+    uint32_t first = allocator.Allocate();
+    allocator.Allocate();
+
+    allocator.Free(first, 5);
+    CHECK(allocator.GetAllocatedCount() == 1);
+
+    // fence가 5에 닿기 전에는 돌려주지 않는다
+    allocator.Reclaim(4);
+    CHECK(allocator.Allocate() == DescriptorIndexAllocator::InvalidIndex);
+
+    allocator.Reclaim(5);
+    CHECK(allocator.Allocate() == first);
+}
+
+TEST(OutOfOrderFreeIsReclaimedByFence)
+{
+    DescriptorIndexAllocator allocator(3);
+    uint32_t a = allocator.Allocate();
+    uint32_t b = allocator.Allocate();
+    uint32_t c = allocator.Allocate();
+
+    // 큰 값이 먼저 들어와도 작은 값의 인덱스는 그 값에서 돌아와야 하고, 큰 값의 인덱스는 먼저 돌아오면 안 된다
+    allocator.Free(a, 10);
+    allocator.Free(b, 3);
+    allocator.Free(c, 7);
+
+    allocator.Reclaim(3);
+    CHECK(allocator.Allocate() == b);
+    CHECK(allocator.Allocate() == DescriptorIndexAllocator::InvalidIndex);
+
+    allocator.Reclaim(7);
+    CHECK(allocator.Allocate() == c);
+    CHECK(allocator.Allocate() == DescriptorIndexAllocator::InvalidIndex);
+
+    allocator.Reclaim(10);
+    CHECK(allocator.Allocate() == a);
+}
+
+TEST(PerFrameChurnStaysWithinCapacity)
+{
+    // 프레임마다 일부 인덱스를 바꾸고 FrameCount 프레임 늦게 Reclaim해도 용량이 늘지 않아야 한다
+    const uint32_t frameCount = 2;
+    const uint32_t liveCount = 256;
+    const uint32_t churn = 16;
+    DescriptorIndexAllocator allocator(liveCount + churn * (frameCount + 1));
+
+    vector<uint32_t> live;
+    for (uint32_t i = 0; i < liveCount; i++)
+        live.push_back(allocator.Allocate());
+
+    bool exhausted = false;
+    for (uint64_t fenceValue = 1; fenceValue <= 1000; fenceValue++)
+    {
+        if (fenceValue > frameCount)
+            allocator.Reclaim(fenceValue - frameCount);
+
+        for (uint32_t i = 0; i < churn; i++)
+        {
+            uint32_t& index = live[(fenceValue * churn + i) % liveCount];
+            uint32_t newIndex = allocator.Allocate();
+            exhausted = exhausted || newIndex == DescriptorIndexAllocator::InvalidIndex;
+            allocator.Free(index, fenceValue);
+            index = newIndex;
+        }
+    }
+
+    CHECK(!exhausted);
+    CHECK(allocator.GetAllocatedCount() == liveCount);
+
+    // 살아있는 인덱스끼리 겹치지 않는다
+    sort(live.begin(), live.end());
+    CHECK(adjacent_find(live.begin(), live.end()) == live.end());
+}
+
+int main()
+{
+    return RunTests();
+}
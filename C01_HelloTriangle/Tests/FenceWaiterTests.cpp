@@ -0,0 +1,190 @@
+#include "Executor.h"
+#include "FenceWaiter.h"
+#include "Task.h"
+#include "TestCheck.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+using namespace std;
+
+namespace
+{
+    // GPU fence 대신 CPU에서 값을 올리는 fence. 등록된 값에 닿으면 WakeEvent를 Set한다
+    class SimulatedFence : public IWaitableFence
+    {
+        mutex waitMutex;
+        atomic<uint64_t> completedValue{ 0 };
+        vector<pair<uint64_t, WakeEvent*>> wakes;
+
+    public:
+        uint64_t GetCompletedValue() override
+        {
+            return completedValue;
+        }
+
+        bool SetWakeOnCompletion(uint64_t value, WakeEvent& wakeEvent) override
+        {
+            lock_guard<mutex> lock(waitMutex);
+            if (value <= completedValue)
+                wakeEvent.Set();
+            else
+                wakes.push_back({ value, &wakeEvent });
+            return true;
+        }
+
+        void Signal(uint64_t value)
+        {
+            lock_guard<mutex> lock(waitMutex);
+            completedValue = value;
+            for (size_t i = 0; i < wakes.size();)
+            {
+                if (wakes[i].first <= value)
+                {
+                    wakes[i].second->Set();
+                    wakes[i] = wakes.back();
+                    wakes.pop_back();
+                }
+                else
+                {
+                    i++;
+                }
+            }
+        }
+    };
+
+    // 코루틴 프레임이 없어질때 같이 줄어드는 카운터
+    struct FrameCounter
+    {
+        atomic<int>& liveFrames;
+
+        explicit FrameCounter(atomic<int>& liveFrames) : liveFrames(liveFrames) { liveFrames++; }
+        ~FrameCounter() { liveFrames--; }
+    };
+
+    Task<bool> WaitOnFence(Executor& executor, FenceWaiter& fenceWaiter, SimulatedFence& fence, uint64_t value)
+    {
+        co_await executor.Schedule();
+        bool reached = co_await fenceWaiter.Wait(&fence, value);
+        co_return reached && fence.GetCompletedValue() >= value;
+    }
+
+    Task<int> WaitOnMany(Executor& executor, FenceWaiter& fenceWaiter, SimulatedFence& fence, int count)
+    {
+        vector<Task<bool>> tasks;
+        for (int i = 0; i < count; i++)
+            tasks.push_back(WaitOnFence(executor, fenceWaiter, fence, 1 + i % 100));
+
+        vector<bool> results = co_await WhenAll(std::move(tasks));
+        int reachedCount = 0;
+        for (bool reached : results)
+            reachedCount += reached ? 1 : 0;
+        co_return reachedCount;
+    }
+
+    // 결과는 결과 변수로 돌려준다. FenceWaiter가 먼저 없어지는 경우를 보려고 Task로 감싸지 않는다
+    detail::DetachedTask WaitDetached(FenceWaiter& fenceWaiter, SimulatedFence& fence, uint64_t value, atomic<int>& liveFrames, atomic<int>& failedCount)
+    {
+        FrameCounter counter(liveFrames);
+        if (!co_await fenceWaiter.Wait(&fence, value))
+            failedCount++;
+    }
+}
+
+TEST(WaitsResumeWhenFenceAdvances)
+{
+    Executor executor(4);
+    FenceWaiter fenceWaiter(executor);
+    SimulatedFence fence;
+
+    thread signaler([&fence]
+    {
+        for (uint64_t value = 1; value <= 100; value++)
+        {
+            this_thread::sleep_for(chrono::microseconds(100));
+            fence.Signal(value);
+        }
+    });
+
+    int reachedCount = SyncWait(WaitOnMany(executor, fenceWaiter, fence, 5000));
+    signaler.join();
+
+    CHECK(reachedCount == 5000);
+    CHECK(fenceWaiter.GetPendingCount() == 0);
+}
+
+TEST(CompletedValueDoesNotSuspend)
+{
+    Executor executor(1);
+    FenceWaiter fenceWaiter(executor);
+    SimulatedFence fence;
+    fence.Signal(10);
+
+    FenceWaiter::Awaiter awaiter = fenceWaiter.Wait(&fence, 10);
+    CHECK(awaiter.await_ready());
+    CHECK(awaiter.await_resume());
+}
+
+TEST(FailedAwaiterCompletesImmediately)
+{
+    Executor executor(1);
+    FenceWaiter fenceWaiter(executor);
+
+    // GpuQueues::SignalAsync가 Signal에 실패하면 돌려주는 awaiter
+    FenceWaiter::Awaiter awaiter = fenceWaiter.Failed();
+    CHECK(awaiter.await_ready());
+    CHECK(!awaiter.await_resume());
+
+    auto waitFailed = [&fenceWaiter]() -> Task<bool> { co_return co_await fenceWaiter.Failed(); };
+    CHECK(!SyncWait(waitFailed()));
+    CHECK(fenceWaiter.GetPendingCount() == 0);
+}
+
+TEST(DestructorResumesPendingWaits)
+{
+    atomic<int> liveFrames{ 0 };
+    atomic<int> failedCount{ 0 };
+    SimulatedFence fence;
+    {
+        Executor executor(2);
+        {
+            FenceWaiter fenceWaiter(executor);
+            for (int i = 0; i < 64; i++)
+                WaitDetached(fenceWaiter, fence, 1 + i % 2, liveFrames, failedCount);
+
+            // 절반만 fence에 닿게 하고 나머지는 기다리는 채로 FenceWaiter를 없앤다
+            fence.Signal(1);
+            while (fenceWaiter.GetPendingCount() > 32)
+                this_thread::sleep_for(chrono::microseconds(100));
+
+            CHECK(fenceWaiter.GetPendingCount() == 32);
+        }
+        // executor가 없어지면서 넘겨받은 코루틴을 다 실행한다
+    }
+
+    CHECK(failedCount == 32);
+    CHECK(liveFrames == 0);
+}
+
+TEST(StopWithReadyWaitsDoesNotHang)
+{
+    // 깨어난 순간에 이미 stopping이면 남은 코루틴을 넘기고 바로 끝나야 한다
+    for (int round = 0; round < 200; round++)
+    {
+        atomic<int> liveFrames{ 0 };
+        atomic<int> failedCount{ 0 };
+        SimulatedFence fence;
+        {
+            Executor executor(2);
+            FenceWaiter fenceWaiter(executor);
+            WaitDetached(fenceWaiter, fence, 1, liveFrames, failedCount);
+            fence.Signal(1);
+        }
+        CHECK(liveFrames == 0);
+    }
+}
+
+int main()
+{
+    return RunTests();
+}
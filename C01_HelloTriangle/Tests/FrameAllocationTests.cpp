@@ -0,0 +1,281 @@
+#include "AllocationTracker.h"
+#include "ClusteredLights.h"
+#include "DebugDraw.h"
+#include "FrameGraph.h"
+#include "LodSelector.h"
+#include "OcclusionCuller.h"
+#include "ParticleSimulation.h"
+#include "ShadowCache.h"
+#include "TestCheck.h"
+#include <cmath>
+#include <random>
+
+using namespace std;
+
+// AllocationTracker.cpp를 같이 링크해서 전역 operator new를 센다
+// MyWindow가 OnUpdate부터 OnRender 끝까지 매 프레임 하는 CPU 작업을 D3D12 없이 돌리고,
+// 워밍업이 끝난 뒤에는 워커 스레드까지 포함해서 힙 할당이 하나도 없어야 한다
+namespace
+{
+    const uint32_t WarmupFrames = 32;
+    const uint32_t MeasuredFrames = 64;
+
+    // 워밍업 뒤 measured 프레임 동안 모든 스레드에서 일어난 할당 수
+    template<typename Frame>
+    uint64_t CountSteadyAllocations(Frame&& frame)
+    {
+        uint32_t frameIndex = 0;
+        for (; frameIndex < WarmupFrames; frameIndex++)
+            frame(frameIndex);
+
+        uint64_t startCount = GetHeapAllocationCount();
+        for (; frameIndex < WarmupFrames + MeasuredFrames; frameIndex++)
+            frame(frameIndex);
+        return GetHeapAllocationCount() - startCount;
+    }
+
+    void Report(const char* name, uint64_t allocations)
+    {
+        printf("  %s: %llu allocations in %u frames\n", name, static_cast<unsigned long long>(allocations), MeasuredFrames);
+    }
+
+    // MyWindow처럼 바닥 근처를 도는 빛들
+    void MoveLights(vector<GpuLight>& lights, uint32_t frameIndex)
+    {
+        for (uint32_t i = 0; i < lights.size(); i++)
+        {
+            float angle = frameIndex * 0.02f + i * 0.37f;
+            GpuLight& light = lights[i];
+            light.positionX = cosf(angle) * (5.0f + (i % 17) * 1.5f);
+            light.positionY = -1.0f + (i % 5) * 0.4f;
+            light.positionZ = 20.0f + sinf(angle) * (5.0f + (i % 13) * 2.0f);
+            light.range = 2.0f + (i % 7) * 0.5f;
+            light.colorR = light.colorG = light.colorB = 1.0f;
+            light.type = i % 3 == 0 ? LightType::Spot : LightType::Point;
+            light.directionX = 0.0f;
+            light.directionY = -1.0f;
+            light.directionZ = 0.0f;
+            light.cosOuterAngle = 0.8f;
+        }
+    }
+
+    // 제출하자마자 끝나는 큐
+    class ImmediateQueues : public IQueueBackend
+    {
+        uint64_t completedValues[QueueTypeCount] = {};
+
+    public:
+        bool ExecutePass(QueueType /*queue*/, uint32_t /*passIndex*/) override { return true; }
+        bool Wait(QueueType /*queue*/, QueueType /*signalQueue*/, uint64_t /*value*/) override { return true; }
+
+        bool Signal(QueueType queue, uint64_t value) override
+        {
+            completedValues[static_cast<uint32_t>(queue)] = value;
+            return true;
+        }
+
+        uint64_t GetCompletedValue(QueueType queue) override { return completedValues[static_cast<uint32_t>(queue)]; }
+    };
+}
+
+TEST(ClusteredLightsAssignDoesNotAllocate)
+{
+    Executor executor(4);
+    LightClusters clusters;
+    float tanHalfFovY = tanf(0.5236f);
+    clusters.Build({ 16, 9, 24, 0.1f, 100.0f, tanHalfFovY * 16.0f / 9.0f, tanHalfFovY });
+
+    vector<GpuLight> lights(1024);
+    uint64_t allocations = CountSteadyAllocations([&](uint32_t frameIndex)
+    {
+        MoveLights(lights, frameIndex);
+        clusters.Assign(lights.data(), static_cast<uint32_t>(lights.size()), &executor);
+    });
+
+    Report("LightClusters::Assign", allocations);
+    CHECK(allocations == 0);
+}
+
+TEST(LodSelectDoesNotAllocate)
+{
+    Executor executor(4);
+    MeshAsset asset = {};
+    asset.boundsRadius = 1.0f;
+    for (uint32_t lod = 0; lod < 6; lod++)
+        asset.lods.push_back({ 0, 0, lod * 0.004f });
+
+    LodSelector selector;
+    selector.SetMesh(asset);
+
+    mt19937 random(1);
+    uniform_real_distribution<float> position(-500.0f, 500.0f);
+    LodInstances instances;
+    instances.Resize(50000);
+    for (uint32_t i = 0; i < instances.GetCount(); i++)
+    {
+        instances.x[i] = position(random);
+        instances.y[i] = 0.0f;
+        instances.z[i] = position(random);
+        instances.scale[i] = 1.0f;
+    }
+
+    vector<uint8_t> lods(instances.GetCount(), 0);
+    uint64_t allocations = CountSteadyAllocations([&](uint32_t frameIndex)
+    {
+        LodCamera camera = { frameIndex * 2.0f, 2.0f, 0.0f, 720.0f / (2.0f * 0.57735027f), 1.0f, 0.1f };
+        selector.Select(instances, camera, lods.data(), &executor);
+    });
+
+    Report("LodSelector::Select", allocations);
+    CHECK(allocations == 0);
+}
+
+TEST(OcclusionCullingDoesNotAllocate)
+{
+    static const float BoxPositions[24] = { 0, 0, 0, 1, 0, 0, 0, 1, 0, 1, 1, 0, 0, 0, 1, 1, 0, 1, 0, 1, 1, 1, 1, 1 };
+    static const uint32_t BoxIndices[36] =
+    {
+        2, 3, 1, 2, 1, 0,
+        7, 6, 4, 7, 4, 5,
+        6, 2, 0, 6, 0, 4,
+        3, 7, 5, 3, 5, 1,
+        6, 7, 3, 6, 3, 2,
+        0, 1, 5, 0, 5, 4,
+    };
+
+    Executor executor(4);
+    OcclusionCuller culler;
+    OcclusionCamera camera = { 0.1f, 0.57735027f * OcclusionCuller::DefaultWidth / OcclusionCuller::DefaultHeight, 0.57735027f };
+
+    mt19937 random(2);
+    uniform_real_distribution<float> unit(0.0f, 1.0f);
+    OcclusionBounds bounds;
+    bounds.Resize(20000);
+    for (uint32_t i = 0; i < bounds.GetCount(); i++)
+    {
+        float minCorner[3] = { (unit(random) - 0.5f) * 60.0f, (unit(random) - 0.5f) * 24.0f, 0.05f + unit(random) * 60.0f };
+        float maxCorner[3] = { minCorner[0] + 1.0f, minCorner[1] + 1.0f, minCorner[2] + 1.0f };
+        bounds.Set(i, minCorner, maxCorner);
+    }
+
+    vector<uint8_t> visible(bounds.GetCount(), 0);
+    uint64_t allocations = CountSteadyAllocations([&](uint32_t frameIndex)
+    {
+        culler.BeginFrame(camera);
+        for (uint32_t i = 0; i < 64; i++)
+        {
+            float x = (static_cast<float>(i % 8) - 4.0f) * 4.0f + sinf(frameIndex * 0.05f);
+            float y = (static_cast<float>(i / 8) - 4.0f) * 2.0f;
+            const float transform[12] = { 2.0f, 0, 0, x, 0, 1.5f, 0, y, 0, 0, 0.5f, 10.0f + (i % 5) * 3.0f };
+            culler.AddOccluder(BoxPositions, 8, BoxIndices, 36, transform);
+        }
+        culler.Render(&executor);
+        culler.TestBounds(bounds, visible.data(), &executor);
+    });
+
+    Report("OcclusionCuller::Render/TestBounds", allocations);
+    CHECK(allocations == 0);
+}
+
+TEST(ParticleUpdateDoesNotAllocate)
+{
+    ParticleSimulation simulation;
+    simulation.Reset(65536, 7);
+
+    uint64_t allocations = CountSteadyAllocations([&](uint32_t frameIndex)
+    {
+        simulation.Update(1.0f / 60.0f, 500 + (frameIndex % 7) * 100);
+    });
+
+    Report("ParticleSimulation::Update", allocations);
+    CHECK(allocations == 0);
+}
+
+TEST(DebugDrawFlushDoesNotAllocate)
+{
+    DebugDraw debugDraw;
+    NullDebugDrawBackend backend(16 * 1024 * 1024);
+
+    uint64_t allocations = CountSteadyAllocations([&](uint32_t frameIndex)
+    {
+        backend.BeginFrame();
+        const float minCorner[3] = { -1.0f, 0.0f, -1.0f };
+        const float maxCorner[3] = { 1.0f, static_cast<float>(frameIndex % 3), 1.0f };
+        debugDraw.AddBox(minCorner, maxCorner, DebugDraw::MakeColor(1.0f, 1.0f, 0.0f));
+        for (uint32_t i = 0; i < 256; i++)
+            debugDraw.AddLine(0.0f, 0.0f, 0.0f, static_cast<float>(i), 1.0f, 0.0f, DebugDraw::MakeColor(0.0f, 1.0f, 0.0f), DebugDepth::Overlay);
+        debugDraw.AddText(8.0f, 8.0f, "frame status line", DebugDraw::MakeColor(1.0f, 1.0f, 1.0f));
+        debugDraw.Flush(backend);
+    });
+
+    Report("DebugDraw::Flush", allocations);
+    CHECK(allocations == 0);
+}
+
+TEST(FrameGraphDoesNotAllocate)
+{
+    // MyWindow와 같은 패스 구성을 프레임 arena 위에서 만든다
+    enum : ResourceId { BackBufferResource, ParticleResource, LightClusterResource = ParticleResource + 2 };
+
+    FrameArenas frameArenas(3);
+    FrameGraph frameGraph;
+    ImmediateQueues queues;
+
+    uint64_t allocations = CountSteadyAllocations([&](uint32_t frameIndex)
+    {
+        LinearArena* frameArena = frameArenas.BeginFrame(queues.GetCompletedValue(QueueType::Graphics));
+        frameGraph.BeginFrame(frameArena);
+
+        ResourceId particleResult = ParticleResource + frameIndex % 2;
+        frameGraph.AddPass("Particles", QueueType::Compute, { ParticleResource + 1 - frameIndex % 2 }, { particleResult });
+        frameGraph.AddPass("LightCulling", QueueType::Compute, {}, { LightClusterResource });
+        frameGraph.AddPass("Triangle", QueueType::Graphics, { particleResult, LightClusterResource }, { BackBufferResource });
+        frameGraph.AddPass("Surface", QueueType::Graphics, {}, { BackBufferResource + 100 });
+
+        frameGraph.Compile();
+        frameGraph.Submit(queues);
+        frameArenas.EndFrame(frameGraph.GetStats(QueueType::Graphics).lastSignaledValue);
+    });
+
+    Report("FrameGraph", allocations);
+    CHECK(allocations == 0);
+}
+
+TEST(ShadowCacheUpdateDoesNotAllocate)
+{
+    ShadowCacheDesc desc = { 3, { 8.0f, 24.0f, 64.0f }, 8, 16 };
+    ShadowCache cache(desc);
+
+    mt19937 random(3);
+    uniform_real_distribution<float> position(-60.0f, 60.0f);
+    vector<ShadowCasterBounds> statics;
+    for (uint32_t i = 0; i < 300; i++)
+    {
+        float x = position(random), z = position(random);
+        statics.push_back({ { x, 0.0f, z }, { x + 1.0f, 2.0f, z + 1.0f } });
+        cache.AddStaticCaster(statics.back());
+    }
+
+    const float lightDirection[3] = { 0.3f, -1.0f, 0.2f };
+    cache.SetLightDirection(lightDirection);
+
+    ShadowCasterBounds dynamicCasters[4] = {};
+    uint64_t allocations = CountSteadyAllocations([&](uint32_t frameIndex)
+    {
+        float camera[3] = { frameIndex * 0.37f, 1.0f, frameIndex * 0.11f };
+        for (uint32_t i = 0; i < 4; i++)
+            dynamicCasters[i] = { { camera[0] + i, 0.0f, camera[2] + 3.0f }, { camera[0] + i + 1.0f, 1.0f, camera[2] + 4.0f } };
+
+        uint32_t moved = frameIndex % static_cast<uint32_t>(statics.size());
+        statics[moved].minCorner[0] += 0.3f;
+        statics[moved].maxCorner[0] += 0.3f;
+        cache.MoveStaticCaster(moved, statics[moved]);
+
+        cache.Update(camera, dynamicCasters, 4);
+    });
+
+    Report("ShadowCache::Update", allocations);
+    CHECK(allocations == 0);
+}
+
+int main() { return RunTests(); }
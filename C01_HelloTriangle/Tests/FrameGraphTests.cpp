@@ -0,0 +1,338 @@
+#include "FrameGraph.h"
+#include "TestCheck.h"
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+
+using namespace std;
+
+namespace
+{
+    // MyWindow의 프레임 구성을 흉내낸다. 시간 단위는 ms
+    const uint32_t FrameCount = 2;
+    const double CpuFrameTime = 1.0;
+    const double ParticlesTime = 2.0;
+    const double LightCullingTime = 1.0;
+    const double TriangleTime = 6.0;
+
+    enum ResourceIds : ResourceId
+    {
+        BackBufferResource,
+        ParticleResource,
+        LightClusterResource = ParticleResource + 2,
+    };
+
+    uint32_t ToIndex(QueueType queue)
+    {
+        return static_cast<uint32_t>(queue);
+    }
+
+    // 큐마다 GPU 시간축을 따로 두고 패스 길이만큼 시간을 보내는 가짜 큐 모델
+    // 제출은 CPU 시간(cpuTime)보다 먼저 시작할 수 없고, Wait는 상대 큐의 signal 시각까지 큐를 멈춘다
+    class SimulatedQueues : public IQueueBackend
+    {
+    public:
+        struct PassRun
+        {
+            uint64_t frame;
+            uint32_t passIndex;
+            QueueType queue;
+            double start;
+            double end;
+        };
+
+        struct Signaled
+        {
+            uint64_t value;
+            double time;
+        };
+
+        const FrameGraph& frameGraph;
+        unordered_map<string, double> durations;
+        double cpuTime = 0.0;
+        double queueTimes[QueueTypeCount] = {};
+        vector<Signaled> signals[QueueTypeCount];
+        vector<PassRun> runs;
+        uint64_t currentFrame = 0;
+        bool ignoreWaits = false;     // 검증기가 실제로 위반을 잡는지 보려고 wait를 무시할 수 있다
+        bool waitedUnsignaled = false; // 아직 제출되지 않은 값을 기다리면 실제 GPU에서는 멈춘다
+
+        explicit SimulatedQueues(const FrameGraph& frameGraph)
+            : frameGraph(frameGraph)
+        {
+        }
+
+        bool ExecutePass(QueueType queue, uint32_t passIndex) override
+        {
+            uint32_t q = ToIndex(queue);
+            double start = max(queueTimes[q], cpuTime);
+            double end = start + durations[frameGraph.GetPassName(passIndex)];
+            runs.push_back({ currentFrame, passIndex, queue, start, end });
+            queueTimes[q] = end;
+            return true;
+        }
+
+        bool Wait(QueueType queue, QueueType signalQueue, uint64_t value) override
+        {
+            double time;
+            if (!FindSignalTime(signalQueue, value, time))
+            {
+                waitedUnsignaled = true;
+                return false;
+            }
+
+            if (!ignoreWaits)
+                queueTimes[ToIndex(queue)] = max(queueTimes[ToIndex(queue)], time);
+
+            return true;
+        }
+
+        bool Signal(QueueType queue, uint64_t value) override
+        {
+            uint32_t q = ToIndex(queue);
+            if (!signals[q].empty() && signals[q].back().value >= value)
+                return false;
+
+            queueTimes[q] = max(queueTimes[q], cpuTime);
+            signals[q].push_back({ value, queueTimes[q] });
+            return true;
+        }
+
+        uint64_t GetCompletedValue(QueueType queue) override
+        {
+            uint64_t completed = 0;
+            for (const Signaled& signaled : signals[ToIndex(queue)])
+            {
+                if (signaled.time <= cpuTime)
+                    completed = signaled.value;
+            }
+            return completed;
+        }
+
+        // CPU가 fence를 기다리는 것. 그 값이 signal된 시각까지 CPU 시간이 간다
+        bool WaitForValue(QueueType queue, uint64_t value)
+        {
+            if (value == 0)
+                return true;
+
+            double time;
+            if (!FindSignalTime(queue, value, time))
+                return false;
+
+            cpuTime = max(cpuTime, time);
+            return true;
+        }
+
+        double GetIdleTime() const
+        {
+            return max(queueTimes[0], queueTimes[1]);
+        }
+
+    private:
+        bool FindSignalTime(QueueType queue, uint64_t value, double& time) const
+        {
+            for (const Signaled& signaled : signals[ToIndex(queue)])
+            {
+                if (signaled.value >= value)
+                {
+                    time = signaled.time;
+                    return true;
+                }
+            }
+            return false;
+        }
+    };
+
+    struct PassAccess
+    {
+        vector<ResourceId> reads;
+        vector<ResourceId> writes;
+    };
+
+    struct FrameRunResult
+    {
+        vector<SimulatedQueues::PassRun> runs;
+        vector<PassAccess> accesses; // runs와 같은 순서
+        uint32_t slotHazards;        // GPU가 아직 쓰고 있는 슬롯을 CPU가 다시 쓴 횟수
+        bool submitted;
+        bool waitedUnsignaled;
+        double totalTime;
+    };
+
+    // drainEveryFrame이면 예전처럼 매 프레임 두 큐를 다 비운다
+    FrameRunResult RunFrames(uint32_t frames, bool drainEveryFrame, bool ignoreWaits = false)
+    {
+        FrameGraph frameGraph;
+        SimulatedQueues queues(frameGraph);
+        queues.durations = { { "Particles", ParticlesTime }, { "LightCulling", LightCullingTime }, { "Triangle", TriangleTime } };
+        queues.ignoreWaits = ignoreWaits;
+
+        FrameRunResult result = {};
+        result.submitted = true;
+
+        uint64_t frameFenceValues[FrameCount][QueueTypeCount] = {};
+        double slotLastGpuUse[FrameCount] = {};
+        uint32_t frameIndex = 0;
+        uint32_t particleResult = 0;
+
+        for (uint32_t frame = 0; frame < frames && result.submitted; frame++)
+        {
+            // 슬롯의 업로드 버퍼와 커맨드 할당자를 CPU가 다시 쓰는 시점
+            if (queues.cpuTime < slotLastGpuUse[frameIndex])
+                result.slotHazards++;
+
+            queues.cpuTime += CpuFrameTime;
+            queues.currentFrame = frame;
+            particleResult = 1 - particleResult;
+
+            const ResourceId lightClusters = LightClusterResource + frameIndex;
+            vector<PassAccess> accesses = {
+                { { ParticleResource + 1 - particleResult }, { ParticleResource + particleResult } },
+                { {}, { lightClusters } },
+                { { ParticleResource + particleResult, lightClusters }, { BackBufferResource } },
+            };
+
+            frameGraph.BeginFrame();
+            frameGraph.AddPass("Particles", QueueType::Compute, { ParticleResource + 1 - particleResult }, { ParticleResource + particleResult });
+            frameGraph.AddPass("LightCulling", QueueType::Compute, {}, { lightClusters });
+            frameGraph.AddPass("Triangle", QueueType::Graphics, { ParticleResource + particleResult, lightClusters }, { BackBufferResource });
+            frameGraph.Compile();
+
+            size_t firstRun = queues.runs.size();
+            if (!frameGraph.Submit(queues))
+            {
+                result.submitted = false;
+                break;
+            }
+
+            double frameEnd = 0.0;
+            for (size_t i = firstRun; i < queues.runs.size(); i++)
+            {
+                result.accesses.push_back(accesses[queues.runs[i].passIndex]);
+                frameEnd = max(frameEnd, queues.runs[i].end);
+            }
+            slotLastGpuUse[frameIndex] = frameEnd;
+
+            // MyWindow::MoveToNextFrame과 같은 순서
+            uint64_t fenceValue = frameGraph.ReserveFenceValue(QueueType::Graphics);
+            if (!queues.Signal(QueueType::Graphics, fenceValue))
+            {
+                result.submitted = false;
+                break;
+            }
+
+            frameFenceValues[frameIndex][ToIndex(QueueType::Graphics)] = fenceValue;
+            frameFenceValues[frameIndex][ToIndex(QueueType::Compute)] = frameGraph.GetStats(QueueType::Compute).lastSignaledValue;
+
+            frameIndex = (frameIndex + 1) % FrameCount;
+            uint32_t waitSlot = drainEveryFrame ? (frameIndex + FrameCount - 1) % FrameCount : frameIndex;
+            for (uint32_t q = 0; q < QueueTypeCount; q++)
+            {
+                if (!queues.WaitForValue(static_cast<QueueType>(q), frameFenceValues[waitSlot][q]))
+                    result.submitted = false;
+            }
+        }
+
+        result.runs = queues.runs;
+        result.waitedUnsignaled = queues.waitedUnsignaled;
+        result.totalTime = queues.GetIdleTime();
+        return result;
+    }
+
+    // 제출 순서대로 보면서, 같은 리소스에 대한 RAW/WAR/WAW 순서가 GPU 시간축에서 지켜졌는지 센다
+    uint32_t CountHazards(const FrameRunResult& result)
+    {
+        struct History
+        {
+            double lastWriteEnd = 0.0;
+            double lastReadEnd = 0.0;
+        };
+
+        unordered_map<ResourceId, History> histories;
+        uint32_t hazards = 0;
+        for (size_t i = 0; i < result.runs.size(); i++)
+        {
+            const SimulatedQueues::PassRun& run = result.runs[i];
+            for (ResourceId read : result.accesses[i].reads)
+            {
+                if (run.start < histories[read].lastWriteEnd)
+                    hazards++;
+            }
+            for (ResourceId write : result.accesses[i].writes)
+            {
+                const History& history = histories[write];
+                if (run.start < history.lastWriteEnd || run.start < history.lastReadEnd)
+                    hazards++;
+            }
+
+            for (ResourceId read : result.accesses[i].reads)
+                histories[read].lastReadEnd = max(histories[read].lastReadEnd, run.end);
+            for (ResourceId write : result.accesses[i].writes)
+                histories[write] = { run.end, 0.0 };
+        }
+        return hazards;
+    }
+
+    const SimulatedQueues::PassRun* FindRun(const FrameRunResult& result, uint64_t frame, QueueType queue)
+    {
+        for (const SimulatedQueues::PassRun& run : result.runs)
+        {
+            if (run.frame == frame && run.queue == queue)
+                return &run;
+        }
+        return nullptr;
+    }
+}
+
+TEST(FramesInFlightKeepDependencies)
+{
+    FrameRunResult result = RunFrames(64, false);
+    CHECK(result.submitted);
+    CHECK(!result.waitedUnsignaled);
+    CHECK(result.runs.size() == 64 * 3);
+    CHECK(CountHazards(result) == 0);
+    CHECK(result.slotHazards == 0);
+}
+
+TEST(ComputeOverlapsPreviousGraphicsFrame)
+{
+    FrameRunResult result = RunFrames(64, false);
+
+    uint32_t overlapped = 0;
+    for (uint64_t frame = 2; frame < 64; frame++)
+    {
+        const SimulatedQueues::PassRun* compute = FindRun(result, frame, QueueType::Compute);
+        const SimulatedQueues::PassRun* graphics = FindRun(result, frame - 1, QueueType::Graphics);
+        CHECK(compute && graphics);
+        if (compute && graphics && compute->start < graphics->end)
+            overlapped++;
+    }
+    CHECK(overlapped == 62);
+}
+
+TEST(FramesInFlightBeatDrainEveryFrame)
+{
+    const uint32_t frames = 100;
+    FrameRunResult inFlight = RunFrames(frames, false);
+    FrameRunResult drained = RunFrames(frames, true);
+    CHECK(CountHazards(drained) == 0);
+
+    // 겹치면 그래픽스 패스 길이, 다 비우면 CPU + compute + 그래픽스 길이가 프레임 주기가 된다
+    double inFlightPeriod = inFlight.totalTime / frames;
+    double drainedPeriod = drained.totalTime / frames;
+    printf("  frame period: in flight %.2f ms, drain every frame %.2f ms\n", inFlightPeriod, drainedPeriod);
+    CHECK(inFlightPeriod < TriangleTime + 0.5);
+    CHECK(drainedPeriod > CpuFrameTime + ParticlesTime + LightCullingTime + TriangleTime - 0.5);
+}
+
+TEST(HazardCheckCatchesMissingWaits)
+{
+    // 프레임 그래프가 넣은 wait를 무시하면 compute 결과를 읽기 전에 그래픽스가 시작하므로 검증기가 잡아야 한다
+    FrameRunResult result = RunFrames(16, false, true);
+    CHECK(CountHazards(result) > 0);
+}
+
+int main()
+{
+    return RunTests();
+}
@@ -0,0 +1,88 @@
+#include "Benchmark.h"
+#include "LodSelector.h"
+#include "MeshSimplifier.h"
+#include <random>
+#include <thread>
+
+using namespace std;
+
+// 1. 오차 대 삼각형 수 곡선: 절차적 메시를 1/2, 1/4, ...로 줄이면서 보고된 오차와 걸린 시간을 찍는다
+// 2. 인스턴스 100만 개의 LOD 고르기: 스칼라, AVX2, AVX2 + 워커 스레드. 카메라가 움직이는 프레임마다 지난 LOD를 이어받는다
+
+namespace
+{
+    const uint32_t InstanceCount = 1 << 20;
+    const int Repeats = 10;
+
+    void ReportErrorCurve(const MeshSource& source)
+    {
+        uint32_t vertexCount = static_cast<uint32_t>(source.positions.size() / 3);
+        uint32_t indexCount = static_cast<uint32_t>(source.indices.size());
+        printf("%s: %u triangles\n", source.name.c_str(), indexCount / 3);
+
+        for (uint32_t divisor = 2; divisor <= 256; divisor *= 2)
+        {
+            vector<uint32_t> simplified;
+            float error = 0.0f;
+            double ms = MeasureMilliseconds(1, [&]
+            {
+                error = SimplifyMesh(source.positions.data(), vertexCount, source.indices.data(), indexCount, indexCount / divisor / 3 * 3, 1e30f, simplified);
+            });
+            printf("  1/%-4u %8zu triangles  error %9.5f  %8.2f ms\n", divisor, simplified.size() / 3, error, ms);
+        }
+    }
+
+    double MeasureSelect(const LodSelector& selector, const LodInstances& instances, vector<uint8_t>& lods, Executor* executor)
+    {
+        uint32_t frame = 0;
+        double ms = MeasureMilliseconds(Repeats, [&]
+        {
+            LodCamera camera = { frame * 7.0f, 2.0f, frame * 3.0f, 720.0f / (2.0f * 0.57735027f), 1.0f, 0.1f };
+            selector.Select(instances, camera, lods.data(), executor);
+            frame++;
+        });
+        KeepResult(lods[frame]);
+        return ms;
+    }
+}
+
+int main()
+{
+    ReportErrorCurve(MakeBumpyTorus(192, 96));
+    ReportErrorCurve(MakeSphere(128, 256));
+    ReportErrorCurve(MakeTerrainPatch(160));
+
+    MeshAsset asset;
+    if (!BuildMeshAsset(MakeBumpyTorus(192, 96), LodChainDesc(), asset))
+        return 1;
+
+    mt19937 random(1);
+    uniform_real_distribution<float> position(-500.0f, 500.0f);
+    uniform_real_distribution<float> scale(0.5f, 2.0f);
+    LodInstances instances;
+    instances.Resize(InstanceCount);
+    for (uint32_t i = 0; i < InstanceCount; i++)
+    {
+        instances.x[i] = position(random);
+        instances.y[i] = position(random) * 0.02f;
+        instances.z[i] = position(random);
+        instances.scale[i] = scale(random);
+    }
+
+    Executor executor;
+    LodSelector selector;
+    selector.SetMesh(asset);
+    vector<uint8_t> lods(InstanceCount, 0);
+
+    printf("\n%u instances, %zu lods, %u hardware threads\n", InstanceCount, asset.lods.size(), thread::hardware_concurrency());
+    selector.SetSimdPath(LodSimdPath::Scalar);
+    double scalarMs = MeasureSelect(selector, instances, lods, nullptr);
+    selector.SetSimdPath(LodSimdPath::Avx2);
+    bool avx2 = selector.GetSimdPath() == LodSimdPath::Avx2;
+    double avx2Ms = MeasureSelect(selector, instances, lods, nullptr);
+    double threadedMs = MeasureSelect(selector, instances, lods, &executor);
+
+    printf("%10s %10s %12s\n", "scalar ms", "avx2 ms", "avx2+mt ms");
+    printf("%10.3f %10.3f %12.3f%s\n", scalarMs, avx2Ms, threadedMs, avx2 ? "" : "  (AVX2 not supported, scalar)");
+    return 0;
+}
@@ -0,0 +1,222 @@
+#include "LodSelector.h"
+#include "TestCheck.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace std;
+
+namespace
+{
+    // 오차가 두 배씩 커지는 LOD 6개. 경계 구 반지름 1
+    MeshAsset MakeLodAsset()
+    {
+        MeshAsset asset = {};
+        asset.boundsRadius = 1.0f;
+        float error = 0.0f;
+        for (uint32_t lod = 0; lod < 6; lod++)
+        {
+            asset.lods.push_back({ 0, 0, error });
+            error = lod == 0 ? 0.002f : error * 2.0f;
+        }
+        return asset;
+    }
+
+    // 크기가 섞인 인스턴스를 카메라 주변 넓은 평면에 흩는다. 수는 8의 배수도 ChunkSize의 배수도 아니게 잡는다
+    LodInstances MakeInstances(uint32_t count, uint32_t seed)
+    {
+        mt19937 random(seed);
+        uniform_real_distribution<float> position(-500.0f, 500.0f);
+        uniform_real_distribution<float> scale(0.5f, 2.0f);
+
+        LodInstances instances;
+        instances.Resize(count);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            instances.x[i] = position(random);
+            instances.y[i] = position(random) * 0.02f;
+            instances.z[i] = position(random);
+            instances.scale[i] = scale(random);
+        }
+        return instances;
+    }
+
+    LodCamera MakeCamera(float hysteresis)
+    {
+        return { 0.0f, 2.0f, 0.0f, 720.0f / (2.0f * 0.57735027f), 1.0f, hysteresis };
+    }
+
+    uint32_t CountChanged(const vector<uint8_t>& a, const vector<uint8_t>& b)
+    {
+        uint32_t changed = 0;
+        for (size_t i = 0; i < a.size(); i++)
+            changed += a[i] != b[i] ? 1 : 0;
+        return changed;
+    }
+}
+
+TEST(PathsAgreeAcrossFrames)
+{
+    const uint32_t count = 100003;
+    MeshAsset asset = MakeLodAsset();
+    LodInstances instances = MakeInstances(count, 1);
+    Executor executor(4);
+
+    LodSelector scalar;
+    LodSelector avx2;
+    scalar.SetMesh(asset);
+    avx2.SetMesh(asset);
+    scalar.SetSimdPath(LodSimdPath::Scalar);
+    avx2.SetSimdPath(LodSimdPath::Avx2);
+    if (avx2.GetSimdPath() != LodSimdPath::Avx2)
+        printf("  AVX2 not supported, comparing scalar paths only\n");
+
+    // 지난 프레임 LOD를 이어받으므로 카메라를 움직이면서 여러 프레임을 돌린다
+    vector<uint8_t> scalarLods(count, 0);
+    vector<uint8_t> avx2Lods(count, 0);
+    vector<uint8_t> threadedLods(count, 0);
+    uint32_t mismatchedFrames = 0;
+    for (uint32_t frame = 0; frame < 12; frame++)
+    {
+        LodCamera camera = MakeCamera(0.1f);
+        camera.x = frame * 7.0f;
+        camera.z = frame * 3.0f;
+
+        scalar.Select(instances, camera, scalarLods.data());
+        avx2.Select(instances, camera, avx2Lods.data());
+        avx2.Select(instances, camera, threadedLods.data(), &executor);
+        mismatchedFrames += (scalarLods == avx2Lods && scalarLods == threadedLods) ? 0 : 1;
+    }
+
+    CHECK(mismatchedFrames == 0);
+}
+
+TEST(ChosenLodIsCoarsestUnderThreshold)
+{
+    const uint32_t count = 20000;
+    MeshAsset asset = MakeLodAsset();
+    LodInstances instances = MakeInstances(count, 2);
+    LodCamera camera = MakeCamera(0.0f);
+
+    LodSelector selector;
+    selector.SetMesh(asset);
+    vector<uint8_t> lods(count, 0);
+    selector.Select(instances, camera, lods.data());
+
+    // 경계 구 표면까지의 거리에서 보이는 오차 픽셀을 double로 다시 계산한다. 문턱에 딱 걸친 것은 빼고 본다
+    uint32_t tooCoarse = 0;
+    uint32_t tooFine = 0;
+    uint32_t histogram[MeshAsset::MaxLods] = {};
+    for (uint32_t i = 0; i < count; i++)
+    {
+        double dx = instances.x[i] - camera.x, dy = instances.y[i] - camera.y, dz = instances.z[i] - camera.z;
+        double distance = sqrt(dx * dx + dy * dy + dz * dz) - asset.boundsRadius * instances.scale[i];
+        auto pixels = [&](uint32_t lod)
+        {
+            return distance <= 0.0 ? 1e30 : asset.lods[lod].error * instances.scale[i] * camera.projectionScale / distance;
+        };
+
+        uint32_t lod = lods[i];
+        histogram[lod]++;
+        tooCoarse += pixels(lod) > camera.pixelThreshold * 1.0001 ? 1 : 0;
+        if (lod + 1 < asset.lods.size())
+            tooFine += pixels(lod + 1) < camera.pixelThreshold * 0.9999 ? 1 : 0;
+    }
+
+    CHECK(tooCoarse == 0);
+    CHECK(tooFine == 0);
+
+    // 분포가 한쪽에 몰리면 위 확인이 의미가 없다
+    uint32_t usedLods = 0;
+    for (uint32_t used : histogram)
+        usedLods += used > 0 ? 1 : 0;
+    CHECK(usedLods >= 4);
+}
+
+TEST(HysteresisStopsFlickerUnderJitter)
+{
+    const uint32_t count = 50000;
+    MeshAsset asset = MakeLodAsset();
+    LodInstances instances = MakeInstances(count, 3);
+
+    LodSelector selector;
+    selector.SetMesh(asset);
+
+    // 카메라가 1만큼 떨어진 두 점 사이를 오가면 문턱 근처 인스턴스가 매 프레임 바뀌는지 센다. 첫 왕복은 자리를 잡는 것이라 뺀다
+    // 거리가 1 바뀌는 것이 hysteresis 폭(거리의 약 11%)보다 작은 인스턴스만 센다
+    vector<bool> farEnough(count);
+    for (uint32_t i = 0; i < count; i++)
+        farEnough[i] = fabsf(instances.x[i]) + fabsf(instances.z[i]) > 20.0f;
+
+    auto countFlips = [&](float hysteresis)
+    {
+        vector<uint8_t> lods(count, 0);
+        uint32_t flips = 0;
+        for (uint32_t frame = 0; frame < 10; frame++)
+        {
+            LodCamera camera = MakeCamera(hysteresis);
+            camera.x = (frame & 1) ? 0.5f : -0.5f;
+            vector<uint8_t> previous = lods;
+            selector.Select(instances, camera, lods.data());
+            for (uint32_t i = 0; i < count && frame >= 2; i++)
+                flips += (farEnough[i] && previous[i] != lods[i]) ? 1 : 0;
+        }
+        return flips;
+    };
+
+    uint32_t withoutHysteresis = countFlips(0.0f);
+    uint32_t withHysteresis = countFlips(0.1f);
+    CHECK(withoutHysteresis > 0);
+    CHECK(withHysteresis == 0);
+}
+
+TEST(CameraInsideBoundsUsesFinestLod)
+{
+    MeshAsset asset = MakeLodAsset();
+    LodInstances instances;
+    instances.Resize(9);
+    for (uint32_t i = 0; i < 9; i++)
+    {
+        instances.x[i] = 0.1f * i;
+        instances.scale[i] = 2.0f;
+    }
+
+    LodSelector selector;
+    selector.SetMesh(asset);
+    vector<uint8_t> lods(9, 5);
+    selector.Select(instances, MakeCamera(0.1f), lods.data());
+    CHECK(CountChanged(lods, vector<uint8_t>(9, 0)) == 0);
+}
+
+TEST(HysteresisIsClamped)
+{
+    const uint32_t count = 10007;
+    MeshAsset asset = MakeLodAsset();
+    LodInstances instances = MakeInstances(count, 3);
+
+    LodSelector selector;
+    selector.SetMesh(asset);
+    auto selectFrames = [&](float hysteresis)
+    {
+        vector<uint8_t> lods(count, 0);
+        for (uint32_t frame = 0; frame < 3; frame++)
+            selector.Select(instances, MakeCamera(hysteresis), lods.data());
+        return lods;
+    };
+
+    // 1과 그 위는 MaxHysteresis와, 음수와 NaN은 0과 같게 고른다
+    vector<uint8_t> clamped = selectFrames(LodSelector::MaxHysteresis);
+    CHECK(CountChanged(selectFrames(1.0f), clamped) == 0);
+    CHECK(CountChanged(selectFrames(5.0f), clamped) == 0);
+    CHECK(CountChanged(selectFrames(-1.0f), selectFrames(0.0f)) == 0);
+    CHECK(CountChanged(selectFrames(nanf("")), selectFrames(0.0f)) == 0);
+
+    // 문턱이 무한대가 아니므로 먼 인스턴스는 여전히 거친 LOD로 내려간다
+    CHECK(CountChanged(clamped, vector<uint8_t>(count, 0)) > 0);
+    CHECK(*max_element(clamped.begin(), clamped.end()) == selector.GetLodCount() - 1);
+}
+
+int main()
+{
+    return RunTests();
+}
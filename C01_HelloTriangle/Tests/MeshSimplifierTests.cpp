@@ -0,0 +1,216 @@
+#include "MeshAsset.h"
+#include "MeshSimplifier.h"
+#include "TestCheck.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace std;
+
+namespace
+{
+    struct Vector3
+    {
+        float x, y, z;
+    };
+
+    Vector3 GetPosition(const vector<float>& positions, uint32_t index)
+    {
+        return { positions[index * 3], positions[index * 3 + 1], positions[index * 3 + 2] };
+    }
+
+    Vector3 Subtract(Vector3 a, Vector3 b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+    float Dot(Vector3 a, Vector3 b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+    // 점에서 삼각형까지 가장 가까운 거리의 제곱 (Ericson, Real-Time Collision Detection 5.1.5)
+    float DistanceSqToTriangle(Vector3 p, Vector3 a, Vector3 b, Vector3 c)
+    {
+        Vector3 ab = Subtract(b, a), ac = Subtract(c, a), ap = Subtract(p, a);
+        float d1 = Dot(ab, ap), d2 = Dot(ac, ap);
+        Vector3 closest;
+        if (d1 <= 0 && d2 <= 0)
+        {
+            closest = a;
+        }
+        else
+        {
+            Vector3 bp = Subtract(p, b);
+            float d3 = Dot(ab, bp), d4 = Dot(ac, bp);
+            Vector3 cp = Subtract(p, c);
+            float d5 = Dot(ab, cp), d6 = Dot(ac, cp);
+            float vc = d1 * d4 - d3 * d2, vb = d5 * d2 - d1 * d6, va = d3 * d6 - d5 * d4;
+            if (d3 >= 0 && d4 <= d3)
+                closest = b;
+            else if (d6 >= 0 && d5 <= d6)
+                closest = c;
+            else if (vc <= 0 && d1 >= 0 && d3 <= 0)
+                closest = { a.x + ab.x * d1 / (d1 - d3), a.y + ab.y * d1 / (d1 - d3), a.z + ab.z * d1 / (d1 - d3) };
+            else if (vb <= 0 && d2 >= 0 && d6 <= 0)
+                closest = { a.x + ac.x * d2 / (d2 - d6), a.y + ac.y * d2 / (d2 - d6), a.z + ac.z * d2 / (d2 - d6) };
+            else if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0)
+            {
+                float w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+                closest = { b.x + (c.x - b.x) * w, b.y + (c.y - b.y) * w, b.z + (c.z - b.z) * w };
+            }
+            else
+            {
+                float denominator = 1.0f / (va + vb + vc);
+                float v = vb * denominator, w = vc * denominator;
+                closest = { a.x + ab.x * v + ac.x * w, a.y + ab.y * v + ac.y * w, a.z + ab.z * v + ac.z * w };
+            }
+        }
+
+        Vector3 offset = Subtract(p, closest);
+        return Dot(offset, offset);
+    }
+
+    struct Deviation
+    {
+        float rms;
+        float max;
+    };
+
+    // 원래 정점들에서 줄인 표면까지의 거리. 정점을 옮기지 않으므로 접힌 정점들만 0이 아니다
+    Deviation MeasureDeviation(const MeshSource& source, const vector<uint32_t>& simplified)
+    {
+        uint32_t vertexCount = static_cast<uint32_t>(source.positions.size() / 3);
+        double sumSq = 0.0;
+        float maxSq = 0.0f;
+        for (uint32_t v = 0; v < vertexCount; v++)
+        {
+            Vector3 p = GetPosition(source.positions, v);
+            float best = numeric_limits<float>::max();
+            for (size_t i = 0; i < simplified.size(); i += 3)
+            {
+                best = min(best, DistanceSqToTriangle(p, GetPosition(source.positions, simplified[i]),
+                    GetPosition(source.positions, simplified[i + 1]), GetPosition(source.positions, simplified[i + 2])));
+            }
+            sumSq += best;
+            maxSq = max(maxSq, best);
+        }
+        return { static_cast<float>(sqrt(sumSq / vertexCount)), sqrtf(maxSq) };
+    }
+
+    bool IsValidIndexList(const vector<uint32_t>& indices, uint32_t vertexCount)
+    {
+        if (indices.size() % 3 != 0)
+            return false;
+
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            uint32_t a = indices[i], b = indices[i + 1], c = indices[i + 2];
+            if (a >= vertexCount || b >= vertexCount || c >= vertexCount || a == b || b == c || a == c)
+                return false;
+        }
+        return true;
+    }
+}
+
+TEST(ErrorCurveGrowsAsTrianglesDrop)
+{
+    MeshSource torus = MakeBumpyTorus(48, 24);
+    uint32_t vertexCount = static_cast<uint32_t>(torus.positions.size() / 3);
+    uint32_t indexCount = static_cast<uint32_t>(torus.indices.size());
+
+    float lastError = 0.0f;
+    for (uint32_t divisor = 2; divisor <= 32; divisor *= 2)
+    {
+        uint32_t target = indexCount / divisor / 3 * 3;
+        vector<uint32_t> simplified;
+        float error = SimplifyMesh(torus.positions.data(), vertexCount, torus.indices.data(), indexCount, target, 1e30f, simplified);
+
+        Deviation deviation = MeasureDeviation(torus, simplified);
+        printf("  1/%-2u %6zu indices error %.5f measured rms %.5f max %.5f\n", divisor, simplified.size(), error, deviation.rms, deviation.max);
+
+        CHECK(IsValidIndexList(simplified, vertexCount));
+        CHECK(simplified.size() <= target);
+        CHECK(error >= lastError);
+
+        // 보고한 오차는 단계마다 더한 상한이라 최대 거리보다는 작을 수 있어도 실제 RMS 거리보다는 커야 한다
+        CHECK(deviation.rms <= error);
+        lastError = error;
+    }
+}
+
+TEST(MaxErrorStopsCollapsing)
+{
+    MeshSource sphere = MakeSphere(32, 64);
+    uint32_t vertexCount = static_cast<uint32_t>(sphere.positions.size() / 3);
+    uint32_t indexCount = static_cast<uint32_t>(sphere.indices.size());
+
+    vector<uint32_t> coarse;
+    float coarseError = SimplifyMesh(sphere.positions.data(), vertexCount, sphere.indices.data(), indexCount, 0, 1e30f, coarse);
+
+    vector<uint32_t> bounded;
+    float maxError = coarseError * 0.05f;
+    float boundedError = SimplifyMesh(sphere.positions.data(), vertexCount, sphere.indices.data(), indexCount, 0, maxError, bounded);
+
+    CHECK(boundedError <= maxError);
+    CHECK(bounded.size() > coarse.size());
+    CHECK(IsValidIndexList(bounded, vertexCount));
+}
+
+TEST(OpenBorderStaysInPlace)
+{
+    // 열린 가장자리는 접혀도 가장자리 위에 남아야 한다. 지형 조각의 xz 범위가 줄지 않는다
+    MeshSource terrain = MakeTerrainPatch(32);
+    uint32_t vertexCount = static_cast<uint32_t>(terrain.positions.size() / 3);
+
+    vector<uint32_t> simplified;
+    SimplifyMesh(terrain.positions.data(), vertexCount, terrain.indices.data(), static_cast<uint32_t>(terrain.indices.size()),
+        static_cast<uint32_t>(terrain.indices.size() / 8), 1e30f, simplified);
+
+    auto extent = [&](const vector<uint32_t>& indices, uint32_t axis, bool takeMax)
+    {
+        float value = takeMax ? -numeric_limits<float>::max() : numeric_limits<float>::max();
+        for (uint32_t index : indices)
+            value = takeMax ? max(value, terrain.positions[index * 3 + axis]) : min(value, terrain.positions[index * 3 + axis]);
+        return value;
+    };
+
+    CHECK(IsValidIndexList(simplified, vertexCount));
+    for (uint32_t axis : { 0u, 2u })
+    {
+        CHECK(extent(simplified, axis, false) == extent(terrain.indices, axis, false));
+        CHECK(extent(simplified, axis, true) == extent(terrain.indices, axis, true));
+    }
+}
+
+TEST(AssetLodsShareVerticesAndRoundTrip)
+{
+    MeshSource torus = MakeBumpyTorus(64, 32);
+    MeshAsset asset;
+    CHECK(BuildMeshAsset(torus, LodChainDesc(), asset));
+    CHECK(asset.lods.size() >= 3);
+    CHECK(asset.lods.size() <= MeshAsset::MaxLods);
+
+    uint32_t vertexCount = static_cast<uint32_t>(asset.positions.size() / 3);
+    uint32_t offset = 0;
+    for (size_t lod = 0; lod < asset.lods.size(); lod++)
+    {
+        const MeshLod& meshLod = asset.lods[lod];
+        CHECK(meshLod.indexOffset == offset);
+        CHECK(lod == 0 ? meshLod.error == 0.0f : meshLod.error >= asset.lods[lod - 1].error);
+        CHECK(lod == 0 || meshLod.indexCount < asset.lods[lod - 1].indexCount);
+
+        vector<uint32_t> lodIndices(asset.indices.begin() + meshLod.indexOffset, asset.indices.begin() + meshLod.indexOffset + meshLod.indexCount);
+        CHECK(IsValidIndexList(lodIndices, vertexCount));
+        offset += meshLod.indexCount;
+    }
+    CHECK(offset == asset.indices.size());
+
+    filesystem::path assetPath = filesystem::temp_directory_path() / "mesh_simplifier_tests.mesh";
+    MeshAsset loaded;
+    CHECK(SaveMeshAsset(assetPath, asset));
+    CHECK(LoadMeshAsset(assetPath, loaded));
+    CHECK(loaded.positions == asset.positions);
+    CHECK(loaded.indices == asset.indices);
+    CHECK(loaded.lods.size() == asset.lods.size());
+    CHECK(loaded.boundsRadius == asset.boundsRadius);
+    filesystem::remove(assetPath);
+}
+
+int main()
+{
+    return RunTests();
+}
@@ -0,0 +1,111 @@
+#include "Benchmark.h"
+#include "OcclusionCuller.h"
+#include <array>
+#include <cmath>
+#include <random>
+#include <thread>
+
+using namespace std;
+
+// occluder 수를 바꿔 가며 OcclusionCuller의 Render와 TestBounds를 스칼라, AVX2, AVX2 + 워커 스레드로 잰다
+// 물체는 10만 개. 장면은 OcclusionCullerTests와 같은 모양(y축으로 돌린 납작한 상자들)이다
+
+namespace
+{
+    const uint32_t ObjectCount = 100000;
+    const int Repeats = 10;
+
+    const float BoxPositions[24] = { 0, 0, 0, 1, 0, 0, 0, 1, 0, 1, 1, 0, 0, 0, 1, 1, 0, 1, 0, 1, 1, 1, 1, 1 };
+    const uint32_t BoxIndices[36] =
+    {
+        2, 3, 1, 2, 1, 0,
+        7, 6, 4, 7, 4, 5,
+        6, 2, 0, 6, 0, 4,
+        3, 7, 5, 3, 5, 1,
+        6, 7, 3, 6, 3, 2,
+        0, 1, 5, 0, 5, 4,
+    };
+
+    struct Result
+    {
+        double renderMs;
+        double testMs;
+        uint32_t visibleObjects;
+    };
+
+    Result Measure(OcclusionSimdPath path, const vector<array<float, 12>>& transforms, const OcclusionBounds& bounds, Executor* executor)
+    {
+        OcclusionCamera camera = { 0.1f, 0.57735027f * OcclusionCuller::DefaultWidth / OcclusionCuller::DefaultHeight, 0.57735027f };
+        OcclusionCuller culler;
+        culler.Init();
+        culler.SetSimdPath(path);
+
+        Result result = {};
+        result.renderMs = MeasureMilliseconds(Repeats, [&]
+        {
+            culler.BeginFrame(camera);
+            for (const array<float, 12>& transform : transforms)
+                culler.AddOccluder(BoxPositions, 8, BoxIndices, 36, transform.data());
+            culler.Render(executor);
+        });
+
+        vector<uint8_t> visible(bounds.GetCount());
+        result.testMs = MeasureMilliseconds(Repeats, [&] { culler.TestBounds(bounds, visible.data(), executor); });
+        result.visibleObjects = culler.GetStats().visibleObjects;
+        KeepResult(visible[0]);
+        return result;
+    }
+}
+
+int main()
+{
+    mt19937 random(5);
+    uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    OcclusionBounds bounds;
+    bounds.Resize(ObjectCount);
+    for (uint32_t i = 0; i < ObjectCount; i++)
+    {
+        float minCorner[3] = { (unit(random) - 0.5f) * 60.0f, (unit(random) - 0.5f) * 24.0f, 0.05f + unit(random) * 60.0f };
+        float extent = 0.05f + unit(random) * 1.5f;
+        float maxCorner[3] = { minCorner[0] + extent, minCorner[1] + extent, minCorner[2] + extent };
+        bounds.Set(i, minCorner, maxCorner);
+    }
+
+    Executor executor;
+    bool avx2 = false;
+    {
+        OcclusionCuller probe;
+        probe.SetSimdPath(OcclusionSimdPath::Avx2);
+        avx2 = probe.GetSimdPath() == OcclusionSimdPath::Avx2;
+    }
+
+    printf("%u objects, %ux%u depth, %u hardware threads, AVX2 %s\n", ObjectCount, OcclusionCuller::DefaultWidth, OcclusionCuller::DefaultHeight,
+        thread::hardware_concurrency(), avx2 ? "supported" : "not supported");
+    printf("%9s | %28s | %28s | %8s\n", "", "render ms", "test ms", "");
+    printf("%9s | %8s %8s %10s | %8s %8s %10s | %8s\n", "occluders", "scalar", "avx2", "avx2+mt", "scalar", "avx2", "avx2+mt", "visible");
+
+    for (uint32_t occluderCount : { 20u, 400u, 2000u })
+    {
+        vector<array<float, 12>> transforms(occluderCount);
+        for (array<float, 12>& transform : transforms)
+        {
+            float sizeX = 0.5f + unit(random) * 3.0f;
+            float sizeY = 0.5f + unit(random) * 3.0f;
+            float sizeZ = 0.2f + unit(random);
+            float x = (unit(random) - 0.5f) * 30.0f;
+            float y = (unit(random) - 0.5f) * 12.0f;
+            float z = 6.0f + unit(random) * 30.0f;
+            float angle = unit(random) * 6.28f;
+            float c = cosf(angle), s = sinf(angle);
+            transform = { c * sizeX, 0, s * sizeZ, x, 0, sizeY, 0, y, -s * sizeX, 0, c * sizeZ, z };
+        }
+
+        Result scalar = Measure(OcclusionSimdPath::Scalar, transforms, bounds, nullptr);
+        Result simd = Measure(OcclusionSimdPath::Avx2, transforms, bounds, nullptr);
+        Result threaded = Measure(OcclusionSimdPath::Avx2, transforms, bounds, &executor);
+        printf("%9u | %8.3f %8.3f %10.3f | %8.3f %8.3f %10.3f | %8u\n", occluderCount, scalar.renderMs, simd.renderMs, threaded.renderMs,
+            scalar.testMs, simd.testMs, threaded.testMs, threaded.visibleObjects);
+    }
+    return 0;
+}
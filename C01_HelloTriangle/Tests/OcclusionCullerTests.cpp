@@ -0,0 +1,294 @@
+#include "OcclusionCuller.h"
+#include "TestCheck.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace std;
+
+namespace
+{
+    // 단위 상자. 모든 면이 바깥에서 볼 때 시계 방향으로 감긴다
+    const float BoxPositions[24] = { 0, 0, 0, 1, 0, 0, 0, 1, 0, 1, 1, 0, 0, 0, 1, 1, 0, 1, 0, 1, 1, 1, 1, 1 };
+    const uint32_t BoxIndices[36] =
+    {
+        2, 3, 1, 2, 1, 0, // -z
+        7, 6, 4, 7, 4, 5, // +z
+        6, 2, 0, 6, 0, 4, // -x
+        3, 7, 5, 3, 5, 1, // +x
+        6, 7, 3, 6, 3, 2, // +y
+        0, 1, 5, 0, 5, 4, // -y
+    };
+
+    struct Occluder
+    {
+        float transform[12];
+    };
+
+    struct Scene
+    {
+        OcclusionCamera camera;
+        vector<Occluder> occluders;
+        OcclusionBounds bounds;
+    };
+
+    // y축으로 돌린 납작한 상자들과 그 뒤에 흩어진 작은 물체들. nearOccluders면 near 평면에 걸치는 상자도 넣는다
+    Scene MakeScene(uint32_t occluderCount, uint32_t objectCount, bool nearOccluders, uint32_t seed)
+    {
+        mt19937 random(seed);
+        uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+        Scene scene;
+        scene.camera = { 0.1f, 0.57735027f * OcclusionCuller::DefaultWidth / OcclusionCuller::DefaultHeight, 0.57735027f };
+        scene.occluders.resize(occluderCount);
+        for (Occluder& occluder : scene.occluders)
+        {
+            float sizeX = 0.5f + unit(random) * 3.0f;
+            float sizeY = 0.5f + unit(random) * 3.0f;
+            float sizeZ = 0.2f + unit(random);
+            float x = (unit(random) - 0.5f) * 30.0f;
+            float y = (unit(random) - 0.5f) * 12.0f;
+            float z = nearOccluders ? 0.02f + unit(random) * 4.0f : 6.0f + unit(random) * 30.0f;
+            float angle = unit(random) * 6.28f;
+            float c = cosf(angle), s = sinf(angle);
+            const float transform[12] = { c * sizeX, 0, s * sizeZ, x, 0, sizeY, 0, y, -s * sizeX, 0, c * sizeZ, z };
+            copy(begin(transform), end(transform), occluder.transform);
+        }
+
+        scene.bounds.Resize(objectCount);
+        for (uint32_t i = 0; i < objectCount; i++)
+        {
+            float minCorner[3] = { (unit(random) - 0.5f) * 60.0f, (unit(random) - 0.5f) * 24.0f, 0.05f + unit(random) * 60.0f };
+            float extent = 0.05f + unit(random) * 1.5f;
+            float maxCorner[3] = { minCorner[0] + extent, minCorner[1] + extent, minCorner[2] + extent };
+            scene.bounds.Set(i, minCorner, maxCorner);
+        }
+        return scene;
+    }
+
+    void Render(OcclusionCuller& culler, const Scene& scene, Executor* executor)
+    {
+        culler.BeginFrame(scene.camera);
+        for (const Occluder& occluder : scene.occluders)
+            culler.AddOccluder(BoxPositions, 8, BoxIndices, 36, occluder.transform);
+        culler.Render(executor);
+    }
+
+    // 타일도 SIMD도 없이 삼각형 경계 상자의 모든 픽셀 중심을 double로 보는 래스터라이저. near 평면에 걸치지 않는 장면만 그린다
+    vector<float> RasterizeReference(const Scene& scene, uint32_t width, uint32_t height)
+    {
+        vector<float> depthBuffer(static_cast<size_t>(width) * height, 0.0f);
+        const OcclusionCamera& camera = scene.camera;
+        for (const Occluder& occluder : scene.occluders)
+        {
+            for (uint32_t i = 0; i < 36; i += 3)
+            {
+                double x[3], y[3], depth[3];
+                for (uint32_t k = 0; k < 3; k++)
+                {
+                    const float* p = &BoxPositions[BoxIndices[i + k] * 3];
+                    const float* t = occluder.transform;
+                    double view[3];
+                    for (uint32_t row = 0; row < 3; row++)
+                        view[row] = t[row * 4] * p[0] + t[row * 4 + 1] * p[1] + t[row * 4 + 2] * p[2] + t[row * 4 + 3];
+
+                    x[k] = (view[0] / (view[2] * camera.tanHalfFovX) * 0.5 + 0.5) * width;
+                    y[k] = (0.5 - view[1] / (view[2] * camera.tanHalfFovY) * 0.5) * height;
+                    depth[k] = camera.nearZ / view[2];
+                }
+
+                // 화면에서 y가 아래로 자라므로 시계 방향 삼각형은 이 값이 양수다
+                double area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+                if (area <= 0.0)
+                    continue;
+
+                int32_t x0 = max(0, static_cast<int32_t>(floor(min({ x[0], x[1], x[2] }))));
+                int32_t y0 = max(0, static_cast<int32_t>(floor(min({ y[0], y[1], y[2] }))));
+                int32_t x1 = min(static_cast<int32_t>(width) - 1, static_cast<int32_t>(ceil(max({ x[0], x[1], x[2] }))));
+                int32_t y1 = min(static_cast<int32_t>(height) - 1, static_cast<int32_t>(ceil(max({ y[0], y[1], y[2] }))));
+                for (int32_t py = y0; py <= y1; py++)
+                {
+                    for (int32_t px = x0; px <= x1; px++)
+                    {
+                        double cx = px + 0.5, cy = py + 0.5;
+                        double w[3];
+                        for (uint32_t k = 0; k < 3; k++)
+                        {
+                            uint32_t j = (k + 1) % 3, l = (k + 2) % 3;
+                            w[l] = ((x[j] - x[k]) * (cy - y[k]) - (y[j] - y[k]) * (cx - x[k])) / area;
+                        }
+                        if (w[0] < 0.0 || w[1] < 0.0 || w[2] < 0.0)
+                            continue;
+
+                        float value = static_cast<float>(w[0] * depth[0] + w[1] * depth[1] + w[2] * depth[2]);
+                        float& dest = depthBuffer[static_cast<size_t>(py) * width + px];
+                        dest = max(dest, value);
+                    }
+                }
+            }
+        }
+        return depthBuffer;
+    }
+
+    // 피라미드 없이 AABB가 덮는 모든 깊이 텍셀을 본다
+    bool IsVisibleBruteForce(const OcclusionCuller& culler, const OcclusionCamera& camera, const OcclusionBounds& bounds, uint32_t i)
+    {
+        if (bounds.maxZ[i] <= camera.nearZ)
+            return false;
+        if (bounds.minZ[i] <= camera.nearZ)
+            return true;
+
+        float width = static_cast<float>(culler.GetWidth());
+        float height = static_cast<float>(culler.GetHeight());
+        float x0 = 1e30f, y0 = 1e30f, x1 = -1e30f, y1 = -1e30f;
+        for (uint32_t corner = 0; corner < 8; corner++)
+        {
+            float x = (corner & 1) ? bounds.maxX[i] : bounds.minX[i];
+            float y = (corner & 2) ? bounds.maxY[i] : bounds.minY[i];
+            float z = (corner & 4) ? bounds.maxZ[i] : bounds.minZ[i];
+            float screenX = (x / (z * camera.tanHalfFovX) * 0.5f + 0.5f) * width;
+            float screenY = (0.5f - y / (z * camera.tanHalfFovY) * 0.5f) * height;
+            x0 = min(x0, screenX);
+            y0 = min(y0, screenY);
+            x1 = max(x1, screenX);
+            y1 = max(y1, screenY);
+        }
+        if (x1 < 0.0f || y1 < 0.0f || x0 >= width || y0 >= height)
+            return false;
+
+        const vector<float>& depthBuffer = culler.GetDepthBuffer();
+        uint32_t pixelX0 = static_cast<uint32_t>(max(x0, 0.0f)), pixelY0 = static_cast<uint32_t>(max(y0, 0.0f));
+        uint32_t pixelX1 = static_cast<uint32_t>(min(x1, width - 1.0f)), pixelY1 = static_cast<uint32_t>(min(y1, height - 1.0f));
+        float nearestDepth = camera.nearZ / bounds.minZ[i];
+        for (uint32_t y = pixelY0; y <= pixelY1; y++)
+        {
+            for (uint32_t x = pixelX0; x <= pixelX1; x++)
+            {
+                if (nearestDepth >= depthBuffer[y * culler.GetWidth() + x])
+                    return true;
+            }
+        }
+        return false;
+    }
+}
+
+TEST(DepthMatchesReferenceRasterizer)
+{
+    for (uint32_t occluderCount : { 20u, 400u })
+    {
+        Scene scene = MakeScene(occluderCount, 0, false, occluderCount);
+        OcclusionCuller culler;
+        culler.Init();
+        culler.SetSimdPath(OcclusionSimdPath::Scalar);
+        Render(culler, scene, nullptr);
+
+        vector<float> reference = RasterizeReference(scene, culler.GetWidth(), culler.GetHeight());
+        const vector<float>& depthBuffer = culler.GetDepthBuffer();
+
+        // 덮인 픽셀은 같아야 하고, 깊이는 float 평면 보간과 double 무게중심 보간의 차이만큼만 다를 수 있다
+        uint32_t coverageDiffs = 0;
+        uint32_t coveredPixels = 0;
+        float maxDepthDiff = 0.0f;
+        for (size_t i = 0; i < reference.size(); i++)
+        {
+            bool covered = reference[i] > 0.0f;
+            coveredPixels += covered ? 1 : 0;
+            if (covered != (depthBuffer[i] > 0.0f))
+                coverageDiffs++;
+            else
+                maxDepthDiff = max(maxDepthDiff, fabsf(reference[i] - depthBuffer[i]));
+        }
+
+        CHECK(coveredPixels > 1000);
+        CHECK(coverageDiffs == 0);
+        CHECK(maxDepthDiff < 1e-6f);
+    }
+}
+
+TEST(PathsProduceSameDepthAndVisibility)
+{
+    Executor executor(4);
+    for (bool nearOccluders : { false, true })
+    {
+        Scene scene = MakeScene(400, 20000, nearOccluders, 7);
+
+        OcclusionCuller scalar, avx2, threaded;
+        scalar.Init();
+        avx2.Init();
+        threaded.Init();
+        scalar.SetSimdPath(OcclusionSimdPath::Scalar);
+        avx2.SetSimdPath(OcclusionSimdPath::Avx2);
+        threaded.SetSimdPath(OcclusionSimdPath::Avx2);
+        if (avx2.GetSimdPath() != OcclusionSimdPath::Avx2)
+            printf("  AVX2 not supported, comparing scalar paths only\n");
+
+        Render(scalar, scene, nullptr);
+        Render(avx2, scene, nullptr);
+        Render(threaded, scene, &executor);
+
+        uint32_t count = scene.bounds.GetCount();
+        vector<uint8_t> scalarVisible(count), avx2Visible(count), threadedVisible(count);
+        scalar.TestBounds(scene.bounds, scalarVisible.data());
+        avx2.TestBounds(scene.bounds, avx2Visible.data());
+        threaded.TestBounds(scene.bounds, threadedVisible.data(), &executor);
+
+        CHECK(scalar.GetDepthBuffer() == avx2.GetDepthBuffer());
+        CHECK(scalar.GetDepthBuffer() == threaded.GetDepthBuffer());
+        CHECK(scalarVisible == avx2Visible);
+        CHECK(scalarVisible == threadedVisible);
+        CHECK(threaded.GetStats().visibleObjects == static_cast<uint32_t>(count_if(scalarVisible.begin(), scalarVisible.end(), [](uint8_t v) { return v != 0; })));
+        CHECK(nearOccluders ? scalar.GetStats().clippedTriangles > 0 : scalar.GetStats().clippedTriangles == 0);
+    }
+}
+
+TEST(PyramidTestMatchesBruteForce)
+{
+    for (bool nearOccluders : { false, true })
+    {
+        Scene scene = MakeScene(400, 20000, nearOccluders, 11);
+        OcclusionCuller culler;
+        culler.Init();
+        Render(culler, scene, nullptr);
+
+        vector<uint8_t> visible(scene.bounds.GetCount());
+        culler.TestBounds(scene.bounds, visible.data());
+
+        uint32_t mismatches = 0;
+        uint32_t hidden = 0;
+        for (uint32_t i = 0; i < scene.bounds.GetCount(); i++)
+        {
+            mismatches += (visible[i] != 0) != IsVisibleBruteForce(culler, scene.camera, scene.bounds, i) ? 1 : 0;
+            hidden += visible[i] == 0 ? 1 : 0;
+        }
+
+        CHECK(mismatches == 0);
+        CHECK(hidden > 0);
+        CHECK(hidden < scene.bounds.GetCount());
+    }
+}
+
+TEST(WallHidesObjectsBehindIt)
+{
+    // 화면을 다 덮는 벽. 벽 뒤는 가려지고, 벽 앞과 near 평면에 걸친 물체는 보인다
+    Scene scene = {};
+    scene.camera = { 0.1f, 1.0f, 1.0f };
+    scene.occluders.push_back({ { 100, 0, 0, -50, 0, 100, 0, -50, 0, 0, 1, 10 } });
+
+    OcclusionCuller culler;
+    culler.Init();
+    Render(culler, scene, nullptr);
+
+    const float behindMin[3] = { -1, -1, 20 }, behindMax[3] = { 1, 1, 22 };
+    const float frontMin[3] = { -1, -1, 5 }, frontMax[3] = { 1, 1, 6 };
+    const float straddleMin[3] = { -1, -1, 0.05f }, straddleMax[3] = { 1, 1, 30 };
+    const float besideMin[3] = { -100, -1, 20 }, besideMax[3] = { -90, 1, 22 };
+    CHECK(!culler.IsVisible(behindMin, behindMax));
+    CHECK(culler.IsVisible(frontMin, frontMax));
+    CHECK(culler.IsVisible(straddleMin, straddleMax));
+    CHECK(!culler.IsVisible(besideMin, besideMax)); // 화면 밖
+}
+
+int main()
+{
+    return RunTests();
+}
@@ -0,0 +1,52 @@
+#include "Benchmark.h"
+#include "ParticleSimulation.h"
+
+using namespace std;
+
+// CPU 파티클 시뮬레이션의 스칼라 경로와 AVX2 경로를 비교한다
+// 방출 수 = 살아있는 수 / 평균 수명(프레임)으로 맞춰서 살아있는 파티클 수가 목표 근처에 머문 상태에서 한 프레임 Update를 잰다
+
+namespace
+{
+    const float DeltaTime = 1.0f / 60.0f;
+    const uint32_t WarmupFrames = 240; // 수명(1.5~3초)이 한 바퀴 돌 만큼
+    const uint32_t MeasuredFrames = 120;
+
+    double MeasureFrameMs(ParticleSimdPath path, uint32_t targetCount, uint32_t& aliveCount)
+    {
+        ParticleSimulation simulation;
+        simulation.Reset(targetCount, 1234);
+        simulation.SetSimdPath(path);
+
+        // 평균 수명 2.25초 = 135프레임
+        uint32_t emitCount = targetCount / 135 + 1;
+        for (uint32_t frame = 0; frame < WarmupFrames; frame++)
+            simulation.Update(DeltaTime, emitCount);
+
+        double totalMs = MeasureMilliseconds(3, [&]
+        {
+            for (uint32_t frame = 0; frame < MeasuredFrames; frame++)
+                simulation.Update(DeltaTime, emitCount);
+        });
+
+        aliveCount = simulation.GetCount();
+        KeepResult(simulation.GetNextId());
+        return totalMs / MeasuredFrames;
+    }
+}
+
+int main()
+{
+    bool avx2 = ParticleSimulation::IsAvx2Supported();
+    printf("AVX2 %s, %u measured frames\n", avx2 ? "supported" : "not supported", MeasuredFrames);
+    printf("%10s %10s | %10s %10s %8s\n", "target", "alive", "scalar ms", "avx2 ms", "speedup");
+
+    for (uint32_t targetCount : { 16384u, 65536u, 262144u, 1048576u })
+    {
+        uint32_t aliveCount = 0;
+        double scalarMs = MeasureFrameMs(ParticleSimdPath::Scalar, targetCount, aliveCount);
+        double avx2Ms = avx2 ? MeasureFrameMs(ParticleSimdPath::Avx2, targetCount, aliveCount) : 0.0;
+        printf("%10u %10u | %10.3f %10.3f %7.2fx\n", targetCount, aliveCount, scalarMs, avx2Ms, avx2 ? scalarMs / avx2Ms : 0.0);
+    }
+    return 0;
+}
@@ -0,0 +1,113 @@
+#include "ParticleSimulation.h"
+#include "TestCheck.h"
+#include <cstring>
+
+using namespace std;
+
+namespace
+{
+    // 프레임마다 dt와 방출 수를 바꿔서 마지막 8개 묶음이 꽉 차지 않는 경우와 capacity가 꽉 찬 경우를 모두 지나가게 한다
+    float GetDeltaTime(uint32_t step)
+    {
+        return (1.0f / 60.0f) * (1.0f + 0.25f * static_cast<float>(step % 5));
+    }
+
+    uint32_t GetEmitCount(uint32_t step)
+    {
+        return 150 + (step % 11) * 37;
+    }
+
+    vector<GpuParticle> Read(const ParticleSimulation& simulation)
+    {
+        vector<GpuParticle> particles(simulation.GetCount());
+        simulation.Write(particles.data());
+        return particles;
+    }
+
+    bool BitEqual(const vector<GpuParticle>& a, const vector<GpuParticle>& b)
+    {
+        return a.size() == b.size() && (a.empty() || memcmp(a.data(), b.data(), a.size() * sizeof(GpuParticle)) == 0);
+    }
+}
+
+TEST(ScalarMatchesPerParticleReference)
+{
+    // SimulateParticle/EmitParticle을 한 파티클씩 부른 결과와 같은지 본다. GPU 셰이더가 따르는 기준이다
+    const uint32_t capacity = 1001;
+    const uint32_t seed = 77;
+    ParticleSimulation simulation;
+    simulation.Reset(capacity, seed);
+    simulation.SetSimdPath(ParticleSimdPath::Scalar);
+
+    vector<GpuParticle> reference;
+    uint32_t nextId = 0;
+    uint32_t mismatchedSteps = 0;
+    for (uint32_t step = 0; step < 400; step++)
+    {
+        float deltaTime = GetDeltaTime(step);
+        uint32_t emitCount = GetEmitCount(step) / 10;
+
+        vector<GpuParticle> alive;
+        for (GpuParticle particle : reference)
+        {
+            if (ParticleSimulation::SimulateParticle(particle, deltaTime))
+                alive.push_back(particle);
+        }
+        for (uint32_t i = 0; i < emitCount && alive.size() < capacity; i++)
+        {
+            GpuParticle particle;
+            ParticleSimulation::EmitParticle(nextId + i, seed, particle);
+            alive.push_back(particle);
+        }
+        nextId += emitCount;
+        reference.swap(alive);
+
+        simulation.Update(deltaTime, emitCount);
+        mismatchedSteps += BitEqual(Read(simulation), reference) ? 0 : 1;
+    }
+
+    CHECK(mismatchedSteps == 0);
+    CHECK(simulation.GetNextId() == nextId);
+    CHECK(simulation.GetCount() == capacity); // 방출이 수명보다 빨라서 도중에 꽉 찬다
+}
+
+TEST(Avx2IsBitExactWithScalar)
+{
+    if (!ParticleSimulation::IsAvx2Supported())
+    {
+        printf("  AVX2 not supported, skipped\n");
+        return;
+    }
+
+    // 8의 배수가 아닌 capacity로 마지막 묶음의 남는 레인까지 본다
+    const uint32_t capacity = 65533;
+    ParticleSimulation scalar;
+    ParticleSimulation avx2;
+    scalar.Reset(capacity, 1234);
+    avx2.Reset(capacity, 1234);
+    scalar.SetSimdPath(ParticleSimdPath::Scalar);
+    avx2.SetSimdPath(ParticleSimdPath::Avx2);
+    CHECK(avx2.GetSimdPath() == ParticleSimdPath::Avx2);
+
+    uint32_t mismatchedSteps = 0;
+    uint32_t fullSteps = 0;
+    for (uint32_t step = 0; step < 1000; step++)
+    {
+        float deltaTime = GetDeltaTime(step);
+        uint32_t emitCount = step < 500 ? GetEmitCount(step) * 4 : 0;
+        scalar.Update(deltaTime, emitCount);
+        avx2.Update(deltaTime, emitCount);
+
+        mismatchedSteps += BitEqual(Read(scalar), Read(avx2)) ? 0 : 1;
+        fullSteps += scalar.GetCount() == capacity ? 1 : 0;
+    }
+
+    CHECK(mismatchedSteps == 0);
+    CHECK(fullSteps > 0);
+    CHECK(scalar.GetCount() == 0); // 방출을 멈추면 모두 수명이 다한다
+}
+
+int main()
+{
+    return RunTests();
+}
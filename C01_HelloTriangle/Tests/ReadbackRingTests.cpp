@@ -0,0 +1,232 @@
+#include "ReadbackRing.h"
+#include "TestCheck.h"
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+using namespace std;
+
+namespace
+{
+    // GPU 대신 CPU에서 값을 올리는 fence. 복사는 lag 프레임 뒤에 끝난다고 본다
+    struct FakeFence
+    {
+        uint64_t completedValue = 0;
+    };
+}
+
+TEST(SlotWaitsForFenceBeforeRetire)
+{
+    ReadbackRing ring(2);
+    FakeFence fence;
+    vector<ReadbackRing::RetiredSlot> retired;
+
+    uint32_t slot = ring.Acquire(10);
+    CHECK(slot == 0);
+    CHECK(ring.GetState(slot) == ReadbackRing::SlotState::Copying);
+
+    // Submit 전에는 fence가 어디에 있어도 꺼내지 않는다
+    fence.completedValue = 1000;
+    ring.Retire(fence.completedValue, retired);
+    CHECK(retired.empty());
+
+    fence.completedValue = 4;
+    ring.Submit(slot, 5);
+    ring.Retire(fence.completedValue, retired);
+    CHECK(retired.empty());
+
+    fence.completedValue = 5;
+    ring.Retire(fence.completedValue, retired);
+    CHECK(retired.size() == 1);
+    CHECK(retired[0].slot == slot);
+    CHECK(retired[0].frameNumber == 10);
+    CHECK(ring.GetState(slot) == ReadbackRing::SlotState::Encoding);
+
+    ring.Release(slot);
+    CHECK(ring.GetState(slot) == ReadbackRing::SlotState::Free);
+}
+
+TEST(FullRingDropsFrames)
+{
+    ReadbackRing ring(2);
+    CHECK(ring.Acquire(1) == 0);
+    CHECK(ring.Acquire(2) == 1);
+    CHECK(ring.Acquire(3) == ReadbackRing::InvalidSlot);
+
+    ReadbackRing::Stats stats = ring.GetStats();
+    CHECK(stats.droppedCount == 1);
+
+    // 다음 차례 슬롯이 비어야 다시 받는다. 순서를 건너뛰지 않는다
+    ring.Submit(0, 1);
+    ring.Submit(1, 2);
+    vector<ReadbackRing::RetiredSlot> retired;
+    ring.Retire(2, retired);
+    ring.Release(1);
+    CHECK(ring.Acquire(4) == ReadbackRing::InvalidSlot);
+    ring.Release(0);
+    CHECK(ring.Acquire(5) == 0);
+}
+
+TEST(DiscardedSlotsAreReusable)
+{
+    // FrameCapture::Poll에서 Map이 실패하면 꺼낸 슬롯을 모두 Discard한다. 링이 막히지 않아야 한다
+    ReadbackRing ring(2);
+    ring.Submit(ring.Acquire(1), 1);
+    ring.Submit(ring.Acquire(2), 2);
+
+    vector<ReadbackRing::RetiredSlot> retired;
+    ring.Retire(2, retired);
+    CHECK(retired.size() == 2);
+    for (const ReadbackRing::RetiredSlot& slot : retired)
+        ring.Discard(slot.slot);
+
+    CHECK(ring.GetState(0) == ReadbackRing::SlotState::Free);
+    CHECK(ring.GetState(1) == ReadbackRing::SlotState::Free);
+    CHECK(ring.Acquire(3) == 0);
+    CHECK(ring.Acquire(4) == 1);
+
+    ReadbackRing::Stats stats = ring.GetStats();
+    CHECK(stats.discardedCount == 2);
+    CHECK(stats.releasedCount == 2);
+    CHECK(stats.droppedCount == 0);
+}
+
+TEST(FakeFenceLagKeepsOrder)
+{
+    // 복사가 2프레임 뒤에 끝나고, 인코딩에 3프레임이 걸리는 상황을 1000프레임 돌린다
+    const uint64_t copyLag = 2;
+    const uint64_t encodeFrames = 3;
+    ReadbackRing ring(4);
+    FakeFence fence;
+
+    struct Encoding
+    {
+        uint32_t slot;
+        uint64_t doneFrame;
+    };
+
+    vector<Encoding> encoding;
+    vector<ReadbackRing::RetiredSlot> retired;
+    uint64_t lastRetiredFrame = 0;
+    uint32_t outOfOrder = 0;
+    uint32_t retiredEarly = 0;
+    vector<uint64_t> submittedFence(ring.GetSlotCount(), 0);
+
+    for (uint64_t frame = 1; frame <= 1000; frame++)
+    {
+        fence.completedValue = frame > copyLag ? frame - copyLag : 0;
+
+        for (size_t i = 0; i < encoding.size();)
+        {
+            if (encoding[i].doneFrame <= frame)
+            {
+                ring.Release(encoding[i].slot);
+                encoding[i] = encoding.back();
+                encoding.pop_back();
+            }
+            else
+            {
+                i++;
+            }
+        }
+
+        retired.clear();
+        ring.Retire(fence.completedValue, retired);
+        for (const ReadbackRing::RetiredSlot& slot : retired)
+        {
+            outOfOrder += slot.frameNumber > lastRetiredFrame ? 0 : 1;
+            retiredEarly += submittedFence[slot.slot] <= fence.completedValue ? 0 : 1;
+            lastRetiredFrame = slot.frameNumber;
+            encoding.push_back({ slot.slot, frame + encodeFrames });
+        }
+
+        uint32_t slot = ring.Acquire(frame);
+        if (slot != ReadbackRing::InvalidSlot)
+        {
+            submittedFence[slot] = frame;
+            ring.Submit(slot, frame);
+        }
+    }
+
+    ReadbackRing::Stats stats = ring.GetStats();
+    CHECK(outOfOrder == 0);
+    CHECK(retiredEarly == 0);
+    CHECK(stats.capturedCount + stats.droppedCount == 1000);
+
+    // 슬롯 하나가 한 바퀴 도는 데 Acquire부터 Release까지 copyLag + encodeFrames + 1프레임쯤 걸린다
+    // 슬롯 4개로는 프레임의 절반 남짓만 잡히고 나머지는 기다리지 않고 버려야 한다
+    CHECK(stats.capturedCount > 0);
+    CHECK(stats.droppedCount > 0);
+    CHECK(stats.retiredCount <= stats.capturedCount);
+    CHECK(stats.releasedCount <= stats.retiredCount);
+    CHECK(stats.capturedCount - stats.retiredCount <= ring.GetSlotCount());
+}
+
+TEST(ReleaseFromEncoderThread)
+{
+    // 인코딩 워커 스레드가 Release하는 동안 렌더 스레드가 Acquire/Submit/Retire한다
+    ReadbackRing ring(3);
+    atomic<uint64_t> fenceValue{ 0 };
+    atomic<bool> done{ false };
+    vector<ReadbackRing::RetiredSlot> retired;
+
+    mutex queueMutex;
+    vector<uint32_t> toRelease;
+    thread encoder([&]
+    {
+        for (;;)
+        {
+            vector<uint32_t> slots;
+            {
+                lock_guard<mutex> lock(queueMutex);
+                slots.swap(toRelease);
+            }
+            for (uint32_t slot : slots)
+                ring.Release(slot);
+
+            if (slots.empty() && done)
+                return;
+
+            this_thread::yield();
+        }
+    });
+
+    for (uint64_t frame = 1; frame <= 20000; frame++)
+    {
+        fenceValue = frame - 1;
+        retired.clear();
+        ring.Retire(fenceValue, retired);
+        {
+            lock_guard<mutex> lock(queueMutex);
+            for (const ReadbackRing::RetiredSlot& slot : retired)
+                toRelease.push_back(slot.slot);
+        }
+
+        uint32_t slot = ring.Acquire(frame);
+        if (slot != ReadbackRing::InvalidSlot)
+            ring.Submit(slot, frame);
+    }
+
+    // 남은 복사를 다 끝내고 인코더가 다 놓을때까지 기다린다
+    retired.clear();
+    ring.Retire(UINT64_MAX - 1, retired);
+    {
+        lock_guard<mutex> lock(queueMutex);
+        for (const ReadbackRing::RetiredSlot& slot : retired)
+            toRelease.push_back(slot.slot);
+    }
+    done = true;
+    encoder.join();
+
+    ReadbackRing::Stats stats = ring.GetStats();
+    CHECK(stats.capturedCount + stats.droppedCount == 20000);
+    CHECK(stats.retiredCount == stats.capturedCount);
+    CHECK(stats.releasedCount == stats.retiredCount);
+    for (uint32_t slot = 0; slot < ring.GetSlotCount(); slot++)
+        CHECK(ring.GetState(slot) == ReadbackRing::SlotState::Free);
+}
+
+int main()
+{
+    return RunTests();
+}
@@ -0,0 +1,485 @@
+#include "ShadowCache.h"
+#include "TestCheck.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <random>
+
+using namespace std;
+
+namespace
+{
+    const uint32_t TilesPerSide = 8;
+
+    float Dot(const float* a, const float* b)
+    {
+        return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    }
+
+    void Cross(const float* a, const float* b, float* result)
+    {
+        result[0] = a[1] * b[2] - a[2] * b[1];
+        result[1] = a[2] * b[0] - a[0] * b[2];
+        result[2] = a[0] * b[1] - a[1] * b[0];
+    }
+
+    void Normalize(float* v)
+    {
+        float length = sqrtf(Dot(v, v));
+        for (uint32_t i = 0; i < 3; i++)
+            v[i] /= length;
+    }
+
+    // ShadowCache와 같은 규칙으로 만든 빛 공간 축
+    struct LightBasis
+    {
+        float right[3];
+        float up[3];
+    };
+
+    LightBasis MakeLightBasis(const float direction[3])
+    {
+        float forward[3] = { direction[0], direction[1], direction[2] };
+        Normalize(forward);
+
+        float reference[3] = { 0.0f, 1.0f, 0.0f };
+        if (fabsf(forward[1]) > 0.99f)
+        {
+            reference[0] = 1.0f;
+            reference[1] = 0.0f;
+        }
+
+        LightBasis basis;
+        Cross(reference, forward, basis.right);
+        Normalize(basis.right);
+        Cross(forward, basis.right, basis.up);
+        return basis;
+    }
+
+    ShadowCacheDesc MakeDesc(uint32_t maxStaticTilesPerFrame)
+    {
+        return { 3, { 8.0f, 24.0f, 64.0f }, TilesPerSide, maxStaticTilesPerFrame };
+    }
+
+    vector<ShadowCasterBounds> MakeStaticCasters(uint32_t count, mt19937& random)
+    {
+        uniform_real_distribution<float> position(-60.0f, 60.0f);
+        vector<ShadowCasterBounds> casters;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            float x = position(random), z = position(random);
+            casters.push_back({ { x, 0.0f, z }, { x + 1.0f, 2.0f, z + 1.0f } });
+        }
+        return casters;
+    }
+
+    uint32_t GetSlot(const ShadowTile& tile)
+    {
+        return (tile.cascade * TilesPerSide + tile.slotY) * TilesPerSide + tile.slotX;
+    }
+
+    // 모든 정적 캐스터를 투영해서 (tileX, tileY) 타일에 걸치는 것을 찾는다
+    vector<uint32_t> FindCastersBruteForce(const vector<ShadowCasterBounds>& casters, const LightBasis& basis, float tileSize, int32_t tileX, int32_t tileY)
+    {
+        vector<uint32_t> result;
+        for (uint32_t i = 0; i < casters.size(); i++)
+        {
+            const ShadowCasterBounds& bounds = casters[i];
+            float center[3], extent[3];
+            for (uint32_t k = 0; k < 3; k++)
+            {
+                center[k] = (bounds.minCorner[k] + bounds.maxCorner[k]) * 0.5f;
+                extent[k] = (bounds.maxCorner[k] - bounds.minCorner[k]) * 0.5f;
+            }
+
+            float x = Dot(center, basis.right);
+            float y = Dot(center, basis.up);
+            float extentX = fabsf(basis.right[0]) * extent[0] + fabsf(basis.right[1]) * extent[1] + fabsf(basis.right[2]) * extent[2];
+            float extentY = fabsf(basis.up[0]) * extent[0] + fabsf(basis.up[1]) * extent[1] + fabsf(basis.up[2]) * extent[2];
+            if (static_cast<int32_t>(floorf((x - extentX) / tileSize)) <= tileX && tileX <= static_cast<int32_t>(floorf((x + extentX) / tileSize)) &&
+                static_cast<int32_t>(floorf((y - extentY) / tileSize)) <= tileY && tileY <= static_cast<int32_t>(floorf((y + extentY) / tileSize)))
+                result.push_back(i);
+        }
+        return result;
+    }
+
+    // 캐시 아틀라스 한 칸에 마지막으로 그린 내용
+    struct SlotContent
+    {
+        int32_t tileX, tileY;
+        vector<uint32_t> casters;
+    };
+}
+
+TEST(CachedTilesMatchBruteForce)
+{
+    // 상한이 넉넉하면 매 프레임 모든 칸이 지금 타일의 정적 캐스터를 정확히 담고 있어야 한다
+    ShadowCacheDesc desc = MakeDesc(1000);
+    ShadowCache cache(desc);
+    mt19937 random(1);
+    uniform_real_distribution<float> position(-60.0f, 60.0f);
+    vector<ShadowCasterBounds> statics = MakeStaticCasters(300, random);
+    for (const ShadowCasterBounds& bounds : statics)
+        cache.AddStaticCaster(bounds);
+
+    float lightDirection[3] = { 0.3f, -1.0f, 0.2f };
+    cache.SetLightDirection(lightDirection);
+
+    map<uint32_t, SlotContent> atlas;
+    float camera[3] = { 0.0f, 1.0f, 0.0f };
+    uint64_t cachedDraws = 0, uncachedDraws = 0;
+    uint32_t mismatches = 0, missingCopies = 0;
+    for (uint32_t frame = 0; frame < 400; frame++)
+    {
+        if (frame % 50 == 49)
+        {
+            lightDirection[0] = position(random) / 60.0f;
+            lightDirection[2] = position(random) / 60.0f;
+            cache.SetLightDirection(lightDirection);
+        }
+        if (frame % 3 == 0)
+        {
+            uint32_t moved = random() % statics.size();
+            statics[moved].minCorner[0] += 0.3f;
+            statics[moved].maxCorner[0] += 0.3f;
+            cache.MoveStaticCaster(moved, statics[moved]);
+        }
+
+        camera[0] += 0.37f;
+        camera[2] += 0.11f;
+        vector<ShadowCasterBounds> dynamicCasters;
+        if (frame % 20 < 10)
+            dynamicCasters.push_back({ { camera[0], 0.0f, camera[2] + 3.0f }, { camera[0] + 1.0f, 1.0f, camera[2] + 4.0f } });
+
+        const ShadowSchedule& schedule = cache.Update(camera, dynamicCasters.data(), static_cast<uint32_t>(dynamicCasters.size()));
+        CHECK(cache.GetStats().pendingTiles == 0);
+        cachedDraws += cache.GetStats().staticCasterDraws;
+        uncachedDraws += cache.GetStats().uncachedCasterDraws;
+
+        for (const ShadowTile& tile : schedule.staticTiles)
+        {
+            vector<uint32_t> casters(schedule.staticCasters.begin() + tile.firstCaster, schedule.staticCasters.begin() + tile.firstCaster + tile.casterCount);
+            sort(casters.begin(), casters.end());
+            atlas[GetSlot(tile)] = { tile.tileX, tile.tileY, casters };
+        }
+
+        // cascade가 덮는 타일마다 그 칸의 내용을 전수 검사와 비교한다
+        LightBasis basis = MakeLightBasis(lightDirection);
+        int32_t side = static_cast<int32_t>(TilesPerSide);
+        for (uint32_t c = 0; c < desc.cascadeCount; c++)
+        {
+            float tileSize = 2.0f * desc.cascadeHalfExtents[c] / TilesPerSide;
+            int32_t originX = static_cast<int32_t>(floorf(Dot(camera, basis.right) / tileSize)) - side / 2;
+            int32_t originY = static_cast<int32_t>(floorf(Dot(camera, basis.up) / tileSize)) - side / 2;
+            for (int32_t tileY = originY; tileY < originY + side; tileY++)
+            {
+                for (int32_t tileX = originX; tileX < originX + side; tileX++)
+                {
+                    uint32_t slotX = static_cast<uint32_t>((tileX % side + side) % side);
+                    uint32_t slotY = static_cast<uint32_t>((tileY % side + side) % side);
+                    auto content = atlas.find((c * TilesPerSide + slotY) * TilesPerSide + slotX);
+                    if (content == atlas.end() || content->second.tileX != tileX || content->second.tileY != tileY ||
+                        content->second.casters != FindCastersBruteForce(statics, basis, tileSize, tileX, tileY))
+                        mismatches++;
+                }
+            }
+        }
+
+        // 덧그리는 칸은 먼저 캐시에서 복사해야 한다
+        for (const ShadowTile& tile : schedule.dynamicTiles)
+        {
+            bool copied = any_of(schedule.copyTiles.begin(), schedule.copyTiles.end(),
+                [&](const ShadowTile& copy) { return GetSlot(copy) == GetSlot(tile); });
+            missingCopies += copied ? 0 : 1;
+        }
+    }
+
+    CHECK(mismatches == 0);
+    CHECK(missingCopies == 0);
+
+    // 바뀐 타일만 다시 그리므로 매 프레임 전부 그리는 것보다 훨씬 적다
+    printf("  static caster draws: %llu cached vs %llu uncached\n", static_cast<unsigned long long>(cachedDraws), static_cast<unsigned long long>(uncachedDraws));
+    CHECK(cachedDraws * 4 < uncachedDraws);
+}
+
+TEST(BudgetSpreadsInitialFill)
+{
+    // 3 cascade x 64칸을 프레임당 16칸씩 채우면 12 프레임이 걸리고, 그 뒤로는 다시 그릴 것이 없다
+    ShadowCache cache(MakeDesc(16));
+    cache.AddStaticCaster({ { 0.0f, 0.0f, 0.0f }, { 1.0f, 2.0f, 1.0f } });
+    const float lightDirection[3] = { 0.3f, -1.0f, 0.2f };
+    cache.SetLightDirection(lightDirection);
+
+    const float camera[3] = { 0.0f, 0.0f, 0.0f };
+    uint32_t frames = 0;
+    do
+    {
+        cache.Update(camera, nullptr, 0);
+        CHECK(cache.GetStats().staticTiles <= 16);
+        frames++;
+    } while (cache.GetStats().pendingTiles > 0 && frames < 100);
+
+    CHECK(frames == 12);
+    cache.Update(camera, nullptr, 0);
+    CHECK(cache.GetStats().staticTiles == 0);
+    CHECK(cache.GetStats().copyTiles == 0);
+}
+
+TEST(CameraMoveRendersOnlyNewColumn)
+{
+    ShadowCacheDesc desc = MakeDesc(1000);
+    ShadowCache cache(desc);
+    const float lightDirection[3] = { 0.3f, -1.0f, 0.2f };
+    cache.SetLightDirection(lightDirection);
+
+    // cascade 0 타일(2m) 가운데에서 빛 공간 x로 한 타일 옮긴다. 더 큰 cascade는 타일 경계를 넘지 않는다
+    LightBasis basis = MakeLightBasis(lightDirection);
+    float camera[3];
+    for (uint32_t i = 0; i < 3; i++)
+        camera[i] = basis.right[i] + basis.up[i];
+    cache.Update(camera, nullptr, 0);
+    CHECK(cache.GetStats().staticTiles == cache.GetStats().totalTiles);
+
+    for (uint32_t i = 0; i < 3; i++)
+        camera[i] += basis.right[i] * 2.0f;
+    const ShadowSchedule& schedule = cache.Update(camera, nullptr, 0);
+
+    // 새로 들어온 오른쪽 한 줄만 그리고, 빠진 왼쪽 줄 자리를 그대로 쓴다
+    CHECK(schedule.staticTiles.size() == TilesPerSide);
+    for (const ShadowTile& tile : schedule.staticTiles)
+    {
+        CHECK(tile.cascade == 0);
+        CHECK(tile.tileX == 1 - static_cast<int32_t>(TilesPerSide / 2) + static_cast<int32_t>(TilesPerSide) - 1);
+        CHECK(cache.IsSlotRendered(0, tile.slotX, tile.slotY));
+    }
+    CHECK(schedule.copyTiles.size() == TilesPerSide);
+}
+
+TEST(LightChangeInvalidatesAllTiles)
+{
+    ShadowCache cache(MakeDesc(1000));
+    mt19937 random(2);
+    for (const ShadowCasterBounds& bounds : MakeStaticCasters(50, random))
+        cache.AddStaticCaster(bounds);
+
+    const float lightDirection[3] = { 0.3f, -1.0f, 0.2f };
+    const float camera[3] = { 0.0f, 0.0f, 0.0f };
+    cache.SetLightDirection(lightDirection);
+    cache.Update(camera, nullptr, 0);
+    uint64_t invalidations = cache.GetStats().lightInvalidations;
+
+    // 같은 방향을 다시 주면 아무것도 더럽히지 않는다
+    cache.SetLightDirection(lightDirection);
+    cache.Update(camera, nullptr, 0);
+    CHECK(cache.GetStats().staticTiles == 0);
+    CHECK(cache.GetStats().lightInvalidations == invalidations);
+
+    const float newDirection[3] = { -0.5f, -1.0f, 0.1f };
+    cache.SetLightDirection(newDirection);
+    cache.Update(camera, nullptr, 0);
+    CHECK(cache.GetStats().staticTiles == cache.GetStats().totalTiles);
+    CHECK(cache.GetStats().lightInvalidations == invalidations + 1);
+}
+
+TEST(DynamicCastersAreCopiedAndCleared)
+{
+    ShadowCache cache(MakeDesc(1000));
+    const float lightDirection[3] = { 0.3f, -1.0f, 0.2f };
+    const float camera[3] = { 0.0f, 0.0f, 0.0f };
+    cache.SetLightDirection(lightDirection);
+    cache.Update(camera, nullptr, 0);
+
+    // 움직이는 캐스터가 걸친 칸은 캐시에서 복사한 뒤 덧그리고, 정적 캐시는 건드리지 않는다
+    ShadowCasterBounds mover = { { 0.5f, 0.0f, 0.5f }, { 1.0f, 1.0f, 1.0f } };
+    const ShadowSchedule& schedule = cache.Update(camera, &mover, 1);
+    CHECK(cache.GetStats().staticTiles == 0);
+    CHECK(!schedule.dynamicTiles.empty());
+    CHECK(schedule.copyTiles.size() == schedule.dynamicTiles.size());
+    CHECK(schedule.dynamicCasters.size() == schedule.dynamicTiles.size());
+    uint32_t dynamicTiles = cache.GetStats().dynamicTiles;
+
+    // 다음 프레임에 사라지면 덧그렸던 칸을 복사로 지우기만 한다
+    cache.Update(camera, nullptr, 0);
+    CHECK(cache.GetStats().dynamicTiles == 0);
+    CHECK(cache.GetStats().copyTiles == dynamicTiles);
+
+    cache.Update(camera, nullptr, 0);
+    CHECK(cache.GetStats().copyTiles == 0);
+}
+
+TEST(BudgetDrawsExposedTilesFirst)
+{
+    ShadowCache cache(MakeDesc(8));
+    const float lightDirection[3] = { 0.3f, -1.0f, 0.2f };
+    cache.SetLightDirection(lightDirection);
+
+    LightBasis basis = MakeLightBasis(lightDirection);
+    float camera[3];
+    for (uint32_t i = 0; i < 3; i++)
+        camera[i] = basis.right[i] + basis.up[i];
+    for (uint32_t frame = 0; frame < 100 && (frame == 0 || cache.GetStats().pendingTiles > 0); frame++)
+        cache.Update(camera, nullptr, 0);
+    CHECK(cache.GetStats().pendingTiles == 0);
+
+    // 모든 칸에 걸치는 캐스터를 더해서 전부 낡게 만들고, cascade 0에서 두 줄을 새로 드러낸다
+    cache.AddStaticCaster({ { -200.0f, 0.0f, -200.0f }, { 200.0f, 1.0f, 200.0f } });
+    for (uint32_t i = 0; i < 3; i++)
+        camera[i] += basis.right[i] * 4.0f;
+    const ShadowSchedule& schedule = cache.Update(camera, nullptr, 0);
+
+    // 상한 8칸은 모두 새로 드러난 칸에 쓰고, 못 그린 8칸은 샘플할 수 없다고 알린다
+    int32_t firstNewColumn = 1 - static_cast<int32_t>(TilesPerSide / 2) + static_cast<int32_t>(TilesPerSide) - 2;
+    CHECK(schedule.staticTiles.size() == 8);
+    for (const ShadowTile& tile : schedule.staticTiles)
+    {
+        CHECK(tile.cascade == 0);
+        CHECK(tile.tileX >= firstNewColumn);
+    }
+    CHECK(cache.GetStats().pendingTiles == cache.GetStats().totalTiles - 8);
+    CHECK(cache.GetStats().unsampleableTiles == 8);
+
+    uint32_t unsampleable = 0;
+    for (uint32_t y = 0; y < TilesPerSide; y++)
+    {
+        for (uint32_t x = 0; x < TilesPerSide; x++)
+        {
+            bool sampleable = cache.IsSlotSampleable(0, x, y);
+            CHECK(schedule.sampleableSlots[(0 * TilesPerSide + y) * TilesPerSide + x] == (sampleable ? 1 : 0));
+            unsampleable += sampleable ? 0 : 1;
+        }
+    }
+    CHECK(unsampleable == 8);
+
+    // 낡기만 한 칸은 샘플해도 되고, 다음 프레임에 새로 드러난 나머지를 먼저 그린다
+    for (uint32_t c = 1; c < 3; c++)
+        for (uint32_t y = 0; y < TilesPerSide; y++)
+            for (uint32_t x = 0; x < TilesPerSide; x++)
+                CHECK(cache.IsSlotSampleable(c, x, y));
+
+    cache.Update(camera, nullptr, 0);
+    CHECK(cache.GetStats().unsampleableTiles == 0);
+    for (uint32_t y = 0; y < TilesPerSide; y++)
+        for (uint32_t x = 0; x < TilesPerSide; x++)
+            CHECK(cache.IsSlotSampleable(0, x, y));
+}
+
+TEST(DeferredSlotsAreNeverSampled)
+{
+    // 상한을 계속 넘기면서 샘플할 수 있다고 한 칸이 지금 타일과 지금 빛으로 그린 내용인지 본다
+    ShadowCacheDesc desc = MakeDesc(6);
+    ShadowCache cache(desc);
+    mt19937 random(3);
+    uniform_real_distribution<float> position(-60.0f, 60.0f);
+    vector<ShadowCasterBounds> statics = MakeStaticCasters(100, random);
+    for (const ShadowCasterBounds& bounds : statics)
+        cache.AddStaticCaster(bounds);
+
+    float lightDirection[3] = { 0.3f, -1.0f, 0.2f };
+    cache.SetLightDirection(lightDirection);
+    uint32_t lightEpoch = 0;
+
+    struct DrawnTile
+    {
+        int32_t tileX, tileY;
+        uint32_t lightEpoch;
+    };
+    map<uint32_t, DrawnTile> atlas;
+
+    float camera[3] = { 0.0f, 1.0f, 0.0f };
+    uint32_t overflowFrames = 0, fallbacks = 0;
+    uint32_t wrongSamples = 0, wrongFlags = 0, hiddenWork = 0, wrongCascades = 0;
+    for (uint32_t frame = 0; frame < 300; frame++)
+    {
+        if (frame % 100 == 99)
+        {
+            lightDirection[0] = position(random) / 60.0f;
+            cache.SetLightDirection(lightDirection);
+            lightEpoch++;
+        }
+        if (frame % 2 == 0)
+        {
+            uint32_t moved = random() % statics.size();
+            statics[moved].minCorner[2] += 0.5f;
+            statics[moved].maxCorner[2] += 0.5f;
+            cache.MoveStaticCaster(moved, statics[moved]);
+        }
+
+        // 가끔 크게 뛰어서 여러 cascade에 새 줄이 한꺼번에 드러나게 한다
+        float step = frame % 37 == 0 ? 20.0f : 0.9f;
+        camera[0] += step;
+        camera[2] += step * 0.3f;
+        ShadowCasterBounds mover = { { camera[0], 0.0f, camera[2] }, { camera[0] + 2.0f, 1.0f, camera[2] + 2.0f } };
+
+        const ShadowSchedule& schedule = cache.Update(camera, &mover, 1);
+        overflowFrames += cache.GetStats().pendingTiles > 0 ? 1 : 0;
+        fallbacks += cache.GetStats().unsampleableTiles;
+        for (const ShadowTile& tile : schedule.staticTiles)
+            atlas[GetSlot(tile)] = { tile.tileX, tile.tileY, lightEpoch };
+
+        LightBasis basis = MakeLightBasis(lightDirection);
+        int32_t side = static_cast<int32_t>(TilesPerSide);
+        for (uint32_t c = 0; c < desc.cascadeCount; c++)
+        {
+            float tileSize = 2.0f * desc.cascadeHalfExtents[c] / TilesPerSide;
+            int32_t originX = static_cast<int32_t>(floorf(Dot(camera, basis.right) / tileSize)) - side / 2;
+            int32_t originY = static_cast<int32_t>(floorf(Dot(camera, basis.up) / tileSize)) - side / 2;
+            for (int32_t tileY = originY; tileY < originY + side; tileY++)
+            {
+                for (int32_t tileX = originX; tileX < originX + side; tileX++)
+                {
+                    uint32_t slotX = static_cast<uint32_t>((tileX % side + side) % side);
+                    uint32_t slotY = static_cast<uint32_t>((tileY % side + side) % side);
+                    uint32_t slot = (c * TilesPerSide + slotY) * TilesPerSide + slotX;
+                    bool sampleable = schedule.sampleableSlots[slot] != 0;
+                    wrongFlags += sampleable == cache.IsSlotSampleable(c, slotX, slotY) ? 0 : 1;
+                    if (!sampleable)
+                        continue;
+
+                    auto content = atlas.find(slot);
+                    if (content == atlas.end() || content->second.tileX != tileX || content->second.tileY != tileY || content->second.lightEpoch != lightEpoch)
+                        wrongSamples++;
+                }
+            }
+        }
+
+        // 샘플하지 않는 칸에는 복사도 덧그리기도 하지 않는다
+        for (const ShadowTile& tile : schedule.copyTiles)
+            hiddenWork += schedule.sampleableSlots[GetSlot(tile)] ? 0 : 1;
+        for (const ShadowTile& tile : schedule.dynamicTiles)
+            hiddenWork += schedule.sampleableSlots[GetSlot(tile)] ? 0 : 1;
+
+        // 카메라 근처 점은 덮는 칸을 샘플할 수 있는 가장 가까운 cascade에서 찾는다
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            float point[3] = { camera[0] + position(random) * 0.5f, 0.0f, camera[2] + position(random) * 0.5f };
+            float lightX = Dot(point, basis.right), lightY = Dot(point, basis.up);
+            uint32_t expected = desc.cascadeCount;
+            for (uint32_t c = 0; c < desc.cascadeCount && expected == desc.cascadeCount; c++)
+            {
+                float tileSize = 2.0f * desc.cascadeHalfExtents[c] / TilesPerSide;
+                int32_t originX = static_cast<int32_t>(floorf(Dot(camera, basis.right) / tileSize)) - side / 2;
+                int32_t originY = static_cast<int32_t>(floorf(Dot(camera, basis.up) / tileSize)) - side / 2;
+                int32_t tileX = static_cast<int32_t>(floorf(lightX / tileSize));
+                int32_t tileY = static_cast<int32_t>(floorf(lightY / tileSize));
+                if (tileX < originX || tileX >= originX + side || tileY < originY || tileY >= originY + side)
+                    continue;
+
+                uint32_t slotX = static_cast<uint32_t>((tileX % side + side) % side);
+                uint32_t slotY = static_cast<uint32_t>((tileY % side + side) % side);
+                if (schedule.sampleableSlots[(c * TilesPerSide + slotY) * TilesPerSide + slotX])
+                    expected = c;
+            }
+            wrongCascades += cache.GetSampleCascade(point) == expected ? 0 : 1;
+        }
+    }
+
+    // 상한을 넘긴 프레임과 다음 cascade로 넘긴 칸이 실제로 있어야 검사가 의미 있다
+    CHECK(overflowFrames > 0);
+    CHECK(fallbacks > 0);
+    CHECK(wrongSamples == 0);
+    CHECK(wrongFlags == 0);
+    CHECK(hiddenWork == 0);
+    CHECK(wrongCascades == 0);
+}
+
+int main() { return RunTests(); }
@@ -0,0 +1,138 @@
+#include "SimulationThread.h"
+#include "TestCheck.h"
+#include "TripleBuffer.h"
+
+using namespace std;
+using namespace std::chrono;
+
+namespace
+{
+    // 필드가 모두 같은 값이어야 하는 스냅샷. 쓰는 중인 슬롯을 읽으면 값이 섞인다
+    struct Payload
+    {
+        uint64_t sequence;
+        uint64_t copies[15];
+    };
+
+    bool IsConsistent(const Payload& payload)
+    {
+        for (uint64_t copy : payload.copies)
+        {
+            if (copy != payload.sequence)
+                return false;
+        }
+        return true;
+    }
+}
+
+TEST(TripleBufferStress)
+{
+    const uint64_t publishCount = 2000000;
+    TripleBuffer<Payload> buffer;
+    atomic<bool> writerDone{ false };
+    uint64_t overwrittenCount = 0;
+
+    thread writer([&]
+    {
+        for (uint64_t sequence = 1; sequence <= publishCount; sequence++)
+        {
+            Payload& payload = buffer.GetWriteSlot();
+            payload.sequence = sequence;
+            for (uint64_t& copy : payload.copies)
+                copy = sequence;
+
+            if (buffer.Publish())
+                overwrittenCount++;
+        }
+        writerDone = true;
+    });
+
+    uint64_t acquireCount = 0;
+    uint64_t tornReads = 0;
+    uint64_t outOfOrder = 0;
+    uint64_t lastSequence = 0;
+    for (;;)
+    {
+        // writerDone을 본 뒤에 한 번 더 Acquire해야 마지막 Publish까지 가져온다
+        bool done = writerDone;
+        if (buffer.Acquire())
+        {
+            acquireCount++;
+            const Payload& payload = buffer.GetReadSlot();
+            tornReads += IsConsistent(payload) ? 0 : 1;
+            outOfOrder += payload.sequence > lastSequence ? 0 : 1;
+            lastSequence = payload.sequence;
+        }
+        else if (done)
+        {
+            break;
+        }
+    }
+    writer.join();
+
+    CHECK(tornReads == 0);
+    CHECK(outOfOrder == 0);
+    CHECK(lastSequence == publishCount);
+
+    // 내보낸 스냅샷은 읽히거나, 읽히기 전에 다음 Publish에 덮어써진다
+    CHECK(acquireCount + overwrittenCount == publishCount);
+}
+
+TEST(AcquireWithoutPublishKeepsFront)
+{
+    TripleBuffer<Payload> buffer;
+    buffer.GetWriteSlot().sequence = 7;
+    CHECK(!buffer.Publish());
+    CHECK(buffer.Acquire());
+    CHECK(buffer.GetReadSlot().sequence == 7);
+
+    CHECK(!buffer.Acquire());
+    CHECK(buffer.GetReadSlot().sequence == 7);
+
+    buffer.GetWriteSlot().sequence = 8;
+    CHECK(!buffer.Publish());
+    buffer.GetWriteSlot().sequence = 9;
+    CHECK(buffer.Publish());
+    CHECK(buffer.Acquire());
+    CHECK(buffer.GetReadSlot().sequence == 9);
+}
+
+TEST(SimulationThreadTicksAndInterpolates)
+{
+    const uint32_t ticksPerSecond = 240;
+    SimulationThread simulation(ticksPerSecond);
+    simulation.Start();
+
+    // 렌더 스레드처럼 틱보다 자주, 불규칙하게 읽는다
+    steady_clock::time_point start = steady_clock::now();
+    uint64_t lastTick = 0;
+    float lastAngle = 0.0f;
+    uint32_t backwards = 0;
+    for (int i = 0; steady_clock::now() - start < milliseconds(300); i++)
+    {
+        this_thread::sleep_for(microseconds(500 + (i % 7) * 300));
+        SimulationState state = simulation.AcquireInterpolated(steady_clock::now());
+        backwards += (state.tick < lastTick || state.angle < lastAngle) ? 1 : 0;
+        lastTick = state.tick;
+        lastAngle = state.angle;
+    }
+    simulation.Stop();
+
+    SimulationStats stats = simulation.GetStats();
+    CHECK(backwards == 0);
+    CHECK(stats.publishCount > 0);
+    CHECK(stats.tickCount >= stats.publishCount);
+
+    // 300ms면 72틱쯤이다. 밀리면 따라잡지만 MaxCatchUpTicks를 넘으면 시간을 버리므로 아래쪽은 넉넉하게 본다
+    CHECK(stats.tickCount >= 20);
+    CHECK(stats.tickCount <= 80);
+
+    // Start가 내보낸 0번 틱까지 포함해서 읽거나 덮어쓴 수가 내보낸 수를 넘지 않는다
+    CHECK(stats.acquireCount + stats.overwrittenCount <= stats.publishCount + 1);
+    CHECK(stats.maxLatencyMs >= stats.lastLatencyMs);
+}
+
+int main()
+{
+    return RunTests();
+}
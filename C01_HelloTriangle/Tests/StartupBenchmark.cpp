@@ -0,0 +1,250 @@
+#include "AsyncFileReader.h"
+#include "LodSelector.h"
+#include "MeshAsset.h"
+#include "StartupStages.h"
+#include <algorithm>
+#include <fstream>
+#include <thread>
+
+using namespace std;
+
+// MyWindow::OnInit과 같은 스테이지 그래프(AddStartupStages)를 창과 GPU 없이 돌려서 시작 시간을 잰다
+// D3D12를 부르는 스테이지는 대역이다. 드라이버나 OS를 기다리는 일은 sleep으로, 셰이더 컴파일처럼 CPU를 쓰는 일은 spin으로 흉내낸다
+// cold와 warm의 차이는 앱과 같은 두 곳에서만 생긴다
+//  - Device: adapter.cache가 없으면 어댑터마다 테스트 device를 만들어보고 고른 것을 저장한다. 있으면 바로 만든다
+//  - MeshAssets: 실제 LoadOrBuildMeshAssetsAsync를 부른다. meshes 폴더가 비었으면 단순화해서 저장하고, 있으면 읽기만 한다
+// 셰이더는 앱처럼 매번 소스를 읽어서 컴파일한다
+// 스테이지 시간의 합(stage sum)도 같이 찍어서 그래프로 겹친 만큼을 본다
+// 워커가 코어보다 많으면 spin끼리 CPU를 나눠 쓰므로 스테이지 시간이 늘어나서 합도 커진다
+
+namespace
+{
+    const int Runs = 5;
+
+    const uint32_t AdapterCount = 2;       // GetHardwareAdapter가 테스트 device를 만들어보는 어댑터 수
+    const double TestDeviceMs = 25.0;      // 어댑터 하나에 테스트 device 만들기
+    const double DeviceMs = 25.0;          // D3D12CreateDevice
+    const double ShaderCompileMs = 20.0;   // 셰이더 하나 컴파일. VS와 PS를 동시에 한다
+    const double PipelineMs = 20.0;        // 드라이버의 PSO 컴파일
+
+    void Block(double milliseconds)
+    {
+        this_thread::sleep_for(chrono::duration<double, milli>(milliseconds));
+    }
+
+    void Spin(double milliseconds)
+    {
+        auto end = chrono::steady_clock::now() + chrono::duration<double, milli>(milliseconds);
+        while (chrono::steady_clock::now() < end)
+        {
+        }
+    }
+
+    Task<bool> CompileShaderAsync(Executor& executor)
+    {
+        co_await executor.Schedule();
+        Spin(ShaderCompileMs);
+        co_return true;
+    }
+
+    class StandInStages : public IStartupStages
+    {
+        Executor& executor;
+        AsyncFileReader& fileReader;
+        filesystem::path directory; // 실행 파일 옆 폴더 대신
+
+        vector<MeshSource> meshSources;
+        vector<MeshAsset> meshAssets;
+        LodSelector lodSelector;
+
+    public:
+        bool adapterCacheHit = false;
+        vector<bool> builtMeshes;
+
+        StandInStages(Executor& executor, AsyncFileReader& fileReader, const filesystem::path& directory)
+            : executor(executor), fileReader(fileReader), directory(directory), meshSources(MakeSceneMeshSources())
+        {
+        }
+
+        bool CreateFactory() override { Block(3.0); return true; }
+
+        bool CreateDevice() override
+        {
+            // MyWindow::CreateDevice와 같은 순서다. 캐시를 못 쓰면 어댑터를 고르고 다시 저장한다
+            ifstream cache(directory / "adapter.cache", ios::binary);
+            adapterCacheHit = static_cast<bool>(cache);
+            if (!adapterCacheHit)
+            {
+                for (uint32_t i = 0; i < AdapterCount; i++)
+                    Block(TestDeviceMs);
+
+                ofstream saved(directory / "adapter.cache", ios::binary);
+                saved << "luid";
+            }
+
+            Block(DeviceMs);
+            return true;
+        }
+
+        bool CreateMainWindow() override { Block(15.0); return true; }
+        bool CreateSwapChain() override { Block(10.0); return true; }
+        bool CreateCommandList() override { Block(1.0); return true; }
+        bool CreateRootSignature() override { Spin(1.0); return true; }
+        Task<bool> LoadShadersAsync() override { return CompileShadersAsync(); }
+        bool CreatePipelineState() override { Spin(PipelineMs); return true; }
+        bool CreateVertexBuffer() override { Block(1.0); return true; }
+        Task<bool> LoadParticleShadersAsync() override { return CompileShadersAsync(); }
+        bool CreateParticles() override { Block(3.0); return true; }
+        Task<bool> LoadClusteredLightingShadersAsync() override { return CompileShadersAsync(); }
+        bool CreateClusteredLighting() override { Block(3.0); return true; }
+        Task<bool> LoadDebugDrawShadersAsync() override { return CompileShadersAsync(); }
+        bool CreateDebugDraw() override { Block(2.0); return true; }
+        bool CreateFrameCapture() override { Block(2.0); return true; }
+
+        Task<bool> LoadMeshAssetsAsync() override
+        {
+            return LoadOrBuildMeshAssetsAsync(executor, directory / "meshes", meshSources, meshAssets, builtMeshes);
+        }
+
+        bool CreateLodInstances() override
+        {
+            lodSelector.SetMesh(meshAssets[0]);
+            return true;
+        }
+
+        bool CreateOcclusionCulling() override { Spin(5.0); return true; }
+        bool CreateShadowCache() override { Spin(5.0); return true; }
+        bool RegisterCommandObjects() override { Spin(0.5); return true; }
+        bool CreateSharedContext() override { Spin(0.5); return true; }
+        bool WaitForGpu() override { Block(5.0); return true; }
+
+    private:
+        // MyWindow::CompileShadersAsync처럼 소스를 읽고 VS와 PS를 워커에서 동시에 컴파일한다
+        Task<bool> CompileShadersAsync()
+        {
+            FileReadResult source = co_await fileReader.ReadAsync(directory / "shaders.hlsl");
+            if (!source.succeeded)
+                co_return false;
+
+            vector<Task<bool>> compileTasks;
+            compileTasks.push_back(CompileShaderAsync(executor));
+            compileTasks.push_back(CompileShaderAsync(executor));
+            vector<bool> results = co_await WhenAll(move(compileTasks));
+            co_return all_of(results.begin(), results.end(), [](bool succeeded) { return succeeded; });
+        }
+    };
+
+    bool WriteFile(const filesystem::path& path, size_t size)
+    {
+        ofstream file(path, ios::binary);
+        vector<char> bytes(size, 0x5a);
+        file.write(bytes.data(), bytes.size());
+        return file.good();
+    }
+
+    // cold면 지난 시작이 남긴 캐시를 지운다
+    void ClearCaches(const filesystem::path& directory)
+    {
+        filesystem::remove(directory / "adapter.cache");
+        filesystem::remove_all(directory / "meshes");
+    }
+
+    struct ScenarioResult
+    {
+        double medianMs;
+        double stageSumMs;
+        bool succeeded;
+        bool adapterCacheHit;
+        uint32_t builtMeshCount;
+        string report;
+    };
+
+    // report를 주면 마지막 실행의 스테이지 표와 캐시 상태를 채운다
+    bool RunOnce(uint32_t workerCount, const filesystem::path& directory, double& totalMs, ScenarioResult* report)
+    {
+        Executor executor(workerCount);
+        AsyncFileReader fileReader(executor);
+        StandInStages stages(executor, fileReader, directory);
+        StartupGraph graph;
+        AddStartupStages(graph, stages);
+
+        bool succeeded = graph.Run(executor);
+        if (report)
+        {
+            report->stageSumMs = 0.0;
+            for (const StageTiming& timing : graph.GetTimings())
+                report->stageSumMs += timing.endMs - timing.startMs;
+
+            report->adapterCacheHit = stages.adapterCacheHit;
+            report->builtMeshCount = static_cast<uint32_t>(count(stages.builtMeshes.begin(), stages.builtMeshes.end(), true));
+            report->report = graph.FormatReport();
+        }
+
+        totalMs = graph.GetTotalMs();
+        return succeeded;
+    }
+
+    ScenarioResult RunScenario(uint32_t workerCount, const filesystem::path& directory, bool warm)
+    {
+        ScenarioResult result = {};
+        result.succeeded = true;
+
+        // warm은 한 번 cold로 시작해서 캐시를 채워 둔다
+        double totalMs = 0.0;
+        if (warm)
+        {
+            ClearCaches(directory);
+            result.succeeded = RunOnce(workerCount, directory, totalMs, nullptr);
+        }
+
+        vector<double> totals;
+        for (int run = 0; run < Runs; run++)
+        {
+            if (!warm)
+                ClearCaches(directory);
+
+            result.succeeded = RunOnce(workerCount, directory, totalMs, run == Runs - 1 ? &result : nullptr) && result.succeeded;
+            totals.push_back(totalMs);
+        }
+
+        sort(totals.begin(), totals.end());
+        result.medianMs = totals[totals.size() / 2];
+        return result;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    // -v를 주면 마지막 실행의 스테이지별 표도 찍는다
+    bool verbose = argc > 1 && string(argv[1]) == "-v";
+
+    filesystem::path directory = filesystem::temp_directory_path() / "startup_benchmark";
+    filesystem::create_directories(directory);
+    if (!WriteFile(directory / "shaders.hlsl", 16 * 1024))
+    {
+        printf("failed to write stand-in files in %s\n", directory.string().c_str());
+        return 1;
+    }
+
+    bool succeeded = true;
+    printf("median of %d runs\n", Runs);
+    printf("%-6s %8s | %10s %10s %8s | %-8s %s\n", "start", "workers", "graph ms", "stage sum", "overlap", "adapter", "meshes built");
+
+    const uint32_t workerCounts[] = { 2, 4, max(1u, thread::hardware_concurrency()) };
+    for (uint32_t workerCount : workerCounts)
+    {
+        for (bool warm : { false, true })
+        {
+            ScenarioResult result = RunScenario(workerCount, directory, warm);
+            succeeded = succeeded && result.succeeded;
+
+            printf("%-6s %8u | %10.2f %10.2f %7.2fx | %-8s %u\n", warm ? "warm" : "cold", workerCount, result.medianMs, result.stageSumMs,
+                result.stageSumMs / result.medianMs, result.adapterCacheHit ? "cached" : "probed", result.builtMeshCount);
+            if (verbose)
+                printf("%s\n", result.report.c_str());
+        }
+    }
+
+    filesystem::remove_all(directory);
+    return succeeded ? 0 : 1;
+}
@@ -0,0 +1,119 @@
+#include "StartupGraph.h"
+#include "TestCheck.h"
+#include <atomic>
+#include <stdexcept>
+
+using namespace std;
+
+namespace
+{
+    Task<bool> ThrowAsync(Executor& executor)
+    {
+        co_await executor.Schedule();
+        throw runtime_error("async stage failed");
+    }
+
+    Task<bool> SucceedAsync(Executor& executor)
+    {
+        co_await executor.Schedule();
+        co_return true;
+    }
+}
+
+TEST(AwaitingEmptyTaskThrows)
+{
+    bool threw = false;
+    try
+    {
+        SyncWait(Task<bool>());
+    }
+    catch (const logic_error&)
+    {
+        threw = true;
+    }
+    CHECK(threw);
+
+    // 옮겨 간 태스크도 빈 태스크다
+    Executor executor(1);
+    Task<bool> task = SucceedAsync(executor);
+    Task<bool> moved = move(task);
+    threw = false;
+    try
+    {
+        SyncWait(move(task));
+    }
+    catch (const logic_error&)
+    {
+        threw = true;
+    }
+    CHECK(threw);
+    CHECK(SyncWait(move(moved)));
+}
+
+TEST(DependentsRunAfterDependencies)
+{
+    Executor executor(4);
+    StartupGraph graph;
+    atomic<int> order{ 0 };
+    int firstOrder = -1;
+    int secondOrder = -1;
+
+    auto first = graph.AddStage("First", StageThread::Worker, {}, [&] { firstOrder = order++; return true; });
+    graph.AddStage("Second", StageThread::Main, { first }, [&] { secondOrder = order++; return true; });
+
+    CHECK(graph.Run(executor));
+    CHECK(firstOrder == 0);
+    CHECK(secondOrder == 1);
+}
+
+TEST(ThrowingStageFailsWithoutHanging)
+{
+    Executor executor(2);
+    StartupGraph graph;
+    bool dependentRan = false;
+
+    auto throwing = graph.AddStage("Throwing", StageThread::Worker, {}, []() -> bool { throw runtime_error("stage failed"); });
+    auto independent = graph.AddStage("Independent", StageThread::Worker, {}, [] { return true; });
+    auto dependent = graph.AddStage("Dependent", StageThread::Main, { throwing }, [&] { dependentRan = true; return true; });
+
+    CHECK(!graph.Run(executor));
+    CHECK(graph.GetTiming(throwing).ran);
+    CHECK(!graph.GetTiming(throwing).succeeded);
+    CHECK(graph.GetTiming(independent).succeeded);
+    CHECK(!graph.GetTiming(dependent).ran);
+    CHECK(!dependentRan);
+}
+
+TEST(ThrowingAsyncStageFailsWithoutHanging)
+{
+    Executor executor(2);
+    StartupGraph graph;
+
+    auto throwing = graph.AddAsyncStage("ThrowingAsync", StageThread::Worker, {}, [&] { return ThrowAsync(executor); });
+    auto succeeding = graph.AddAsyncStage("SucceedingAsync", StageThread::Worker, {}, [&] { return SucceedAsync(executor); });
+    auto dependent = graph.AddStage("Dependent", StageThread::Worker, { throwing, succeeding }, [] { return true; });
+
+    CHECK(!graph.Run(executor));
+    CHECK(!graph.GetTiming(throwing).succeeded);
+    CHECK(graph.GetTiming(succeeding).succeeded);
+    CHECK(!graph.GetTiming(dependent).ran);
+    CHECK(graph.FormatReport().find("FAILED") != string::npos);
+}
+
+TEST(ThrowingMainStageFailsWithoutHanging)
+{
+    Executor executor(2);
+    StartupGraph graph;
+
+    auto throwing = graph.AddStage("ThrowingMain", StageThread::Main, {}, []() -> bool { throw runtime_error("window failed"); });
+    auto dependent = graph.AddStage("Dependent", StageThread::Worker, { throwing }, [] { return true; });
+
+    CHECK(!graph.Run(executor));
+    CHECK(!graph.GetTiming(throwing).succeeded);
+    CHECK(!graph.GetTiming(dependent).ran);
+}
+
+int main()
+{
+    return RunTests();
+}
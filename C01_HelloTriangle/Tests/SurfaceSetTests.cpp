@@ -0,0 +1,146 @@
+#include "SurfaceSet.h"
+#include "TestCheck.h"
+#include <cstdio>
+
+using namespace std;
+
+namespace
+{
+    const uint32_t SurfaceWidth = 1280;
+    const uint32_t SurfaceHeight = 720;
+    const uint32_t BufferCount = 2;
+    const uint32_t DescriptorSize = 32;
+    const ResourceId SurfaceResource = 10;
+
+    // MyWindow::OnRender와 같은 순서로 부른다. 주 창 패스 뒤에 추가 창 패스를 붙이고, Submit 뒤에 Present한다
+    bool RenderFrames(SurfaceSet& surfaces, CommandStreamWriter& writer, uint32_t frameCount)
+    {
+        FrameGraph frameGraph;
+        for (uint64_t frame = 0; frame < frameCount; frame++)
+        {
+            uint32_t frameSlot = static_cast<uint32_t>(frame % BufferCount);
+            writer.BeginFrame(frame);
+            frameGraph.BeginFrame();
+            frameGraph.AddPass("Particles", QueueType::Compute, {}, { 1 });
+            frameGraph.AddPass("Triangle", QueueType::Graphics, { 1 }, { 2 });
+            writer.DrawInstanced(3, 1, 0, 0);
+
+            if (!surfaces.Record(frameGraph, writer, frame, frameSlot))
+                return false;
+
+            frameGraph.Compile();
+            if (!frameGraph.Submit(writer))
+                return false;
+
+            writer.Present(1);
+            if (!surfaces.Present())
+                return false;
+
+            writer.Signal(QueueType::Graphics, frameGraph.ReserveFenceValue(QueueType::Graphics));
+        }
+
+        return true;
+    }
+}
+
+TEST(SurfacesShareOneGraphicsSubmission)
+{
+    const uint32_t frames = 60;
+    for (uint32_t surfaceCount = 0; surfaceCount <= 3; surfaceCount++)
+    {
+        NullSurfaceBackend backend(BufferCount, DescriptorSize);
+        SurfaceSet surfaces(backend, SurfaceResource);
+        for (uint32_t i = 0; i < surfaceCount; i++)
+            CHECK(surfaces.AddSurface(SurfaceWidth, SurfaceHeight, { 1, 1 }) == i);
+
+        CommandStreamWriter writer;
+        CHECK(RenderFrames(surfaces, writer, frames));
+
+        // 창이 몇 개든 그래픽스 큐는 프레임마다 ExecuteCommandLists 한 번이다
+        CHECK(writer.GetSubmissionCount(QueueType::Graphics) == frames);
+        CHECK(writer.GetCommandCount(CommandType::ExecutePass) == frames * (2 + surfaceCount));
+        CHECK(writer.GetCommandCount(CommandType::External) == frames * surfaceCount);
+        CHECK(backend.GetRecordCount() == frames * surfaceCount);
+        CHECK(backend.GetPresentCount() == frames * surfaceCount);
+
+        // 창 하나에 백 버퍼 BufferCount개와 RTV 칸만 더 든다
+        uint64_t surfaceBytes = surfaceCount > 0 ? surfaces.GetMemory(0).GetTotal() : 0;
+        for (uint32_t i = 0; i < surfaceCount; i++)
+            CHECK(surfaces.GetMemory(i).GetTotal() == surfaceBytes);
+        CHECK(surfaces.GetTotalMemory() == surfaceBytes * surfaceCount);
+        printf("  %u windows: %llu submissions, %.2f MB per window, %.2f MB total\n", surfaceCount,
+            static_cast<unsigned long long>(writer.GetSubmissionCount(QueueType::Graphics)),
+            surfaceBytes / (1024.0 * 1024.0), surfaces.GetTotalMemory() / (1024.0 * 1024.0));
+    }
+}
+
+TEST(SurfaceMemoryUsesPlacementAlignment)
+{
+    NullSurfaceBackend backend(BufferCount, DescriptorSize);
+    SurfaceSet surfaces(backend, SurfaceResource);
+    CHECK(surfaces.AddSurface(SurfaceWidth, SurfaceHeight, { 1, 1 }) == 0);
+    CHECK(surfaces.AddSurface(1, 1, { 1, 1 }) == 1);
+
+    // 1280x720x4 바이트는 64KB 단위로 올림하면 57칸이다
+    CHECK(surfaces.GetMemory(0).backBufferBytes == 57ull * 64 * 1024 * BufferCount);
+    CHECK(surfaces.GetMemory(0).descriptorBytes == DescriptorSize * BufferCount);
+    CHECK(surfaces.GetMemory(1).backBufferBytes == 64ull * 1024 * BufferCount);
+}
+
+TEST(FrameIntervalSkipsFrames)
+{
+    const uint32_t frames = 60;
+    NullSurfaceBackend backend(BufferCount, DescriptorSize);
+    SurfaceSet surfaces(backend, SurfaceResource);
+    for (uint32_t i = 0; i < 4; i++)
+        CHECK(surfaces.AddSurface(SurfaceWidth, SurfaceHeight, { 1, i + 1 }) == i);
+    // 0은 매 프레임으로 본다
+    CHECK(surfaces.AddSurface(SurfaceWidth, SurfaceHeight, { 0, 0 }) == 4);
+
+    CommandStreamWriter writer;
+    CHECK(RenderFrames(surfaces, writer, frames));
+
+    const uint64_t expected[] = { 60, 30, 20, 15, 60 };
+    uint64_t recorded = 0;
+    for (uint32_t i = 0; i < surfaces.GetSurfaceCount(); i++)
+    {
+        CHECK(surfaces.GetStats(i).recordedFrames == expected[i]);
+        CHECK(surfaces.GetStats(i).presentedFrames == expected[i]);
+        CHECK(surfaces.GetStats(i).notReadyFrames == 0);
+        recorded += expected[i];
+    }
+
+    // 건너뛴 창이 있어도 제출 횟수는 그대로다
+    CHECK(writer.GetSubmissionCount(QueueType::Graphics) == frames);
+    CHECK(writer.GetCommandCount(CommandType::ExecutePass) == frames * 2 + recorded);
+}
+
+TEST(NotReadySurfacesSkipTheirTurn)
+{
+    const uint32_t frames = 60;
+    NullSurfaceBackend backend(BufferCount, DescriptorSize, /*readyInterval*/ 3);
+    SurfaceSet surfaces(backend, SurfaceResource);
+    CHECK(surfaces.AddSurface(SurfaceWidth, SurfaceHeight, { 1, 1 }) == 0);
+    CHECK(surfaces.AddSurface(SurfaceWidth, SurfaceHeight, { 1, 2 }) == 1);
+
+    CommandStreamWriter writer;
+    CHECK(RenderFrames(surfaces, writer, frames));
+
+    // 차례가 온 프레임에만 물어보고, 세 번에 한 번만 준비됐다고 답한다
+    CHECK(surfaces.GetStats(0).recordedFrames == 20);
+    CHECK(surfaces.GetStats(0).notReadyFrames == 40);
+    CHECK(surfaces.GetStats(1).recordedFrames == 10);
+    CHECK(surfaces.GetStats(1).notReadyFrames == 20);
+
+    // 준비 안 된 창은 기록도 Present도 하지 않는다
+    CHECK(surfaces.GetStats(0).presentedFrames == 20);
+    CHECK(surfaces.GetStats(1).presentedFrames == 10);
+    CHECK(backend.GetRecordCount() == 30);
+    CHECK(backend.GetPresentCount() == 30);
+    CHECK(writer.GetSubmissionCount(QueueType::Graphics) == frames);
+}
+
+int main()
+{
+    return RunTests();
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdio>
+#include <vector>
+
+// D3D12 없이 도는 테스트 실행 파일들이 같이 쓰는 등록/확인 매크로
+// TEST로 만든 함수를 RunTests가 차례로 부르고, CHECK가 실패하면 위치를 찍고 개수를 센다
+
+struct TestCase
+{
+    const char* name;
+    void (*function)();
+};
+
+inline std::vector<TestCase>& GetTestCases()
+{
+    static std::vector<TestCase> testCases;
+    return testCases;
+}
+
+inline int& GetFailureCount()
+{
+    static int failureCount = 0;
+    return failureCount;
+}
+
+inline bool RegisterTest(const char* name, void (*function)())
+{
+    GetTestCases().push_back({ name, function });
+    return true;
+}
+
+#define TEST(name) \
+    static void name(); \
+    static const bool name##Registered = RegisterTest(#name, name); \
+    static void name()
+
+#define CHECK(condition) \
+    do \
+    { \
+        if (!(condition)) \
+        { \
+            std::printf("  %s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            GetFailureCount()++; \
+        } \
+    } while (0)
+
+// 실패가 하나라도 있으면 1을 돌려주므로 main에서 그대로 돌려주면 ctest가 실패로 본다
+inline int RunTests()
+{
+    for (const TestCase& testCase : GetTestCases())
+    {
+        int failuresBefore = GetFailureCount();
+        testCase.function();
+        std::printf("[%s] %s\n", GetFailureCount() == failuresBefore ? "pass" : "FAIL", testCase.name);
+    }
+
+    std::printf("%zu tests, %d failed checks\n", GetTestCases().size(), GetFailureCount());
+    return GetFailureCount() == 0 ? 0 : 1;
+}
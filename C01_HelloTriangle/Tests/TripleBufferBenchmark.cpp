@@ -0,0 +1,184 @@
+#include "Benchmark.h"
+#include "SimulationThread.h"
+#include "TripleBuffer.h"
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+// SimulationThread가 쓰는 트리플 버퍼를 뮤텍스로 복사하는 버퍼와 비교한다
+//  - throughput: 쓰는 쪽이 쉬지 않고 Publish하고 읽는 쪽은 쉬지 않고 Acquire한다. Publish 하나당 ns
+//  - latency: 쓰는 쪽이 일정 간격으로 Publish하고 읽는 쪽이 돌면서 기다린다. Publish에서 Acquire까지 걸린 시간의 분포
+
+namespace
+{
+    const uint64_t ThroughputPublishes = 2000000;
+    const uint32_t LatencySamples = 20000;
+    const microseconds LatencyInterval(50);
+
+    // 뮤텍스 안에서 스냅샷을 통째로 복사해서 넘기는 버퍼. TripleBuffer와 같은 모양으로 쓴다
+    template<typename T>
+    class MutexBuffer
+    {
+        mutex bufferMutex;
+        T shared;
+        bool dirty = false;
+        T back;
+        T front;
+
+    public:
+        T& GetWriteSlot() { return back; }
+
+        bool Publish()
+        {
+            lock_guard<mutex> lock(bufferMutex);
+            bool overwritten = dirty;
+            shared = back;
+            dirty = true;
+            return overwritten;
+        }
+
+        bool Acquire()
+        {
+            lock_guard<mutex> lock(bufferMutex);
+            if (!dirty)
+                return false;
+
+            front = shared;
+            dirty = false;
+            return true;
+        }
+
+        const T& GetReadSlot() const { return front; }
+    };
+
+    struct ThroughputResult
+    {
+        double nsPerPublish;
+        uint64_t acquired;
+        uint64_t overwritten;
+    };
+
+    template<typename Buffer>
+    ThroughputResult MeasureThroughput()
+    {
+        Buffer buffer;
+        atomic<bool> writerDone{ false };
+        uint64_t overwritten = 0;
+        uint64_t acquired = 0;
+
+        steady_clock::time_point start = steady_clock::now();
+        thread writer([&]
+        {
+            for (uint64_t i = 1; i <= ThroughputPublishes; i++)
+            {
+                SimulationSnapshot& snapshot = buffer.GetWriteSlot();
+                snapshot.current.tick = i;
+                snapshot.previous.tick = i - 1;
+                overwritten += buffer.Publish() ? 1 : 0;
+            }
+            writerDone = true;
+        });
+
+        uint64_t checksum = 0;
+        for (;;)
+        {
+            bool done = writerDone;
+            if (buffer.Acquire())
+            {
+                acquired++;
+                checksum += buffer.GetReadSlot().current.tick;
+            }
+            else if (done)
+            {
+                break;
+            }
+        }
+        writer.join();
+        double elapsedNs = duration<double, nano>(steady_clock::now() - start).count();
+
+        KeepResult(checksum);
+        return { elapsedNs / ThroughputPublishes, acquired, overwritten };
+    }
+
+    struct LatencyResult
+    {
+        double p50Us;
+        double p99Us;
+        double maxUs;
+    };
+
+    template<typename Buffer>
+    LatencyResult MeasureLatency()
+    {
+        Buffer buffer;
+        atomic<bool> writerDone{ false };
+
+        thread writer([&]
+        {
+            steady_clock::time_point next = steady_clock::now();
+            for (uint32_t i = 1; i <= LatencySamples; i++)
+            {
+                next += LatencyInterval;
+                while (steady_clock::now() < next)
+                {
+                }
+
+                SimulationSnapshot& snapshot = buffer.GetWriteSlot();
+                snapshot.current.tick = i;
+                snapshot.publishTime = steady_clock::now();
+                buffer.Publish();
+            }
+            writerDone = true;
+        });
+
+        vector<double> latencies;
+        latencies.reserve(LatencySamples);
+        for (;;)
+        {
+            bool done = writerDone;
+            if (buffer.Acquire())
+            {
+                steady_clock::time_point now = steady_clock::now();
+                latencies.push_back(duration<double, micro>(now - buffer.GetReadSlot().publishTime).count());
+            }
+            else if (done)
+            {
+                break;
+            }
+        }
+        writer.join();
+
+        sort(latencies.begin(), latencies.end());
+        if (latencies.empty())
+            return {};
+
+        return { latencies[latencies.size() / 2], latencies[latencies.size() * 99 / 100], latencies.back() };
+    }
+
+    template<typename Buffer>
+    void Report(const char* name)
+    {
+        ThroughputResult throughput = MeasureThroughput<Buffer>();
+        LatencyResult latency = MeasureLatency<Buffer>();
+        printf("%-8s | %10.1f %10llu %11llu | %8.2f %8.2f %8.2f\n", name, throughput.nsPerPublish,
+            static_cast<unsigned long long>(throughput.acquired), static_cast<unsigned long long>(throughput.overwritten),
+            latency.p50Us, latency.p99Us, latency.maxUs);
+    }
+}
+
+int main()
+{
+    // 코어가 하나뿐이면 두 스레드가 번갈아 돌아서 latency가 타임 슬라이스 단위로 나온다
+    printf("%u hardware threads, %zu byte snapshot, %llu publishes, %u latency samples every %lld us\n",
+        thread::hardware_concurrency(), sizeof(SimulationSnapshot), static_cast<unsigned long long>(ThroughputPublishes),
+        LatencySamples, static_cast<long long>(LatencyInterval.count()));
+    printf("%-8s | %10s %10s %11s | %8s %8s %8s\n", "buffer", "ns/publish", "acquired", "overwritten", "p50 us", "p99 us", "max us");
+
+    Report<TripleBuffer<SimulationSnapshot>>("triple");
+    Report<MutexBuffer<SimulationSnapshot>>("mutex");
+    return 0;
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// 쓰는 스레드 하나, 읽는 스레드 하나 사이의 lock-free 트리플 버퍼
+// 쓰는 쪽은 back 슬롯에 쓰고 Publish로 middle과 바꾸고, 읽는 쪽은 Acquire로 front와 middle을 바꾼다
+// 슬롯을 복사하지 않고 인덱스만 바꾸므로 읽는 쪽은 항상 가장 최근에 완성된 슬롯을 참조로 본다
+template<typename T>
+class TripleBuffer
+{
+    static const uint8_t IndexMask = 0x3;
+    static const uint8_t DirtyBit = 0x4; // middle에 아직 읽지 않은 새 데이터가 있다
+
+    // 슬롯끼리 캐시 라인을 나눠 쓰지 않게 한다
+    struct alignas(64) Slot
+    {
+        T value;
+    };
+
+    Slot slots[3];
+    alignas(64) std::atomic<uint8_t> middle;
+    alignas(64) uint8_t back;  // 쓰는 스레드만 건드린다
+    alignas(64) uint8_t front; // 읽는 스레드만 건드린다
+
+public:
+    TripleBuffer()
+        : slots{}, middle(1), back(0), front(2)
+    {
+    }
+
+    T& GetWriteSlot() { return slots[back].value; }
+
+    // 쓰기가 끝난 back 슬롯을 내보낸다. 읽히지 않은 이전 데이터를 덮어썼으면 true
+    bool Publish()
+    {
+        uint8_t oldMiddle = middle.exchange(back | DirtyBit, std::memory_order_acq_rel);
+        back = oldMiddle & IndexMask;
+        return (oldMiddle & DirtyBit) != 0;
+    }
+
+    // 새로 내보낸 슬롯이 있으면 front로 가져온다. 없으면 front는 그대로다
+    bool Acquire()
+    {
+        if (!(middle.load(std::memory_order_relaxed) & DirtyBit))
+            return false;
+
+        uint8_t oldMiddle = middle.exchange(front, std::memory_order_acq_rel);
+        front = oldMiddle & IndexMask;
+        return true;
+    }
+
+    const T& GetReadSlot() const { return slots[front].value; }
+};
@@ -0,0 +1,43 @@
+// SM 6.6 bindless 경로
+// 입력 레이아웃도 descriptor table도 없고, root constant로 받은 인덱스로 ResourceDescriptorHeap에서 직접 꺼낸다
+
+struct Vertex
+{
+    float3 position;
+    float4 color;
+};
+
+// BindlessHeap::DrawConstants와 맞아야 한다
+struct DrawConstants
+{
+    uint vertexBufferIndex;
+    uint firstVertex;
+    uint materialIndex;
+    uint instanceIndex;
+};
+
+ConstantBuffer<DrawConstants> drawConstants : register(b0);
+
+struct PSInput
+{
+    float4 position : SV_POSITION;
+    float4 color : COLOR;
+};
+
+PSInput VSMain(uint vertexId : SV_VertexID)
+{
+    StructuredBuffer<Vertex> vertices = ResourceDescriptorHeap[drawConstants.vertexBufferIndex];
+    Vertex vertex = vertices[drawConstants.firstVertex + vertexId];
+
+    PSInput result;
+
+    result.position = float4(vertex.position, 1.0f);
+    result.color = vertex.color;
+
+    return result;
+}
+
+float4 PSMain(PSInput input) : SV_TARGET
+{
+    return input.color;
+}
@@ -0,0 +1,196 @@
+// clustered 조명. 빛을 뷰 공간 클러스터마다 배정하는 compute 셰이더와, 그 목록으로 바닥을 칠하는 셰이더
+// 배정은 ClusteredLights.cpp의 CPU 구현과 같은 판정을 같은 순서로 한다. GPU의 pow, log 오차로 경계에 걸친 빛만 다를 수 있다
+
+// ClusteredLights.h의 GpuLight와 맞아야 한다
+struct Light
+{
+    float3 position;
+    float range;
+    float3 color;
+    uint type;
+    float3 direction;
+    float cosOuterAngle;
+};
+
+// ClusteredLights.h의 ClusterConstants와 맞아야 한다
+cbuffer ClusterConstants : register(b0)
+{
+    uint tilesX;
+    uint tilesY;
+    uint slices;
+    uint lightCount;
+    float nearZ;
+    float farZ;
+    float tanHalfFovX;
+    float tanHalfFovY;
+    float viewportWidth;
+    float viewportHeight;
+    float sliceScale;
+    float sliceBias;
+    uint maxLightsPerCluster;
+    float floorY;
+    uint2 constantsPadding;
+};
+
+StructuredBuffer<Light> lights : register(t0);
+
+#define THREAD_GROUP_SIZE 64
+#define LIGHT_TYPE_SPOT 1
+
+static const float NarrowConeCos = 0.70710678f;
+
+// LightClusters::ComputeCullSphere와 같다. xyz가 중심, w가 반지름
+float4 ComputeCullSphere(Light light)
+{
+    if (light.type != LIGHT_TYPE_SPOT || light.cosOuterAngle <= 0.0f)
+        return float4(light.position, light.range);
+
+    float radius;
+    float offset;
+    if (light.cosOuterAngle > NarrowConeCos)
+    {
+        radius = light.range / (2.0f * light.cosOuterAngle);
+        offset = radius;
+    }
+    else
+    {
+        radius = light.range * sqrt(1.0f - light.cosOuterAngle * light.cosOuterAngle);
+        offset = light.range * light.cosOuterAngle;
+    }
+
+    return float4(light.position + light.direction * offset, radius);
+}
+
+// LightClusters::GetClusterIndex와 같다. 타일 y는 화면 위에서부터 센다
+uint GetClusterIndex(float2 pixel, float viewZ)
+{
+    uint slice = 0;
+    if (viewZ > nearZ)
+        slice = min(uint(max(floor(log(viewZ) * sliceScale + sliceBias), 0.0f)), slices - 1);
+
+    uint2 tile = min(uint2(max(pixel * float2(tilesX, tilesY) / float2(viewportWidth, viewportHeight), 0.0f)), uint2(tilesX - 1, tilesY - 1));
+    return (slice * tilesY + tile.y) * tilesX + tile.x;
+}
+
+RWStructuredBuffer<uint> clusterLightCounts : register(u0);
+RWStructuredBuffer<uint> clusterLightIndices : register(u1); // 클러스터마다 maxLightsPerCluster 칸
+
+groupshared float4 sharedSpheres[THREAD_GROUP_SIZE];
+
+// 스레드 하나가 클러스터 하나를 맡는다. 빛은 그룹이 같이 64개씩 공유 메모리로 올려서 본다
+// 빛 번호 순서대로 담으므로 CPU 구현과 목록 순서까지 같다
+[numthreads(THREAD_GROUP_SIZE, 1, 1)]
+void CSAssignLights(uint3 dispatchThreadId : SV_DispatchThreadID, uint groupIndex : SV_GroupIndex)
+{
+    uint clusterIndex = dispatchThreadId.x;
+    bool active = clusterIndex < tilesX * tilesY * slices;
+
+    // LightClusters::ComputeClusterBounds와 같다
+    uint tileX = clusterIndex % tilesX;
+    uint tileY = (clusterIndex / tilesX) % tilesY;
+    uint slice = clusterIndex / (tilesX * tilesY);
+
+    float2 ndcMin = float2(-1.0f + 2.0f * tileX / tilesX, 1.0f - 2.0f * (tileY + 1) / tilesY);
+    float2 ndcMax = float2(-1.0f + 2.0f * (tileX + 1) / tilesX, 1.0f - 2.0f * tileY / tilesY);
+    float depthRatio = farZ / nearZ;
+    float sliceNear = nearZ * pow(depthRatio, float(slice) / slices);
+    float sliceFar = nearZ * pow(depthRatio, float(slice + 1) / slices);
+
+    float2 tanHalfFov = float2(tanHalfFovX, tanHalfFovY);
+    float3 minCorner = float3(min(ndcMin * tanHalfFov * sliceNear, ndcMin * tanHalfFov * sliceFar), sliceNear);
+    float3 maxCorner = float3(max(ndcMax * tanHalfFov * sliceNear, ndcMax * tanHalfFov * sliceFar), sliceFar);
+
+    uint listBase = clusterIndex * maxLightsPerCluster;
+    uint count = 0;
+
+    for (uint batch = 0; batch < lightCount; batch += THREAD_GROUP_SIZE)
+    {
+        uint lightIndex = batch + groupIndex;
+        if (lightIndex < lightCount)
+            sharedSpheres[groupIndex] = ComputeCullSphere(lights[lightIndex]);
+
+        GroupMemoryBarrierWithGroupSync();
+
+        uint batchCount = min(uint(THREAD_GROUP_SIZE), lightCount - batch);
+        if (active)
+        {
+            for (uint i = 0; i < batchCount; i++)
+            {
+                // 구 중심에서 AABB까지 거리의 제곱
+                float4 sphere = sharedSpheres[i];
+                float3 d = max(max(minCorner - sphere.xyz, sphere.xyz - maxCorner), 0.0f);
+                if (d.x * d.x + d.y * d.y + d.z * d.z <= sphere.w * sphere.w)
+                {
+                    if (count < maxLightsPerCluster)
+                        clusterLightIndices[listBase + count] = batch + i;
+                    count++;
+                }
+            }
+        }
+
+        GroupMemoryBarrierWithGroupSync();
+    }
+
+    if (active)
+        clusterLightCounts[clusterIndex] = min(count, maxLightsPerCluster);
+}
+
+StructuredBuffer<uint> shadeLightCounts : register(t1);
+StructuredBuffer<uint> shadeLightIndices : register(t2);
+
+static const float3 AmbientLight = float3(0.04f, 0.04f, 0.05f);
+static const float SpotSoftness = 0.2f; // 원뿔 가장자리가 흐려지는 폭. cos 범위에서 바깥쪽 비율
+
+float3 EvaluateLight(Light light, float3 position)
+{
+    float3 toLight = light.position - position;
+    float distance = length(toLight);
+    if (distance >= light.range)
+        return 0.0f;
+
+    float3 direction = toLight / distance;
+    float attenuation = 1.0f - distance / light.range;
+    attenuation *= attenuation;
+
+    if (light.type == LIGHT_TYPE_SPOT)
+        attenuation *= smoothstep(light.cosOuterAngle, lerp(light.cosOuterAngle, 1.0f, SpotSoftness), dot(-direction, light.direction));
+
+    // 바닥 법선은 +y다
+    return light.color * (attenuation * saturate(direction.y));
+}
+
+// 화면을 덮는 삼각형 하나
+float4 VSFloor(uint vertexId : SV_VertexID) : SV_POSITION
+{
+    float2 uv = float2((vertexId << 1) & 2, vertexId & 2);
+    return float4(uv.x * 2.0f - 1.0f, 1.0f - uv.y * 2.0f, 0.0f, 1.0f);
+}
+
+// 픽셀마다 시선과 바닥 평면이 만나는 점을 구하고, 그 점이 속한 클러스터의 빛만 더한다
+float4 PSFloor(float4 position : SV_POSITION) : SV_TARGET
+{
+    float2 ndc = float2(position.x / viewportWidth * 2.0f - 1.0f, 1.0f - position.y / viewportHeight * 2.0f);
+    float3 ray = float3(ndc.x * tanHalfFovX, ndc.y * tanHalfFovY, 1.0f);
+
+    // 수평선 위와 far 너머는 지운 색을 그대로 둔다
+    if (ray.y >= 0.0f)
+        discard;
+
+    float3 viewPosition = ray * (floorY / ray.y);
+    if (viewPosition.z >= farZ)
+        discard;
+
+    // 체크 무늬 바닥
+    int2 checker = int2(floor(viewPosition.xz));
+    float3 albedo = ((checker.x + checker.y) & 1) ? float3(0.7f, 0.7f, 0.7f) : float3(0.45f, 0.45f, 0.5f);
+
+    uint clusterIndex = GetClusterIndex(position.xy, viewPosition.z);
+    uint count = shadeLightCounts[clusterIndex];
+    uint listBase = clusterIndex * maxLightsPerCluster;
+
+    float3 lighting = AmbientLight;
+    for (uint i = 0; i < count; i++)
+        lighting += EvaluateLight(lights[shadeLightIndices[listBase + i]], viewPosition);
+
+    return float4(albedo * lighting, 1.0f);
+}
@@ -0,0 +1,61 @@
+// 디버그 그리기. 선은 viewProjection으로 변환하고, 글자는 픽셀 좌표를 그대로 받아 글리프 아틀라스로 그린다
+
+// DebugDrawRenderer::DrawConstants와 맞아야 한다
+cbuffer DrawConstants : register(b0)
+{
+    row_major float4x4 viewProjection;
+    float2 viewportSize;
+    float2 constantsPadding;
+};
+
+// 아틀라스 텍셀 하나가 1바이트 커버리지다. DebugDraw::AtlasWidth, AtlasHeight와 맞아야 한다
+ByteAddressBuffer glyphAtlas : register(t0);
+
+#define ATLAS_WIDTH 128
+#define ATLAS_HEIGHT 96
+
+struct LinePSInput
+{
+    float4 position : SV_POSITION;
+    float4 color : COLOR;
+};
+
+LinePSInput VSLine(float3 position : POSITION, float4 color : COLOR)
+{
+    LinePSInput result;
+    result.position = mul(float4(position, 1.0f), viewProjection);
+    result.color = color;
+    return result;
+}
+
+float4 PSLine(LinePSInput input) : SV_TARGET
+{
+    return input.color;
+}
+
+struct TextPSInput
+{
+    float4 position : SV_POSITION;
+    float2 texel : TEXCOORD;
+    float4 color : COLOR;
+};
+
+TextPSInput VSText(float2 position : POSITION, float2 texel : TEXCOORD, float4 color : COLOR)
+{
+    TextPSInput result;
+    result.position = float4(position.x / viewportSize.x * 2.0f - 1.0f, 1.0f - position.y / viewportSize.y * 2.0f, 0.0f, 1.0f);
+    result.texel = texel;
+    result.color = color;
+    return result;
+}
+
+float4 PSText(TextPSInput input) : SV_TARGET
+{
+    // 샘플러 없이 가장 가까운 텍셀을 읽는다. 배율 1이면 픽셀과 텍셀이 정확히 맞는다
+    uint2 texel = min(uint2(input.texel), uint2(ATLAS_WIDTH - 1, ATLAS_HEIGHT - 1));
+    uint index = texel.y * ATLAS_WIDTH + texel.x;
+    uint word = glyphAtlas.Load(index & ~3u);
+    float coverage = ((word >> ((index & 3u) * 8u)) & 0xFFu) / 255.0f;
+
+    return float4(input.color.rgb, input.color.a * coverage);
+}
@@ -15,28 +15,10 @@ int WINAPI WinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance, _
     windowClass.lpszClassName = L"HelloWindow";
     RegisterClassEx(&windowClass);
 
-    RECT windowRect{ 0, 0, 1280, 720 };
-    AdjustWindowRect(&windowRect, WS_OVERLAPPEDWINDOW, FALSE);
-
-    // Create the window and store a handle to it.
-    HWND hWnd = CreateWindow(
-        windowClass.lpszClassName,
-        L"D3D12 Hello Window",
-        WS_OVERLAPPEDWINDOW,
-        CW_USEDEFAULT,
-        CW_USEDEFAULT,
-        windowRect.right - windowRect.left,
-        windowRect.bottom - windowRect.top,
-        nullptr,        // We have no parent window.
-        nullptr,        // We aren't using menus.
-        hInstance,
-        &myWindow);
-
-    if (!myWindow.OnInit(hWnd))
+    // 창 만들기는 device 생성, 셰이더 컴파일과 함께 OnInit의 StartupGraph 안에서 진행된다
+    if (!myWindow.OnInit(hInstance, windowClass.lpszClassName, nShowCmd))
         return 0;
 
-    ShowWindow(hWnd, nShowCmd);
-
     // Main sample loop.
     MSG msg = {};
     while (msg.message != WM_QUIT)
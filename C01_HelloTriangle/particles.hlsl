@@ -0,0 +1,161 @@
+// 파티클 시뮬레이션 compute 셰이더와 그리기 셰이더
+// ParticleSimulation.cpp의 CPU 구현과 같은 연산을 같은 순서로 한다. 상수도 같아야 한다
+
+// ParticleSimulation.h의 GpuParticle과 맞아야 한다
+struct Particle
+{
+    float2 position;
+    float2 velocity;
+    float age;
+    float lifetime;
+    uint id;
+    uint padding;
+};
+
+// ParticleSimulation.h의 ParticleConstants와 맞아야 한다
+cbuffer ParticleConstants : register(b0)
+{
+    float deltaTime;
+    uint emitCount;
+    uint emitBaseId;
+    uint seed;
+    uint capacity;
+    uint sourceIndex;
+    uint reset;
+    uint constantsPadding;
+};
+
+RWStructuredBuffer<Particle> sourceParticles : register(u0);
+RWStructuredBuffer<Particle> destParticles : register(u1);
+RWByteAddressBuffer counters : register(u2);     // [0], [1]: 핑퐁 버퍼별 살아있는 파티클 수
+RWByteAddressBuffer indirectArgs : register(u3); // ParticleSystem::DispatchArgsOffset, DrawArgsOffset
+
+#define THREAD_GROUP_SIZE 256
+#define DISPATCH_ARGS_OFFSET 0
+#define DRAW_ARGS_OFFSET 16
+
+static const float Gravity = -1.2f;
+static const float FloorY = -1.0f;
+static const float Restitution = 0.5f;
+static const float EmitterX = 0.0f;
+static const float EmitterY = -0.6f;
+static const float SpreadX = 0.8f;
+static const float LaunchSpeed = 0.8f;
+static const float LaunchSpread = 0.6f;
+static const float MinLifetime = 1.5f;
+static const float LifetimeRange = 1.5f;
+
+uint PcgHash(uint value)
+{
+    uint state = value * 747796405u + 2891336453u;
+    uint word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return (word >> 22u) ^ word;
+}
+
+float ToUnitFloat(uint hash)
+{
+    return float(hash >> 8) * (1.0f / 16777216.0f);
+}
+
+// 살아있는 파티클을 한 스텝 진행하고 살아남은 것만 dest에 붙인다
+// 스레드 그룹 수는 지난 프레임 CSArgs가 써둔 indirect 인자로 정해진다
+[numthreads(THREAD_GROUP_SIZE, 1, 1)]
+void CSSimulate(uint3 dispatchThreadId : SV_DispatchThreadID)
+{
+    uint index = dispatchThreadId.x;
+    if (index >= counters.Load(sourceIndex * 4))
+        return;
+
+    Particle particle = sourceParticles[index];
+
+    particle.velocity.y = particle.velocity.y + Gravity * deltaTime;
+    particle.position.x = particle.position.x + particle.velocity.x * deltaTime;
+    particle.position.y = particle.position.y + particle.velocity.y * deltaTime;
+
+    [flatten]
+    if (particle.position.y < FloorY)
+    {
+        particle.position.y = FloorY;
+        particle.velocity.y = -particle.velocity.y * Restitution;
+    }
+
+    particle.age = particle.age + deltaTime;
+    if (!(particle.age < particle.lifetime))
+        return;
+
+    uint destIndex;
+    counters.InterlockedAdd((1 - sourceIndex) * 4, 1, destIndex);
+    destParticles[destIndex] = particle;
+}
+
+// 새 파티클은 시뮬레이션이 끝난 뒤 dest 끝에 이어 붙인다. 카운터는 CSArgs에서 올린다
+[numthreads(THREAD_GROUP_SIZE, 1, 1)]
+void CSEmit(uint3 dispatchThreadId : SV_DispatchThreadID)
+{
+    uint index = dispatchThreadId.x;
+    uint destIndex = counters.Load((1 - sourceIndex) * 4) + index;
+    if (index >= emitCount || destIndex >= capacity)
+        return;
+
+    uint particleId = emitBaseId + index;
+    uint hash0 = PcgHash(particleId ^ seed);
+    uint hash1 = PcgHash(hash0);
+    uint hash2 = PcgHash(hash1);
+
+    Particle particle;
+    particle.position = float2(EmitterX, EmitterY);
+    particle.velocity.x = (ToUnitFloat(hash0) - 0.5f) * SpreadX;
+    particle.velocity.y = LaunchSpeed + ToUnitFloat(hash1) * LaunchSpread;
+    particle.age = 0.0f;
+    particle.lifetime = MinLifetime + ToUnitFloat(hash2) * LifetimeRange;
+    particle.id = particleId;
+    particle.padding = 0;
+
+    destParticles[destIndex] = particle;
+}
+
+// 스레드 하나로 이번 프레임 그리기 인자와 다음 프레임 시뮬레이션 dispatch 인자를 쓴다
+[numthreads(1, 1, 1)]
+void CSArgs()
+{
+    uint count = 0;
+    if (reset)
+    {
+        counters.Store2(0, uint2(0, 0));
+    }
+    else
+    {
+        uint destOffset = (1 - sourceIndex) * 4;
+        count = min(counters.Load(destOffset) + emitCount, capacity);
+        counters.Store(destOffset, count);
+        counters.Store(sourceIndex * 4, 0);
+    }
+
+    indirectArgs.Store3(DISPATCH_ARGS_OFFSET, uint3((count + THREAD_GROUP_SIZE - 1) / THREAD_GROUP_SIZE, 1, 1));
+    indirectArgs.Store4(DRAW_ARGS_OFFSET, uint4(count, 1, 0, 0));
+}
+
+StructuredBuffer<Particle> drawParticles : register(t0);
+
+struct PSInput
+{
+    float4 position : SV_POSITION;
+    float4 color : COLOR;
+};
+
+// 점 하나가 파티클 하나다. 나이가 들수록 노란색에서 붉은색으로 어두워진다
+PSInput VSMain(uint vertexId : SV_VertexID)
+{
+    Particle particle = drawParticles[vertexId];
+    float t = saturate(particle.age / particle.lifetime);
+
+    PSInput result;
+    result.position = float4(particle.position, 0.0f, 1.0f);
+    result.color = float4(lerp(float3(1.0f, 0.9f, 0.3f), float3(0.6f, 0.1f, 0.05f), t), 1.0f);
+    return result;
+}
+
+float4 PSMain(PSInput input) : SV_TARGET
+{
+    return input.color;
+}